@@ -67,6 +67,13 @@ CREATE OR REPLACE FUNCTION _timescaledb_functions.recompress_chunk_segmentwise(
 CREATE OR REPLACE FUNCTION _timescaledb_functions.get_compressed_chunk_index_for_recompression(
     uncompressed_chunk REGCLASS
 ) RETURNS REGCLASS AS '@MODULE_PATHNAME@', 'ts_get_compressed_chunk_index_for_recompression' LANGUAGE C STRICT VOLATILE;
+
+-- merge adjacent compressed batches of the same segment that are below the fill factor
+-- returns the number of batches that were merged
+CREATE OR REPLACE FUNCTION _timescaledb_functions.compact_chunk(
+    uncompressed_chunk REGCLASS,
+    min_fill_factor FLOAT8 = 0.5
+) RETURNS INTEGER AS '@MODULE_PATHNAME@', 'ts_compact_chunk' LANGUAGE C STRICT VOLATILE;
 -- Recompress a chunk
 --
 -- Will give an error if the chunk was not already compressed. In this
@@ -43,7 +43,8 @@ _timescaledb_functions.policy_compression_execute(
   verbose_log         BOOLEAN,
   recompress_enabled  BOOLEAN,
   use_creation_time   BOOLEAN,
-  useam               BOOLEAN = NULL)
+  useam               BOOLEAN = NULL,
+  compact_enabled     BOOLEAN = false)
 AS $$
 DECLARE
   htoid       REGCLASS;
@@ -132,6 +133,10 @@ BEGIN
         -- or if we'd better fall back to decompressing & recompressing entire chunk
         IF _timescaledb_functions.get_compressed_chunk_index_for_recompression(chunk_rec.oid) IS NOT NULL THEN
           PERFORM _timescaledb_functions.recompress_chunk_segmentwise(chunk_rec.oid);
+          -- segmentwise recompression leaves small batches behind, merge them
+          IF compact_enabled IS TRUE THEN
+            PERFORM _timescaledb_functions.compact_chunk(chunk_rec.oid);
+          END IF;
         ELSE
           PERFORM @extschema@.decompress_chunk(chunk_rec.oid, if_compressed => true);
           PERFORM @extschema@.compress_chunk(chunk_rec.oid, hypercore_use_access_method => useam);
@@ -188,6 +193,7 @@ DECLARE
   recompress_enabled  BOOL;
   use_creation_time   BOOL := FALSE;
   hypercore_use_access_method   BOOL;
+  compact_enabled     BOOL;
 BEGIN
 
   -- procedures with SET clause cannot execute transaction
@@ -206,6 +212,7 @@ BEGIN
   verbose_log         := COALESCE(jsonb_object_field_text(config, 'verbose_log')::BOOLEAN, FALSE);
   maxchunks           := COALESCE(jsonb_object_field_text(config, 'maxchunks_to_compress')::INTEGER, 0);
   recompress_enabled  := COALESCE(jsonb_object_field_text(config, 'recompress')::BOOLEAN, TRUE);
+  compact_enabled     := COALESCE(jsonb_object_field_text(config, 'compact_batches')::BOOLEAN, FALSE);
 
   -- find primary dimension type --
   SELECT dim.column_type INTO dimtype
@@ -235,22 +242,26 @@ BEGIN
     WHEN 'TIMESTAMP'::regtype, 'TIMESTAMPTZ'::regtype, 'DATE'::regtype, 'INTERVAL' ::regtype  THEN
       CALL _timescaledb_functions.policy_compression_execute(
         job_id, htid, lag_value::INTERVAL,
-        maxchunks, verbose_log, recompress_enabled, use_creation_time, hypercore_use_access_method
+        maxchunks, verbose_log, recompress_enabled, use_creation_time, hypercore_use_access_method,
+        compact_enabled
       );
     WHEN 'BIGINT'::regtype THEN
       CALL _timescaledb_functions.policy_compression_execute(
         job_id, htid, lag_value::BIGINT,
-        maxchunks, verbose_log, recompress_enabled, use_creation_time, hypercore_use_access_method
+        maxchunks, verbose_log, recompress_enabled, use_creation_time, hypercore_use_access_method,
+        compact_enabled
       );
     WHEN 'INTEGER'::regtype THEN
       CALL _timescaledb_functions.policy_compression_execute(
         job_id, htid, lag_value::INTEGER,
-        maxchunks, verbose_log, recompress_enabled, use_creation_time, hypercore_use_access_method
+        maxchunks, verbose_log, recompress_enabled, use_creation_time, hypercore_use_access_method,
+        compact_enabled
       );
     WHEN 'SMALLINT'::regtype THEN
       CALL _timescaledb_functions.policy_compression_execute(
         job_id, htid, lag_value::SMALLINT,
-        maxchunks, verbose_log, recompress_enabled, use_creation_time, hypercore_use_access_method
+        maxchunks, verbose_log, recompress_enabled, use_creation_time, hypercore_use_access_method,
+        compact_enabled
       );
   END CASE;
 END;
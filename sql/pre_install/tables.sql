@@ -134,6 +134,19 @@ SELECT pg_catalog.pg_extension_config_dump('_timescaledb_catalog.dimension_slice
 
 SELECT pg_catalog.pg_extension_config_dump(pg_get_serial_sequence('_timescaledb_catalog.dimension_slice', 'id'), '');
 
+-- The version of the slices of a dimension. It is incremented by every
+-- transaction that inserts or updates slices of the dimension, so that
+-- backends caching the slices can check that the cache is current.
+CREATE TABLE _timescaledb_catalog.dimension_slice_version (
+  dimension_id integer NOT NULL,
+  version bigint NOT NULL,
+  -- table constraints
+  CONSTRAINT dimension_slice_version_pkey PRIMARY KEY (dimension_id),
+  CONSTRAINT dimension_slice_version_dimension_id_fkey FOREIGN KEY (dimension_id) REFERENCES _timescaledb_catalog.dimension (id) ON DELETE CASCADE
+);
+
+SELECT pg_catalog.pg_extension_config_dump('_timescaledb_catalog.dimension_slice_version', '');
+
 -- A chunk is a partition (hypercube) in an N-dimensional
 -- hyperspace. Each chunk is associated with N constraints that define
 -- the chunk's hypercube. Tuples that fall within the chunk's
@@ -476,6 +489,9 @@ CREATE TABLE _timescaledb_catalog.compression_settings (
   orderby text[],
   orderby_desc bool[],
   orderby_nullsfirst bool[],
+  toast_compression text,
+  batch_size int,
+  batch_target_size bigint,
   CONSTRAINT compression_settings_pkey PRIMARY KEY (relid),
   CONSTRAINT compression_settings_check_segmentby CHECK (array_ndims(segmentby) = 1),
   CONSTRAINT compression_settings_check_orderby_null CHECK ((orderby IS NULL AND orderby_desc IS NULL AND orderby_nullsfirst IS NULL) OR (orderby IS NOT NULL AND orderby_desc IS NOT NULL AND orderby_nullsfirst IS NOT NULL)),
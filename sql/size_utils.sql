@@ -544,6 +544,52 @@ BEGIN
 END;
 $BODY$ SET search_path TO pg_catalog, pg_temp;
 
+-- Get the batch statistics of the compressed chunks of a hypertable.
+-- The fill factor is the average number of rows per batch relative to the
+-- batch size in the compression settings of the chunk, set with the
+-- timescaledb.compress_batch_size option. When the batch target size is set,
+-- it is the larger of that and the average size of the batches relative to the
+-- target size. Chunks with a low fill factor can be compacted with
+-- _timescaledb_functions.compact_chunk.
+CREATE OR REPLACE FUNCTION _timescaledb_functions.compressed_chunk_batch_stats (hypertable REGCLASS)
+    RETURNS TABLE (
+        chunk_schema name,
+        chunk_name name,
+        total_batches bigint,
+        total_rows bigint,
+        fill_factor float8)
+    LANGUAGE PLPGSQL
+    STABLE STRICT
+    AS $BODY$
+DECLARE
+    chunk_rec RECORD;
+    total_bytes bigint;
+BEGIN
+    FOR chunk_rec IN
+        SELECT srcch.schema_name, srcch.table_name, comp.schema_name AS comp_schema_name, comp.table_name AS comp_table_name,
+               coalesce(s.batch_size, 1000) AS batch_size, coalesce(s.batch_target_size, 0) AS target_bytes
+        FROM _timescaledb_catalog.hypertable ht
+        INNER JOIN _timescaledb_catalog.chunk srcch ON srcch.hypertable_id = ht.id
+        INNER JOIN _timescaledb_catalog.chunk comp ON comp.id = srcch.compressed_chunk_id
+        LEFT JOIN _timescaledb_catalog.compression_settings s ON s.relid = format('%I.%I', comp.schema_name, comp.table_name)::regclass
+        WHERE format('%I.%I', ht.schema_name, ht.table_name)::regclass = hypertable
+          AND NOT srcch.dropped
+        ORDER BY srcch.id
+    LOOP
+        chunk_schema := chunk_rec.schema_name;
+        chunk_name := chunk_rec.table_name;
+        EXECUTE format('SELECT count(*), coalesce(sum(_ts_meta_count), 0), coalesce(sum(pg_column_size(c.*)), 0) FROM %I.%I c',
+                       chunk_rec.comp_schema_name, chunk_rec.comp_table_name)
+        INTO total_batches, total_rows, total_bytes;
+        fill_factor := CASE WHEN total_batches > 0 THEN total_rows::float8 / (total_batches * chunk_rec.batch_size) END;
+        IF total_batches > 0 AND chunk_rec.target_bytes > 0 THEN
+            fill_factor := greatest(fill_factor, total_bytes::float8 / (total_batches * chunk_rec.target_bytes));
+        END IF;
+        RETURN NEXT;
+    END LOOP;
+END;
+$BODY$ SET search_path TO pg_catalog, pg_temp;
+
 CREATE OR REPLACE FUNCTION @extschema@.chunk_columnstore_stats (hypertable REGCLASS)
     RETURNS TABLE (
         chunk_schema name,
@@ -45,6 +45,33 @@ AS '@MODULE_PATHNAME@', 'ts_update_placeholder'
 LANGUAGE C VOLATILE;
 
 DROP PROCEDURE IF EXISTS _timescaledb_functions.policy_compression_execute(job_id INTEGER, htid INTEGER, lag ANYELEMENT, maxchunks INTEGER, verbose_log BOOLEAN, recompress_enabled  BOOLEAN, use_creation_time BOOLEAN);
+DROP PROCEDURE IF EXISTS _timescaledb_functions.policy_compression_execute(job_id INTEGER, htid INTEGER, lag ANYELEMENT, maxchunks INTEGER, verbose_log BOOLEAN, recompress_enabled  BOOLEAN, use_creation_time BOOLEAN, useam BOOLEAN);
+
+CREATE PROCEDURE _timescaledb_functions.policy_compression_execute(
+  job_id              INTEGER,
+  htid                INTEGER,
+  lag                 ANYELEMENT,
+  maxchunks           INTEGER,
+  verbose_log         BOOLEAN,
+  recompress_enabled  BOOLEAN,
+  use_creation_time   BOOLEAN,
+  useam               BOOLEAN = NULL,
+  compact_enabled     BOOLEAN = false)
+AS $$BEGIN END$$ LANGUAGE PLPGSQL SET search_path TO pg_catalog, pg_temp;
+
+CREATE FUNCTION _timescaledb_functions.compact_chunk(
+    uncompressed_chunk REGCLASS,
+    min_fill_factor FLOAT8 = 0.5
+) RETURNS INTEGER AS '@MODULE_PATHNAME@', 'ts_update_placeholder' LANGUAGE C STRICT VOLATILE;
+
+CREATE FUNCTION _timescaledb_functions.compressed_chunk_batch_stats (hypertable REGCLASS)
+    RETURNS TABLE (
+        chunk_schema name,
+        chunk_name name,
+        total_batches bigint,
+        total_rows bigint,
+        fill_factor float8)
+    AS $$BEGIN END$$ LANGUAGE PLPGSQL STABLE STRICT SET search_path TO pg_catalog, pg_temp;
 
 DROP PROCEDURE IF EXISTS _timescaledb_functions.policy_compression(job_id INTEGER, config JSONB);
 
@@ -114,3 +141,34 @@ CREATE FUNCTION @extschema@.hypertable_columnstore_stats (hypertable REGCLASS)
     STABLE STRICT
     AS 'SELECT * FROM @extschema@.hypertable_compression_stats($1)'
     SET search_path TO pg_catalog, pg_temp;
+
+-- Bool compression algorithm
+INSERT INTO _timescaledb_catalog.compression_algorithm( id, version, name, description) values
+( 5, 1, 'COMPRESSION_ALGORITHM_BOOL', 'bool');
+
+-- UUID compression algorithm
+INSERT INTO _timescaledb_catalog.compression_algorithm( id, version, name, description) values
+( 6, 1, 'COMPRESSION_ALGORITHM_UUID', 'uuid');
+
+-- TOAST compression method of the compressed columns
+ALTER TABLE _timescaledb_catalog.compression_settings ADD COLUMN toast_compression text;
+
+-- Batch size and batch target size of the compressed batches
+ALTER TABLE _timescaledb_catalog.compression_settings ADD COLUMN batch_size int;
+ALTER TABLE _timescaledb_catalog.compression_settings ADD COLUMN batch_target_size bigint;
+
+-- Version of the slices of each dimension
+CREATE TABLE _timescaledb_catalog.dimension_slice_version (
+  dimension_id integer NOT NULL,
+  version bigint NOT NULL,
+  -- table constraints
+  CONSTRAINT dimension_slice_version_pkey PRIMARY KEY (dimension_id),
+  CONSTRAINT dimension_slice_version_dimension_id_fkey FOREIGN KEY (dimension_id) REFERENCES _timescaledb_catalog.dimension (id) ON DELETE CASCADE
+);
+
+INSERT INTO _timescaledb_catalog.dimension_slice_version (dimension_id, version)
+  SELECT id, 0 FROM _timescaledb_catalog.dimension;
+
+SELECT pg_catalog.pg_extension_config_dump('_timescaledb_catalog.dimension_slice_version', '');
+
+GRANT SELECT ON TABLE _timescaledb_catalog.dimension_slice_version TO PUBLIC;
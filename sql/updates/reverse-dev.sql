@@ -41,7 +41,9 @@ RETURNS BOOL
 AS '@MODULE_PATHNAME@', 'ts_policies_add'
 LANGUAGE C VOLATILE;
 
-DROP PROCEDURE IF EXISTS _timescaledb_functions.policy_compression_execute(job_id INTEGER, htid INTEGER, lag ANYELEMENT, maxchunks INTEGER, verbose_log BOOLEAN, recompress_enabled  BOOLEAN, use_creation_time BOOLEAN, useam BOOLEAN);
+DROP PROCEDURE IF EXISTS _timescaledb_functions.policy_compression_execute(job_id INTEGER, htid INTEGER, lag ANYELEMENT, maxchunks INTEGER, verbose_log BOOLEAN, recompress_enabled  BOOLEAN, use_creation_time BOOLEAN, useam BOOLEAN, compact_enabled BOOLEAN);
+DROP FUNCTION IF EXISTS _timescaledb_functions.compact_chunk(REGCLASS, FLOAT8);
+DROP FUNCTION IF EXISTS _timescaledb_functions.compressed_chunk_batch_stats(REGCLASS);
 
 DROP PROCEDURE IF EXISTS _timescaledb_functions.policy_compression(job_id INTEGER, config JSONB);
 DROP PROCEDURE IF EXISTS @extschema@.convert_to_columnstore(REGCLASS, BOOLEAN, BOOLEAN, BOOLEAN);
@@ -58,3 +60,51 @@ DROP VIEW timescaledb_information.hypertable_columnstore_settings;
 DROP VIEW timescaledb_information.chunk_columnstore_settings;
 
 DROP PROCEDURE IF EXISTS _timescaledb_functions.cagg_migrate_update_watermark(INTEGER);
+
+-- Bool compression algorithm
+DELETE FROM _timescaledb_catalog.compression_algorithm WHERE id = 5 AND version = 1 AND name = 'COMPRESSION_ALGORITHM_BOOL';
+
+-- UUID compression algorithm
+DELETE FROM _timescaledb_catalog.compression_algorithm WHERE id = 6 AND version = 1 AND name = 'COMPRESSION_ALGORITHM_UUID';
+
+-- Rebuild the compression settings without the columns added since the
+-- previous version
+ALTER EXTENSION timescaledb DROP VIEW timescaledb_information.compression_settings;
+ALTER EXTENSION timescaledb DROP VIEW timescaledb_information.hypertable_compression_settings;
+ALTER EXTENSION timescaledb DROP VIEW timescaledb_information.chunk_compression_settings;
+DROP VIEW timescaledb_information.compression_settings;
+DROP VIEW timescaledb_information.hypertable_compression_settings;
+DROP VIEW timescaledb_information.chunk_compression_settings;
+
+CREATE TABLE _timescaledb_catalog._tmp_compression_settings AS
+    SELECT relid, segmentby, orderby, orderby_desc, orderby_nullsfirst
+    FROM _timescaledb_catalog.compression_settings;
+
+ALTER EXTENSION timescaledb DROP TABLE _timescaledb_catalog.compression_settings;
+DROP TABLE _timescaledb_catalog.compression_settings;
+
+CREATE TABLE _timescaledb_catalog.compression_settings (
+  relid regclass NOT NULL,
+  segmentby text[],
+  orderby text[],
+  orderby_desc bool[],
+  orderby_nullsfirst bool[],
+  CONSTRAINT compression_settings_pkey PRIMARY KEY (relid),
+  CONSTRAINT compression_settings_check_segmentby CHECK (array_ndims(segmentby) = 1),
+  CONSTRAINT compression_settings_check_orderby_null CHECK ((orderby IS NULL AND orderby_desc IS NULL AND orderby_nullsfirst IS NULL) OR (orderby IS NOT NULL AND orderby_desc IS NOT NULL AND orderby_nullsfirst IS NOT NULL)),
+  CONSTRAINT compression_settings_check_orderby_cardinality CHECK (array_ndims(orderby) = 1 AND array_ndims(orderby_desc) = 1 AND array_ndims(orderby_nullsfirst) = 1 AND cardinality(orderby) = cardinality(orderby_desc) AND cardinality(orderby) = cardinality(orderby_nullsfirst))
+);
+
+INSERT INTO _timescaledb_catalog.compression_settings
+  SELECT * FROM _timescaledb_catalog._tmp_compression_settings;
+
+DROP TABLE _timescaledb_catalog._tmp_compression_settings;
+
+SELECT pg_catalog.pg_extension_config_dump('_timescaledb_catalog.compression_settings', '');
+
+GRANT SELECT ON TABLE _timescaledb_catalog.compression_settings TO PUBLIC;
+
+ANALYZE _timescaledb_catalog.compression_settings;
+
+ALTER EXTENSION timescaledb DROP TABLE _timescaledb_catalog.dimension_slice_version;
+DROP TABLE _timescaledb_catalog.dimension_slice_version;
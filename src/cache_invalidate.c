@@ -21,6 +21,7 @@
 #include "bgw/scheduler.h"
 #include "cache_invalidate.h"
 #include "cross_module_fn.h"
+#include "dimension_slice_cache.h"
 
 /*
  * Notes on the way cache invalidation works.
@@ -58,6 +59,7 @@ cache_invalidate_relcache_all(void)
 {
 	ts_hypertable_cache_invalidate_callback();
 	ts_bgw_job_cache_invalidate_callback();
+	ts_dimension_slice_cache_invalidate_callback();
 }
 
 static Oid hypertable_proxy_table_oid = InvalidOid;
@@ -99,6 +101,10 @@ cache_invalidate_relcache_callback(Datum arg, Oid relid)
 	{
 		ts_bgw_job_cache_invalidate_callback();
 	}
+	else
+	{
+		ts_dimension_slice_cache_invalidate_relation(relid);
+	}
 }
 
 TS_FUNCTION_INFO_V1(ts_timescaledb_invalidate_cache);
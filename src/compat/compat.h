@@ -661,6 +661,16 @@ RelationGetSmgr(Relation rel)
 #define pgstat_get_local_beentry_by_index_compat(idx) pgstat_fetch_stat_local_beentry(idx)
 #endif
 
+/*
+ * PG16 renamed the RelFileNode of a relation to RelFileLocator and its
+ * relNode field to relNumber.
+ */
+#if PG16_GE
+#define RelationGetRelfilenumberCompat(rel) ((rel)->rd_locator.relNumber)
+#else
+#define RelationGetRelfilenumberCompat(rel) ((rel)->rd_node.relNode)
+#endif
+
 /*
  * PG16 adds a new parameter to DefineIndex, total_parts, that takes
  * in the total number of direct and indirect partitions of the relation.
@@ -6,6 +6,7 @@
 
 #include <postgres.h>
 #include <access/htup_details.h>
+#include <access/toast_compression.h>
 #include <catalog/dependency.h>
 #include <catalog/namespace.h>
 #include <catalog/pg_trigger.h>
@@ -15,6 +16,7 @@
 #include <parser/parser.h>
 #include <storage/lmgr.h>
 #include <utils/builtins.h>
+#include <utils/guc.h>
 #include <utils/lsyscache.h>
 #include <utils/typcache.h>
 
@@ -41,6 +43,18 @@ static const WithClauseDefinition compress_hypertable_with_clause_def[] = {
 			.arg_names = {"compress_chunk_time_interval", NULL},
 			 .type_id = INTERVALOID,
 		},
+		[CompressToastCompression] = {
+			.arg_names = {"compress_toast_compression", NULL},
+			 .type_id = TEXTOID,
+		},
+		[CompressBatchSize] = {
+			.arg_names = {"compress_batch_size", NULL},
+			 .type_id = INT4OID,
+		},
+		[CompressBatchTargetSize] = {
+			.arg_names = {"compress_batch_target_size", NULL},
+			 .type_id = TEXTOID,
+		},
 };
 
 WithClauseResult *
@@ -342,3 +356,83 @@ ts_compress_hypertable_parse_chunk_time_interval(WithClauseResult *parsed_option
 	else
 		return NULL;
 }
+
+/*
+ * Parse the TOAST compression method used for the compressed columns, e.g.
+ * 'lz4' or 'pglz'. Returns InvalidCompressionMethod if the option is not set.
+ */
+char
+ts_compress_hypertable_parse_toast_compression(WithClauseResult *parsed_options)
+{
+	if (parsed_options[CompressToastCompression].is_default)
+		return InvalidCompressionMethod;
+
+	char *method_name = TextDatumGetCString(parsed_options[CompressToastCompression].parsed);
+	char method = CompressionNameToMethod(method_name);
+
+	if (!CompressionMethodIsValid(method))
+		ereport(ERROR,
+				(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+				 errmsg("invalid compression method \"%s\"", method_name),
+				 errhint("The option timescaledb.compress_toast_compression must be one of the "
+						 "TOAST compression methods, e.g. \"pglz\" or \"lz4\".")));
+
+#ifndef USE_LZ4
+	if (method == TOAST_LZ4_COMPRESSION)
+		ereport(ERROR,
+				(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+				 errmsg("compression method lz4 not supported"),
+				 errdetail("This functionality requires the server to be built with lz4 "
+						   "support.")));
+#endif
+
+	return method;
+}
+
+/*
+ * Parse the maximum number of rows in a compressed batch. Returns 0 if the
+ * option is not set, in which case the default batch size is used.
+ */
+int32
+ts_compress_hypertable_parse_batch_size(WithClauseResult *parsed_options)
+{
+	if (parsed_options[CompressBatchSize].is_default)
+		return 0;
+
+	int32 batch_size = DatumGetInt32(parsed_options[CompressBatchSize].parsed);
+
+	if (batch_size < 1 || batch_size > PG_INT16_MAX)
+		ereport(ERROR,
+				(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+				 errmsg("invalid batch size %d", batch_size),
+				 errhint("The option timescaledb.compress_batch_size must be between 1 and %d.",
+						 PG_INT16_MAX)));
+
+	return batch_size;
+}
+
+/*
+ * Parse the target size of a compressed batch in bytes, e.g. '8kB'. A value
+ * without unit is taken as kilobytes, the same as for memory settings. Returns
+ * 0 if the option is not set or the adaptive batch size is disabled.
+ */
+int64
+ts_compress_hypertable_parse_batch_target_size(WithClauseResult *parsed_options)
+{
+	if (parsed_options[CompressBatchTargetSize].is_default)
+		return 0;
+
+	char *value = TextDatumGetCString(parsed_options[CompressBatchTargetSize].parsed);
+	const char *hintmsg = NULL;
+	int kilobytes;
+
+	if (!parse_int(value, &kilobytes, GUC_UNIT_KB, &hintmsg) || kilobytes < 0 ||
+		kilobytes > MAX_KILOBYTES)
+		ereport(ERROR,
+				(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+				 errmsg("invalid batch target size \"%s\"", value),
+				 errhint("The option timescaledb.compress_batch_target_size must be a size, "
+						 "e.g. \"8kB\", or 0 to disable the adaptive batch size.")));
+
+	return kilobytes * INT64CONST(1024);
+}
@@ -19,6 +19,9 @@ typedef enum CompressHypertableOption
 	CompressSegmentBy,
 	CompressOrderBy,
 	CompressChunkTimeInterval,
+	CompressToastCompression,
+	CompressBatchSize,
+	CompressBatchTargetSize,
 	CompressOptionMax
 } CompressHypertableOption;
 
@@ -44,5 +47,10 @@ ts_compress_hypertable_parse_order_by(WithClauseResult *parsed_options, Hypertab
 extern TSDLLEXPORT Interval *
 ts_compress_hypertable_parse_chunk_time_interval(WithClauseResult *parsed_options,
 												 Hypertable *hypertable);
+extern TSDLLEXPORT char
+ts_compress_hypertable_parse_toast_compression(WithClauseResult *parsed_options);
+extern TSDLLEXPORT int32 ts_compress_hypertable_parse_batch_size(WithClauseResult *parsed_options);
+extern TSDLLEXPORT int64
+ts_compress_hypertable_parse_batch_target_size(WithClauseResult *parsed_options);
 extern TSDLLEXPORT OrderBySettings ts_compress_parse_order_collist(char *inpstr,
 																   Hypertable *hypertable);
@@ -58,6 +58,7 @@
 
 #include "compat/compat.h"
 #include "copy.h"
+#include "copy_parallel.h"
 #include "cross_module_fn.h"
 #include "dimension.h"
 #include "hypertable.h"
@@ -165,11 +166,13 @@ copy_chunk_state_create(Hypertable *ht, Relation rel, CopyFromFunc from_func, Co
 	/* In the copy path, no chunk dispatch node and no chunk dispatch state is available. Create an
 	 * empty state to be able to count decompressed tuples. */
 	ccstate->dispatch->dispatch_state = palloc0(sizeof(ChunkDispatchState));
+	ccstate->dispatch->dispatch_state->dispatch = ccstate->dispatch;
 
 	ccstate->cstate = cstate;
 	ccstate->scandesc = scandesc;
 	ccstate->next_copy_from = from_func;
 	ccstate->where_clause = NULL;
+	ccstate->parallel_state = NULL;
 
 	return ccstate;
 }
@@ -337,12 +340,23 @@ TSCopyMultiInsertBufferFlush(TSCopyMultiInsertInfo *miinfo, TSCopyMultiInsertBuf
 		cstate->line_buf_valid = false;
 	}
 
-	table_multi_insert(resultRelInfo->ri_RelationDesc,
-					   slots,
-					   nused,
-					   mycid,
-					   ti_options,
-					   buffer->bistate);
+	if (cis->compressed_insert_buffer != NULL)
+	{
+		/*
+		 * The tuples are compressed directly into the compressed chunk, so
+		 * they are not added to the indexes of the uncompressed chunk. There
+		 * are no row triggers on the chunk in this case.
+		 */
+		for (i = 0; i < nused; i++)
+			ts_chunk_dispatch_compress_tuple(miinfo->ccstate->dispatch, cis, slots[i]);
+	}
+	else
+		table_multi_insert(resultRelInfo->ri_RelationDesc,
+						   slots,
+						   nused,
+						   mycid,
+						   ti_options,
+						   buffer->bistate);
 	MemoryContextSwitchTo(oldcontext);
 
 	for (i = 0; i < nused; i++)
@@ -353,7 +367,7 @@ TSCopyMultiInsertBufferFlush(TSCopyMultiInsertInfo *miinfo, TSCopyMultiInsertBuf
 		 * If there are any indexes, update them for all the inserted tuples,
 		 * and run AFTER ROW INSERT triggers.
 		 */
-		if (resultRelInfo->ri_NumIndices > 0)
+		if (resultRelInfo->ri_NumIndices > 0 && cis->compressed_insert_buffer == NULL)
 		{
 			List *recheckIndexes;
 
@@ -626,6 +640,14 @@ next_copy_from(CopyChunkState *ccstate, ExprContext *econtext, Datum *values, bo
 	return NextCopyFrom(ccstate->cstate, econtext, values, nulls);
 }
 
+static bool
+next_copy_from_parallel(CopyChunkState *ccstate, ExprContext *econtext, Datum *values,
+						bool *nulls)
+{
+	Assert(ccstate->parallel_state != NULL);
+	return ts_copy_parallel_next(ccstate->parallel_state, econtext, values, nulls);
+}
+
 /*
  * Error context callback when copying from table to chunk.
  */
@@ -920,6 +942,13 @@ copyfrom(CopyChunkState *ccstate, ParseState *pstate, Hypertable *ht, MemoryCont
 		/* Calculate the tuple's point in the N-dimensional hyperspace */
 		point = ts_hyperspace_calculate_point(ht->space, myslot);
 
+		/*
+		 * Chunks can't be looked up or created in the catalog while workers
+		 * parse the input in parallel mode.
+		 */
+		if (ccstate->parallel_state != NULL && !ts_chunk_dispatch_has_cached_chunk(dispatch, point))
+			ts_copy_parallel_pause(ccstate->parallel_state);
+
 		/* Find or create the insert state matching the point */
 		cis = ts_chunk_dispatch_get_chunk_insert_state(dispatch,
 													   point,
@@ -1046,13 +1075,16 @@ copyfrom(CopyChunkState *ccstate, ParseState *pstate, Hypertable *ht, MemoryCont
 			if (currentTupleInsertMethod == CIM_SINGLE)
 			{
 				/* OK, store the tuple and create index entries for it */
-				table_tuple_insert(resultRelInfo->ri_RelationDesc,
-								   myslot,
-								   mycid,
-								   ti_options,
-								   bistate);
+				if (cis->compressed_insert_buffer != NULL)
+					ts_chunk_dispatch_compress_tuple(dispatch, cis, myslot);
+				else
+					table_tuple_insert(resultRelInfo->ri_RelationDesc,
+									   myslot,
+									   mycid,
+									   ti_options,
+									   bistate);
 
-				if (resultRelInfo->ri_NumIndices > 0)
+				if (resultRelInfo->ri_NumIndices > 0 && cis->compressed_insert_buffer == NULL)
 					recheckIndexes = ExecInsertIndexTuplesCompat(resultRelInfo,
 																 myslot,
 																 estate,
@@ -1118,6 +1150,10 @@ copyfrom(CopyChunkState *ccstate, ParseState *pstate, Hypertable *ht, MemoryCont
 	if (insertMethod != CIM_SINGLE)
 		TSCopyMultiInsertInfoFlushAndCleanup(&multiInsertInfo);
 
+	/* Compress the tuples buffered for direct compression before the AFTER
+	 * triggers run */
+	ts_chunk_dispatch_flush_batches(dispatch);
+
 	/* Done, clean up */
 	if (ccstate->cstate && callback)
 		error_context_stack = errcallback.previous;
@@ -1344,15 +1380,6 @@ timescaledb_DoCopy(const CopyStmt *stmt, const char *queryString, uint64 *proces
 	pstate->p_sourcetext = queryString;
 	copy_constraints_and_check(pstate, rel, attnums);
 
-	cstate = BeginCopyFrom(pstate,
-						   rel,
-						   NULL,
-						   stmt->filename,
-						   stmt->is_program,
-						   NULL,
-						   stmt->attlist,
-						   stmt->options);
-
 	if (stmt->whereClause)
 	{
 		where_clause = transformExpr(pstate, stmt->whereClause, EXPR_KIND_COPY_WHERE);
@@ -1366,11 +1393,29 @@ timescaledb_DoCopy(const CopyStmt *stmt, const char *queryString, uint64 *proces
 		where_clause = (Node *) make_ands_implicit((Expr *) where_clause);
 	}
 
+	cstate = BeginCopyFrom(pstate,
+						   rel,
+						   where_clause,
+						   stmt->filename,
+						   stmt->is_program,
+						   NULL,
+						   stmt->attlist,
+						   stmt->options);
+
 	ccstate = copy_chunk_state_create(ht, rel, next_copy_from, cstate, NULL);
 	ccstate->where_clause = where_clause;
+
+	/* Parse the input with parallel workers if enabled and supported */
+	ccstate->parallel_state = ts_copy_parallel_begin(cstate, rel);
+	if (ccstate->parallel_state != NULL)
+		ccstate->next_copy_from = next_copy_from_parallel;
+
 	copycontext = cstate->copycontext;
 	*processed = copyfrom(ccstate, pstate, ht, copycontext, CopyFromErrorCallback, cstate);
 
+	if (ccstate->parallel_state != NULL)
+		ts_copy_parallel_end(ccstate->parallel_state);
+
 	copy_chunk_state_destroy(ccstate);
 	EndCopyFrom(cstate);
 	free_parsestate(pstate);
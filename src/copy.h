@@ -16,6 +16,7 @@
 typedef struct ChunkDispatch ChunkDispatch;
 typedef struct CopyChunkState CopyChunkState;
 typedef struct Hypertable Hypertable;
+typedef struct ParallelCopyState ParallelCopyState;
 
 typedef bool (*CopyFromFunc)(CopyChunkState *ccstate, ExprContext *econtext, Datum *values,
 							 bool *nulls);
@@ -29,6 +30,7 @@ typedef struct CopyChunkState
 	CopyFromState cstate;
 	TableScanDesc scandesc;
 	Node *where_clause;
+	ParallelCopyState *parallel_state;
 } CopyChunkState;
 
 extern void timescaledb_DoCopy(const CopyStmt *stmt, const char *queryString, uint64 *processed,
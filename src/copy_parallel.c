@@ -0,0 +1,1051 @@
+/*
+ * This file and its contents are licensed under the Apache License 2.0.
+ * Please see the included NOTICE for copyright information and
+ * LICENSE-APACHE for a copy of the license.
+ */
+#include <postgres.h>
+#include <access/htup_details.h>
+#include <access/parallel.h>
+#include <access/table.h>
+#include <access/xact.h>
+#include <catalog/pg_class.h>
+#include <catalog/pg_proc.h>
+#include <catalog/pg_trigger.h>
+#include <catalog/pg_type.h>
+#include <commands/copyfrom_internal.h>
+#include <commands/trigger.h>
+#include <executor/executor.h>
+#include <mb/pg_wchar.h>
+#include <miscadmin.h>
+#include <nodes/nodeFuncs.h>
+#include <storage/proc.h>
+#include <storage/shm_mq.h>
+#include <storage/shm_toc.h>
+#include <utils/lsyscache.h>
+#include <utils/memutils.h>
+#include <utils/rel.h>
+#include <utils/snapmgr.h>
+
+#if PG16_GE
+#include <nodes/miscnodes.h>
+#endif
+
+#include "compat/compat.h"
+#include "copy_parallel.h"
+#include "extension.h"
+#include "guc.h"
+#include "hypertable.h"
+#include "hypertable_cache.h"
+
+/*
+ * Parallel parsing of COPY FROM input.
+ *
+ * Converting the text of each field with the type input functions is what
+ * makes a single COPY stream CPU-bound, so with parallel_copy_workers > 0 the
+ * leader reads the input in blocks of lines and hands them out to parallel
+ * workers, which convert them into tuples while the leader inserts the rows
+ * of the blocks before them.
+ *
+ * The leader splits the lines into raw fields with NextCopyFromRawFields(),
+ * which handles the quoting and the encoding conversion, and sends each block
+ * through the input queue of a worker, taking the workers in turn. Each worker
+ * sends the tuples of its blocks back through its output queue, so the leader
+ * gets the rows in input order by reading the queues in the same turn. The
+ * leader keeps a block until it has returned all its rows.
+ *
+ * The workers are started once and parse the input until its end, and the
+ * leader stays in parallel mode meanwhile. Parallel workers cannot insert,
+ * so the rows are still routed to chunks and inserted by the leader, which is
+ * allowed in parallel mode the same way as for CREATE TABLE AS. It is only
+ * possible as long as the leader does not have to update the catalog, which
+ * is the case for the chunks that it has already looked up. Before another
+ * chunk is looked up or created, ts_copy_parallel_pause() stops the workers
+ * and the leader parses the blocks handed out to them itself. The workers are
+ * started again for the block read after those.
+ *
+ * A worker does not raise an error for a line with an invalid value, since
+ * that would be reported out of order and with the position of the worker.
+ * It uses soft errors, which need PG16, and the leader parses the line again
+ * when it gets to it, which reports the error the same way as a serial COPY.
+ *
+ * An input that fits in a single block is parsed by the leader without
+ * starting workers.
+ */
+
+#define PARALLEL_KEY_COPY_SHARED UINT64CONST(0xC0B7000000000001)
+#define PARALLEL_KEY_COPY_INPUT_QUEUES UINT64CONST(0xC0B7000000000002)
+#define PARALLEL_KEY_COPY_OUTPUT_QUEUES UINT64CONST(0xC0B7000000000003)
+
+/* Size of the raw fields of a block of lines. */
+#define PARALLEL_COPY_BLOCK_SIZE (64 * 1024)
+
+/* Number of blocks handed out to each worker at the same time. */
+#define PARALLEL_COPY_BLOCKS_PER_WORKER 4
+
+/* Size of the input and output queue of each worker. */
+#define PARALLEL_COPY_QUEUE_SIZE (PARALLEL_COPY_BLOCK_SIZE * PARALLEL_COPY_BLOCKS_PER_WORKER)
+
+/*
+ * Size of the message that a worker sends instead of the tuple of a line with
+ * an invalid value. Any MinimalTuple is longer.
+ */
+#define PARALLEL_COPY_INVALID_LINE_SIZE 1
+
+/* Same as in copyfrom.c */
+#define MAX_COPY_DATA_DISPLAY 100
+
+/*
+ * The default expressions are indexed by attribute since PG16, because of the
+ * DEFAULT option of COPY.
+ */
+#if PG16_GE
+#define COPY_DEFEXPR(cstate, i) ((cstate)->defexprs[(cstate)->defmap[(i)]])
+#else
+#define COPY_DEFEXPR(cstate, i) ((cstate)->defexprs[(i)])
+#endif
+
+typedef struct ParallelCopyShared
+{
+	Oid relid;
+	int ncolumns;
+	AttrNumber attnums[FLEXIBLE_ARRAY_MEMBER];
+} ParallelCopyShared;
+
+/*
+ * A block of lines. Each line is stored as the line number, followed by the
+ * length of each field (-1 for NULL) and the null-terminated field.
+ */
+typedef struct ParallelCopyBlock
+{
+	StringInfoData data;
+	Size *line_offsets;
+	int lines_capacity;
+	int nlines;
+	/* The next line to return. */
+	int next_line;
+	/* The worker that parses the block, or -1 if the leader parses it. */
+	int worker;
+} ParallelCopyBlock;
+
+typedef struct ParallelCopyParser
+{
+	TupleDesc tupdesc;
+	const char *relname;
+	int ncolumns;
+	const AttrNumber *attnums;
+	FmgrInfo *in_functions;
+	Oid *typioparams;
+	/* The COPY state to report the position to, only set in the leader. */
+	CopyFromState cstate;
+	/* Position for the error context. */
+	uint64 lineno;
+	const char *attname;
+	const char *attval;
+} ParallelCopyParser;
+
+typedef struct ParallelCopyState
+{
+	CopyFromState cstate;
+	Relation rel;
+	int nworkers;
+	ParallelCopyParser parser;
+	MemoryContext mcxt;
+	/* The blocks read and not returned yet, oldest first. */
+	ParallelCopyBlock *blocks;
+	int max_blocks;
+	int first_block;
+	int nblocks;
+	/* The last block read is not completely sent to its worker yet. */
+	bool send_pending;
+	/* The line number of the last line read. */
+	uint64 read_lineno;
+	bool eof;
+	/* The running workers, if any. */
+	ParallelContext *pcxt;
+	int nqueues;
+	shm_mq_handle **inputs;
+	shm_mq_handle **outputs;
+	int next_worker;
+	TupleTableSlot *slot;
+} ParallelCopyState;
+
+static bool
+parallel_unsafe_func_checker(Oid func_id, void *context)
+{
+	return func_parallel(func_id) == PROPARALLEL_UNSAFE;
+}
+
+/*
+ * Check if an expression that the leader evaluates for the rows cannot be
+ * evaluated in parallel mode.
+ */
+static bool
+contain_parallel_unsafe_walker(Node *node, void *context)
+{
+	if (node == NULL)
+		return false;
+
+	/* The default of identity columns */
+	if (IsA(node, NextValueExpr))
+		return true;
+
+	if (check_functions_in_node(node, parallel_unsafe_func_checker, context))
+		return true;
+
+	return expression_tree_walker(node, contain_parallel_unsafe_walker, context);
+}
+
+/*
+ * Parallel parsing is not supported for the options that NextCopyFrom()
+ * applies on top of the raw fields, the input functions have to be parallel
+ * safe, and what the leader does for each row has to be possible in parallel
+ * mode.
+ */
+static bool
+parallel_copy_is_supported(CopyFromState cstate, Relation rel)
+{
+	TupleDesc tupdesc = RelationGetDescr(rel);
+	TupleConstr *constr = tupdesc->constr;
+	TriggerDesc *trigdesc = rel->trigdesc;
+	Cache *hcache;
+	Hypertable *ht;
+	bool compression_enabled;
+	ListCell *lc;
+
+	if (ts_guc_parallel_copy_workers == 0)
+		return false;
+
+	/* Invalid lines are only found by the workers with soft errors. */
+#if PG16_LT
+	return false;
+#endif
+
+	/* Same restrictions as for parallel index builds. */
+	if (!IsUnderPostmaster || IsInParallelMode() ||
+		rel->rd_rel->relpersistence == RELPERSISTENCE_TEMP)
+		return false;
+
+	/* The active snapshot is passed to the workers. */
+	if (!ActiveSnapshotSet())
+		return false;
+
+	if (cstate->opts.binary || cstate->opts.force_notnull != NIL ||
+		cstate->opts.force_null != NIL)
+		return false;
+
+#if PG16_GE
+	if (cstate->opts.default_print != NULL)
+		return false;
+#endif
+
+#if PG17_GE
+	if (cstate->opts.force_notnull_all || cstate->opts.force_null_all ||
+		cstate->opts.on_error != COPY_ON_ERROR_STOP)
+		return false;
+#endif
+
+	foreach (lc, cstate->attnumlist)
+	{
+		Form_pg_attribute att = TupleDescAttr(tupdesc, lfirst_int(lc) - 1);
+		Oid in_func_oid;
+		Oid typioparam;
+
+		/* The input function of a domain also checks its constraints. */
+		if (get_typtype(att->atttypid) == TYPTYPE_DOMAIN)
+			return false;
+
+		getTypeInputInfo(att->atttypid, &in_func_oid, &typioparam);
+
+		if (func_parallel(in_func_oid) != PROPARALLEL_SAFE)
+			return false;
+	}
+
+	/*
+	 * The leader computes the defaults, checks the constraints and filters
+	 * the rows in parallel mode.
+	 */
+	for (int i = 0; i < tupdesc->natts; i++)
+	{
+		if (TupleDescAttr(tupdesc, i)->attidentity)
+			return false;
+	}
+
+	if (constr != NULL)
+	{
+		for (int i = 0; i < constr->num_defval; i++)
+		{
+			if (contain_parallel_unsafe_walker(stringToNode(constr->defval[i].adbin), NULL))
+				return false;
+		}
+
+		for (int i = 0; i < constr->num_check; i++)
+		{
+			if (contain_parallel_unsafe_walker(stringToNode(constr->check[i].ccbin), NULL))
+				return false;
+		}
+	}
+
+	if (contain_parallel_unsafe_walker(cstate->whereClause, NULL))
+		return false;
+
+	/* BEFORE ROW triggers run in the leader for each row. */
+	if (trigdesc != NULL && trigdesc->trig_insert_before_row)
+	{
+		for (int i = 0; i < trigdesc->numtriggers; i++)
+		{
+			Trigger *trigger = &trigdesc->triggers[i];
+
+			if (TRIGGER_TYPE_MATCHES(trigger->tgtype,
+									 TRIGGER_TYPE_ROW,
+									 TRIGGER_TYPE_BEFORE,
+									 TRIGGER_TYPE_INSERT) &&
+				strncmp(trigger->tgname, INSERT_BLOCKER_NAME, NAMEDATALEN) != 0)
+				return false;
+		}
+	}
+
+	/* Inserting into compressed chunks updates the catalog. */
+	ht = ts_hypertable_cache_get_cache_and_entry(RelationGetRelid(rel), CACHE_FLAG_NONE, &hcache);
+	compression_enabled = TS_HYPERTABLE_HAS_COMPRESSION_ENABLED(ht);
+	ts_cache_release(&hcache);
+
+	return !compression_enabled;
+}
+
+static void
+parallel_copy_parser_init(ParallelCopyParser *parser, Relation rel, int ncolumns,
+						  const AttrNumber *attnums)
+{
+	parser->tupdesc = RelationGetDescr(rel);
+	parser->relname = RelationGetRelationName(rel);
+	parser->ncolumns = ncolumns;
+	parser->attnums = attnums;
+	parser->in_functions = palloc(sizeof(FmgrInfo) * Max(ncolumns, 1));
+	parser->typioparams = palloc(sizeof(Oid) * Max(ncolumns, 1));
+	parser->cstate = NULL;
+	parser->lineno = 0;
+	parser->attname = NULL;
+	parser->attval = NULL;
+
+	for (int i = 0; i < ncolumns; i++)
+	{
+		Form_pg_attribute att = TupleDescAttr(parser->tupdesc, attnums[i] - 1);
+		Oid in_func_oid;
+
+		getTypeInputInfo(att->atttypid, &in_func_oid, &parser->typioparams[i]);
+		fmgr_info(in_func_oid, &parser->in_functions[i]);
+	}
+}
+
+static void
+parallel_copy_parser_set_position(ParallelCopyParser *parser, const char *attname,
+								  const char *attval)
+{
+	parser->attname = attname;
+	parser->attval = attval;
+
+	if (parser->cstate != NULL)
+	{
+		parser->cstate->cur_lineno = parser->lineno;
+		parser->cstate->cur_attname = attname;
+		parser->cstate->cur_attval = attval;
+	}
+}
+
+/*
+ * Convert a field with the input function of its column. With soft errors,
+ * return false for an invalid value instead of raising an error.
+ */
+static bool
+parallel_copy_parser_input(ParallelCopyParser *parser, int i, char *string, int32 typmod,
+						   bool soft_errors, Datum *value)
+{
+#if PG16_GE
+	if (soft_errors)
+	{
+		ErrorSaveContext escontext = { .type = T_ErrorSaveContext };
+
+		return InputFunctionCallSafe(&parser->in_functions[i],
+									 string,
+									 parser->typioparams[i],
+									 typmod,
+									 (Node *) &escontext,
+									 value);
+	}
+#else
+	Assert(!soft_errors);
+#endif
+
+	*value = InputFunctionCall(&parser->in_functions[i], string, parser->typioparams[i], typmod);
+	return true;
+}
+
+/*
+ * Parse the line at *pos into values and nulls, which are initialized by the
+ * caller for the columns not in the input, and advance *pos to the next line.
+ * This does the same as NextCopyFrom() for the columns in the input. Returns
+ * false if a value is invalid, which is only possible with soft errors.
+ */
+static bool
+parallel_copy_parse_line(ParallelCopyParser *parser, const char **pos, Datum *values,
+						 bool *nulls, bool soft_errors)
+{
+	const char *p = *pos;
+	bool valid = true;
+
+	memcpy(&parser->lineno, p, sizeof(uint64));
+	p += sizeof(uint64);
+
+	for (int i = 0; i < parser->ncolumns; i++)
+	{
+		int m = parser->attnums[i] - 1;
+		Form_pg_attribute att = TupleDescAttr(parser->tupdesc, m);
+		char *string = NULL;
+		int32 len;
+
+		memcpy(&len, p, sizeof(int32));
+		p += sizeof(int32);
+
+		if (len >= 0)
+		{
+			string = (char *) p;
+			p += len + 1;
+		}
+
+		/* Skip the remaining fields of an invalid line */
+		if (!valid)
+			continue;
+
+		parallel_copy_parser_set_position(parser, NameStr(att->attname), string);
+		valid = parallel_copy_parser_input(parser,
+										   i,
+										   string,
+										   att->atttypmod,
+										   soft_errors,
+										   &values[m]);
+		nulls[m] = (string == NULL);
+	}
+
+	parallel_copy_parser_set_position(parser, NULL, NULL);
+	*pos = p;
+
+	return valid;
+}
+
+static char *
+parallel_copy_limit_printout_length(const char *str)
+{
+	int slen = strlen(str);
+	int len;
+	char *res;
+
+	if (slen <= MAX_COPY_DATA_DISPLAY)
+		return pstrdup(str);
+
+	len = pg_mbcliplen(str, slen, MAX_COPY_DATA_DISPLAY);
+	res = palloc(len + 4);
+	memcpy(res, str, len);
+	strcpy(res + len, "...");
+
+	return res;
+}
+
+/*
+ * Error context for the parsing in the workers, same as the one of COPY when
+ * the line itself is not available. Only input functions that do not support
+ * soft errors raise errors there.
+ */
+static void
+parallel_copy_error_callback(void *arg)
+{
+	ParallelCopyParser *parser = arg;
+
+	if (parser->attname != NULL && parser->attval != NULL)
+	{
+		char *attval = parallel_copy_limit_printout_length(parser->attval);
+
+		errcontext("COPY %s, line %llu, column %s: \"%s\"",
+				   parser->relname,
+				   (unsigned long long) parser->lineno,
+				   parser->attname,
+				   attval);
+		pfree(attval);
+	}
+	else if (parser->attname != NULL)
+		errcontext("COPY %s, line %llu, column %s: null input",
+				   parser->relname,
+				   (unsigned long long) parser->lineno,
+				   parser->attname);
+	else
+		errcontext("COPY %s, line %llu", parser->relname, (unsigned long long) parser->lineno);
+}
+
+/*
+ * Parse the blocks received from the leader and send the tuple of each line
+ * back, until the leader detaches from the queues.
+ */
+static void
+parallel_copy_parse_blocks(ParallelCopyParser *parser, shm_mq_handle *input,
+						   shm_mq_handle *output)
+{
+	int natts = parser->tupdesc->natts;
+	TupleTableSlot *slot = MakeSingleTupleTableSlot(parser->tupdesc, &TTSOpsVirtual);
+	MemoryContext line_mcxt =
+		AllocSetContextCreate(CurrentMemoryContext, "parallel COPY line", ALLOCSET_DEFAULT_SIZES);
+	shm_mq_result res = SHM_MQ_SUCCESS;
+	ErrorContextCallback errcallback = {
+		.callback = parallel_copy_error_callback,
+		.arg = parser,
+		.previous = error_context_stack,
+	};
+
+	error_context_stack = &errcallback;
+
+	while (res == SHM_MQ_SUCCESS)
+	{
+		Size nbytes;
+		void *data;
+		const char *pos;
+		const char *end;
+
+		res = shm_mq_receive(input, &nbytes, &data, false);
+
+		if (res != SHM_MQ_SUCCESS)
+			break;
+
+		pos = data;
+		end = pos + nbytes;
+
+		while (pos < end && res == SHM_MQ_SUCCESS)
+		{
+			MemoryContext oldcontext;
+
+			CHECK_FOR_INTERRUPTS();
+
+			ExecClearTuple(slot);
+			MemSet(slot->tts_values, 0, natts * sizeof(Datum));
+			MemSet(slot->tts_isnull, true, natts * sizeof(bool));
+
+			oldcontext = MemoryContextSwitchTo(line_mcxt);
+
+			if (parallel_copy_parse_line(parser, &pos, slot->tts_values, slot->tts_isnull, true))
+			{
+				MinimalTuple tuple;
+				bool should_free;
+
+				ExecStoreVirtualTuple(slot);
+				tuple = ExecFetchSlotMinimalTuple(slot, &should_free);
+				res = shm_mq_send_compat(output, tuple->t_len, tuple, false);
+			}
+			else
+				res = shm_mq_send_compat(output, PARALLEL_COPY_INVALID_LINE_SIZE, "", false);
+
+			MemoryContextSwitchTo(oldcontext);
+			MemoryContextReset(line_mcxt);
+		}
+	}
+
+	error_context_stack = errcallback.previous;
+
+	ExecDropSingleTupleTableSlot(slot);
+	MemoryContextDelete(line_mcxt);
+}
+
+PGDLLEXPORT void ts_copy_parallel_worker_main(dsm_segment *seg, shm_toc *toc);
+
+void
+ts_copy_parallel_worker_main(dsm_segment *seg, shm_toc *toc)
+{
+	ParallelCopyShared *shared = shm_toc_lookup(toc, PARALLEL_KEY_COPY_SHARED, false);
+	char *inputs = shm_toc_lookup(toc, PARALLEL_KEY_COPY_INPUT_QUEUES, false);
+	char *outputs = shm_toc_lookup(toc, PARALLEL_KEY_COPY_OUTPUT_QUEUES, false);
+	shm_mq *input_mq = (shm_mq *) (inputs + ParallelWorkerNumber * PARALLEL_COPY_QUEUE_SIZE);
+	shm_mq *output_mq = (shm_mq *) (outputs + ParallelWorkerNumber * PARALLEL_COPY_QUEUE_SIZE);
+	shm_mq_handle *input;
+	shm_mq_handle *output;
+	ParallelCopyParser parser;
+	Relation rel;
+
+	shm_mq_set_receiver(input_mq, MyProc);
+	shm_mq_set_sender(output_mq, MyProc);
+	input = shm_mq_attach(input_mq, seg, NULL);
+	output = shm_mq_attach(output_mq, seg, NULL);
+
+	/* The leader holds a RowExclusiveLock, we are in its lock group. */
+	rel = table_open(shared->relid, AccessShareLock);
+
+	parallel_copy_parser_init(&parser, rel, shared->ncolumns, shared->attnums);
+	parallel_copy_parse_blocks(&parser, input, output);
+
+	table_close(rel, AccessShareLock);
+
+	shm_mq_detach(input);
+	shm_mq_detach(output);
+}
+
+/*
+ * Returns NULL if the COPY can't be parsed in parallel.
+ */
+ParallelCopyState *
+ts_copy_parallel_begin(CopyFromState cstate, Relation rel)
+{
+	ParallelCopyState *pcstate;
+	AttrNumber *attnums;
+	int ncolumns = list_length(cstate->attnumlist);
+	MemoryContext oldcontext;
+	ListCell *lc;
+	int i = 0;
+
+	if (!parallel_copy_is_supported(cstate, rel))
+		return NULL;
+
+	pcstate = palloc0(sizeof(ParallelCopyState));
+	pcstate->cstate = cstate;
+	pcstate->rel = rel;
+	pcstate->nworkers = ts_guc_parallel_copy_workers;
+	pcstate->mcxt =
+		AllocSetContextCreate(CurrentMemoryContext, "parallel COPY", ALLOCSET_DEFAULT_SIZES);
+
+	oldcontext = MemoryContextSwitchTo(pcstate->mcxt);
+
+	attnums = palloc(sizeof(AttrNumber) * Max(ncolumns, 1));
+	foreach (lc, cstate->attnumlist)
+		attnums[i++] = lfirst_int(lc);
+
+	parallel_copy_parser_init(&pcstate->parser, rel, ncolumns, attnums);
+
+	/* The leader parses one more block while the workers parse theirs. */
+	pcstate->max_blocks = pcstate->nworkers * PARALLEL_COPY_BLOCKS_PER_WORKER + 1;
+	pcstate->blocks = palloc0(sizeof(ParallelCopyBlock) * pcstate->max_blocks);
+	pcstate->inputs = palloc0(sizeof(shm_mq_handle *) * pcstate->nworkers);
+	pcstate->outputs = palloc0(sizeof(shm_mq_handle *) * pcstate->nworkers);
+	pcstate->slot = MakeSingleTupleTableSlot(RelationGetDescr(rel), &TTSOpsMinimalTuple);
+	pcstate->read_lineno = cstate->cur_lineno;
+
+	MemoryContextSwitchTo(oldcontext);
+
+	return pcstate;
+}
+
+/*
+ * Read the raw fields of the next block of lines into a new block after the
+ * last one.
+ */
+static ParallelCopyBlock *
+parallel_copy_read_block(ParallelCopyState *pcstate)
+{
+	CopyFromState cstate = pcstate->cstate;
+	int ncolumns = pcstate->parser.ncolumns;
+	ParallelCopyBlock *block;
+	uint64 lineno = cstate->cur_lineno;
+
+	Assert(pcstate->nblocks < pcstate->max_blocks);
+	block = &pcstate->blocks[(pcstate->first_block + pcstate->nblocks) % pcstate->max_blocks];
+	pcstate->nblocks++;
+
+	if (block->data.data == NULL)
+	{
+		MemoryContext oldcontext = MemoryContextSwitchTo(pcstate->mcxt);
+
+		initStringInfo(&block->data);
+		block->lines_capacity = 1024;
+		block->line_offsets = palloc(sizeof(Size) * block->lines_capacity);
+		MemoryContextSwitchTo(oldcontext);
+	}
+	else
+		resetStringInfo(&block->data);
+
+	block->nlines = 0;
+	block->next_line = 0;
+	block->worker = -1;
+
+	/* The error context of the COPY reports the line being read. */
+	cstate->cur_lineno = pcstate->read_lineno;
+
+	while (block->data.len < PARALLEL_COPY_BLOCK_SIZE)
+	{
+		char **fields;
+		int nfields;
+
+		CHECK_FOR_INTERRUPTS();
+
+		if (!NextCopyFromRawFields(cstate, &fields, &nfields))
+		{
+			pcstate->eof = true;
+			break;
+		}
+
+		/* Same checks as in NextCopyFrom() */
+		if (ncolumns > 0 && nfields > ncolumns)
+			ereport(ERROR,
+					(errcode(ERRCODE_BAD_COPY_FILE_FORMAT),
+					 errmsg("extra data after last expected column")));
+
+		if (nfields < ncolumns)
+		{
+			Form_pg_attribute att =
+				TupleDescAttr(pcstate->parser.tupdesc, pcstate->parser.attnums[nfields] - 1);
+
+			ereport(ERROR,
+					(errcode(ERRCODE_BAD_COPY_FILE_FORMAT),
+					 errmsg("missing data for column \"%s\"", NameStr(att->attname))));
+		}
+
+		if (block->nlines >= block->lines_capacity)
+		{
+			block->lines_capacity *= 2;
+			block->line_offsets =
+				repalloc(block->line_offsets, sizeof(Size) * block->lines_capacity);
+		}
+
+		block->line_offsets[block->nlines++] = block->data.len;
+		appendBinaryStringInfo(&block->data, (const char *) &cstate->cur_lineno, sizeof(uint64));
+
+		for (int i = 0; i < ncolumns; i++)
+		{
+			int32 len = (fields[i] == NULL) ? -1 : strlen(fields[i]);
+
+			appendBinaryStringInfo(&block->data, (const char *) &len, sizeof(int32));
+
+			if (fields[i] != NULL)
+				appendBinaryStringInfo(&block->data, fields[i], len + 1);
+		}
+	}
+
+	/* Errors while inserting the current row report its line. */
+	pcstate->read_lineno = cstate->cur_lineno;
+	cstate->cur_lineno = lineno;
+	cstate->line_buf_valid = false;
+
+	return block;
+}
+
+static ParallelCopyBlock *
+parallel_copy_last_block(ParallelCopyState *pcstate)
+{
+	Assert(pcstate->nblocks > 0);
+	return &pcstate->blocks[(pcstate->first_block + pcstate->nblocks - 1) % pcstate->max_blocks];
+}
+
+/*
+ * Stop the workers and leave parallel mode. A worker that failed raises its
+ * error here.
+ */
+static void
+parallel_copy_stop_workers(ParallelCopyState *pcstate)
+{
+	if (pcstate->pcxt == NULL)
+		return;
+
+	/* The workers exit when the leader detaches from their queues. */
+	for (int i = 0; i < pcstate->nqueues; i++)
+	{
+		shm_mq_detach(pcstate->inputs[i]);
+		shm_mq_detach(pcstate->outputs[i]);
+	}
+
+	WaitForParallelWorkersToFinish(pcstate->pcxt);
+	DestroyParallelContext(pcstate->pcxt);
+	ExitParallelMode();
+
+	pcstate->pcxt = NULL;
+	pcstate->nqueues = 0;
+	pcstate->send_pending = false;
+}
+
+static void
+parallel_copy_worker_lost(ParallelCopyState *pcstate)
+{
+	parallel_copy_stop_workers(pcstate);
+	elog(ERROR, "lost connection to parallel COPY worker");
+}
+
+/*
+ * Start the workers, which parse the blocks read after the current one.
+ */
+static void
+parallel_copy_start_workers(ParallelCopyState *pcstate)
+{
+	const int nworkers = pcstate->nworkers;
+	const int ncolumns = pcstate->parser.ncolumns;
+	Size shared_size = add_size(offsetof(ParallelCopyShared, attnums),
+								mul_size(sizeof(AttrNumber), Max(ncolumns, 1)));
+	Size queues_size = mul_size(PARALLEL_COPY_QUEUE_SIZE, nworkers);
+	ParallelContext *pcxt;
+	ParallelCopyShared *shared;
+	char *inputs;
+	char *outputs;
+
+	/*
+	 * The leader inserts the rows in parallel mode, where it cannot assign a
+	 * transaction id, so it is assigned before like for CREATE TABLE AS.
+	 */
+	(void) GetCurrentTransactionId();
+
+	EnterParallelMode();
+
+	pcxt =
+		CreateParallelContext(ts_extension_get_so_name(), "ts_copy_parallel_worker_main", nworkers);
+	shm_toc_estimate_chunk(&pcxt->estimator, shared_size);
+	shm_toc_estimate_chunk(&pcxt->estimator, queues_size);
+	shm_toc_estimate_chunk(&pcxt->estimator, queues_size);
+	shm_toc_estimate_keys(&pcxt->estimator, 3);
+	InitializeParallelDSM(pcxt);
+
+	shared = shm_toc_allocate(pcxt->toc, shared_size);
+	shared->relid = RelationGetRelid(pcstate->rel);
+	shared->ncolumns = ncolumns;
+	memcpy(shared->attnums, pcstate->parser.attnums, sizeof(AttrNumber) * ncolumns);
+	shm_toc_insert(pcxt->toc, PARALLEL_KEY_COPY_SHARED, shared);
+
+	inputs = shm_toc_allocate(pcxt->toc, queues_size);
+	outputs = shm_toc_allocate(pcxt->toc, queues_size);
+	shm_toc_insert(pcxt->toc, PARALLEL_KEY_COPY_INPUT_QUEUES, inputs);
+	shm_toc_insert(pcxt->toc, PARALLEL_KEY_COPY_OUTPUT_QUEUES, outputs);
+
+	for (int i = 0; i < nworkers; i++)
+	{
+		shm_mq *mq;
+
+		mq = shm_mq_create(inputs + i * PARALLEL_COPY_QUEUE_SIZE, PARALLEL_COPY_QUEUE_SIZE);
+		shm_mq_set_sender(mq, MyProc);
+		pcstate->inputs[i] = shm_mq_attach(mq, pcxt->seg, NULL);
+
+		mq = shm_mq_create(outputs + i * PARALLEL_COPY_QUEUE_SIZE, PARALLEL_COPY_QUEUE_SIZE);
+		shm_mq_set_receiver(mq, MyProc);
+		pcstate->outputs[i] = shm_mq_attach(mq, pcxt->seg, NULL);
+	}
+
+	pcstate->pcxt = pcxt;
+	pcstate->nqueues = nworkers;
+
+	LaunchParallelWorkers(pcxt);
+
+	elog(DEBUG1,
+		 "launched %d parallel workers to parse COPY into \"%s\"",
+		 pcxt->nworkers_launched,
+		 RelationGetRelationName(pcstate->rel));
+
+	if (pcxt->nworkers_launched == 0)
+	{
+		/* Parse the rest of the input here instead of trying again. */
+		parallel_copy_stop_workers(pcstate);
+		pcstate->nworkers = 0;
+		return;
+	}
+
+	for (int i = 0; i < pcxt->nworkers_launched; i++)
+	{
+		shm_mq_set_handle(pcstate->inputs[i], pcxt->worker[i].bgwhandle);
+		shm_mq_set_handle(pcstate->outputs[i], pcxt->worker[i].bgwhandle);
+	}
+
+	pcstate->next_worker = 0;
+}
+
+/*
+ * Send the last block read to its worker. Returns false if the input queue of
+ * the worker is full and nowait is set, then the rest of the block has to be
+ * sent later.
+ */
+static bool
+parallel_copy_send_block(ParallelCopyState *pcstate, bool nowait)
+{
+	ParallelCopyBlock *block = parallel_copy_last_block(pcstate);
+	shm_mq_result res;
+
+	Assert(pcstate->send_pending && block->worker >= 0);
+
+	res = shm_mq_send_compat(pcstate->inputs[block->worker],
+							 block->data.len,
+							 block->data.data,
+							 nowait);
+
+	if (res == SHM_MQ_WOULD_BLOCK)
+		return false;
+
+	if (res != SHM_MQ_SUCCESS)
+		parallel_copy_worker_lost(pcstate);
+
+	pcstate->send_pending = false;
+	return true;
+}
+
+/*
+ * Read blocks ahead and hand them out to the workers, until as many blocks as
+ * they can take are handed out or the input queue of the next worker is full.
+ */
+static void
+parallel_copy_send_blocks(ParallelCopyState *pcstate)
+{
+	for (;;)
+	{
+		ParallelCopyBlock *block;
+
+		if (!pcstate->send_pending)
+		{
+			if (pcstate->eof || pcstate->nblocks == pcstate->max_blocks)
+				return;
+
+			block = parallel_copy_read_block(pcstate);
+
+			/* Nothing to send at the end of the input */
+			if (block->nlines == 0)
+				return;
+
+			block->worker = pcstate->next_worker;
+			pcstate->next_worker = (pcstate->next_worker + 1) % pcstate->pcxt->nworkers_launched;
+			pcstate->send_pending = true;
+		}
+
+		if (!parallel_copy_send_block(pcstate, true))
+			return;
+	}
+}
+
+/*
+ * Get the row of the next line of a block from its worker. Returns false if
+ * the line has an invalid value.
+ */
+static bool
+parallel_copy_receive_row(ParallelCopyState *pcstate, ParallelCopyBlock *block, Datum *values,
+						  bool *nulls)
+{
+	int natts = RelationGetDescr(pcstate->rel)->natts;
+	MinimalTuple tuple;
+	shm_mq_result res;
+	Size nbytes;
+	void *data;
+
+	/*
+	 * The worker might wait for the rest of the block, which is safe to send
+	 * without waiting for the worker since it has no rows of other blocks to
+	 * return.
+	 */
+	if (pcstate->send_pending && pcstate->nblocks == 1)
+		parallel_copy_send_block(pcstate, false);
+
+	res = shm_mq_receive(pcstate->outputs[block->worker], &nbytes, &data, false);
+
+	if (res != SHM_MQ_SUCCESS)
+		parallel_copy_worker_lost(pcstate);
+
+	if (nbytes == PARALLEL_COPY_INVALID_LINE_SIZE)
+		return false;
+
+	/* The message is overwritten by the next ones. */
+	tuple = heap_copy_minimal_tuple((MinimalTuple) data);
+	ExecStoreMinimalTuple(tuple, pcstate->slot, false);
+	slot_getallattrs(pcstate->slot);
+	memcpy(values, pcstate->slot->tts_values, natts * sizeof(Datum));
+	memcpy(nulls, pcstate->slot->tts_isnull, natts * sizeof(bool));
+
+	return true;
+}
+
+/*
+ * Return the next row of the COPY, in input order, the same way as
+ * NextCopyFrom().
+ */
+bool
+ts_copy_parallel_next(ParallelCopyState *pcstate, ExprContext *econtext, Datum *values,
+					  bool *nulls)
+{
+	CopyFromState cstate = pcstate->cstate;
+	int natts = RelationGetDescr(pcstate->rel)->natts;
+	ParallelCopyBlock *block = NULL;
+	const char *line;
+
+	for (;;)
+	{
+		if (pcstate->pcxt != NULL)
+			parallel_copy_send_blocks(pcstate);
+
+		if (pcstate->nblocks > 0)
+		{
+			block = &pcstate->blocks[pcstate->first_block];
+
+			if (block->next_line < block->nlines)
+				break;
+
+			pcstate->first_block = (pcstate->first_block + 1) % pcstate->max_blocks;
+			pcstate->nblocks--;
+			continue;
+		}
+
+		if (pcstate->eof)
+		{
+			parallel_copy_stop_workers(pcstate);
+			return false;
+		}
+
+		/*
+		 * Parse the next block here, and start the workers for the blocks
+		 * after it unless the input ends with it.
+		 */
+		parallel_copy_read_block(pcstate);
+
+		if (!pcstate->eof && pcstate->pcxt == NULL && pcstate->nworkers > 0)
+			parallel_copy_start_workers(pcstate);
+	}
+
+	MemSet(values, 0, natts * sizeof(Datum));
+	MemSet(nulls, true, natts * sizeof(bool));
+
+	line = block->data.data + block->line_offsets[block->next_line];
+	block->next_line++;
+
+	if (block->worker >= 0 && parallel_copy_receive_row(pcstate, block, values, nulls))
+	{
+		/* Errors while inserting the row report its line. */
+		memcpy(&cstate->cur_lineno, line, sizeof(uint64));
+	}
+	else
+	{
+		/*
+		 * Parse the line here, with the position reported by the COPY. This
+		 * raises the error of a line that a worker found invalid.
+		 */
+		pcstate->parser.cstate = cstate;
+		parallel_copy_parse_line(&pcstate->parser, &line, values, nulls, false);
+		pcstate->parser.cstate = NULL;
+	}
+
+	cstate->line_buf_valid = false;
+
+	/* Compute the defaults of the columns not in the input, like NextCopyFrom() */
+	for (int i = 0; i < cstate->num_defaults; i++)
+	{
+		Assert(econtext != NULL);
+		values[cstate->defmap[i]] =
+			ExecEvalExpr(COPY_DEFEXPR(cstate, i), econtext, &nulls[cstate->defmap[i]]);
+	}
+
+	return true;
+}
+
+/*
+ * Stop the workers before the leader does something that is not possible in
+ * parallel mode, like looking up or creating a chunk. The leader parses the
+ * blocks that were handed out to the workers, and the workers are started
+ * again for the next block read.
+ */
+void
+ts_copy_parallel_pause(ParallelCopyState *pcstate)
+{
+	if (pcstate->pcxt == NULL)
+		return;
+
+	parallel_copy_stop_workers(pcstate);
+
+	for (int i = 0; i < pcstate->nblocks; i++)
+		pcstate->blocks[(pcstate->first_block + i) % pcstate->max_blocks].worker = -1;
+}
+
+void
+ts_copy_parallel_end(ParallelCopyState *pcstate)
+{
+	parallel_copy_stop_workers(pcstate);
+	ExecDropSingleTupleTableSlot(pcstate->slot);
+	MemoryContextDelete(pcstate->mcxt);
+}
@@ -0,0 +1,19 @@
+/*
+ * This file and its contents are licensed under the Apache License 2.0.
+ * Please see the included NOTICE for copyright information and
+ * LICENSE-APACHE for a copy of the license.
+ */
+#pragma once
+
+#include <postgres.h>
+#include <commands/copy.h>
+#include <nodes/execnodes.h>
+#include <utils/relcache.h>
+
+typedef struct ParallelCopyState ParallelCopyState;
+
+extern ParallelCopyState *ts_copy_parallel_begin(CopyFromState cstate, Relation rel);
+extern bool ts_copy_parallel_next(ParallelCopyState *pcstate, ExprContext *econtext,
+								  Datum *values, bool *nulls);
+extern void ts_copy_parallel_pause(ParallelCopyState *pcstate);
+extern void ts_copy_parallel_end(ParallelCopyState *pcstate);
@@ -33,6 +33,8 @@ typedef struct JsonbParseState JsonbParseState;
 typedef struct Hypertable Hypertable;
 typedef struct Chunk Chunk;
 typedef struct ChunkInsertState ChunkInsertState;
+typedef struct CompressedInsertBuffer CompressedInsertBuffer;
+typedef struct CompressedConflictFilter CompressedConflictFilter;
 typedef struct CopyChunkState CopyChunkState;
 typedef struct HypertableModifyState HypertableModifyState;
 
@@ -130,7 +132,11 @@ typedef struct CrossModuleFunctions
 	PGFunction create_compressed_chunk;
 	PGFunction compress_chunk;
 	PGFunction decompress_chunk;
-	void (*decompress_batches_for_insert)(const ChunkInsertState *state, TupleTableSlot *slot);
+	void (*decompress_batches_for_insert)(ChunkInsertState *state, TupleTableSlot *slot);
+	CompressedInsertBuffer *(*compressed_insert_buffer_create)(const ChunkInsertState *state);
+	void (*compressed_insert_buffer_add)(CompressedInsertBuffer *buffer, TupleTableSlot *slot);
+	void (*compressed_insert_buffer_flush)(CompressedInsertBuffer *buffer);
+	void (*compressed_insert_buffer_finish)(CompressedInsertBuffer *buffer);
 	bool (*decompress_target_segments)(HypertableModifyState *ht_state);
 	int (*hypercore_decompress_update_segment)(Relation relation, const ItemPointer ctid,
 											   TupleTableSlot *slot, Snapshot snapshot,
@@ -162,6 +168,7 @@ typedef struct CrossModuleFunctions
 	PGFunction chunk_unfreeze_chunk;
 	PGFunction recompress_chunk_segmentwise;
 	PGFunction get_compressed_chunk_index_for_recompression;
+	PGFunction compact_chunk;
 	void (*preprocess_query_tsl)(Query *parse, int *cursor_opts);
 } CrossModuleFunctions;
 
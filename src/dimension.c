@@ -22,6 +22,7 @@
 #include "debug_point.h"
 #include "dimension.h"
 #include "dimension_slice.h"
+#include "dimension_slice_cache.h"
 #include "dimension_vector.h"
 #include "error_utils.h"
 #include "errors.h"
@@ -682,6 +683,8 @@ dimension_tuple_delete(TupleInfo *ti, void *data)
 	if (NULL != delete_slices && *delete_slices)
 		ts_dimension_slice_delete_by_dimension_id(DatumGetInt32(dimension_id), false);
 
+	ts_dimension_slice_cache_delete_dimension(DatumGetInt32(dimension_id));
+
 	ts_catalog_database_info_become_owner(ts_catalog_database_info_get(), &sec_ctx);
 	ts_catalog_delete_tid(ti->scanrel, ts_scanner_get_tuple_tid(ti));
 	ts_catalog_restore_user(&sec_ctx);
@@ -860,6 +863,10 @@ dimension_insert(int32 hypertable_id, Name colname, Oid coltype, int16 num_slice
 											 partitioning_func,
 											 interval_length);
 	table_close(rel, RowExclusiveLock);
+
+	/* Create the slice version of the new dimension */
+	ts_dimension_slice_cache_invalidate_dimension(dimension_id);
+
 	return dimension_id;
 }
 
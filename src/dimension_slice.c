@@ -20,6 +20,7 @@
 #include "chunk_constraint.h"
 #include "dimension.h"
 #include "dimension_slice.h"
+#include "dimension_slice_cache.h"
 #include "dimension_vector.h"
 #include "hypertable.h"
 #include "scanner.h"
@@ -506,6 +507,35 @@ ts_dimension_slice_scan_list(int32 dimension_id, int64 coordinate, List **matchi
 										CurrentMemoryContext);
 }
 
+/*
+ * Get the value to compare range_end with when searching for slices with a
+ * condition on the end of the range.
+ */
+int64
+ts_dimension_slice_range_end_search_value(int64 end_value)
+{
+	/*
+	 * range_end is stored as exclusive, so add 1 to the value being
+	 * searched. Also avoid overflow
+	 */
+	if (end_value != PG_INT64_MAX)
+	{
+		end_value++;
+
+		/*
+		 * If getting as input INT64_MAX-1, need to remap the incremented
+		 * value back to INT64_MAX-1
+		 */
+		return REMAP_LAST_COORDINATE(end_value);
+	}
+
+	/*
+	 * The point with INT64_MAX gets mapped to INT64_MAX-1 so incrementing
+	 * that gets you to INT_64MAX
+	 */
+	return PG_INT64_MAX;
+}
+
 int
 ts_dimension_slice_scan_iterator_set_range(ScanIterator *it, int32 dimension_id,
 										   StrategyNumber start_strategy, int64 start_value,
@@ -549,28 +579,7 @@ ts_dimension_slice_scan_iterator_set_range(ScanIterator *it, int32 dimension_id,
 
 		Assert(OidIsValid(proc));
 
-		/*
-		 * range_end is stored as exclusive, so add 1 to the value being
-		 * searched. Also avoid overflow
-		 */
-		if (end_value != PG_INT64_MAX)
-		{
-			end_value++;
-
-			/*
-			 * If getting as input INT64_MAX-1, need to remap the incremented
-			 * value back to INT64_MAX-1
-			 */
-			end_value = REMAP_LAST_COORDINATE(end_value);
-		}
-		else
-		{
-			/*
-			 * The point with INT64_MAX gets mapped to INT64_MAX-1 so
-			 * incrementing that gets you to INT_64MAX
-			 */
-			end_value = PG_INT64_MAX;
-		}
+		end_value = ts_dimension_slice_range_end_search_value(end_value);
 
 		ts_scan_iterator_scan_key_init(
 			it,
@@ -1150,6 +1159,7 @@ ts_dimension_slice_insert_multi(DimensionSlice **slices, Size num_slices)
 		if (slices[i]->fd.id == 0)
 		{
 			dimension_slice_insert_relation(rel, slices[i]);
+			ts_dimension_slice_cache_invalidate_dimension(slices[i]->fd.dimension_id);
 			n++;
 		}
 	}
@@ -1167,7 +1177,8 @@ ts_dimension_slice_insert(DimensionSlice *slice)
 
 	rel = table_open(catalog_get_table_id(catalog, DIMENSION_SLICE), RowExclusiveLock);
 
-	dimension_slice_insert_relation(rel, slice);
+	if (dimension_slice_insert_relation(rel, slice))
+		ts_dimension_slice_cache_invalidate_dimension(slice->fd.dimension_id);
 
 	/* Keeping a row lock to prevent VACUUM or ALTER TABLE from running while working on the table.
 	 * This is known to cause issues in certain situations.
@@ -1369,6 +1380,7 @@ ts_dimension_slice_range_update(DimensionSlice *slice)
 		form.range_start = slice->fd.range_start;
 		form.range_end = slice->fd.range_end;
 		dimension_slice_update_catalog_tuple(&tid, &form);
+		ts_dimension_slice_cache_invalidate_dimension(form.dimension_id);
 	}
 	return true;
 }
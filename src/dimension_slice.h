@@ -105,6 +105,7 @@ extern int ts_dimension_slice_scan_iterator_set_range(ScanIterator *it, int32 di
 													  StrategyNumber start_strategy,
 													  int64 start_value,
 													  StrategyNumber end_strategy, int64 end_value);
+extern int64 ts_dimension_slice_range_end_search_value(int64 end_value);
 
 extern bool ts_osm_chunk_range_overlaps(int32 osm_dimension_slice_id, int32 dimension_id,
 										int64 range_start, int64 range_end);
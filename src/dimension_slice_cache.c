@@ -0,0 +1,578 @@
+/*
+ * This file and its contents are licensed under the Apache License 2.0.
+ * Please see the included NOTICE for copyright information and
+ * LICENSE-APACHE for a copy of the license.
+ */
+#include <postgres.h>
+#include <access/htup_details.h>
+#include <access/xact.h>
+#include <utils/fmgroids.h>
+#include <utils/memutils.h>
+#include <utils/rel.h>
+
+#include "cache.h"
+#include "dimension.h"
+#include "dimension_slice.h"
+#include "dimension_slice_cache.h"
+#include "dimension_vector.h"
+#include "scan_iterator.h"
+#include "ts_catalog/catalog.h"
+
+/*
+ * Cache of the dimension slices of each dimension.
+ *
+ * Chunk exclusion during planning needs the slices matching the restrictions
+ * on each dimension. Instead of scanning the dimension_slice catalog table
+ * for each restriction in each plan, all slices of a dimension are read once
+ * into a sorted array that can be binary searched.
+ *
+ * The cache is per backend, like the hypertable cache. Invalidation messages
+ * only arrive after the transaction that sent them is visible to others, so a
+ * query could see a new chunk before its slices are invalidated in the cache.
+ * Instead, each transaction that inserts or updates slices of a dimension
+ * increments the version of the dimension in the dimension_slice_version
+ * catalog table. The version is read with the same snapshot as a scan of the
+ * dimension_slice table would use, before the slices are read, and it is
+ * checked again on each lookup. A cached entry is therefore only used if a
+ * catalog scan would return the same slices.
+ *
+ * Deleted slices can remain in the cache until the next change to the
+ * dimension, which is harmless since no chunk references them.
+ */
+
+typedef struct DimensionSliceCacheQuery
+{
+	CacheQuery q;
+	int32 dimension_id;
+	Oid hypertable_relid;
+} DimensionSliceCacheQuery;
+
+static void *
+dimension_slice_cache_get_key(CacheQuery *query)
+{
+	return &((DimensionSliceCacheQuery *) query)->dimension_id;
+}
+
+static bool
+dimension_slice_cache_valid_result(const void *result)
+{
+	return result != NULL;
+}
+
+static void
+dimension_slice_version_init_scan(ScanIterator *it, int32 dimension_id)
+{
+	it->ctx.index = catalog_get_index(ts_catalog_get(),
+									  DIMENSION_SLICE_VERSION,
+									  DIMENSION_SLICE_VERSION_PKEY);
+
+	ts_scan_iterator_scan_key_init(it,
+								   Anum_dimension_slice_version_pkey_dimension_id,
+								   BTEqualStrategyNumber,
+								   F_INT4EQ,
+								   Int32GetDatum(dimension_id));
+}
+
+/*
+ * Read the slice version of a dimension. A dimension without a version tuple
+ * has version 0.
+ *
+ * Versions are only reused for different slices if a transaction that
+ * incremented the version rolls back, and the cache is reset on rollback.
+ */
+static int64
+dimension_slice_version_get(int32 dimension_id)
+{
+	ScanIterator it =
+		ts_scan_iterator_create(DIMENSION_SLICE_VERSION, AccessShareLock, CurrentMemoryContext);
+	int64 version = 0;
+
+	dimension_slice_version_init_scan(&it, dimension_id);
+
+	ts_scanner_foreach(&it)
+	{
+		bool isnull;
+		Datum value = slot_getattr(ts_scan_iterator_slot(&it),
+								   Anum_dimension_slice_version_version,
+								   &isnull);
+
+		Assert(!isnull);
+		version = DatumGetInt64(value);
+	}
+
+	ts_scan_iterator_close(&it);
+
+	return version;
+}
+
+/*
+ * Read all slices of the entry's dimension from the catalog.
+ */
+static void
+dimension_slice_cache_load(DimensionSliceCacheEntry *entry, MemoryContext mcxt)
+{
+	ScanIterator it = ts_dimension_slice_scan_iterator_create(NULL, CurrentMemoryContext);
+	int32 capacity = DIMENSION_VEC_DEFAULT_SIZE;
+
+	/*
+	 * Read the version before the slices. Slices committed between the two
+	 * scans are then cached with the old version and read again on the next
+	 * lookup.
+	 */
+	entry->version = dimension_slice_version_get(entry->dimension_id);
+
+	/* Mark the entry as valid before scanning, so that an invalidation
+	 * received during the scan is not lost */
+	entry->valid = true;
+	entry->num_slices = 0;
+	entry->slices = MemoryContextAlloc(mcxt, sizeof(FormData_dimension_slice) * capacity);
+
+	/*
+	 * Scan all slices of the dimension. The index on (dimension_id,
+	 * range_start, range_end) returns the slices in the order the cache
+	 * needs.
+	 */
+	ts_dimension_slice_scan_iterator_set_range(&it,
+											   entry->dimension_id,
+											   InvalidStrategy,
+											   0,
+											   InvalidStrategy,
+											   0);
+
+	ts_scanner_foreach(&it)
+	{
+		bool should_free;
+		HeapTuple tuple = ts_scan_iterator_fetch_heap_tuple(&it, false, &should_free);
+
+		if (entry->num_slices >= capacity)
+		{
+			capacity *= 2;
+			entry->slices =
+				repalloc(entry->slices, sizeof(FormData_dimension_slice) * capacity);
+		}
+
+		memcpy(&entry->slices[entry->num_slices],
+			   GETSTRUCT(tuple),
+			   sizeof(FormData_dimension_slice));
+
+		Assert(entry->num_slices == 0 ||
+			   entry->slices[entry->num_slices - 1].range_start <
+				   entry->slices[entry->num_slices].range_start ||
+			   (entry->slices[entry->num_slices - 1].range_start ==
+					entry->slices[entry->num_slices].range_start &&
+				entry->slices[entry->num_slices - 1].range_end <=
+					entry->slices[entry->num_slices].range_end));
+
+		entry->num_slices++;
+
+		if (should_free)
+			heap_freetuple(tuple);
+	}
+
+	ts_scan_iterator_close(&it);
+
+	entry->max_range_end = MemoryContextAlloc(mcxt, sizeof(int64) * Max(entry->num_slices, 1));
+
+	for (int32 i = 0; i < entry->num_slices; i++)
+	{
+		int64 range_end = entry->slices[i].range_end;
+
+		if (i > 0 && entry->max_range_end[i - 1] > range_end)
+			range_end = entry->max_range_end[i - 1];
+
+		entry->max_range_end[i] = range_end;
+	}
+}
+
+static void *
+dimension_slice_cache_create_entry(Cache *cache, CacheQuery *query)
+{
+	DimensionSliceCacheQuery *dq = (DimensionSliceCacheQuery *) query;
+	DimensionSliceCacheEntry *entry = query->result;
+
+	entry->dimension_id = dq->dimension_id;
+	entry->hypertable_relid = dq->hypertable_relid;
+	dimension_slice_cache_load(entry, ts_cache_memory_ctx(cache));
+
+	return entry;
+}
+
+static void *
+dimension_slice_cache_update_entry(Cache *cache, CacheQuery *query)
+{
+	DimensionSliceCacheEntry *entry = query->result;
+
+	if (!entry->valid || entry->version != dimension_slice_version_get(entry->dimension_id))
+	{
+		pfree(entry->slices);
+		pfree(entry->max_range_end);
+		dimension_slice_cache_load(entry, ts_cache_memory_ctx(cache));
+	}
+
+	return entry;
+}
+
+static Cache *
+dimension_slice_cache_create(void)
+{
+	MemoryContext ctx = AllocSetContextCreate(CacheMemoryContext,
+											  "Dimension slice cache",
+											  ALLOCSET_DEFAULT_SIZES);
+
+	Cache *cache = MemoryContextAlloc(ctx, sizeof(Cache));
+	Cache		template =
+	{
+		.hctl =
+		{
+			.keysize = sizeof(int32),
+			.entrysize = sizeof(DimensionSliceCacheEntry),
+			.hcxt = ctx,
+		},
+		.name = "dimension_slice_cache",
+		.numelements = 16,
+		.flags = HASH_ELEM | HASH_CONTEXT | HASH_BLOBS,
+		.get_key = dimension_slice_cache_get_key,
+		.create_entry = dimension_slice_cache_create_entry,
+		.update_entry = dimension_slice_cache_update_entry,
+		.valid_result = dimension_slice_cache_valid_result,
+	};
+
+	*cache = template;
+
+	ts_cache_init(cache);
+
+	return cache;
+}
+
+static Cache *dimension_slice_cache_current = NULL;
+
+Cache *
+ts_dimension_slice_cache_pin(void)
+{
+	return ts_cache_pin(dimension_slice_cache_current);
+}
+
+DimensionSliceCacheEntry *
+ts_dimension_slice_cache_get_entry(Cache *cache, const Dimension *dim)
+{
+	DimensionSliceCacheQuery query = {
+		.q.flags = CACHE_FLAG_NONE,
+		.dimension_id = dim->fd.id,
+		.hypertable_relid = dim->main_table_relid,
+	};
+
+	return ts_cache_fetch(cache, &query.q);
+}
+
+/*
+ * Find the index of the first slice with a range_start above the given value
+ * (or equal to it, unless strict).
+ */
+static int32
+dimension_slice_cache_bsearch(const DimensionSliceCacheEntry *entry, int64 value, bool strict)
+{
+	int32 lo = 0;
+	int32 hi = entry->num_slices;
+
+	while (lo < hi)
+	{
+		int32 mid = lo + (hi - lo) / 2;
+		int64 start = entry->slices[mid].range_start;
+
+		if (start < value || (strict && start == value))
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	return lo;
+}
+
+/*
+ * Find the index of the first slice in [lo, hi) such that it or an earlier
+ * slice has a range_end above the given value (or equal to it, unless
+ * strict). No slice before that index can match a lower bound on range_end.
+ */
+static int32
+dimension_slice_cache_bsearch_end(const DimensionSliceCacheEntry *entry, int32 lo, int32 hi,
+								  int64 value, bool strict)
+{
+	while (lo < hi)
+	{
+		int32 mid = lo + (hi - lo) / 2;
+		int64 end = entry->max_range_end[mid];
+
+		if (end < value || (strict && end == value))
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	return lo;
+}
+
+static bool
+value_matches_strategy(int64 value, StrategyNumber strategy, int64 bound)
+{
+	switch (strategy)
+	{
+		case InvalidStrategy:
+			return true;
+		case BTLessStrategyNumber:
+			return value < bound;
+		case BTLessEqualStrategyNumber:
+			return value <= bound;
+		case BTEqualStrategyNumber:
+			return value == bound;
+		case BTGreaterEqualStrategyNumber:
+			return value >= bound;
+		case BTGreaterStrategyNumber:
+			return value > bound;
+		default:
+			elog(ERROR, "unexpected strategy number %d", strategy);
+			pg_unreachable();
+	}
+}
+
+/*
+ * Add the cached slices that match the given range to a dimension vector.
+ *
+ * The range is interpreted the same way as in
+ * ts_dimension_slice_scan_iterator_set_range(), so this returns the same
+ * slices as a catalog scan with the same arguments. The slices are copied
+ * into the current memory context.
+ *
+ * The conditions on range_start are resolved with a binary search since the
+ * slices are sorted on range_start. A lower bound on range_end, which is what
+ * a lower bound on time gives, is resolved with a binary search on
+ * max_range_end. Only the slices in the resulting interval are checked, so
+ * finding k matching slices takes O(log n + k) when slices do not overlap.
+ */
+DimensionVec *
+ts_dimension_slice_cache_get_matching(const DimensionSliceCacheEntry *entry,
+									  StrategyNumber start_strategy, int64 start_value,
+									  StrategyNumber end_strategy, int64 end_value,
+									  DimensionVec **dv, bool unique)
+{
+	int32 lo = 0;
+	int32 hi = entry->num_slices;
+
+	switch (start_strategy)
+	{
+		case InvalidStrategy:
+			break;
+		case BTLessStrategyNumber:
+			hi = dimension_slice_cache_bsearch(entry, start_value, false);
+			break;
+		case BTLessEqualStrategyNumber:
+			hi = dimension_slice_cache_bsearch(entry, start_value, true);
+			break;
+		case BTEqualStrategyNumber:
+			lo = dimension_slice_cache_bsearch(entry, start_value, false);
+			hi = dimension_slice_cache_bsearch(entry, start_value, true);
+			break;
+		case BTGreaterEqualStrategyNumber:
+			lo = dimension_slice_cache_bsearch(entry, start_value, false);
+			break;
+		case BTGreaterStrategyNumber:
+			lo = dimension_slice_cache_bsearch(entry, start_value, true);
+			break;
+		default:
+			elog(ERROR, "unexpected strategy number %d", start_strategy);
+	}
+
+	if (end_strategy != InvalidStrategy)
+		end_value = ts_dimension_slice_range_end_search_value(end_value);
+
+	switch (end_strategy)
+	{
+		case BTEqualStrategyNumber:
+		case BTGreaterEqualStrategyNumber:
+			lo = dimension_slice_cache_bsearch_end(entry, lo, hi, end_value, false);
+			break;
+		case BTGreaterStrategyNumber:
+			lo = dimension_slice_cache_bsearch_end(entry, lo, hi, end_value, true);
+			break;
+		default:
+			break;
+	}
+
+	for (int32 i = lo; i < hi; i++)
+	{
+		const FormData_dimension_slice *fd = &entry->slices[i];
+
+		if (value_matches_strategy(fd->range_end, end_strategy, end_value))
+		{
+			DimensionSlice *slice =
+				ts_dimension_slice_create(fd->dimension_id, fd->range_start, fd->range_end);
+
+			slice->fd.id = fd->id;
+
+			if (unique)
+				*dv = ts_dimension_vec_add_unique_slice(dv, slice);
+			else
+				*dv = ts_dimension_vec_add_slice(dv, slice);
+		}
+	}
+
+	return *dv;
+}
+
+/*
+ * Invalidate the cached slices of a dimension in all backends.
+ *
+ * Called when slices of the dimension are inserted or updated, and when the
+ * dimension is created. This increments the slice version of the dimension
+ * in the current transaction, so the cached slices are read again by any
+ * lookup that can see the change. The version tuple is locked until the end
+ * of the transaction, which orders concurrent changes to the same dimension.
+ */
+void
+ts_dimension_slice_cache_invalidate_dimension(int32 dimension_id)
+{
+	Catalog *catalog = ts_catalog_get();
+	ScanTupLock scantuplock = {
+		.waitpolicy = LockWaitBlock,
+		.lockmode = LockTupleExclusive,
+		.lockflags = TUPLE_LOCK_FLAG_LOCK_UPDATE_IN_PROGRESS,
+	};
+	ScanIterator it =
+		ts_scan_iterator_create(DIMENSION_SLICE_VERSION, RowExclusiveLock, CurrentMemoryContext);
+	Datum values[Natts_dimension_slice_version];
+	bool nulls[Natts_dimension_slice_version] = { false };
+	CatalogSecurityContext sec_ctx;
+	bool found = false;
+
+	/* In read committed mode, follow all updates to the tuple */
+	if (!IsolationUsesXactSnapshot())
+		scantuplock.lockflags |= TUPLE_LOCK_FLAG_FIND_LAST_VERSION;
+
+	it.ctx.tuplock = &scantuplock;
+	it.ctx.flags = SCANNER_F_KEEPLOCK;
+	dimension_slice_version_init_scan(&it, dimension_id);
+
+	values[AttrNumberGetAttrOffset(Anum_dimension_slice_version_dimension_id)] =
+		Int32GetDatum(dimension_id);
+	values[AttrNumberGetAttrOffset(Anum_dimension_slice_version_version)] = Int64GetDatum(1);
+
+	ts_scanner_foreach(&it)
+	{
+		TupleInfo *ti = ts_scan_iterator_tuple_info(&it);
+		bool should_free;
+		HeapTuple tuple;
+		HeapTuple new_tuple;
+
+		if (ti->lockresult != TM_Ok)
+		{
+			if (IsolationUsesXactSnapshot())
+				ereport(ERROR,
+						(errcode(ERRCODE_T_R_SERIALIZATION_FAILURE),
+						 errmsg("could not serialize access due to concurrent update")));
+
+			ereport(ERROR,
+					(errcode(ERRCODE_INTERNAL_ERROR),
+					 errmsg("unable to lock dimension slice version tuple, lock result is %d "
+							"for dimension ID (%d)",
+							ti->lockresult,
+							dimension_id)));
+		}
+
+		tuple = ts_scan_iterator_fetch_heap_tuple(&it, false, &should_free);
+		values[AttrNumberGetAttrOffset(Anum_dimension_slice_version_version)] =
+			Int64GetDatum(((Form_dimension_slice_version) GETSTRUCT(tuple))->version + 1);
+		new_tuple = heap_form_tuple(ts_scanner_get_tupledesc(ti), values, nulls);
+
+		ts_catalog_database_info_become_owner(ts_catalog_database_info_get(), &sec_ctx);
+		ts_catalog_update_tid(ti->scanrel, ts_scanner_get_tuple_tid(ti), new_tuple);
+		ts_catalog_restore_user(&sec_ctx);
+
+		heap_freetuple(new_tuple);
+
+		if (should_free)
+			heap_freetuple(tuple);
+
+		found = true;
+	}
+
+	ts_scan_iterator_close(&it);
+
+	if (!found)
+	{
+		Relation rel = table_open(catalog_get_table_id(catalog, DIMENSION_SLICE_VERSION),
+								  RowExclusiveLock);
+
+		ts_catalog_database_info_become_owner(ts_catalog_database_info_get(), &sec_ctx);
+		ts_catalog_insert_values(rel, RelationGetDescr(rel), values, nulls);
+		ts_catalog_restore_user(&sec_ctx);
+		table_close(rel, NoLock);
+	}
+}
+
+/*
+ * Delete the slice version of a dimension that is being deleted.
+ */
+void
+ts_dimension_slice_cache_delete_dimension(int32 dimension_id)
+{
+	ScanIterator it =
+		ts_scan_iterator_create(DIMENSION_SLICE_VERSION, RowExclusiveLock, CurrentMemoryContext);
+	CatalogSecurityContext sec_ctx;
+
+	dimension_slice_version_init_scan(&it, dimension_id);
+
+	ts_catalog_database_info_become_owner(ts_catalog_database_info_get(), &sec_ctx);
+
+	ts_scanner_foreach(&it)
+	{
+		TupleInfo *ti = ts_scan_iterator_tuple_info(&it);
+
+		ts_catalog_delete_tid(ti->scanrel, ts_scanner_get_tuple_tid(ti));
+	}
+
+	ts_catalog_restore_user(&sec_ctx);
+	ts_scan_iterator_close(&it);
+}
+
+/*
+ * Mark the cached dimensions of a relation as invalid.
+ *
+ * Entries are not removed since they can be in use. They are read again on
+ * the next lookup.
+ */
+void
+ts_dimension_slice_cache_invalidate_relation(Oid relid)
+{
+	HASH_SEQ_STATUS status;
+	DimensionSliceCacheEntry *entry;
+
+	if (dimension_slice_cache_current == NULL)
+		return;
+
+	hash_seq_init(&status, dimension_slice_cache_current->htab);
+
+	while ((entry = hash_seq_search(&status)) != NULL)
+	{
+		if (entry->hypertable_relid == relid)
+			entry->valid = false;
+	}
+}
+
+void
+ts_dimension_slice_cache_invalidate_callback(void)
+{
+	ts_cache_invalidate(dimension_slice_cache_current);
+	dimension_slice_cache_current = dimension_slice_cache_create();
+}
+
+void
+_dimension_slice_cache_init(void)
+{
+	CreateCacheMemoryContext();
+	dimension_slice_cache_current = dimension_slice_cache_create();
+}
+
+void
+_dimension_slice_cache_fini(void)
+{
+	ts_cache_invalidate(dimension_slice_cache_current);
+}
@@ -0,0 +1,58 @@
+/*
+ * This file and its contents are licensed under the Apache License 2.0.
+ * Please see the included NOTICE for copyright information and
+ * LICENSE-APACHE for a copy of the license.
+ */
+#pragma once
+
+#include <postgres.h>
+#include <access/stratnum.h>
+
+#include "cache.h"
+#include "dimension.h"
+#include "dimension_slice.h"
+#include "export.h"
+
+/*
+ * All slices of a dimension, sorted on (range_start, range_end).
+ *
+ * The slices are stored as plain form data since the cache entry is shared
+ * by all users of the cache. Use ts_dimension_slice_cache_get_matching() to
+ * get copies of the slices that match a range.
+ *
+ * max_range_end[i] is the largest range_end of slices[0..i]. It is
+ * non-decreasing, so it can be binary searched for the first slice that can
+ * end after a given value, even if slices overlap.
+ *
+ * version is the slice version of the dimension that was visible when the
+ * slices were read. Entries that are invalid or whose version has changed are
+ * read again from the catalog on the next lookup.
+ */
+typedef struct DimensionSliceCacheEntry
+{
+	int32 dimension_id;
+	Oid hypertable_relid;
+	bool valid;
+	int64 version;
+	int32 num_slices;
+	FormData_dimension_slice *slices;
+	int64 *max_range_end;
+} DimensionSliceCacheEntry;
+
+extern Cache *ts_dimension_slice_cache_pin(void);
+extern DimensionSliceCacheEntry *ts_dimension_slice_cache_get_entry(Cache *cache,
+																	const Dimension *dim);
+extern DimensionVec *ts_dimension_slice_cache_get_matching(const DimensionSliceCacheEntry *entry,
+														   StrategyNumber start_strategy,
+														   int64 start_value,
+														   StrategyNumber end_strategy,
+														   int64 end_value, DimensionVec **dv,
+														   bool unique);
+
+extern void ts_dimension_slice_cache_invalidate_dimension(int32 dimension_id);
+extern void ts_dimension_slice_cache_delete_dimension(int32 dimension_id);
+extern void ts_dimension_slice_cache_invalidate_relation(Oid relid);
+extern void ts_dimension_slice_cache_invalidate_callback(void);
+
+extern void _dimension_slice_cache_init(void);
+extern void _dimension_slice_cache_fini(void);
@@ -6,6 +6,7 @@
 #include <postgres.h>
 #include <miscadmin.h>
 #include <parser/parse_func.h>
+#include <postmaster/bgworker.h>
 #include <utils/guc.h>
 #include <utils/regproc.h>
 #include <utils/varlena.h>
@@ -114,6 +115,13 @@ static const struct config_enum_entry hypercore_copy_to_options[] = {
 	{ NULL, 0, false }
 };
 
+static const struct config_enum_entry compression_algorithm_selection_options[] = {
+	{ "default", COMPRESSION_ALGORITHM_SELECTION_DEFAULT, false },
+	{ "size", COMPRESSION_ALGORITHM_SELECTION_SIZE, false },
+	{ "speed", COMPRESSION_ALGORITHM_SELECTION_SPEED, false },
+	{ NULL, 0, false }
+};
+
 bool ts_guc_enable_deprecation_warnings = true;
 bool ts_guc_enable_optimizations = true;
 bool ts_guc_restoring = false;
@@ -121,8 +129,11 @@ bool ts_guc_enable_constraint_aware_append = true;
 bool ts_guc_enable_ordered_append = true;
 bool ts_guc_enable_chunk_append = true;
 bool ts_guc_enable_parallel_chunk_append = true;
+bool ts_guc_enable_parallel_ordered_append = false;
 bool ts_guc_enable_runtime_exclusion = true;
+bool ts_guc_enable_chunk_append_prefetch = true;
 bool ts_guc_enable_constraint_exclusion = true;
+bool ts_guc_enable_dimension_slice_cache = true;
 bool ts_guc_enable_qual_propagation = true;
 bool ts_guc_enable_cagg_reorder_groupby = true;
 bool ts_guc_enable_now_constify = true;
@@ -134,9 +145,14 @@ TSDLLEXPORT bool ts_guc_enable_cagg_watermark_constify = true;
 TSDLLEXPORT int ts_guc_cagg_max_individual_materializations = 10;
 bool ts_guc_enable_osm_reads = true;
 TSDLLEXPORT bool ts_guc_enable_compressed_direct_batch_delete = true;
+TSDLLEXPORT bool ts_guc_enable_compressed_direct_row_delete = false;
+TSDLLEXPORT bool ts_guc_enable_direct_compress_insert = false;
+bool ts_guc_enable_batched_insert = true;
 TSDLLEXPORT bool ts_guc_enable_dml_decompression = true;
 TSDLLEXPORT bool ts_guc_enable_dml_decompression_tuple_filtering = true;
 TSDLLEXPORT int ts_guc_max_tuples_decompressed_per_dml = 100000;
+TSDLLEXPORT int ts_guc_compression_parallel_workers = 0;
+int ts_guc_parallel_copy_workers = 0;
 TSDLLEXPORT int ts_guc_enable_transparent_decompression = 1;
 TSDLLEXPORT bool ts_guc_enable_compression_wal_markers = false;
 TSDLLEXPORT bool ts_guc_enable_decompression_sorted_merge = true;
@@ -145,6 +161,10 @@ bool ts_guc_enable_vectorized_aggregation = true;
 bool ts_guc_enable_custom_hashagg = false;
 TSDLLEXPORT bool ts_guc_enable_compression_indexscan = false;
 TSDLLEXPORT bool ts_guc_enable_bulk_decompression = true;
+TSDLLEXPORT bool ts_guc_enable_bool_compression = false;
+TSDLLEXPORT bool ts_guc_enable_uuid_compression = false;
+TSDLLEXPORT CompressionAlgorithmSelection ts_guc_compression_algorithm_selection =
+	COMPRESSION_ALGORITHM_SELECTION_DEFAULT;
 TSDLLEXPORT bool ts_guc_auto_sparse_indexes = true;
 TSDLLEXPORT bool ts_guc_default_hypercore_use_access_method = false;
 bool ts_guc_enable_chunk_skipping = false;
@@ -164,6 +184,8 @@ TSDLLEXPORT bool ts_guc_enable_merge_on_cagg_refresh = false;
 TSDLLEXPORT char *ts_guc_hypercore_indexam_whitelist;
 TSDLLEXPORT HypercoreCopyToBehavior ts_guc_hypercore_copy_to_behavior =
 	HYPERCORE_COPY_NO_COMPRESSED_DATA;
+TSDLLEXPORT int ts_guc_hypercore_arrow_cache_size = 16 * 1024;
+TSDLLEXPORT bool ts_guc_hypercore_arrow_cache_shared = false;
 
 /* default value of ts_guc_max_open_chunks_per_insert and
  * ts_guc_max_cached_chunks_per_hypertable will be set as their respective boot-value when the
@@ -522,6 +544,18 @@ _guc_init(void)
 							 NULL,
 							 NULL);
 
+	DefineCustomBoolVariable(MAKE_EXTOPTION("enable_parallel_ordered_append"),
+							 "Enable parallel ordered append",
+							 "Enable using a parallel aware ordered chunk append node below a "
+							 "Gather Merge",
+							 &ts_guc_enable_parallel_ordered_append,
+							 false,
+							 PGC_USERSET,
+							 0,
+							 NULL,
+							 NULL,
+							 NULL);
+
 	DefineCustomBoolVariable(MAKE_EXTOPTION("enable_runtime_exclusion"),
 							 "Enable runtime chunk exclusion",
 							 "Enable runtime chunk exclusion in ChunkAppend node",
@@ -533,6 +567,18 @@ _guc_init(void)
 							 NULL,
 							 NULL);
 
+	DefineCustomBoolVariable(MAKE_EXTOPTION("enable_chunk_append_prefetch"),
+							 "Enable prefetching in ChunkAppend",
+							 "Prefetch the first blocks of the next chunk in ChunkAppend node "
+							 "while the current chunk is scanned, for sequential scans",
+							 &ts_guc_enable_chunk_append_prefetch,
+							 true,
+							 PGC_USERSET,
+							 0,
+							 NULL,
+							 NULL,
+							 NULL);
+
 	DefineCustomBoolVariable(MAKE_EXTOPTION("enable_constraint_exclusion"),
 							 "Enable constraint exclusion",
 							 "Enable planner constraint exclusion",
@@ -544,6 +590,18 @@ _guc_init(void)
 							 NULL,
 							 NULL);
 
+	DefineCustomBoolVariable(MAKE_EXTOPTION("enable_dimension_slice_cache"),
+							 "Enable the dimension slice cache",
+							 "Use a per-session cache of dimension slices instead of scanning "
+							 "the dimension slice catalog during chunk exclusion",
+							 &ts_guc_enable_dimension_slice_cache,
+							 true,
+							 PGC_USERSET,
+							 0,
+							 NULL,
+							 NULL,
+							 NULL);
+
 	DefineCustomBoolVariable(MAKE_EXTOPTION("enable_foreign_key_propagation"),
 							 "Enable foreign key propagation",
 							 "Adjust foreign key lookup queries to target whole hypertable",
@@ -600,6 +658,44 @@ _guc_init(void)
 							 NULL,
 							 NULL);
 
+	DefineCustomBoolVariable(MAKE_EXTOPTION("enable_compressed_direct_row_delete"),
+							 "Enable direct deletion of rows from compressed batches",
+							 "Delete the matching rows of compressed batches by compressing the "
+							 "remaining rows of the batch again, instead of decompressing the "
+							 "batch into the uncompressed chunk",
+							 &ts_guc_enable_compressed_direct_row_delete,
+							 false,
+							 PGC_USERSET,
+							 0,
+							 NULL,
+							 NULL,
+							 NULL);
+
+	DefineCustomBoolVariable(MAKE_EXTOPTION("enable_batched_insert"),
+							 "Enable batched inserts",
+							 "Buffer the tuples of INSERT statements per chunk and write them "
+							 "with multi-inserts, like COPY does",
+							 &ts_guc_enable_batched_insert,
+							 true,
+							 PGC_USERSET,
+							 0,
+							 NULL,
+							 NULL,
+							 NULL);
+
+	DefineCustomBoolVariable(MAKE_EXTOPTION("enable_direct_compress_insert"),
+							 "Enable direct compression of inserted tuples",
+							 "Compress the tuples inserted into compressed chunks directly into "
+							 "new compressed batches at the end of the statement, instead of "
+							 "writing them into the uncompressed chunk",
+							 &ts_guc_enable_direct_compress_insert,
+							 false,
+							 PGC_USERSET,
+							 0,
+							 NULL,
+							 NULL,
+							 NULL);
+
 	DefineCustomIntVariable(MAKE_EXTOPTION("max_tuples_decompressed_per_dml_transaction"),
 							"The max number of tuples that can be decompressed during an "
 							"INSERT, UPDATE, or DELETE.",
@@ -744,6 +840,39 @@ _guc_init(void)
 							 NULL,
 							 NULL);
 
+	DefineCustomIntVariable(MAKE_EXTOPTION("compression_parallel_workers"),
+							"Number of parallel workers used to compress a chunk",
+							"Maximum number of parallel workers that compress the segments "
+							"of a chunk concurrently, further limited by "
+							"max_parallel_maintenance_workers. Requires segmentby columns. "
+							"Setting this to 0 disables parallel compression.",
+							&ts_guc_compression_parallel_workers,
+							0,
+							0,
+							MAX_PARALLEL_WORKER_LIMIT,
+							PGC_USERSET,
+							0,
+							NULL,
+							NULL,
+							NULL);
+
+	DefineCustomIntVariable(MAKE_EXTOPTION("parallel_copy_workers"),
+							"Number of parallel workers used to parse COPY FROM input",
+							"Maximum number of parallel workers that parse the lines of COPY "
+							"FROM into a hypertable, further limited by max_parallel_workers. "
+							"The rows are still inserted by the backend running the COPY. "
+							"Only used with PostgreSQL 16 and later. "
+							"Setting this to 0 disables parallel parsing.",
+							&ts_guc_parallel_copy_workers,
+							0,
+							0,
+							MAX_PARALLEL_WORKER_LIMIT,
+							PGC_USERSET,
+							0,
+							NULL,
+							NULL,
+							NULL);
+
 	/*
 	 * Define the limit on number of invalidation-based refreshes we allow per
 	 * refresh call. If this limit is exceeded, fall back to a single refresh that
@@ -821,6 +950,46 @@ _guc_init(void)
 							 NULL,
 							 NULL);
 
+	DefineCustomBoolVariable(MAKE_EXTOPTION("enable_bool_compression"),
+							 "Enable bool compression functionality",
+							 "Enable bool compression, and the bulk decompression and "
+							 "vectorized filters of bool columns",
+							 &ts_guc_enable_bool_compression,
+							 false,
+							 PGC_USERSET,
+							 0,
+							 NULL,
+							 NULL,
+							 NULL);
+
+	DefineCustomBoolVariable(MAKE_EXTOPTION("enable_uuid_compression"),
+							 "Enable uuid compression functionality",
+							 "Enable uuid compression, and the bulk decompression and "
+							 "vectorized filters of uuid columns",
+							 &ts_guc_enable_uuid_compression,
+							 false,
+							 PGC_USERSET,
+							 0,
+							 NULL,
+							 NULL,
+							 NULL);
+
+	DefineCustomEnumVariable(MAKE_EXTOPTION("compression_algorithm_selection"),
+							 "Choose the compression algorithm for each batch",
+							 "Set to 'size' to trial-encode every compressed batch with all "
+							 "algorithms applicable to the column type and keep the smallest "
+							 "result. Set to 'speed' to also take the decompression cost of "
+							 "the algorithms into account. Set to 'default' to always use the "
+							 "default algorithm for the column type.",
+							 /* valueAddr= */ (int *) &ts_guc_compression_algorithm_selection,
+							 /* bootValue= */ COMPRESSION_ALGORITHM_SELECTION_DEFAULT,
+							 /* options= */ compression_algorithm_selection_options,
+							 /* context= */ PGC_USERSET,
+							 0,
+							 NULL,
+							 NULL,
+							 NULL);
+
 	DefineCustomBoolVariable(MAKE_EXTOPTION("enable_bulk_decompression"),
 							 "Enable decompression of the entire compressed batches",
 							 "Increases throughput of decompression, but might increase query "
@@ -1069,6 +1238,33 @@ _guc_init(void)
 							 NULL,
 							 NULL);
 
+	DefineCustomIntVariable(MAKE_EXTOPTION("hypercore_arrow_cache_size"),
+							"Memory used for decompressed data by a hypercore scan",
+							"Maximum amount of memory used for caching decompressed columns of "
+							"compressed tuples when scanning a hypercore table.",
+							&ts_guc_hypercore_arrow_cache_size,
+							16 * 1024,
+							64,
+							MAX_KILOBYTES,
+							PGC_USERSET,
+							GUC_UNIT_KB,
+							NULL,
+							NULL,
+							NULL);
+
+	DefineCustomBoolVariable(MAKE_EXTOPTION("hypercore_arrow_cache_shared"),
+							 "Share decompressed data between hypercore scans",
+							 "Cache decompressed columns of compressed tuples in a cache that is "
+							 "shared by all scans of hypercore tables in the transaction, instead "
+							 "of a cache per scan.",
+							 &ts_guc_hypercore_arrow_cache_shared,
+							 false,
+							 PGC_USERSET,
+							 0,
+							 NULL,
+							 NULL,
+							 NULL);
+
 	DefineCustomIntVariable(/* name= */ MAKE_EXTOPTION("debug_bgw_scheduler_exit_status"),
 							/* short_desc= */ "exit status to use when shutting down the scheduler",
 							/* long_desc= */ "this is for debugging purposes",
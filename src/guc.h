@@ -37,9 +37,12 @@ extern bool ts_guc_enable_constraint_aware_append;
 extern bool ts_guc_enable_ordered_append;
 extern bool ts_guc_enable_chunk_append;
 extern bool ts_guc_enable_parallel_chunk_append;
+extern bool ts_guc_enable_parallel_ordered_append;
 extern bool ts_guc_enable_qual_propagation;
 extern bool ts_guc_enable_runtime_exclusion;
+extern bool ts_guc_enable_chunk_append_prefetch;
 extern bool ts_guc_enable_constraint_exclusion;
+extern bool ts_guc_enable_dimension_slice_cache;
 extern bool ts_guc_enable_cagg_reorder_groupby;
 extern TSDLLEXPORT int ts_guc_cagg_max_individual_materializations;
 extern bool ts_guc_enable_now_constify;
@@ -52,7 +55,12 @@ extern TSDLLEXPORT bool ts_guc_enable_cagg_watermark_constify;
 extern TSDLLEXPORT bool ts_guc_enable_dml_decompression;
 extern TSDLLEXPORT bool ts_guc_enable_dml_decompression_tuple_filtering;
 extern TSDLLEXPORT bool ts_guc_enable_compressed_direct_batch_delete;
+extern TSDLLEXPORT bool ts_guc_enable_compressed_direct_row_delete;
+extern TSDLLEXPORT bool ts_guc_enable_direct_compress_insert;
+extern bool ts_guc_enable_batched_insert;
 extern TSDLLEXPORT int ts_guc_max_tuples_decompressed_per_dml;
+extern TSDLLEXPORT int ts_guc_compression_parallel_workers;
+extern int ts_guc_parallel_copy_workers;
 extern TSDLLEXPORT int ts_guc_enable_transparent_decompression;
 extern TSDLLEXPORT bool ts_guc_enable_compression_wal_markers;
 extern TSDLLEXPORT bool ts_guc_enable_decompression_sorted_merge;
@@ -88,6 +96,8 @@ extern char *ts_last_tune_version;
 extern TSDLLEXPORT bool ts_guc_enable_2pc;
 extern TSDLLEXPORT bool ts_guc_enable_compression_indexscan;
 extern TSDLLEXPORT bool ts_guc_enable_bulk_decompression;
+extern TSDLLEXPORT bool ts_guc_enable_bool_compression;
+extern TSDLLEXPORT bool ts_guc_enable_uuid_compression;
 extern TSDLLEXPORT bool ts_guc_auto_sparse_indexes;
 extern TSDLLEXPORT bool ts_guc_enable_columnarscan;
 extern TSDLLEXPORT int ts_guc_bgw_log_level;
@@ -148,6 +158,26 @@ typedef enum HypercoreCopyToBehavior
 } HypercoreCopyToBehavior;
 
 extern TSDLLEXPORT HypercoreCopyToBehavior ts_guc_hypercore_copy_to_behavior;
+extern TSDLLEXPORT int ts_guc_hypercore_arrow_cache_size;
+extern TSDLLEXPORT bool ts_guc_hypercore_arrow_cache_shared;
+
+/*
+ * How the compression algorithm is chosen for each compressed batch.
+ *
+ * With COMPRESSION_ALGORITHM_SELECTION_DEFAULT, each column uses the default
+ * algorithm for its type. Otherwise, every batch is trial-encoded with all the
+ * algorithms applicable to the column type, and the result with the smallest
+ * size (SIZE) or with the smallest size weighted by the decompression cost
+ * (SPEED) is kept.
+ */
+typedef enum CompressionAlgorithmSelection
+{
+	COMPRESSION_ALGORITHM_SELECTION_DEFAULT,
+	COMPRESSION_ALGORITHM_SELECTION_SIZE,
+	COMPRESSION_ALGORITHM_SELECTION_SPEED,
+} CompressionAlgorithmSelection;
+
+extern TSDLLEXPORT CompressionAlgorithmSelection ts_guc_compression_algorithm_selection;
 
 void _guc_init(void);
 
@@ -20,6 +20,7 @@
 #include "chunk_scan.h"
 #include "dimension.h"
 #include "dimension_slice.h"
+#include "dimension_slice_cache.h"
 #include "dimension_vector.h"
 #include "expression_utils.h"
 #include "guc.h"
@@ -518,7 +519,8 @@ scan_and_append_slices(ScanIterator *it, int old_nkeys, DimensionVec **dv, bool
 	return *dv;
 }
 
-/* search dimension_slice catalog table for slices that meet hri restriction
+/* search dimension_slice catalog table (or the dimension slice cache) for
+ * slices that meet hri restriction
  */
 static List *
 gather_restriction_dimension_vectors(const HypertableRestrictInfo *hri)
@@ -527,15 +529,24 @@ gather_restriction_dimension_vectors(const HypertableRestrictInfo *hri)
 	ScanIterator it;
 	int i;
 	int old_nkeys = -1;
+	Cache *slice_cache = NULL;
+
+	if (ts_guc_enable_dimension_slice_cache)
+		slice_cache = ts_dimension_slice_cache_pin();
 
 	it = ts_dimension_slice_scan_iterator_create(NULL, CurrentMemoryContext);
 
 	for (i = 0; i < hri->num_dimensions; i++)
 	{
 		DimensionRestrictInfo *dri = hri->dimension_restriction[i];
+		DimensionSliceCacheEntry *slices = NULL;
 		DimensionVec *dv;
 
 		Assert(NULL != dri);
+
+		if (slice_cache != NULL && dri->dimension->type != DIMENSION_TYPE_STATS)
+			slices = ts_dimension_slice_cache_get_entry(slice_cache, dri->dimension);
+
 		/* dimension ranges don't need dimension slices */
 		dv = ts_dimension_vec_create(
 			dri->dimension->type == DIMENSION_TYPE_STATS ? 1 : DIMENSION_VEC_DEFAULT_SIZE);
@@ -547,6 +558,18 @@ gather_restriction_dimension_vectors(const HypertableRestrictInfo *hri)
 			{
 				const DimensionRestrictInfoOpen *open = (const DimensionRestrictInfoOpen *) dri;
 
+				if (slices != NULL)
+				{
+					dv = ts_dimension_slice_cache_get_matching(slices,
+															   open->upper_strategy,
+															   open->upper_bound,
+															   open->lower_strategy,
+															   open->lower_bound,
+															   &dv,
+															   false);
+					break;
+				}
+
 				ts_dimension_slice_scan_iterator_set_range(&it,
 														   open->base.dimension->fd.id,
 														   open->upper_strategy,
@@ -589,6 +612,18 @@ gather_restriction_dimension_vectors(const HypertableRestrictInfo *hri)
 				{
 					int32 partition = lfirst_int(cell);
 
+					if (slices != NULL)
+					{
+						dv = ts_dimension_slice_cache_get_matching(slices,
+																   BTLessEqualStrategyNumber,
+																   partition,
+																   BTGreaterEqualStrategyNumber,
+																   partition,
+																   &dv,
+																   true);
+						continue;
+					}
+
 					/*
 					 * slice_end >= value && slice_start <= value.
 					 * See the comment about scan direction above.
@@ -629,6 +664,9 @@ gather_restriction_dimension_vectors(const HypertableRestrictInfo *hri)
 		{
 			ts_scan_iterator_close(&it);
 
+			if (slice_cache != NULL)
+				ts_cache_release(slice_cache);
+
 			return NIL;
 		}
 
@@ -639,6 +677,9 @@ gather_restriction_dimension_vectors(const HypertableRestrictInfo *hri)
 
 	ts_scan_iterator_close(&it);
 
+	if (slice_cache != NULL)
+		ts_cache_release(slice_cache);
+
 	Assert(list_length(dimension_vecs) == hri->num_dimensions);
 
 	return dimension_vecs;
@@ -8,6 +8,7 @@
 #include <optimizer/optimizer.h>
 #include <optimizer/pathnode.h>
 #include <optimizer/paths.h>
+#include <optimizer/planmain.h>
 #include <optimizer/tlist.h>
 #include <utils/builtins.h>
 #include <utils/typcache.h>
@@ -16,6 +17,7 @@
 #include "guc.h"
 #include "nodes/chunk_append/chunk_append.h"
 #include "planner/planner.h"
+#include "ts_catalog/chunk_column_stats.h"
 
 static Var *find_equality_join_var(Var *sort_var, Index ht_relid, Oid eq_opr,
 								   List *join_conditions);
@@ -86,6 +88,63 @@ ts_chunk_append_path_copy(ChunkAppendPath *ca, List *subpaths, PathTarget *patht
 	return new;
 }
 
+/*
+ * Same as get_parallel_divisor() in costsize.c, which is not exported.
+ */
+static double
+chunk_append_parallel_divisor(int parallel_workers)
+{
+	double parallel_divisor = parallel_workers;
+
+	if (parallel_leader_participation)
+	{
+		double leader_contribution = 1.0 - (0.3 * parallel_workers);
+
+		if (leader_contribution > 0)
+			parallel_divisor += leader_contribution;
+	}
+
+	return parallel_divisor;
+}
+
+/*
+ * Create a parallel-aware version of an ordered ChunkAppend path.
+ *
+ * The children of an ordered ChunkAppend are sorted and cover disjoint,
+ * increasing ranges of the order column. When all children are non-partial,
+ * a participant scans each child it gets completely, and since the children
+ * are handed out in order, the children a participant gets are increasing
+ * as well. So the output of each participant is sorted and a Gather Merge
+ * can combine them into a sorted result.
+ */
+Path *
+ts_chunk_append_partial_ordered_path_create(PlannerInfo *root, ChunkAppendPath *ordered,
+											int parallel_workers)
+{
+	ChunkAppendPath *path = palloc(sizeof(ChunkAppendPath));
+	double parallel_divisor = chunk_append_parallel_divisor(parallel_workers);
+	Path *ordered_path = &ordered->cpath.path;
+
+	Assert(ordered_path->pathkeys != NIL && ordered_path->parallel_safe);
+	Assert(PATH_REQ_OUTER(ordered_path) == NULL);
+
+	memcpy(path, ordered, sizeof(ChunkAppendPath));
+
+	path->cpath.path.parallel_aware = true;
+	path->cpath.path.parallel_workers = parallel_workers;
+
+	/* all children are non-partial and scanned by a single participant */
+	path->first_partial_path = list_length(ordered->cpath.custom_paths);
+
+	path->cpath.path.rows = clamp_row_est(ordered_path->rows / parallel_divisor);
+	path->cpath.path.startup_cost = ordered_path->startup_cost;
+	path->cpath.path.total_cost =
+		ordered_path->startup_cost +
+		(ordered_path->total_cost - ordered_path->startup_cost) / parallel_divisor;
+
+	return &path->cpath.path;
+}
+
 Path *
 ts_chunk_append_path_create(PlannerInfo *root, RelOptInfo *rel, Hypertable *ht, Path *subpath,
 							bool parallel_aware, bool ordered, List *nested_oids)
@@ -187,7 +246,8 @@ ts_chunk_append_path_create(PlannerInfo *root, RelOptInfo *rel, Hypertable *ht,
 			 * the range of the chunk. It is more widely applicable than the parent
 			 * exclusion but is also more expensive to evaluate since you have to perform
 			 * the check on every chunk. Child exclusion can only apply if one of the quals
-			 * involves a partitioning column.
+			 * involves a partitioning column or a column with chunk skipping enabled,
+			 * since only those columns have ranges in the chunk constraints.
 			 *
 			 */
 			path->runtime_exclusion_parent = true;
@@ -201,7 +261,9 @@ ts_chunk_append_path_create(PlannerInfo *root, RelOptInfo *rel, Hypertable *ht,
 				 * answer for those as well
 				 */
 				if ((Index) var->varno == rel->relid && var->varattno > 0 &&
-					ts_is_partitioning_column(ht, var->varattno))
+					(ts_is_partitioning_column(ht, var->varattno) ||
+					 (ts_guc_enable_chunk_skipping &&
+					  ts_chunk_column_stats_is_range_column(ht, var->varattno))))
 				{
 					path->runtime_exclusion_children = true;
 					break;
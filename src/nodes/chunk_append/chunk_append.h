@@ -26,6 +26,9 @@ extern TSDLLEXPORT ChunkAppendPath *ts_chunk_append_path_copy(ChunkAppendPath *c
 extern Path *ts_chunk_append_path_create(PlannerInfo *root, RelOptInfo *rel, Hypertable *ht,
 										 Path *subpath, bool parallel_aware, bool ordered,
 										 List *nested_oids);
+extern Path *ts_chunk_append_partial_ordered_path_create(PlannerInfo *root,
+														ChunkAppendPath *ordered,
+														int parallel_workers);
 extern Plan *ts_chunk_append_plan_create(PlannerInfo *root, RelOptInfo *rel, CustomPath *path,
 										 List *tlist, List *clauses, List *custom_plans);
 extern Node *ts_chunk_append_state_create(CustomScan *cscan);
@@ -4,6 +4,7 @@
  * LICENSE-APACHE for a copy of the license.
  */
 #include <postgres.h>
+#include <catalog/pg_class.h>
 #include <catalog/pg_collation.h>
 #include <executor/executor.h>
 #include <executor/nodeSubplan.h>
@@ -19,9 +20,13 @@
 #include <optimizer/restrictinfo.h>
 #include <parser/parsetree.h>
 #include <rewrite/rewriteManip.h>
+#include <storage/bufmgr.h>
 #include <utils/builtins.h>
+#include <utils/lsyscache.h>
 #include <utils/memutils.h>
+#include <utils/rel.h>
 #include <utils/ruleutils.h>
+#include <utils/spccache.h>
 #include <utils/typcache.h>
 
 #include <math.h>
@@ -77,6 +82,8 @@ typedef struct ChunkAppendState
 	bool runtime_exclusion_parent;
 	bool runtime_exclusion_children;
 	bool runtime_initialized;
+	/* subplans are initialized when they are first used */
+	bool lazy_init;
 	uint32 limit;
 
 #ifdef USE_ASSERT_CHECKING
@@ -105,6 +112,9 @@ typedef struct ChunkAppendState
 	Bitmapset *valid_subplans;
 	Bitmapset *params;
 
+	/* subplans whose first blocks have been prefetched */
+	Bitmapset *prefetched_subplans;
+
 	/* sort options if this append is ordered, only used for EXPLAIN */
 	List *sort_options;
 
@@ -146,6 +156,7 @@ static CustomExecMethods chunk_append_state_methods = {
 };
 
 static void choose_next_subplan_non_parallel(ChunkAppendState *state);
+static void prefetch_next_subplan(ChunkAppendState *state);
 static void choose_next_subplan_for_worker(ChunkAppendState *state);
 
 static bool can_exclude_chunk(List *constraints, List *baserestrictinfo);
@@ -160,6 +171,7 @@ static void show_sortorder_options(StringInfo buf, Node *sortexpr, Oid sortOpera
 								   bool nullsFirst);
 
 static void perform_plan_init(ChunkAppendState *state, EState *estate, int eflags);
+static PlanState *get_subplanstate(ChunkAppendState *state, int subplan);
 
 Node *
 ts_chunk_append_state_create(CustomScan *cscan)
@@ -373,7 +385,6 @@ chunk_append_begin(CustomScanState *node, EState *estate, int eflags)
 static void
 perform_plan_init(ChunkAppendState *state, EState *estate, int eflags)
 {
-	ListCell *lc;
 	int i;
 
 #ifdef USE_ASSERT_CHECKING
@@ -391,33 +402,84 @@ perform_plan_init(ChunkAppendState *state, EState *estate, int eflags)
 
 	state->subplanstates = (PlanState **) palloc0(state->num_subplans * sizeof(PlanState *));
 
-	i = 0;
-	foreach (lc, state->filtered_subplans)
-	{
-		/*
-		 * we use an array for the states but put it in custom_ps as well
-		 * so explain and planstate_tree_walker can find it
-		 */
-		state->subplanstates[i] = ExecInitNode(lfirst(lc), estate, eflags);
-		state->csstate.custom_ps = lappend(state->csstate.custom_ps, state->subplanstates[i]);
+	/*
+	 * With a LIMIT pushed down, an ordered append usually only reads the
+	 * first few subplans, so initializing the subplans for all chunks at
+	 * startup can take much longer than the actual scan. In that case the
+	 * subplans are initialized when they are first used instead. This only
+	 * reduces executor startup time. The planner still creates a
+	 * RelOptInfo and a plan for every chunk.
+	 *
+	 * This is not done for EXPLAIN, which needs all subplans, nor for
+	 * parallel plans, where the subplans must exist when the shared state is
+	 * set up.
+	 */
+	state->lazy_init = state->limit > 0 && !(eflags & EXEC_FLAG_EXPLAIN_ONLY) &&
+					   estate->es_instrument == 0 && !state->csstate.ss.ps.plan->parallel_aware;
 
-		/*
-		 * pass down limit to child nodes
-		 */
-		if (state->limit)
-			ExecSetTupleBound(state->limit, state->subplanstates[i]);
+	state->eflags = eflags;
 
-		i++;
+	if (!state->lazy_init)
+	{
+		for (i = 0; i < state->num_subplans; i++)
+			get_subplanstate(state, i);
 	}
 
 	if (state->runtime_exclusion_parent || state->runtime_exclusion_children)
 	{
-		state->params = state->subplanstates[0]->plan->allParam;
+		Plan *first_plan = linitial(state->filtered_subplans);
+
+		state->params = first_plan->allParam;
 		/*
 		 * make sure all params are initialized for runtime exclusion
 		 */
-		state->csstate.ss.ps.chgParam = bms_copy(state->subplanstates[0]->plan->allParam);
+		state->csstate.ss.ps.chgParam = bms_copy(first_plan->allParam);
+	}
+}
+
+/*
+ * Get the state of a subplan, initializing the subplan if needed.
+ */
+static PlanState *
+get_subplanstate(ChunkAppendState *state, int subplan)
+{
+	EState *estate = state->csstate.ss.ps.state;
+	MemoryContext old;
+
+	Assert(subplan >= 0 && subplan < state->num_subplans);
+
+	if (state->subplanstates[subplan] != NULL)
+		return state->subplanstates[subplan];
+
+	if (state->lazy_init)
+	{
+		Scan *scan = ts_chunk_append_get_scan_plan(list_nth(state->filtered_subplans, subplan));
+
+		if (scan != NULL && scan->scanrelid > 0)
+			elog(DEBUG1,
+				 "initializing ChunkAppend subplan for relation \"%s\"",
+				 get_rel_name(exec_rt_fetch(scan->scanrelid, estate)->relid));
 	}
+
+	old = MemoryContextSwitchTo(estate->es_query_cxt);
+
+	/*
+	 * we use an array for the states but put it in custom_ps as well
+	 * so explain and planstate_tree_walker can find it
+	 */
+	state->subplanstates[subplan] =
+		ExecInitNode(list_nth(state->filtered_subplans, subplan), estate, state->eflags);
+	state->csstate.custom_ps = lappend(state->csstate.custom_ps, state->subplanstates[subplan]);
+
+	/*
+	 * pass down limit to child nodes
+	 */
+	if (state->limit)
+		ExecSetTupleBound(state->limit, state->subplanstates[subplan]);
+
+	MemoryContextSwitchTo(old);
+
+	return state->subplanstates[subplan];
 }
 
 static bool
@@ -506,8 +568,7 @@ initialize_runtime_exclusion(ChunkAppendState *state)
 	 */
 	for (i = 0; i < state->num_subplans; i++)
 	{
-		PlanState *ps = state->subplanstates[i];
-		Scan *scan = ts_chunk_append_get_scan_plan(ps->plan);
+		Scan *scan = ts_chunk_append_get_scan_plan(list_nth(state->filtered_subplans, i));
 
 		if (scan == NULL || scan->scanrelid == 0)
 		{
@@ -519,7 +580,7 @@ initialize_runtime_exclusion(ChunkAppendState *state)
 																	 lfirst(lc_constraints),
 																	 lfirst(lc_clauses),
 																	 &root,
-																	 ps);
+																	 &state->csstate.ss.ps);
 
 			if (!can_exclude)
 				state->valid_subplans = bms_add_member(state->valid_subplans, i);
@@ -562,7 +623,7 @@ chunk_append_exec(CustomScanState *node)
 			return ExecClearTuple(node->ss.ps.ps_ResultTupleSlot);
 
 		Assert(state->current >= 0 && state->current < state->num_subplans);
-		subnode = state->subplanstates[state->current];
+		subnode = get_subplanstate(state, state->current);
 
 		/*
 		 * get a tuple from the subplan
@@ -622,6 +683,95 @@ static void
 choose_next_subplan_non_parallel(ChunkAppendState *state)
 {
 	state->current = get_next_subplan(state, state->current);
+
+	if (ts_guc_enable_chunk_append_prefetch && state->current >= 0)
+		prefetch_next_subplan(state);
+}
+
+/*
+ * Get the relation to prefetch the first blocks of when a subplan starts.
+ *
+ * Only sequential scans read the relation from the first block on, so only
+ * those are prefetched. An index scan starts at the metapage and then reads
+ * the pages on the path to the first matching key, which are not the first
+ * blocks of the index. DecompressChunk and other custom scans with a child
+ * scan start by reading the relation of the child scan.
+ */
+static Relation
+get_prefetch_relation(PlanState *ps)
+{
+	switch (nodeTag(ps))
+	{
+		case T_SeqScanState:
+			return ((ScanState *) ps)->ss_currentRelation;
+		case T_CustomScanState:
+		{
+			CustomScanState *css = castNode(CustomScanState, ps);
+
+			if (list_length(css->custom_ps) == 1)
+				return get_prefetch_relation(linitial(css->custom_ps));
+			break;
+		}
+		case T_SortState:
+		case T_ResultState:
+		case T_AggState:
+			if (outerPlanState(ps) != NULL)
+				return get_prefetch_relation(outerPlanState(ps));
+			break;
+		default:
+			break;
+	}
+
+	return NULL;
+}
+
+/*
+ * Prefetch the first blocks of the subplan following the current one.
+ *
+ * Switching to the next chunk has to wait for the first blocks of the chunk
+ * to be read. Issuing prefetch requests for them while the current chunk is
+ * scanned overlaps that I/O with the execution of the current subplan. The
+ * number of blocks prefetched is the effective_io_concurrency of the
+ * tablespace, so this does nothing if prefetching is disabled or not
+ * supported by the platform.
+ *
+ * Subplans that are initialized lazily are not prefetched, since with a
+ * LIMIT the next subplan is most likely never executed. Each subplan is
+ * prefetched only once, since on rescans the blocks are most likely still
+ * in shared buffers.
+ */
+static void
+prefetch_next_subplan(ChunkAppendState *state)
+{
+	int next_plan = get_next_subplan(state, state->current);
+	Relation rel;
+	BlockNumber nblocks;
+	int prefetch_blocks;
+
+	if (next_plan < 0 || bms_is_member(next_plan, state->prefetched_subplans))
+		return;
+
+	state->prefetched_subplans = bms_add_member(state->prefetched_subplans, next_plan);
+
+	if (state->subplanstates[next_plan] == NULL)
+		return;
+
+	rel = get_prefetch_relation(state->subplanstates[next_plan]);
+
+	if (rel == NULL || !RELKIND_HAS_STORAGE(rel->rd_rel->relkind))
+		return;
+
+	prefetch_blocks = get_tablespace_io_concurrency(rel->rd_rel->reltablespace);
+
+	if (prefetch_blocks <= 0)
+		return;
+
+	nblocks = Min(RelationGetNumberOfBlocks(rel), (BlockNumber) prefetch_blocks);
+
+	elog(DEBUG1, "prefetching %u blocks of relation \"%s\"", nblocks, RelationGetRelationName(rel));
+
+	for (BlockNumber blkno = 0; blkno < nblocks; blkno++)
+		PrefetchBuffer(rel, MAIN_FORKNUM, blkno);
 }
 
 static void
@@ -735,6 +885,10 @@ chunk_append_rescan(CustomScanState *node)
 
 	for (i = 0; i < state->num_subplans; i++)
 	{
+		/* subplans that are not initialized yet have nothing to rescan */
+		if (state->subplanstates[i] == NULL)
+			continue;
+
 		if (node->ss.ps.chgParam != NULL)
 			UpdateChangedParamSet(state->subplanstates[i], node->ss.ps.chgParam);
 
@@ -1115,17 +1269,18 @@ ca_get_relation_constraints(Oid relationObjectId, Index varno, bool include_notn
 				}
 			}
 		}
-
-		if (ts_guc_enable_chunk_skipping)
-		{
-			/* Add column range min/max ranges in 'CHECK CONSTRAINT' form */
-			result = list_concat(result,
-								 ts_chunk_column_stats_construct_check_constraints(relation,
-																				   relationObjectId,
-																				   varno));
-		}
 	}
 
+	/*
+	 * Add column range min/max ranges in 'CHECK CONSTRAINT' form. These do
+	 * not depend on the relation having any constraints of its own.
+	 */
+	if (ts_guc_enable_chunk_skipping)
+		result = list_concat(result,
+							 ts_chunk_column_stats_construct_check_constraints(relation,
+																			   relationObjectId,
+																			   varno));
+
 	table_close(relation, NoLock);
 
 	return result;
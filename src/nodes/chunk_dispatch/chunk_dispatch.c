@@ -5,8 +5,12 @@
  */
 #include <postgres.h>
 #include <access/attnum.h>
+#include <access/tableam.h>
 #include <access/xact.h>
+#include <catalog/pg_proc.h>
 #include <catalog/pg_type.h>
+#include <commands/trigger.h>
+#include <executor/executor.h>
 #include <nodes/extensible.h>
 #include <nodes/makefuncs.h>
 #include <nodes/nodeFuncs.h>
@@ -14,6 +18,8 @@
 #include <parser/parsetree.h>
 #include <storage/lmgr.h>
 #include <storage/lockdefs.h>
+#include <utils/fmgroids.h>
+#include <utils/lsyscache.h>
 #include <utils/rel.h>
 #include <utils/syscache.h>
 
@@ -28,6 +34,7 @@
 #include "subspace_store.h"
 
 static Node *chunk_dispatch_state_create(CustomScan *cscan);
+static void chunk_insert_state_flush_batch(ChunkDispatch *dispatch, ChunkInsertState *cis);
 
 ChunkDispatch *
 ts_chunk_dispatch_create(Hypertable *ht, EState *estate, int eflags)
@@ -42,6 +49,7 @@ ts_chunk_dispatch_create(Hypertable *ht, EState *estate, int eflags)
 		ts_subspace_store_init(ht->space, estate->es_query_cxt, ts_guc_max_open_chunks_per_insert);
 	cd->prev_cis = NULL;
 	cd->prev_cis_oid = InvalidOid;
+	cd->chunk_cache_stats = *ts_subspace_store_stats(ht->chunk_cache);
 
 	return cd;
 }
@@ -49,13 +57,79 @@ ts_chunk_dispatch_create(Hypertable *ht, EState *estate, int eflags)
 void
 ts_chunk_dispatch_destroy(ChunkDispatch *chunk_dispatch)
 {
+	const SubspaceStoreStats *stats = ts_subspace_store_stats(chunk_dispatch->cache);
+
+	elog(DEBUG2,
+		 "chunk insert state cache of \"%s\": " UINT64_FORMAT " hits, " UINT64_FORMAT
+		 " misses, " UINT64_FORMAT " evictions",
+		 NameStr(chunk_dispatch->hypertable->fd.table_name),
+		 stats->hits,
+		 stats->misses,
+		 stats->evictions);
+
 	ts_subspace_store_free(chunk_dispatch->cache);
 }
 
+/*
+ * Add the lookup statistics of the chunk insert state cache and of the
+ * hypertable's chunk cache to the given statistics. For the chunk cache,
+ * which lives as long as the hypertable cache entry, only the lookups done
+ * since the dispatch was created are counted.
+ */
+void
+ts_chunk_dispatch_get_cache_stats(const ChunkDispatch *dispatch, SubspaceStoreStats *cis_stats,
+								  SubspaceStoreStats *chunk_stats)
+{
+	const SubspaceStoreStats *cis = ts_subspace_store_stats(dispatch->cache);
+	const SubspaceStoreStats *chunk = ts_subspace_store_stats(dispatch->hypertable->chunk_cache);
+
+	cis_stats->hits += cis->hits;
+	cis_stats->misses += cis->misses;
+	cis_stats->evictions += cis->evictions;
+
+	chunk_stats->hits += chunk->hits - dispatch->chunk_cache_stats.hits;
+	chunk_stats->misses += chunk->misses - dispatch->chunk_cache_stats.misses;
+	chunk_stats->evictions += chunk->evictions - dispatch->chunk_cache_stats.evictions;
+}
+
 static void
 destroy_chunk_insert_state(void *cis)
 {
-	ts_chunk_insert_state_destroy((ChunkInsertState *) cis);
+	ChunkInsertState *state = (ChunkInsertState *) cis;
+
+	/* The chunk can be closed before the end of the statement if too many
+	 * chunks are open, so write out the tuples buffered for it first */
+	if (state->batch_nused > 0)
+	{
+		ChunkDispatch *dispatch = state->cds->dispatch;
+
+		chunk_insert_state_flush_batch(dispatch, state);
+		dispatch->batched_cis = list_delete_ptr(dispatch->batched_cis, state);
+	}
+
+	/* The buffer for direct compression is written out when the chunk
+	 * insert state is destroyed */
+	if (state->compressed_insert_pending)
+	{
+		ChunkDispatch *dispatch = state->cds->dispatch;
+
+		dispatch->compressed_cis = list_delete_ptr(dispatch->compressed_cis, state);
+		state->compressed_insert_pending = false;
+	}
+
+	ts_chunk_insert_state_destroy(state);
+}
+
+/*
+ * Check if the chunk for the point is open or in the chunk cache of the
+ * hypertable, so that getting its chunk insert state does not need to look
+ * up or create the chunk in the catalog.
+ */
+bool
+ts_chunk_dispatch_has_cached_chunk(ChunkDispatch *dispatch, const Point *point)
+{
+	return ts_subspace_store_contains(dispatch->cache, point) ||
+		   ts_subspace_store_contains(dispatch->hypertable->chunk_cache, point);
 }
 
 /*
@@ -212,6 +286,177 @@ ts_chunk_dispatch_decompress_batches_for_insert(ChunkDispatch *dispatch, ChunkIn
 	}
 }
 
+/*
+ * Buffer a tuple for a multi-insert into the chunk.
+ *
+ * INSERT normally writes one tuple at a time. When there are no RETURNING
+ * clause, row triggers or ON CONFLICT clause that need the tuple to be
+ * inserted right away, the tuples are instead collected per chunk and
+ * written with table_multi_insert(), like in the COPY path. The index
+ * entries are added and AFTER ROW triggers are queued when the batch is
+ * flushed.
+ */
+void
+ts_chunk_dispatch_batch_tuple(ChunkDispatch *dispatch, ChunkInsertState *cis,
+							  TupleTableSlot *slot)
+{
+	MemoryContext old = MemoryContextSwitchTo(cis->mctx);
+
+	if (cis->batch_slots == NULL)
+	{
+		cis->batch_slots = palloc0(sizeof(TupleTableSlot *) * MAX_BATCHED_TUPLES);
+
+		/*
+		 * Use a non-refcounted copy of the tuple descriptor for the slots to
+		 * avoid the ResourceOwner overhead of pinning it for each slot.
+		 */
+		cis->batch_tupdesc = CreateTupleDescCopy(RelationGetDescr(cis->rel));
+	}
+
+	if (cis->batch_slots[cis->batch_nused] == NULL)
+		cis->batch_slots[cis->batch_nused] =
+			MakeSingleTupleTableSlot(cis->batch_tupdesc, table_slot_callbacks(cis->rel));
+
+	ExecCopySlot(cis->batch_slots[cis->batch_nused], slot);
+	MemoryContextSwitchTo(old);
+
+	if (cis->batch_nused == 0)
+	{
+		old = MemoryContextSwitchTo(dispatch->estate->es_query_cxt);
+		dispatch->batched_cis = lappend(dispatch->batched_cis, cis);
+		MemoryContextSwitchTo(old);
+	}
+
+	cis->batch_nused++;
+	dispatch->batched_tuples++;
+
+	if (dispatch->batched_tuples >= MAX_BATCHED_TUPLES)
+		ts_chunk_dispatch_flush_batches(dispatch);
+}
+
+/*
+ * Write the tuples buffered for a chunk.
+ */
+static void
+chunk_insert_state_flush_batch(ChunkDispatch *dispatch, ChunkInsertState *cis)
+{
+	EState *estate = dispatch->estate;
+	ResultRelInfo *rri = cis->result_relation_info;
+	MemoryContext old;
+
+	Assert(cis->batch_nused > 0);
+
+	/* table_multi_insert may leak memory, so use the per-tuple context */
+	old = MemoryContextSwitchTo(GetPerTupleMemoryContext(estate));
+	table_multi_insert(cis->rel,
+					   cis->batch_slots,
+					   cis->batch_nused,
+					   estate->es_output_cid,
+					   0,
+					   NULL);
+	MemoryContextSwitchTo(old);
+
+	for (int i = 0; i < cis->batch_nused; i++)
+	{
+		TupleTableSlot *slot = cis->batch_slots[i];
+		List *recheck_indexes = NIL;
+
+		if (rri->ri_NumIndices > 0)
+			recheck_indexes =
+				ExecInsertIndexTuplesCompat(rri, slot, estate, false, false, NULL, NIL, false);
+
+		ExecARInsertTriggers(estate, rri, slot, recheck_indexes, NULL);
+		list_free(recheck_indexes);
+		ExecClearTuple(slot);
+	}
+
+	dispatch->batched_tuples -= cis->batch_nused;
+	cis->batch_nused = 0;
+}
+
+/*
+ * Add a tuple to the buffer for direct compression of the chunk. The buffer
+ * is written into the compressed chunk by ts_chunk_dispatch_flush_batches()
+ * at the end of the statement, or when the chunk insert state is destroyed.
+ */
+void
+ts_chunk_dispatch_compress_tuple(ChunkDispatch *dispatch, ChunkInsertState *cis,
+								 TupleTableSlot *slot)
+{
+	Assert(cis->compressed_insert_buffer != NULL);
+
+	ts_cm_functions->compressed_insert_buffer_add(cis->compressed_insert_buffer, slot);
+
+	if (!cis->compressed_insert_pending)
+	{
+		MemoryContext old = MemoryContextSwitchTo(dispatch->estate->es_query_cxt);
+		dispatch->compressed_cis = lappend(dispatch->compressed_cis, cis);
+		MemoryContextSwitchTo(old);
+		cis->compressed_insert_pending = true;
+	}
+}
+
+/*
+ * Write the tuples buffered for all chunks.
+ *
+ * This has to be called at the end of the INSERT or COPY, before the AFTER
+ * triggers run, so that the tuples are in the chunks when the triggers and
+ * deferred constraints look at them.
+ */
+void
+ts_chunk_dispatch_flush_batches(ChunkDispatch *dispatch)
+{
+	ListCell *lc;
+
+	foreach (lc, dispatch->batched_cis)
+		chunk_insert_state_flush_batch(dispatch, lfirst(lc));
+
+	list_free(dispatch->batched_cis);
+	dispatch->batched_cis = NIL;
+	Assert(dispatch->batched_tuples == 0);
+
+	foreach (lc, dispatch->compressed_cis)
+	{
+		ChunkInsertState *cis = lfirst(lc);
+
+		ts_cm_functions->compressed_insert_buffer_flush(cis->compressed_insert_buffer);
+		cis->compressed_insert_pending = false;
+	}
+
+	list_free(dispatch->compressed_cis);
+	dispatch->compressed_cis = NIL;
+}
+
+static bool
+volatile_func_not_nextval_checker(Oid func_id, void *context)
+{
+	return func_id != F_NEXTVAL && func_volatile(func_id) == PROVOLATILE_VOLATILE;
+}
+
+/*
+ * Check if the query contains volatile functions other than nextval(). Such
+ * functions could read the hypertable and would not see the tuples that are
+ * buffered for multi-inserts. nextval() is commonly used in defaults and is
+ * safe, so it is allowed like in COPY.
+ */
+static bool
+contain_volatile_functions_not_nextval_walker(Node *node, void *context)
+{
+	if (node == NULL)
+		return false;
+
+	if (IsA(node, Query))
+		return query_tree_walker((Query *) node,
+								 contain_volatile_functions_not_nextval_walker,
+								 context,
+								 0);
+
+	if (check_functions_in_node(node, volatile_func_not_nextval_checker, context))
+		return true;
+
+	return expression_tree_walker(node, contain_volatile_functions_not_nextval_walker, context);
+}
+
 static CustomScanMethods chunk_dispatch_plan_methods = {
 	.CustomName = "ChunkDispatch",
 	.CreateCustomScanState = chunk_dispatch_state_create,
@@ -238,6 +483,7 @@ chunk_dispatch_plan_create(PlannerInfo *root, RelOptInfo *relopt, CustomPath *be
 	ChunkDispatchPath *cdpath = (ChunkDispatchPath *) best_path;
 	CustomScan *cscan = makeNode(CustomScan);
 	ListCell *lc;
+	bool batch_inserts;
 
 	foreach (lc, custom_plans)
 	{
@@ -249,7 +495,11 @@ chunk_dispatch_plan_create(PlannerInfo *root, RelOptInfo *relopt, CustomPath *be
 		cscan->scan.plan.plan_width += subplan->plan_width;
 	}
 
-	cscan->custom_private = list_make1_oid(cdpath->hypertable_relid);
+	batch_inserts = root->parse->commandType == CMD_INSERT &&
+					!contain_volatile_functions_not_nextval_walker((Node *) root->parse, NULL);
+
+	cscan->custom_private =
+		list_make2(list_make1_oid(cdpath->hypertable_relid), makeBoolean(batch_inserts));
 	cscan->methods = &chunk_dispatch_plan_methods;
 	cscan->custom_plans = custom_plans;
 	cscan->scan.scanrelid = 0; /* Indicate this is not a real relation we are
@@ -513,12 +763,13 @@ static Node *
 chunk_dispatch_state_create(CustomScan *cscan)
 {
 	ChunkDispatchState *state;
-	Oid hypertable_relid = linitial_oid(cscan->custom_private);
+	Oid hypertable_relid = linitial_oid(linitial(cscan->custom_private));
 
 	state = (ChunkDispatchState *) newNode(sizeof(ChunkDispatchState), T_CustomScanState);
 	state->hypertable_relid = hypertable_relid;
 	Assert(list_length(cscan->custom_plans) == 1);
 	state->subplan = linitial(cscan->custom_plans);
+	state->batch_inserts = boolVal(lsecond(cscan->custom_private));
 	state->cscan_state.methods = &chunk_dispatch_state_methods;
 	return (Node *) state;
 }
@@ -554,4 +805,14 @@ ts_chunk_dispatch_state_set_parent(ChunkDispatchState *state, ModifyTableState *
 	/* Inserts on hypertables should always have one subplan */
 	state->mtstate = mtstate;
 	state->arbiter_indexes = mt_plan->arbiterIndexes;
+
+	/*
+	 * Tuples are only buffered for plain INSERTs. RETURNING, ON CONFLICT
+	 * and transition tables need each tuple to be inserted before the next
+	 * one is processed.
+	 */
+	state->batch_inserts = state->batch_inserts && ts_guc_enable_batched_insert &&
+						   mtstate->operation == CMD_INSERT &&
+						   mt_plan->onConflictAction == ONCONFLICT_NONE &&
+						   mt_plan->returningLists == NIL && mtstate->mt_transition_capture == NULL;
 }
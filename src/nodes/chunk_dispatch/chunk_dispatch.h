@@ -18,6 +18,12 @@
 #include "hypertable_cache.h"
 #include "subspace_store.h"
 
+/*
+ * Flush the tuples buffered for multi-inserts when there are this many of
+ * them, over all chunks. Same as the limit in the COPY path.
+ */
+#define MAX_BATCHED_TUPLES 1000
+
 /*
  * ChunkDispatch keeps cached state needed to dispatch tuples to chunks. It is
  * separate from any plan and executor nodes, since it is used both for INSERT
@@ -40,6 +46,18 @@ typedef struct ChunkDispatch
 	ResultRelInfo *hypertable_result_rel_info;
 	ChunkInsertState *prev_cis;
 	Oid prev_cis_oid;
+
+	/* Chunk insert states with buffered tuples and the total number of
+	 * buffered tuples */
+	List *batched_cis;
+	int batched_tuples;
+
+	/* Lookup statistics of the hypertable's chunk cache when the dispatch
+	 * was created, to report the lookups done by this statement */
+	SubspaceStoreStats chunk_cache_stats;
+
+	/* Chunk insert states with tuples buffered for direct compression */
+	List *compressed_cis;
 } ChunkDispatch;
 
 typedef struct ChunkDispatchPath
@@ -82,6 +100,8 @@ typedef struct ChunkDispatchState
 
 	/* flag to represent dropped attributes */
 	bool is_dropped_attr_exists;
+	/* tuples can be buffered and written with multi-inserts */
+	bool batch_inserts;
 	int64 batches_deleted;
 	int64 batches_filtered;
 	int64 batches_decompressed;
@@ -103,11 +123,20 @@ extern void ts_chunk_dispatch_destroy(ChunkDispatch *chunk_dispatch);
 extern ChunkInsertState *
 ts_chunk_dispatch_get_chunk_insert_state(ChunkDispatch *dispatch, Point *p,
 										 const on_chunk_changed_func on_chunk_changed, void *data);
+extern bool ts_chunk_dispatch_has_cached_chunk(ChunkDispatch *dispatch, const Point *point);
 extern void ts_chunk_dispatch_decompress_batches_for_insert(ChunkDispatch *dispatch,
 															ChunkInsertState *cis,
 															TupleTableSlot *slot);
 extern TupleTableSlot *ts_chunk_dispatch_prepare_tuple_routing(ChunkDispatchState *state,
 															   TupleTableSlot *slot);
+extern void ts_chunk_dispatch_batch_tuple(ChunkDispatch *dispatch, ChunkInsertState *cis,
+										  TupleTableSlot *slot);
+extern void ts_chunk_dispatch_compress_tuple(ChunkDispatch *dispatch, ChunkInsertState *cis,
+											 TupleTableSlot *slot);
+extern void ts_chunk_dispatch_flush_batches(ChunkDispatch *dispatch);
+extern void ts_chunk_dispatch_get_cache_stats(const ChunkDispatch *dispatch,
+											 SubspaceStoreStats *cis_stats,
+											 SubspaceStoreStats *chunk_stats);
 
 extern TSDLLEXPORT Path *ts_chunk_dispatch_path_create(PlannerInfo *root, ModifyTablePath *mtpath,
 													   Index hypertable_rti, int subpath_index);
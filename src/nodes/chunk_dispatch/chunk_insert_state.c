@@ -31,6 +31,7 @@
 #include "chunk_insert_state.h"
 #include "debug_point.h"
 #include "errors.h"
+#include "guc.h"
 #include "indexing.h"
 #include "ts_catalog/continuous_agg.h"
 
@@ -464,6 +465,48 @@ adjust_projections(ChunkInsertState *cis, const ChunkDispatch *dispatch, Oid row
 	}
 }
 
+/*
+ * Check if the tuples inserted into a compressed chunk can be compressed
+ * directly instead of being inserted into the uncompressed chunk.
+ *
+ * The tuples are only visible in the chunk after the buffer is flushed at the
+ * end of the statement, so this is only possible if nothing looks at the
+ * inserted tuples before that, i.e. there are no insert triggers on the chunk
+ * or the hypertable, no transition tables, no RETURNING or WITH CHECK OPTION
+ * clauses, and there is no unique constraint to check.
+ */
+static bool
+can_compress_inserted_tuples(const ChunkInsertState *state, const ChunkDispatch *dispatch,
+							 OnConflictAction onconflict_action)
+{
+	ResultRelInfo *relinfo = state->result_relation_info;
+	TriggerDesc *tg = relinfo->ri_TrigDesc;
+	TriggerDesc *ht_tg = dispatch->hypertable_result_rel_info->ri_TrigDesc;
+
+	if (!ts_guc_enable_direct_compress_insert || !state->chunk_compressed || state->use_tam ||
+		ts_cm_functions->compressed_insert_buffer_create == NULL)
+		return false;
+
+	if (chunk_dispatch_get_cmd_type(dispatch) != CMD_INSERT || onconflict_action != ONCONFLICT_NONE)
+		return false;
+
+	if (chunk_dispatch_has_returning(dispatch) ||
+		dispatch->hypertable_result_rel_info->ri_WithCheckOptions != NIL)
+		return false;
+
+	if (tg != NULL && (tg->trig_insert_before_row || tg->trig_insert_after_row ||
+					   tg->trig_insert_instead_row || tg->trig_insert_new_table))
+		return false;
+
+	if (ht_tg != NULL &&
+		(ht_tg->trig_insert_before_row || ht_tg->trig_insert_after_row ||
+		 ht_tg->trig_insert_before_statement || ht_tg->trig_insert_after_statement ||
+		 ht_tg->trig_insert_new_table))
+		return false;
+
+	return !ts_indexing_relation_has_primary_or_unique_index(state->rel);
+}
+
 /*
  * Create new insert chunk state.
  *
@@ -556,6 +599,9 @@ ts_chunk_insert_state_create(Oid chunk_relid, const ChunkDispatch *dispatch)
 
 	adjust_projections(state, dispatch, RelationGetForm(rel)->reltype);
 
+	if (can_compress_inserted_tuples(state, dispatch, onconflict_action))
+		state->compressed_insert_buffer = ts_cm_functions->compressed_insert_buffer_create(state);
+
 	/* Need a tuple table slot to store tuples going into this chunk. We don't
 	 * want this slot tied to the executor's tuple table, since that would tie
 	 * the slot's lifetime to the entire length of the execution and we want
@@ -648,7 +694,13 @@ ts_chunk_insert_state_destroy(ChunkInsertState *state)
 {
 	ResultRelInfo *rri = state->result_relation_info;
 
-	if (state->chunk_compressed && !state->chunk_partial)
+	if (state->compressed_insert_buffer != NULL)
+	{
+		/* The buffered tuples go into new compressed batches, so the chunk
+		 * does not become partial */
+		ts_cm_functions->compressed_insert_buffer_finish(state->compressed_insert_buffer);
+	}
+	else if (state->chunk_compressed && !state->chunk_partial)
 	{
 		Oid chunk_relid = RelationGetRelid(state->result_relation_info->ri_RelationDesc);
 		Chunk *chunk = ts_chunk_get_by_relid(chunk_relid, true);
@@ -667,6 +719,16 @@ ts_chunk_insert_state_destroy(ChunkInsertState *state)
 	if (state->slot)
 		ExecDropSingleTupleTableSlot(state->slot);
 
+	if (state->batch_slots != NULL)
+	{
+		Assert(state->batch_nused == 0);
+
+		for (int i = 0; i < MAX_BATCHED_TUPLES && state->batch_slots[i] != NULL; i++)
+			ExecDropSingleTupleTableSlot(state->batch_slots[i]);
+
+		FreeTupleDesc(state->batch_tupdesc);
+	}
+
 	/*
 	 * Postgres stores cached row types from `get_cached_rowtype` in the
 	 * constraint expression and tries to free this type via a callback from the
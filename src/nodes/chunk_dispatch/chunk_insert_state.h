@@ -60,6 +60,22 @@ typedef struct ChunkInsertState
 	bool use_tam;
 
 	Oid compressed_chunk_table_id;
+
+	/* Buffer for compressing the inserted tuples directly, or NULL if the
+	 * tuples are inserted into the uncompressed chunk */
+	CompressedInsertBuffer *compressed_insert_buffer;
+	/* The buffer has tuples to compress at the end of the statement */
+	bool compressed_insert_pending;
+
+	/* Vectorized filters for the conflict checks of the inserted tuples
+	 * against the compressed batches, built for the first tuple */
+	CompressedConflictFilter *conflict_filter;
+
+	/* Tuples buffered by INSERT for a multi-insert into the chunk, see
+	 * ts_chunk_dispatch_batch_tuple() */
+	TupleTableSlot **batch_slots;
+	TupleDesc batch_tupdesc;
+	int batch_nused;
 } ChunkInsertState;
 
 typedef struct ChunkDispatch ChunkDispatch;
@@ -34,6 +34,10 @@
 #include "nodes/chunk_dispatch/chunk_dispatch.h"
 #include "utils.h"
 
+/* Show the chunk cache statistics in EXPLAIN ANALYZE, set by the
+ * chunk_cache_stats option of EXPLAIN */
+bool ts_explain_chunk_cache_stats = false;
+
 static void fireASTriggers(ModifyTableState *node);
 static void fireBSTriggers(ModifyTableState *node);
 static TupleTableSlot *ExecModifyTable(CustomScanState *cs_node, PlanState *pstate);
@@ -188,6 +192,34 @@ hypertable_modify_rescan(CustomScanState *node)
 	ExecReScan(linitial(node->custom_ps));
 }
 
+/*
+ * Show the lookup statistics of a chunk cache, in the same format as the
+ * buffer usage.
+ */
+static void
+explain_chunk_cache_stats(const char *label, const SubspaceStoreStats *stats, ExplainState *es)
+{
+	if (es->format == EXPLAIN_FORMAT_TEXT)
+	{
+		appendStringInfoSpaces(es->str, es->indent * 2);
+		appendStringInfo(es->str,
+						 "%s: hits=" UINT64_FORMAT " misses=" UINT64_FORMAT
+						 " evictions=" UINT64_FORMAT "\n",
+						 label,
+						 stats->hits,
+						 stats->misses,
+						 stats->evictions);
+	}
+	else
+	{
+		ExplainOpenGroup(label, label, true, es);
+		ExplainPropertyUInteger("Hits", NULL, stats->hits, es);
+		ExplainPropertyUInteger("Misses", NULL, stats->misses, es);
+		ExplainPropertyUInteger("Evictions", NULL, stats->evictions, es);
+		ExplainCloseGroup(label, label, true, es);
+	}
+}
+
 static void
 hypertable_modify_explain(CustomScanState *node, List *ancestors, ExplainState *es)
 {
@@ -240,6 +272,8 @@ hypertable_modify_explain(CustomScanState *node, List *ancestors, ExplainState *
 		outerPlanState(mtstate))
 	{
 		List *chunk_dispatch_states = get_chunk_dispatch_states(outerPlanState(mtstate));
+		SubspaceStoreStats cis_stats = { 0 };
+		SubspaceStoreStats chunk_stats = { 0 };
 		ListCell *lc;
 
 		foreach (lc, chunk_dispatch_states)
@@ -249,6 +283,15 @@ hypertable_modify_explain(CustomScanState *node, List *ancestors, ExplainState *
 			state->batches_filtered += cds->batches_filtered;
 			state->batches_decompressed += cds->batches_decompressed;
 			state->tuples_decompressed += cds->tuples_decompressed;
+
+			if (cds->dispatch != NULL)
+				ts_chunk_dispatch_get_cache_stats(cds->dispatch, &cis_stats, &chunk_stats);
+		}
+
+		if (es->analyze && ts_explain_chunk_cache_stats && chunk_dispatch_states != NIL)
+		{
+			explain_chunk_cache_stats("Chunk insert state cache", &cis_stats, es);
+			explain_chunk_cache_stats("Chunk cache", &chunk_stats, es);
 		}
 	}
 	if (state->batches_filtered > 0)
@@ -259,6 +302,8 @@ hypertable_modify_explain(CustomScanState *node, List *ancestors, ExplainState *
 		ExplainPropertyInteger("Tuples decompressed", NULL, state->tuples_decompressed, es);
 	if (state->batches_deleted > 0)
 		ExplainPropertyInteger("Batches deleted", NULL, state->batches_deleted, es);
+	if (state->batches_rewritten > 0)
+		ExplainPropertyInteger("Batches rewritten", NULL, state->batches_rewritten, es);
 }
 
 static CustomExecMethods hypertable_modify_state_methods = {
@@ -1002,6 +1047,9 @@ ExecModifyTable(CustomScanState *cs_node, PlanState *pstate)
 	/*
 	 * Insert remaining tuples for batch insert.
 	 */
+	if (cds != NULL)
+		ts_chunk_dispatch_flush_batches(cds->dispatch);
+
 	relinfos = estate->es_opened_result_relations;
 
 	if (ht_state->comp_chunks_processed)
@@ -1808,6 +1856,29 @@ ExecInsert(ModifyTableContext *context, ResultRelInfo *resultRelInfo, ChunkDispa
 
 			/* Since there was no insertion conflict, we're done */
 		}
+		else if (cds->cis->compressed_insert_buffer != NULL)
+		{
+			/* compress the tuple directly into the compressed chunk */
+			ts_chunk_dispatch_compress_tuple(cds->dispatch, cds->cis, slot);
+		}
+		else if (cds->batch_inserts && !cds->cis->chunk_compressed &&
+				 resultRelInfo->ri_WithCheckOptions == NIL &&
+				 !(resultRelInfo->ri_TrigDesc &&
+				   resultRelInfo->ri_TrigDesc->trig_insert_before_row))
+		{
+			/*
+			 * Buffer the tuple for a multi-insert into the chunk. Index
+			 * entries and AFTER ROW triggers are handled when the buffer is
+			 * flushed. There is no RETURNING clause or transition table when
+			 * batching, so there is nothing more to do for this tuple.
+			 */
+			ts_chunk_dispatch_batch_tuple(cds->dispatch, cds->cis, slot);
+
+			if (canSetTag)
+				(estate->es_processed)++;
+
+			return NULL;
+		}
 		else
 		{
 			/* insert the tuple normally */
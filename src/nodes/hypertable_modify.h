@@ -36,8 +36,11 @@ typedef struct HypertableModifyState
 	int64 batches_decompressed;
 	int64 batches_filtered;
 	int64 batches_deleted;
+	int64 batches_rewritten;
 } HypertableModifyState;
 
+extern bool ts_explain_chunk_cache_stats;
+
 extern void ts_hypertable_modify_fixup_tlist(Plan *plan);
 extern Path *ts_hypertable_modify_path_create(PlannerInfo *root, ModifyTablePath *mtpath,
 											  Hypertable *ht, RelOptInfo *input_rel);
@@ -1281,6 +1281,35 @@ apply_optimizations(PlannerInfo *root, TsRelType reltype, RelOptInfo *rel, Range
 					break;
 			}
 		}
+
+		/*
+		 * Add parallel versions of the ordered ChunkAppend paths, so that a
+		 * Gather Merge can be used on top of an ordered append.
+		 */
+		if (ordered && ts_guc_enable_parallel_chunk_append &&
+			ts_guc_enable_parallel_ordered_append && rel->consider_parallel &&
+			rel->partial_pathlist != NIL)
+		{
+			int parallel_workers = ((Path *) linitial(rel->partial_pathlist))->parallel_workers;
+			List *partial_paths = NIL;
+
+			foreach (lc, rel->pathlist)
+			{
+				Path *path = lfirst(lc);
+
+				if (ts_is_chunk_append_path(path) && path->pathkeys != NIL &&
+					path->parallel_safe && PATH_REQ_OUTER(path) == NULL)
+				{
+					ChunkAppendPath *ca = (ChunkAppendPath *) path;
+
+					path = ts_chunk_append_partial_ordered_path_create(root, ca, parallel_workers);
+					partial_paths = lappend(partial_paths, path);
+				}
+			}
+
+			foreach (lc, partial_paths)
+				add_partial_path(rel, lfirst(lc));
+		}
 	}
 }
 
@@ -68,6 +68,7 @@
 #include "hypertable.h"
 #include "hypertable_cache.h"
 #include "indexing.h"
+#include "nodes/hypertable_modify.h"
 #include "partitioning.h"
 #include "process_utility.h"
 #include "scan_iterator.h"
@@ -3250,14 +3251,19 @@ process_explain_start(ProcessUtilityArgs *args)
 	ExplainStmt *stmt = castNode(ExplainStmt, args->parsetree);
 	ListCell *lc;
 
-	if (ts_cm_functions->process_explain_def)
+	ts_explain_chunk_cache_stats = false;
+
+	foreach (lc, stmt->options)
 	{
-		foreach (lc, stmt->options)
+		DefElem *opt = (DefElem *) lfirst(lc);
+
+		if (strcmp(opt->defname, "chunk_cache_stats") == 0)
 		{
-			DefElem *opt = (DefElem *) lfirst(lc);
-			if (ts_cm_functions->process_explain_def(opt))
-				foreach_delete_current(stmt->options, lc);
+			ts_explain_chunk_cache_stats = defGetBoolean(opt);
+			foreach_delete_current(stmt->options, lc);
 		}
+		else if (ts_cm_functions->process_explain_def && ts_cm_functions->process_explain_def(opt))
+			foreach_delete_current(stmt->options, lc);
 	}
 	return DDL_CONTINUE;
 }
@@ -4,6 +4,8 @@
  * LICENSE-APACHE for a copy of the license.
  */
 #include <postgres.h>
+#include <lib/ilist.h>
+#include <utils/hsearch.h>
 #include <utils/memutils.h>
 
 #include "dimension.h"
@@ -13,189 +15,388 @@
 #include "subspace_store.h"
 
 /*
- * In terms of datastructures, the subspace store is actually a tree. At the
- * root of a tree is a DimensionVec representing the different DimensionSlices
- * for the first dimension. Each of the DimensionSlices of the
- * first dimension point to a DimensionVec of the second dimension. This recurses
- * for the N dimensions. The leaf DimensionSlice points to the data being stored.
+ * The subspace store is a hash table keyed on the slices of the stored
+ * hypercubes, with one slice id per dimension.
  *
- * */
+ * To look up the object for a point, each coordinate of the point is first
+ * resolved to a slice id using a sorted array of the slices that are in use
+ * in that dimension. Each dimension remembers the slice that was found last,
+ * which is checked before doing a binary search since inserts usually hit
+ * the same slices over and over. The resulting key is then compared to the
+ * key of the object found last, and only on a mismatch is the hash table
+ * probed.
+ *
+ * Slices of different chunks in the same dimension can overlap, for example
+ * for space dimensions after the number of partitions changed. When a
+ * dimension has overlapping slices, all slices that contain the coordinate
+ * are tried instead.
+ *
+ * If the store has a limit on the number of objects, the least recently used
+ * object is evicted when the limit is reached.
+ */
 
-typedef struct SubspaceStoreInternalNode
+typedef struct SubspaceStoreSlice
 {
-	DimensionVec *vector;
-	uint16 descendants;
-	bool last_internal_node;
-} SubspaceStoreInternalNode;
+	int64 range_start;
+	int64 range_end;
+	int32 id;
+	/* Number of stored objects using this slice */
+	int32 refcount;
+} SubspaceStoreSlice;
+
+typedef struct SubspaceStoreDimension
+{
+	/* Slices in use, sorted on (range_start, range_end) */
+	SubspaceStoreSlice *slices;
+	int32 num_slices;
+	int32 capacity;
+	/* Index of the slice found by the last lookup */
+	int32 last_hit;
+	/* Some of the slices overlap, so binary search cannot be used */
+	bool overlapping;
+} SubspaceStoreDimension;
+
+/*
+ * An entry in the hash table. The hash key, which is an array of slice ids,
+ * comes first in the hash table element and is followed by this struct, see
+ * subspace_store_entry().
+ */
+typedef struct SubspaceStoreEntry
+{
+	const int32 *key;
+	void *object;
+	void (*object_free)(void *);
+	dlist_node lru_node;
+} SubspaceStoreEntry;
 
 typedef struct SubspaceStore
 {
 	MemoryContext mcxt;
 	uint16 num_dimensions;
-	/* limit growth of store by  limiting number of slices in first dimension,	0 for no limit */
+	/* limit on the number of stored objects, 0 for no limit */
 	uint16 max_items;
-	SubspaceStoreInternalNode *origin; /* origin of the tree */
+	uint32 num_items;
+	Size keysize;
+	HTAB *entries;
+	/* Entries in least recently used order */
+	dlist_head lru;
+	SubspaceStoreEntry *last_entry;
+	SubspaceStoreDimension *dimensions;
+	/* Scratch space for building keys */
+	int32 *key;
+	/* Slices are identified by ids local to the store so that the keys do
+	 * not depend on the slices having catalog ids */
+	int32 last_slice_id;
+	SubspaceStoreStats stats;
 } SubspaceStore;
 
-static inline SubspaceStoreInternalNode *
-subspace_store_internal_node_create(bool last_internal_node)
+static inline SubspaceStoreEntry *
+subspace_store_entry(const SubspaceStore *subspace_store, void *hash_entry)
 {
-	SubspaceStoreInternalNode *node = palloc(sizeof(SubspaceStoreInternalNode));
-
-	node->vector = ts_dimension_vec_create(DIMENSION_VEC_DEFAULT_SIZE);
-	node->descendants = 0;
-	node->last_internal_node = last_internal_node;
-	return node;
+	return (SubspaceStoreEntry *) ((char *) hash_entry + MAXALIGN(subspace_store->keysize));
 }
 
-static inline void
-subspace_store_internal_node_free(void *node)
+static inline bool
+subspace_store_slice_contains(const SubspaceStoreSlice *slice, int64 coordinate)
 {
-	ts_dimension_vec_free(((SubspaceStoreInternalNode *) node)->vector);
-	pfree(node);
-}
-
-static size_t
-subspace_store_internal_node_descendants(SubspaceStoreInternalNode *node, int index)
-{
-	const DimensionSlice *slice = ts_dimension_vec_get(node->vector, index);
-
-	if (slice == NULL)
-		return 0;
-
-	if (node->last_internal_node)
-		return 1;
-
-	return ((SubspaceStoreInternalNode *) slice->storage)->descendants;
+	return coordinate >= slice->range_start && coordinate < slice->range_end;
 }
 
 SubspaceStore *
 ts_subspace_store_init(const Hyperspace *space, MemoryContext mcxt, int16 max_items)
 {
 	MemoryContext old = MemoryContextSwitchTo(mcxt);
-	SubspaceStore *sst = palloc(sizeof(SubspaceStore));
+	SubspaceStore *sst = palloc0(sizeof(SubspaceStore));
 
-	sst->origin = subspace_store_internal_node_create(space->num_dimensions == 1);
 	sst->num_dimensions = space->num_dimensions;
 	/* max_items = 0 is treated as unlimited */
 	sst->max_items = max_items;
 	sst->mcxt = mcxt;
+	sst->keysize = sizeof(int32) * space->num_dimensions;
+	dlist_init(&sst->lru);
+
+	/* The internal compressed hypertable has no dimensions and never stores
+	 * anything */
+	if (sst->num_dimensions > 0)
+	{
+		HASHCTL ctl = {
+			.keysize = sst->keysize,
+			.entrysize = MAXALIGN(sst->keysize) + sizeof(SubspaceStoreEntry),
+			.hcxt = mcxt,
+		};
+
+		sst->dimensions = palloc0(sizeof(SubspaceStoreDimension) * sst->num_dimensions);
+		sst->key = palloc(sst->keysize);
+		sst->entries = hash_create("subspace store",
+								   max_items > 0 ? max_items : 64,
+								   &ctl,
+								   HASH_ELEM | HASH_BLOBS | HASH_CONTEXT);
+	}
+
 	MemoryContextSwitchTo(old);
 	return sst;
 }
 
+/*
+ * Find the index of the first slice that sorts after the given range.
+ */
+static int32
+subspace_store_dimension_upper_bound(const SubspaceStoreDimension *dim, int64 range_start,
+									 int64 range_end)
+{
+	int32 lo = 0;
+	int32 hi = dim->num_slices;
+
+	while (lo < hi)
+	{
+		int32 mid = lo + (hi - lo) / 2;
+		const SubspaceStoreSlice *slice = &dim->slices[mid];
+
+		if (slice->range_start < range_start ||
+			(slice->range_start == range_start && slice->range_end <= range_end))
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	return lo;
+}
+
+/*
+ * Find the slice containing the coordinate in a dimension without
+ * overlapping slices. Returns -1 if there is no such slice.
+ */
+static int32
+subspace_store_dimension_find(SubspaceStoreDimension *dim, int64 coordinate)
+{
+	int32 index;
+
+	Assert(!dim->overlapping);
+
+	if (dim->last_hit < dim->num_slices &&
+		subspace_store_slice_contains(&dim->slices[dim->last_hit], coordinate))
+		return dim->last_hit;
+
+	/* The only candidate is the last slice that starts at or before the
+	 * coordinate */
+	index = subspace_store_dimension_upper_bound(dim, coordinate, PG_INT64_MAX) - 1;
+
+	if (index < 0 || !subspace_store_slice_contains(&dim->slices[index], coordinate))
+		return -1;
+
+	dim->last_hit = index;
+	return index;
+}
+
+/*
+ * Add a reference to a slice of a stored hypercube and return the slice id
+ * to use in the key. Slices are identified by their range, so the same
+ * slice always gets the same id while it is in use.
+ */
+static int32
+subspace_store_dimension_add(SubspaceStore *subspace_store, SubspaceStoreDimension *dim,
+							 const DimensionSlice *target)
+{
+	int32 index =
+		subspace_store_dimension_upper_bound(dim, target->fd.range_start, target->fd.range_end);
+	SubspaceStoreSlice *slice;
+
+	/* An existing slice with the same range is the slice right before */
+	if (index > 0 && dim->slices[index - 1].range_start == target->fd.range_start &&
+		dim->slices[index - 1].range_end == target->fd.range_end)
+	{
+		slice = &dim->slices[index - 1];
+		slice->refcount++;
+		return slice->id;
+	}
+
+	if (dim->num_slices >= dim->capacity)
+	{
+		dim->capacity = Max(dim->capacity * 2, DIMENSION_VEC_DEFAULT_SIZE);
+
+		Size size = sizeof(SubspaceStoreSlice) * dim->capacity;
+
+		if (dim->slices == NULL)
+			dim->slices = MemoryContextAlloc(subspace_store->mcxt, size);
+		else
+			dim->slices = repalloc(dim->slices, size);
+	}
+
+	memmove(&dim->slices[index + 1],
+			&dim->slices[index],
+			sizeof(SubspaceStoreSlice) * (dim->num_slices - index));
+	dim->num_slices++;
+
+	slice = &dim->slices[index];
+	slice->range_start = target->fd.range_start;
+	slice->range_end = target->fd.range_end;
+	slice->id = ++subspace_store->last_slice_id;
+	slice->refcount = 1;
+
+	/* Check the neighbors for overlaps. Once a dimension has overlapping
+	 * slices, it is treated as such until the store is freed. */
+	if ((index > 0 && dim->slices[index - 1].range_end > slice->range_start) ||
+		(index + 1 < dim->num_slices && dim->slices[index + 1].range_start < slice->range_end))
+		dim->overlapping = true;
+
+	dim->last_hit = index;
+
+	return slice->id;
+}
+
+/*
+ * Remove a reference to a slice of an evicted hypercube.
+ */
+static void
+subspace_store_dimension_release(SubspaceStoreDimension *dim, int32 slice_id)
+{
+	for (int32 i = 0; i < dim->num_slices; i++)
+	{
+		if (dim->slices[i].id != slice_id)
+			continue;
+
+		Assert(dim->slices[i].refcount > 0);
+
+		if (--dim->slices[i].refcount == 0)
+		{
+			dim->num_slices--;
+			memmove(&dim->slices[i],
+					&dim->slices[i + 1],
+					sizeof(SubspaceStoreSlice) * (dim->num_slices - i));
+			dim->last_hit = 0;
+		}
+
+		return;
+	}
+
+	Assert(false);
+}
+
+static void
+subspace_store_evict(SubspaceStore *subspace_store, SubspaceStoreEntry *entry)
+{
+	void *object = entry->object;
+	void (*object_free)(void *) = entry->object_free;
+	bool found;
+
+	for (int i = 0; i < subspace_store->num_dimensions; i++)
+		subspace_store_dimension_release(&subspace_store->dimensions[i], entry->key[i]);
+
+	dlist_delete(&entry->lru_node);
+
+	if (subspace_store->last_entry == entry)
+		subspace_store->last_entry = NULL;
+
+	hash_search(subspace_store->entries, entry->key, HASH_REMOVE, &found);
+	Assert(found);
+
+	subspace_store->num_items--;
+	subspace_store->stats.evictions++;
+
+	/* Free the object last, after the store is consistent again */
+	if (object_free != NULL)
+		object_free(object);
+}
+
 void
 ts_subspace_store_add(SubspaceStore *subspace_store, const Hypercube *hypercube, void *object,
 					  void (*object_free)(void *))
 {
-	SubspaceStoreInternalNode *node = subspace_store->origin;
-	DimensionSlice *last = NULL;
-	MemoryContext old = MemoryContextSwitchTo(subspace_store->mcxt);
-	int i;
+	int32 *key = subspace_store->key;
+	SubspaceStoreEntry *entry;
+	void *hash_entry;
+	bool found;
 
 	Assert(hypercube->num_slices == subspace_store->num_dimensions);
+	Assert(subspace_store->num_dimensions > 0);
+
+	/* Make room for the new object by evicting the least recently used one */
+	if (subspace_store->max_items > 0 && subspace_store->num_items >= subspace_store->max_items)
+		subspace_store_evict(subspace_store,
+							 dlist_head_element(SubspaceStoreEntry,
+												lru_node,
+												&subspace_store->lru));
 
-	for (i = 0; i < hypercube->num_slices; i++)
+	for (int i = 0; i < hypercube->num_slices; i++)
 	{
-		const DimensionSlice *target = hypercube->slices[i];
-		DimensionSlice *match;
+		key[i] = subspace_store_dimension_add(subspace_store,
+											  &subspace_store->dimensions[i],
+											  hypercube->slices[i]);
+	}
 
-		Assert(target->storage == NULL);
+	/* We only call this function on a cache miss */
+	hash_entry = hash_search(subspace_store->entries, key, HASH_ENTER, &found);
+	Assert(!found);
 
-		if (node == NULL)
-		{
-			/*
-			 * We should have one internal node per dimension in the
-			 * hypertable. If we don't have one for the current dimension,
-			 * create one now. (There will always be one for time)
-			 */
-			Assert(last != NULL);
-			last->storage = subspace_store_internal_node_create(i == (hypercube->num_slices - 1));
-			last->storage_free = subspace_store_internal_node_free;
-			node = last->storage;
-		}
+	entry = subspace_store_entry(subspace_store, hash_entry);
+	entry->key = hash_entry;
+	entry->object = object;
+	entry->object_free = object_free;
+	dlist_push_tail(&subspace_store->lru, &entry->lru_node);
 
-		Assert(subspace_store->max_items == 0 ||
-			   node->descendants <= (size_t) subspace_store->max_items);
+	subspace_store->num_items++;
+	subspace_store->last_entry = entry;
+}
 
-		/*
-		 * We only call this function on a cache miss, so number of leaves
-		 * will definitely increase see `Assert(last != NULL && last->storage
-		 * == NULL);` at bottom.
-		 */
-		node->descendants += 1;
+/*
+ * Resolve the coordinates of the target point, starting at the given
+ * dimension, into slice ids and find the entry with the resulting key.
+ */
+static SubspaceStoreEntry *
+subspace_store_lookup(SubspaceStore *subspace_store, const Point *target, int dimension,
+					  int32 *key)
+{
+	SubspaceStoreDimension *dim;
+	int64 coordinate;
 
-		Assert(0 == node->vector->num_slices ||
-			   node->vector->slices[0]->fd.dimension_id == target->fd.dimension_id);
+	if (dimension == subspace_store->num_dimensions)
+	{
+		void *hash_entry;
 
-		/* Do we have enough space to store the object? */
-		if (subspace_store->max_items > 0 && node->descendants > subspace_store->max_items)
-		{
-			/*
-			 * Always delete the slice corresponding to the earliest time
-			 * range. In the normal case that inserts are performed in
-			 * time-order this is the one least likely to be reused. (Note
-			 * that we made sure that the first dimension is a time dimension
-			 * when creating the subspace_store). If out-of-order inserts are
-			 * become significant we may wish to change this to something more
-			 * sophisticated like LRU.
-			 */
-			size_t items_removed = subspace_store_internal_node_descendants(node, i);
-
-			/*
-			 * descendants at the root is inclusive of the descendants at the
-			 * children, so if we have an overflow it must be in the time dim
-			 */
-			Assert(i == 0);
-
-			Assert(subspace_store->max_items + 1 == node->descendants);
-
-			ts_dimension_vec_remove_slice(&node->vector, i);
-
-			/*
-			 * Note we would have to do this to ancestors if this was not the
-			 * root.
-			 */
-			node->descendants -= items_removed;
-		}
+		if (subspace_store->last_entry != NULL &&
+			memcmp(subspace_store->last_entry->key, key, subspace_store->keysize) == 0)
+			return subspace_store->last_entry;
 
-		match = ts_dimension_vec_find_slice(node->vector, target->fd.range_start);
+		hash_entry = hash_search(subspace_store->entries, key, HASH_FIND, NULL);
 
-		/* Do we have a slot in this vector for the new object? */
-		if (match == NULL)
-		{
-			DimensionSlice *copy;
+		return hash_entry ? subspace_store_entry(subspace_store, hash_entry) : NULL;
+	}
 
-			/*
-			 * create a new copy of the range this slice covers, to store the
-			 * object in
-			 */
-			copy = ts_dimension_slice_copy(target);
+	dim = &subspace_store->dimensions[dimension];
+	coordinate = REMAP_LAST_COORDINATE(target->coordinates[dimension]);
 
-			ts_dimension_vec_add_slice_sort(&node->vector, copy);
-			match = copy;
-		}
+	if (!dim->overlapping)
+	{
+		int32 index = subspace_store_dimension_find(dim, coordinate);
 
-		Assert(subspace_store->max_items == 0 ||
-			   node->descendants <= (size_t) subspace_store->max_items);
+		if (index < 0)
+			return NULL;
 
-		last = match;
-		/* internal slices point to the next SubspaceStoreInternalNode */
-		node = last->storage;
+		key[dimension] = dim->slices[index].id;
+		return subspace_store_lookup(subspace_store, target, dimension + 1, key);
 	}
 
-	Assert(last != NULL && last->storage == NULL);
-	last->storage = object; /* at the end we store the object */
-	last->storage_free = object_free;
-	MemoryContextSwitchTo(old);
+	for (int32 i = 0; i < dim->num_slices && dim->slices[i].range_start <= coordinate; i++)
+	{
+		SubspaceStoreEntry *entry;
+
+		if (!subspace_store_slice_contains(&dim->slices[i], coordinate))
+			continue;
+
+		key[dimension] = dim->slices[i].id;
+		entry = subspace_store_lookup(subspace_store, target, dimension + 1, key);
+
+		if (entry != NULL)
+			return entry;
+	}
+
+	return NULL;
 }
 
 void *
-ts_subspace_store_get(const SubspaceStore *subspace_store, const Point *target)
+ts_subspace_store_get(SubspaceStore *subspace_store, const Point *target)
 {
-	int i;
-	DimensionVec *vec = subspace_store->origin->vector;
-	DimensionSlice *match = NULL;
+	SubspaceStoreEntry *entry;
 
 	Assert(target->cardinality == subspace_store->num_dimensions);
 
@@ -205,23 +406,64 @@ ts_subspace_store_get(const SubspaceStore *subspace_store, const Point *target)
 	if (subspace_store->num_dimensions == 0)
 		return NULL;
 
-	for (i = 0; i < target->cardinality; i++)
+	entry = subspace_store_lookup(subspace_store, target, 0, subspace_store->key);
+
+	if (entry == NULL)
 	{
-		match = ts_dimension_vec_find_slice(vec, target->coordinates[i]);
+		subspace_store->stats.misses++;
+		return NULL;
+	}
 
-		if (NULL == match)
-			return NULL;
+	subspace_store->stats.hits++;
 
-		vec = ((SubspaceStoreInternalNode *) match->storage)->vector;
+	if (entry != subspace_store->last_entry)
+	{
+		dlist_move_tail(&subspace_store->lru, &entry->lru_node);
+		subspace_store->last_entry = entry;
 	}
-	Assert(match != NULL);
-	return match->storage;
+
+	return entry->object;
+}
+
+bool
+ts_subspace_store_contains(SubspaceStore *subspace_store, const Point *target)
+{
+	Assert(target->cardinality == subspace_store->num_dimensions);
+
+	if (subspace_store->num_dimensions == 0)
+		return false;
+
+	return subspace_store_lookup(subspace_store, target, 0, subspace_store->key) != NULL;
 }
 
 void
 ts_subspace_store_free(SubspaceStore *subspace_store)
 {
-	subspace_store_internal_node_free(subspace_store->origin);
+	dlist_mutable_iter iter;
+
+	dlist_foreach_modify(iter, &subspace_store->lru)
+	{
+		SubspaceStoreEntry *entry = dlist_container(SubspaceStoreEntry, lru_node, iter.cur);
+
+		if (entry->object_free != NULL)
+			entry->object_free(entry->object);
+	}
+
+	if (subspace_store->entries != NULL)
+		hash_destroy(subspace_store->entries);
+
+	for (int i = 0; i < subspace_store->num_dimensions; i++)
+	{
+		if (subspace_store->dimensions[i].slices != NULL)
+			pfree(subspace_store->dimensions[i].slices);
+	}
+
+	if (subspace_store->dimensions != NULL)
+	{
+		pfree(subspace_store->dimensions);
+		pfree(subspace_store->key);
+	}
+
 	pfree(subspace_store);
 }
 
@@ -230,3 +472,9 @@ ts_subspace_store_mcxt(const SubspaceStore *subspace_store)
 {
 	return subspace_store->mcxt;
 }
+
+const SubspaceStoreStats *
+ts_subspace_store_stats(const SubspaceStore *subspace_store)
+{
+	return &subspace_store->stats;
+}
@@ -18,6 +18,18 @@ typedef struct Hypercube Hypercube;
 typedef struct Point Point;
 typedef struct SubspaceStore SubspaceStore;
 
+/* Lookup statistics, for tuning the size of the store */
+typedef struct SubspaceStoreStats
+{
+	uint64 hits;
+	uint64 misses;
+	uint64 evictions;
+} SubspaceStoreStats;
+
+/* Create a store holding at most max_items objects, or any number of objects
+ * if max_items is 0. When the store is full, adding an object evicts the
+ * least recently used one.
+ */
 extern SubspaceStore *ts_subspace_store_init(const Hyperspace *space, MemoryContext mcxt,
 											 int16 max_items);
 
@@ -27,7 +39,13 @@ extern void ts_subspace_store_add(SubspaceStore *subspace_store, const Hypercube
 
 /* Get the object stored for the subspace that a point is in.
  * Return the object stored or NULL if this subspace is not in the store.
+ * A found object becomes the most recently used one.
+ */
+extern void *ts_subspace_store_get(SubspaceStore *subspace_store, const Point *target);
+/* Check if the subspace that a point is in is in the store, without counting
+ * it as a lookup or making the object the most recently used one.
  */
-extern void *ts_subspace_store_get(const SubspaceStore *subspace_store, const Point *target);
+extern bool ts_subspace_store_contains(SubspaceStore *subspace_store, const Point *target);
 extern void ts_subspace_store_free(SubspaceStore *subspace_store);
 extern MemoryContext ts_subspace_store_mcxt(const SubspaceStore *subspace_store);
+extern const SubspaceStoreStats *ts_subspace_store_stats(const SubspaceStore *subspace_store);
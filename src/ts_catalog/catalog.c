@@ -113,6 +113,10 @@ static const TableInfoDef catalog_table_names[_MAX_CATALOG_TABLES + 1] = {
 		.schema_name = CATALOG_SCHEMA_NAME,
 		.table_name = CHUNK_COLUMN_STATS_TABLE_NAME,
 	},
+	[DIMENSION_SLICE_VERSION] = {
+		.schema_name = CATALOG_SCHEMA_NAME,
+		.table_name = DIMENSION_SLICE_VERSION_TABLE_NAME,
+	},
 	[_MAX_CATALOG_TABLES] = {
 		.schema_name = "invalid schema",
 		.table_name = "invalid table",
@@ -141,6 +145,12 @@ static const TableIndexDef catalog_table_index_definitions[_MAX_CATALOG_TABLES]
 			[DIMENSION_SLICE_DIMENSION_ID_RANGE_START_RANGE_END_IDX] = "dimension_slice_dimension_id_range_start_range_end_key",
 		},
 	},
+	[DIMENSION_SLICE_VERSION] = {
+		.length = _MAX_DIMENSION_SLICE_VERSION_INDEX,
+		.names = (char *[]) {
+			[DIMENSION_SLICE_VERSION_PKEY] = "dimension_slice_version_pkey",
+		},
+	},
 	[CHUNK_COLUMN_STATS] = {
 		.length = _MAX_CHUNK_COLUMN_STATS_INDEX,
 		.names = (char *[]) {
@@ -54,6 +54,7 @@ typedef enum CatalogTable
 	CONTINUOUS_AGGS_WATERMARK,
 	TELEMETRY_EVENT,
 	CHUNK_COLUMN_STATS,
+	DIMENSION_SLICE_VERSION,
 	/* Don't forget updating catalog.c when adding new tables! */
 	_MAX_CATALOG_TABLES,
 } CatalogTable;
@@ -291,6 +292,45 @@ enum
 	_MAX_DIMENSION_SLICE_INDEX,
 };
 
+/******************************
+ *
+ * Dimension slice version table definitions
+ *
+ ******************************/
+
+#define DIMENSION_SLICE_VERSION_TABLE_NAME "dimension_slice_version"
+
+enum Anum_dimension_slice_version
+{
+	Anum_dimension_slice_version_dimension_id = 1,
+	Anum_dimension_slice_version_version,
+	_Anum_dimension_slice_version_max,
+};
+
+#define Natts_dimension_slice_version (_Anum_dimension_slice_version_max - 1)
+
+typedef struct FormData_dimension_slice_version
+{
+	int32 dimension_id;
+	int64 version;
+} FormData_dimension_slice_version;
+
+typedef FormData_dimension_slice_version *Form_dimension_slice_version;
+
+enum Anum_dimension_slice_version_pkey
+{
+	Anum_dimension_slice_version_pkey_dimension_id = 1,
+	_Anum_dimension_slice_version_pkey_max,
+};
+
+#define Natts_dimension_slice_version_pkey (_Anum_dimension_slice_version_pkey_max - 1)
+
+enum
+{
+	DIMENSION_SLICE_VERSION_PKEY = 0,
+	_MAX_DIMENSION_SLICE_VERSION_INDEX,
+};
+
 /******************************
  *
  * Dimension range table definitions
@@ -1159,6 +1199,9 @@ typedef enum Anum_compression_settings
 	Anum_compression_settings_orderby,
 	Anum_compression_settings_orderby_desc,
 	Anum_compression_settings_orderby_nullsfirst,
+	Anum_compression_settings_toast_compression,
+	Anum_compression_settings_batch_size,
+	Anum_compression_settings_batch_target_size,
 	_Anum_compression_settings_max,
 } Anum_compression_settings;
 
@@ -1171,6 +1214,12 @@ typedef struct FormData_compression_settings
 	ArrayType *orderby;
 	ArrayType *orderby_desc;
 	ArrayType *orderby_nullsfirst;
+	/* TOAST compression method of the compressed columns, stored by name */
+	char toast_compression;
+	/* maximum number of rows per batch, 0 for the default */
+	int32 batch_size;
+	/* target size of a batch in bytes, 0 disables the adaptive batch size */
+	int64 batch_target_size;
 } FormData_compression_settings;
 
 typedef FormData_compression_settings *Form_compression_settings;
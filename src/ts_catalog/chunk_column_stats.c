@@ -665,6 +665,31 @@ ts_chunk_column_stats_range_space_scan(int32 hypertable_id, Oid ht_reloid, Memor
 	return range_space;
 }
 
+/*
+ * Check if min/max ranges are tracked for a column of the hypertable.
+ */
+bool
+ts_chunk_column_stats_is_range_column(const Hypertable *ht, AttrNumber column_attno)
+{
+	const char *col_name;
+
+	if (ht->range_space == NULL || column_attno <= 0)
+		return false;
+
+	col_name = get_attname(ht->main_table_relid, column_attno, true);
+
+	if (col_name == NULL)
+		return false;
+
+	for (int i = 0; i < ht->range_space->num_range_cols; i++)
+	{
+		if (namestrcmp(&ht->range_space->range_cols[i].column_name, col_name) == 0)
+			return true;
+	}
+
+	return false;
+}
+
 static ScanTupleResult
 form_range_tuple_found(TupleInfo *ti, void *data)
 {
@@ -1326,13 +1351,20 @@ construct_check_constraint_range_tuple(TupleInfo *ti, void *data)
 
 	fd = (Form_chunk_column_stats) GETSTRUCT(tuple);
 
-	constr = create_col_stats_check_constraint(fd,
-											   checklist->main_table_relid,
-											   checklist->chunk_relid,
-											   NULL);
+	/*
+	 * An invalid range does not cover rows modified after it was computed,
+	 * so it cannot be used to exclude the chunk.
+	 */
+	if (fd->valid)
+	{
+		constr = create_col_stats_check_constraint(fd,
+												   checklist->main_table_relid,
+												   checklist->chunk_relid,
+												   NULL);
 
-	if (constr)
-		checklist->cclist = lappend(checklist->cclist, constr);
+		if (constr)
+			checklist->cclist = lappend(checklist->cclist, constr);
+	}
 
 	if (should_free)
 		heap_freetuple(tuple);
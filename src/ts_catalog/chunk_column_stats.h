@@ -28,6 +28,8 @@ typedef struct ChunkRangeSpace
 
 extern ChunkRangeSpace *ts_chunk_column_stats_range_space_scan(int32 hypertable_id, Oid ht_reloid,
 															   MemoryContext mctx);
+extern bool ts_chunk_column_stats_is_range_column(const Hypertable *ht,
+												  AttrNumber column_attno);
 
 extern int ts_chunk_column_stats_update_by_id(int32 chunk_column_stats_id,
 											  FormData_chunk_column_stats *fd_range);
@@ -4,6 +4,7 @@
  * LICENSE-APACHE for a copy of the license.
  */
 #include <postgres.h>
+#include <access/htup_details.h>
 
 #include "scan_iterator.h"
 #include "scanner.h"
@@ -43,3 +44,34 @@ ts_compression_chunk_size_delete(int32 uncompressed_chunk_id)
 
 	return count;
 }
+
+/*
+ * Get the compression size stats of a chunk.
+ *
+ * Returns false if the chunk has no stats.
+ */
+TSDLLEXPORT bool
+ts_compression_chunk_size_get(int32 uncompressed_chunk_id, Form_compression_chunk_size form)
+{
+	ScanIterator iterator =
+		ts_scan_iterator_create(COMPRESSION_CHUNK_SIZE, AccessShareLock, CurrentMemoryContext);
+	bool found = false;
+
+	init_scan_by_uncompressed_chunk_id(&iterator, uncompressed_chunk_id);
+	ts_scanner_foreach(&iterator)
+	{
+		bool should_free;
+		HeapTuple tuple = ts_scan_iterator_fetch_heap_tuple(&iterator, false, &should_free);
+
+		memcpy(form, GETSTRUCT(tuple), sizeof(*form));
+
+		if (should_free)
+			heap_freetuple(tuple);
+
+		found = true;
+	}
+
+	ts_scan_iterator_close(&iterator);
+
+	return found;
+}
@@ -8,4 +8,8 @@
 #include <compat/compat.h>
 #include <postgres.h>
 
+#include "ts_catalog/catalog.h"
+
 extern TSDLLEXPORT int ts_compression_chunk_size_delete(int32 uncompressed_chunk_id);
+extern TSDLLEXPORT bool ts_compression_chunk_size_get(int32 uncompressed_chunk_id,
+													  Form_compression_chunk_size form);
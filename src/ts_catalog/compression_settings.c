@@ -4,6 +4,7 @@
  * LICENSE-APACHE for a copy of the license.
  */
 #include <postgres.h>
+#include <access/toast_compression.h>
 #include <utils/builtins.h>
 
 #include "chunk.h"
@@ -17,7 +18,14 @@
 static ScanTupleResult compression_settings_tuple_update(TupleInfo *ti, void *data);
 static HeapTuple compression_settings_formdata_make_tuple(const FormData_compression_settings *fd,
 														  TupleDesc desc);
+static CompressionSettings *compression_settings_insert(const FormData_compression_settings *fd);
 
+/*
+ * Compare the settings that determine the layout of the compressed data. The
+ * TOAST compression method only applies to the compressed chunks created
+ * afterwards and the batch size only to the batches written afterwards, so
+ * they do not prevent recompressing or merging the existing ones.
+ */
 bool
 ts_compression_settings_equal(const CompressionSettings *left, const CompressionSettings *right)
 {
@@ -32,43 +40,51 @@ ts_compression_settings_materialize(Oid ht_relid, Oid dst_relid)
 {
 	CompressionSettings *src = ts_compression_settings_get(ht_relid);
 	Assert(src);
-	CompressionSettings *dst = ts_compression_settings_create(dst_relid,
-															  src->fd.segmentby,
-															  src->fd.orderby,
-															  src->fd.orderby_desc,
-															  src->fd.orderby_nullsfirst);
+	FormData_compression_settings fd = src->fd;
+
+	fd.relid = dst_relid;
 
-	return dst;
+	return compression_settings_insert(&fd);
 }
 
 CompressionSettings *
 ts_compression_settings_create(Oid relid, ArrayType *segmentby, ArrayType *orderby,
 							   ArrayType *orderby_desc, ArrayType *orderby_nullsfirst)
+{
+	FormData_compression_settings fd = {
+		.relid = relid,
+		.segmentby = segmentby,
+		.orderby = orderby,
+		.orderby_desc = orderby_desc,
+		.orderby_nullsfirst = orderby_nullsfirst,
+		.toast_compression = InvalidCompressionMethod,
+		.batch_size = 0,
+		.batch_target_size = 0,
+	};
+
+	return compression_settings_insert(&fd);
+}
+
+static CompressionSettings *
+compression_settings_insert(const FormData_compression_settings *fd)
 {
 	Catalog *catalog = ts_catalog_get();
 	CatalogSecurityContext sec_ctx;
 	Relation rel;
-	FormData_compression_settings fd;
 
-	Assert(OidIsValid(relid));
+	Assert(OidIsValid(fd->relid));
 
 	/*
 	 * The default compression settings will always have orderby settings but the user may have
 	 * chosen to overwrite it. For both cases all 3 orderby arrays must either have the same number
 	 * of entries or be all NULL.
 	 */
-	Assert((orderby && orderby_desc && orderby_nullsfirst) ||
-		   (!orderby && !orderby_desc && !orderby_nullsfirst));
-
-	fd.relid = relid;
-	fd.segmentby = segmentby;
-	fd.orderby = orderby;
-	fd.orderby_desc = orderby_desc;
-	fd.orderby_nullsfirst = orderby_nullsfirst;
+	Assert((fd->orderby && fd->orderby_desc && fd->orderby_nullsfirst) ||
+		   (!fd->orderby && !fd->orderby_desc && !fd->orderby_nullsfirst));
 
 	rel = table_open(catalog_get_table_id(catalog, COMPRESSION_SETTINGS), RowExclusiveLock);
 
-	HeapTuple new_tuple = compression_settings_formdata_make_tuple(&fd, RelationGetDescr(rel));
+	HeapTuple new_tuple = compression_settings_formdata_make_tuple(fd, RelationGetDescr(rel));
 	ts_catalog_database_info_become_owner(ts_catalog_database_info_get(), &sec_ctx);
 	ts_catalog_insert(rel, new_tuple);
 	ts_catalog_restore_user(&sec_ctx);
@@ -76,7 +92,7 @@ ts_compression_settings_create(Oid relid, ArrayType *segmentby, ArrayType *order
 
 	table_close(rel, RowExclusiveLock);
 
-	return ts_compression_settings_get(relid);
+	return ts_compression_settings_get(fd->relid);
 }
 
 static void
@@ -119,6 +135,24 @@ compression_settings_fill_from_tuple(CompressionSettings *settings, TupleInfo *t
 		fd->orderby_nullsfirst = DatumGetArrayTypeP(
 			values[AttrNumberGetAttrOffset(Anum_compression_settings_orderby_nullsfirst)]);
 
+	if (nulls[AttrNumberGetAttrOffset(Anum_compression_settings_toast_compression)])
+		fd->toast_compression = InvalidCompressionMethod;
+	else
+		fd->toast_compression = CompressionNameToMethod(TextDatumGetCString(
+			values[AttrNumberGetAttrOffset(Anum_compression_settings_toast_compression)]));
+
+	if (nulls[AttrNumberGetAttrOffset(Anum_compression_settings_batch_size)])
+		fd->batch_size = 0;
+	else
+		fd->batch_size =
+			DatumGetInt32(values[AttrNumberGetAttrOffset(Anum_compression_settings_batch_size)]);
+
+	if (nulls[AttrNumberGetAttrOffset(Anum_compression_settings_batch_target_size)])
+		fd->batch_target_size = 0;
+	else
+		fd->batch_target_size = DatumGetInt64(
+			values[AttrNumberGetAttrOffset(Anum_compression_settings_batch_target_size)]);
+
 	MemoryContextSwitchTo(old);
 
 	if (should_free)
@@ -293,6 +327,24 @@ compression_settings_formdata_make_tuple(const FormData_compression_settings *fd
 	else
 		nulls[AttrNumberGetAttrOffset(Anum_compression_settings_orderby_nullsfirst)] = true;
 
+	if (CompressionMethodIsValid(fd->toast_compression))
+		values[AttrNumberGetAttrOffset(Anum_compression_settings_toast_compression)] =
+			CStringGetTextDatum(GetCompressionMethodName(fd->toast_compression));
+	else
+		nulls[AttrNumberGetAttrOffset(Anum_compression_settings_toast_compression)] = true;
+
+	if (fd->batch_size > 0)
+		values[AttrNumberGetAttrOffset(Anum_compression_settings_batch_size)] =
+			Int32GetDatum(fd->batch_size);
+	else
+		nulls[AttrNumberGetAttrOffset(Anum_compression_settings_batch_size)] = true;
+
+	if (fd->batch_target_size > 0)
+		values[AttrNumberGetAttrOffset(Anum_compression_settings_batch_target_size)] =
+			Int64GetDatum(fd->batch_target_size);
+	else
+		nulls[AttrNumberGetAttrOffset(Anum_compression_settings_batch_target_size)] = true;
+
 	return heap_form_tuple(desc, values, nulls);
 }
 
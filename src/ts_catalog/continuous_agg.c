@@ -83,6 +83,18 @@ static const WithClauseDefinition continuous_aggregate_with_clause_def[] = {
 			.arg_names = {"compress_chunk_time_interval", NULL},
 			 .type_id = INTERVALOID,
 		},
+		[ContinuousViewOptionCompressToastCompression] = {
+			.arg_names = {"compress_toast_compression", NULL},
+			 .type_id = TEXTOID,
+		},
+		[ContinuousViewOptionCompressBatchSize] = {
+			.arg_names = {"compress_batch_size", NULL},
+			 .type_id = INT4OID,
+		},
+		[ContinuousViewOptionCompressBatchTargetSize] = {
+			.arg_names = {"compress_batch_target_size", NULL},
+			 .type_id = TEXTOID,
+		},
 };
 
 WithClauseResult *
@@ -115,6 +127,15 @@ ts_continuous_agg_get_compression_defelems(const WithClauseResult *with_clauses)
 			case CompressChunkTimeInterval:
 				option_index = ContinuousViewOptionCompressChunkTimeInterval;
 				break;
+			case CompressToastCompression:
+				option_index = ContinuousViewOptionCompressToastCompression;
+				break;
+			case CompressBatchSize:
+				option_index = ContinuousViewOptionCompressBatchSize;
+				break;
+			case CompressBatchTargetSize:
+				option_index = ContinuousViewOptionCompressBatchTargetSize;
+				break;
 			default:
 				elog(ERROR, "Unhandled compression option");
 				break;
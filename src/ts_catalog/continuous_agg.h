@@ -56,6 +56,9 @@ typedef enum ContinuousAggViewOption
 	ContinuousViewOptionCompressSegmentBy,
 	ContinuousViewOptionCompressOrderBy,
 	ContinuousViewOptionCompressChunkTimeInterval,
+	ContinuousViewOptionCompressToastCompression,
+	ContinuousViewOptionCompressBatchSize,
+	ContinuousViewOptionCompressBatchTargetSize,
 	ContinuousViewOptionMax
 } ContinuousAggViewOption;
 
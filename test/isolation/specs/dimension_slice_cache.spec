@@ -0,0 +1,53 @@
+# This file and its contents are licensed under the Apache License 2.0.
+# Please see the included NOTICE for copyright information and
+# LICENSE-APACHE for a copy of the license.
+
+###
+# Test that queries using the dimension slice cache see chunks created by
+# other sessions as soon as they are committed, also inside a transaction
+# that already used the cache, and chunks created by the same transaction.
+#
+# A transaction that already holds a lock on the hypertable does not process
+# invalidation messages when it plans the next query, so these tests depend
+# on the cache checking the slice version of each dimension on lookup.
+###
+
+setup
+{
+  CREATE TABLE slices(time timestamptz NOT NULL, device int, temp float);
+  SELECT FROM create_hypertable('slices', 'time', chunk_time_interval => interval '1 day');
+  SELECT FROM add_dimension('slices', 'device', number_partitions => 2);
+  INSERT INTO slices VALUES ('2017-01-20 09:00', 1, 23.4);
+}
+
+teardown { DROP TABLE slices; }
+
+session "s1"
+setup { SET timescaledb.enable_dimension_slice_cache TO on; }
+step "s1_begin" { BEGIN ISOLATION LEVEL READ COMMITTED; }
+step "s1_query" { SELECT count(*) FROM slices WHERE time > '2017-01-01'; }
+step "s1_query_device" { SELECT count(*) FROM slices WHERE device = 2 AND time > '2017-01-01'; }
+step "s1_insert" { INSERT INTO slices VALUES ('2017-01-22 09:00', 1, 0.72); }
+step "s1_commit" { COMMIT; }
+
+session "s2"
+step "s2_begin" { BEGIN; }
+step "s2_insert" { INSERT INTO slices VALUES ('2017-01-21 09:00', 2, 1.5); }
+step "s2_commit" { COMMIT; }
+step "s2_partitions" { SELECT FROM set_number_partitions('slices', 3); }
+
+# New chunk committed while s1 is in a transaction that used the cache
+permutation "s1_begin" "s1_query" "s2_insert" "s1_query" "s1_commit"
+
+# New chunk committed by an explicit transaction after s1 used the cache
+permutation "s1_begin" "s1_query" "s2_begin" "s2_insert" "s2_commit" "s1_query" "s1_commit"
+
+# New chunk is not visible until it is committed
+permutation "s1_query" "s2_begin" "s2_insert" "s1_query" "s2_commit" "s1_query"
+
+# New chunk created by the same transaction
+permutation "s1_begin" "s1_query" "s1_insert" "s1_query" "s1_commit" "s1_query"
+
+# New slices in the closed dimension after another session changed the
+# number of partitions
+permutation "s1_begin" "s1_query_device" "s2_partitions" "s2_insert" "s1_query_device" "s1_commit"
@@ -0,0 +1,61 @@
+-- This file and its contents are licensed under the Apache License 2.0.
+-- Please see the included NOTICE for copyright information and
+-- LICENSE-APACHE for a copy of the license.
+--
+-- Test that an ordered ChunkAppend with a LIMIT initializes its subplans
+-- when they are first used. The initialized subplans are shown with
+-- DEBUG1.
+--
+create table lazy(time timestamptz not null, hour int);
+select table_name from create_hypertable('lazy', 'time', chunk_time_interval => interval '1 day');
+-- Five chunks with 24 hours each
+insert into lazy
+select '2000-01-01 00:00+00'::timestamptz + h * interval '1 hour', h
+from generate_series(0, 119) h;
+analyze lazy;
+set enable_seqscan to off;
+
+-- Show the ChunkAppend node and its children of a query
+create function show_chunk_append(query text) returns setof text as $$
+declare
+    line text;
+begin
+    for line in execute 'explain (analyze, costs off, timing off, summary off) ' || query loop
+        if line ~ '(ChunkAppend|excluded|on _hyper)' then
+            return next regexp_replace(line, '^\s*(->\s*)?', '');
+        end if;
+    end loop;
+end
+$$ language plpgsql;
+
+set client_min_messages to debug1;
+-- Only the subplans that are read are initialized
+select hour from lazy order by time limit 3;
+select count(*), min(hour), max(hour) from (select hour from lazy order by time limit 30) l;
+select count(*), min(hour), max(hour) from (select hour from lazy order by time desc limit 30) l;
+
+-- Runtime exclusion and rescans skip the subplans that are not initialized
+-- and initialize the subplans on the first rescan that reads them
+select l.hour
+from (values ('2000-01-03 00:00+00'::timestamptz), ('2000-01-01 00:00+00'), ('2000-01-03 00:00+00')) g(start)
+cross join lateral (select hour from lazy where time >= g.start order by time limit 2) l;
+reset client_min_messages;
+
+-- EXPLAIN ANALYZE initializes all subplans, so it shows the subplans
+-- that are never executed
+select * from show_chunk_append($$select hour from lazy order by time limit 3$$);
+select * from show_chunk_append($$select l.hour
+from (values ('2000-01-03 00:00+00'::timestamptz), ('2000-01-01 00:00+00'), ('2000-01-03 00:00+00')) g(start)
+cross join lateral (select hour from lazy where time >= g.start order by time limit 2) l$$);
+
+-- Same results without ordered append
+set timescaledb.enable_ordered_append to off;
+select hour from lazy order by time limit 3;
+select l.hour
+from (values ('2000-01-03 00:00+00'::timestamptz), ('2000-01-01 00:00+00'), ('2000-01-03 00:00+00')) g(start)
+cross join lateral (select hour from lazy where time >= g.start order by time limit 2) l;
+reset timescaledb.enable_ordered_append;
+
+reset enable_seqscan;
+drop table lazy;
+drop function show_chunk_append;
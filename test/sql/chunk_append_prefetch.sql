@@ -0,0 +1,44 @@
+-- This file and its contents are licensed under the Apache License 2.0.
+-- Please see the included NOTICE for copyright information and
+-- LICENSE-APACHE for a copy of the license.
+--
+-- Test prefetching the first blocks of the next chunk in ChunkAppend.
+-- Only sequential scans are prefetched, and the prefetched relations are
+-- shown with DEBUG1.
+--
+create table prefetch(time timestamptz not null, value int);
+select table_name from create_hypertable('prefetch', 'time', chunk_time_interval => interval '1 day');
+insert into prefetch
+select '2000-01-01 00:00+00'::timestamptz + i * interval '12 hours', i
+from generate_series(0, 5) i;
+set effective_io_concurrency to 4;
+
+-- Sequential scans prefetch the next chunk when switching chunks
+set enable_indexscan to off;
+set enable_bitmapscan to off;
+explain (costs off) select value from prefetch where time < now();
+set client_min_messages to debug1;
+select value from prefetch where time < now();
+
+-- Nothing is prefetched with prefetching turned off
+set timescaledb.enable_chunk_append_prefetch to off;
+select value from prefetch where time < now();
+reset timescaledb.enable_chunk_append_prefetch;
+set effective_io_concurrency to 0;
+select value from prefetch where time < now();
+set effective_io_concurrency to 4;
+reset client_min_messages;
+reset enable_indexscan;
+reset enable_bitmapscan;
+
+-- Index scans do not start reading the index at the first block, so they
+-- are not prefetched
+set enable_seqscan to off;
+explain (costs off) select value from prefetch where time < now();
+set client_min_messages to debug1;
+select value from prefetch where time < now();
+reset client_min_messages;
+reset enable_seqscan;
+reset effective_io_concurrency;
+
+drop table prefetch;
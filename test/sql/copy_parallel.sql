@@ -0,0 +1,93 @@
+-- This file and its contents are licensed under the Apache License 2.0.
+-- Please see the included NOTICE for copyright information and
+-- LICENSE-APACHE for a copy of the license.
+--
+-- Test parsing the input of COPY FROM with parallel workers. The results have
+-- to be the same as with a serial COPY for the inputs that are parsed in
+-- parallel and for those that fall back to parsing in the backend.
+--
+set timescaledb.parallel_copy_workers = 2;
+
+create table uk_price_paid(price integer, "date" date, postcode1 text, postcode2 text, type smallint, is_new bool, duration smallint, addr1 text, addr2 text, street text, locality text, town text, district text, country text, category smallint);
+select table_name from create_hypertable('uk_price_paid', 'date', chunk_time_interval => interval '90 day');
+-- Serial COPY into a plain table for comparison
+create table uk_price_paid_serial(like uk_price_paid);
+\copy uk_price_paid_serial from program 'bash -c "zcat < data/prices-10k-random-1.tsv.gz"';
+\copy uk_price_paid from program 'bash -c "zcat < data/prices-10k-random-1.tsv.gz"';
+select count(*) from uk_price_paid;
+select count(*) from (
+    (select * from uk_price_paid except all select * from uk_price_paid_serial)
+    union all
+    (select * from uk_price_paid_serial except all select * from uk_price_paid)) t;
+-- Again into the existing chunks
+\copy uk_price_paid from program 'bash -c "zcat < data/prices-10k-random-1.tsv.gz"';
+select count(*) from (
+    select * from uk_price_paid
+    except all
+    (select * from uk_price_paid_serial union all select * from uk_price_paid_serial)) t;
+select count(*) from uk_price_paid;
+
+-- CSV with quoted fields, NULLs and newlines in quoted fields
+create table csv_data(time int not null, device int, note text, value float8);
+select table_name from create_hypertable('csv_data', 'time', chunk_time_interval => 10000);
+\copy csv_data from program 'seq 1 100000 | sed -e "/5$/s/.*/&,,QQ,/" -e "/,/!s/.*/&,1,QaQQ&QQ,b&Q,&.5/" -e "/^[0-9]*0,/s/,b/\n/" | tr Q \"' with (format csv);
+select count(*), count(device), count(note), sum(value), sum(length(note)) from csv_data;
+select time, device, replace(note, E'\n', '\n') as note, note is null as null_note, value
+from csv_data where time in (9, 10, 15) order by time;
+-- Errors report the line and column like a serial COPY, also with newlines
+-- in quoted fields before them
+\set VERBOSITY default
+\copy csv_data from program 'seq 1 100000 | sed -e "/5$/s/.*/&,,QQ,/" -e "/,/!s/.*/&,1,QaQQ&QQ,b&Q,&.5/" -e "/^[0-9]*0,/s/,b/\n/" -e "s/^70001,1,/70001,x,/" | tr Q \"' with (format csv);
+\copy csv_data from program 'seq 1 100000 | sed -e "/5$/s/.*/&,,QQ,/" -e "/,/!s/.*/&,1,QaQQ&QQ,b&Q,&.5/" -e "/^[0-9]*0,/s/,b/\n/" -e "s/^50001,.*/&,extra/" | tr Q \"' with (format csv);
+\set VERBOSITY terse
+select count(*), count(device), count(note), sum(value), sum(length(note)) from csv_data;
+
+-- Defaults of the columns that are not in the input
+create table defaults(time int not null, device int default 7, value float8 default 0.5, note text default 'x' || 'y');
+select table_name from create_hypertable('defaults', 'time', chunk_time_interval => 10000);
+\copy defaults(time) from program 'seq 1 100000';
+select count(*), sum(device), sum(value), min(note), max(note) from defaults;
+
+--
+-- The inputs below are parsed in the backend
+--
+-- An input that fits in a single block
+\copy defaults(time) from program 'seq 100001 100010';
+select count(*), sum(device), max(time) from defaults;
+-- FORCE_NULL
+truncate csv_data;
+\copy csv_data from program 'seq 1 100000 | sed -e "/5$/s/.*/&,,QQ,/" -e "/,/!s/.*/&,1,QaQQ&QQ,b&Q,&.5/" -e "/^[0-9]*0,/s/,b/\n/" | tr Q \"' with (format csv, force_null (note));
+select count(*), count(device), count(note), sum(value), sum(length(note)) from csv_data;
+select time, device, replace(note, E'\n', '\n') as note, note is null as null_note, value
+from csv_data where time in (9, 10, 15) order by time;
+-- Identity and serial columns, which get their values in input order
+create table ident(id bigint generated always as identity, seq serial, time int not null, value int);
+select table_name from create_hypertable('ident', 'time', chunk_time_interval => 10000);
+\copy ident(time, value) from program 'seq 1 100000 | sed -e "s/.*/&,&/"' with (format csv);
+select count(*), min(id), max(id), sum(value) from ident;
+select count(*) from ident where id <> time or seq <> time;
+-- BEFORE ROW triggers
+create table trig(time int not null, value int);
+select table_name from create_hypertable('trig', 'time', chunk_time_interval => 10000);
+create function double_value() returns trigger language plpgsql as $$
+begin
+    new.value := new.value * 2;
+    return new;
+end
+$$;
+create trigger double_value before insert on trig for each row execute function double_value();
+\copy trig from program 'seq 1 100000 | sed -e "s/.*/&,&/"' with (format csv);
+select count(*), sum(value) from trig;
+
+-- WHERE clauses, which are evaluated in the backend in parallel mode unless
+-- they are parallel unsafe
+create table filtered(time int not null, value int);
+select table_name from create_hypertable('filtered', 'time', chunk_time_interval => 10000);
+\copy filtered from program 'seq 1 100000 | sed -e "s/.*/&,&/"' with (format csv) where time % 3 = 0;
+select count(*), sum(value) from filtered;
+create function unsafe_filter(int) returns bool language sql parallel unsafe as 'select $1 % 3 = 0';
+truncate filtered;
+\copy filtered from program 'seq 1 100000 | sed -e "s/.*/&,&/"' with (format csv) where unsafe_filter(time);
+select count(*), sum(value) from filtered;
+
+reset timescaledb.parallel_copy_workers;
@@ -0,0 +1,128 @@
+-- This file and its contents are licensed under the Apache License 2.0.
+-- Please see the included NOTICE for copyright information and
+-- LICENSE-APACHE for a copy of the license.
+--
+-- Test chunk exclusion with the dimension slice cache. The cached
+-- slices should exclude the same chunks as a scan of the dimension
+-- slice catalog, also after chunks are created in the same session or
+-- transaction. See also the dimension_slice_cache isolation test for
+-- chunks created by other sessions.
+--
+create table dsc(time timestamptz not null, device int, temp float);
+select table_name from create_hypertable('dsc', 'time', 'device', 2, chunk_time_interval => interval '1 day');
+
+-- Count the rows matching a condition with and without the cache
+create function slice_counts(pred text, out cached bigint, out uncached bigint) as $$
+declare
+    saved text := current_setting('timescaledb.enable_dimension_slice_cache');
+begin
+    perform set_config('timescaledb.enable_dimension_slice_cache', 'on', true);
+    execute format('select count(*) from dsc where %s', pred) into cached;
+    perform set_config('timescaledb.enable_dimension_slice_cache', 'off', true);
+    execute format('select count(*) from dsc where %s', pred) into uncached;
+    perform set_config('timescaledb.enable_dimension_slice_cache', saved, true);
+end
+$$ language plpgsql;
+
+insert into dsc
+select t, d, 1.0
+from generate_series('2024-01-01'::timestamptz, '2024-01-10', '1 hour') t,
+     generate_series(1, 4) d;
+
+-- Conditions on the open and closed dimensions
+select p.pred, c.cached, c.cached = c.uncached as same
+from (values (1, $$time < '2024-01-03'$$),
+             (2, $$time <= '2024-01-03'$$),
+             (3, $$time = '2024-01-05 12:00'$$),
+             (4, $$time > '2024-01-09'$$),
+             (5, $$time >= '2024-01-09'$$),
+             (6, $$time between '2024-01-04' and '2024-01-06'$$),
+             (7, $$time < '2023-12-31'$$),
+             (8, $$time > '2024-01-11'$$),
+             (9, $$device = 1 and time > '2024-01-09'$$),
+             (10, $$device in (2, 3) and time < '2024-01-02'$$),
+             (11, $$device = 4$$)) p(id, pred),
+     slice_counts(p.pred) c
+order by p.id;
+
+-- New chunks created in the same session after the slices are cached
+insert into dsc
+select t, d, 1.0
+from generate_series('2024-01-15'::timestamptz, '2024-01-16', '1 hour') t,
+     generate_series(1, 4) d;
+select p.pred, c.cached, c.cached = c.uncached as same
+from (values (1, $$time > '2024-01-09'$$),
+             (2, $$time >= '2024-01-15'$$),
+             (3, $$device = 1 and time > '2024-01-15 12:00'$$)) p(id, pred),
+     slice_counts(p.pred) c
+order by p.id;
+
+-- New chunks created in the same transaction, which is rolled back
+begin;
+insert into dsc
+select t, d, 1.0
+from generate_series('2024-01-20'::timestamptz, '2024-01-20 23:00', '1 hour') t,
+     generate_series(1, 4) d;
+select p.pred, c.cached, c.cached = c.uncached as same
+from (values (1, $$time >= '2024-01-20'$$),
+             (2, $$time > '2024-01-09'$$)) p(id, pred),
+     slice_counts(p.pred) c
+order by p.id;
+rollback;
+select p.pred, c.cached, c.cached = c.uncached as same
+from (values (1, $$time >= '2024-01-20'$$),
+             (2, $$time > '2024-01-09'$$)) p(id, pred),
+     slice_counts(p.pred) c
+order by p.id;
+
+-- New chunks created in a subtransaction that is rolled back and in
+-- the same transaction after that
+begin;
+savepoint s1;
+insert into dsc
+select t, d, 1.0
+from generate_series('2024-01-21'::timestamptz, '2024-01-21 23:00', '1 hour') t,
+     generate_series(1, 4) d;
+select p.pred, c.cached, c.cached = c.uncached as same
+from (values (1, $$time >= '2024-01-21'$$)) p(id, pred),
+     slice_counts(p.pred) c
+order by p.id;
+rollback to savepoint s1;
+select p.pred, c.cached, c.cached = c.uncached as same
+from (values (1, $$time >= '2024-01-21'$$)) p(id, pred),
+     slice_counts(p.pred) c
+order by p.id;
+insert into dsc
+select t, d, 1.0
+from generate_series('2024-01-22'::timestamptz, '2024-01-22 23:00', '1 hour') t,
+     generate_series(1, 4) d;
+select p.pred, c.cached, c.cached = c.uncached as same
+from (values (1, $$time >= '2024-01-21'$$)) p(id, pred),
+     slice_counts(p.pred) c
+order by p.id;
+commit;
+select p.pred, c.cached, c.cached = c.uncached as same
+from (values (1, $$time >= '2024-01-21'$$)) p(id, pred),
+     slice_counts(p.pred) c
+order by p.id;
+
+-- Overlapping slices in the closed dimension after changing the
+-- number of partitions, and a time slice that is cut to fit between
+-- existing chunks after changing the chunk interval
+select set_number_partitions('dsc', 3);
+select set_chunk_time_interval('dsc', interval '7 days');
+insert into dsc
+select t, d, 1.0
+from generate_series('2024-01-11'::timestamptz, '2024-01-13 23:00', '1 hour') t,
+     generate_series(1, 4) d;
+select p.pred, c.cached, c.cached = c.uncached as same
+from (values (1, $$time > '2024-01-10' and time < '2024-01-14'$$),
+             (2, $$device = 1$$),
+             (3, $$device in (1, 2, 3, 4) and time >= '2024-01-10'$$),
+             (4, $$time < '2024-01-12'$$),
+             (5, $$device = 3 and time between '2024-01-13' and '2024-01-15'$$)) p(id, pred),
+     slice_counts(p.pred) c
+order by p.id;
+
+drop table dsc;
+drop function slice_counts;
@@ -0,0 +1,96 @@
+-- This file and its contents are licensed under the Apache License 2.0.
+-- Please see the included NOTICE for copyright information and
+-- LICENSE-APACHE for a copy of the license.
+--
+-- Test INSERTs that buffer the tuples per chunk and write them with
+-- multi-inserts
+--
+create table batched(time int not null, device int, value int);
+select table_name from create_hypertable('batched', 'time', chunk_time_interval => 10);
+
+-- AFTER ROW triggers are queued when the tuples of a chunk are written,
+-- so they fire grouped by chunk
+create function log_insert() returns trigger language plpgsql as $$
+begin
+    raise notice 'inserted %', new;
+    return null;
+end
+$$;
+create trigger log_insert after insert on batched for each row execute function log_insert();
+insert into batched values (1, 1, 1), (11, 2, 2), (2, 3, 3), (12, 4, 4);
+-- Without batching they fire in input order
+set timescaledb.enable_batched_insert to off;
+insert into batched values (3, 1, 1), (13, 2, 2), (4, 3, 3), (14, 4, 4);
+reset timescaledb.enable_batched_insert;
+
+-- A chunk insert state that is closed because too many chunks are open
+-- writes its tuples first, so with a single open chunk the tuples are
+-- written whenever the chunk changes
+set timescaledb.max_open_chunks_per_insert to 1;
+insert into batched values (5, 1, 1), (15, 2, 2), (6, 3, 3), (16, 4, 4), (25, 5, 5);
+reset timescaledb.max_open_chunks_per_insert;
+drop trigger log_insert on batched;
+select * from batched order by time;
+
+-- Flushing when the buffers are full, with more tuples than fit in the
+-- buffers and alternating between chunks
+truncate batched;
+insert into batched select i % 30, i, i from generate_series(1, 2500) i;
+select count(*), count(distinct device), sum(value) from batched;
+select tableoid::regclass, count(*) from batched group by 1 order by 1;
+
+-- Foreign keys are checked for the buffered tuples
+create table devices(id int primary key);
+insert into devices values (1), (2);
+create table fk_data(time int not null, device int references devices(id));
+select table_name from create_hypertable('fk_data', 'time', chunk_time_interval => 10);
+insert into fk_data values (1, 1), (11, 2), (2, 1);
+do $$
+begin
+    insert into fk_data values (3, 1), (13, 3), (4, 2);
+exception when foreign_key_violation then
+    raise notice 'foreign key violation';
+end
+$$;
+select * from fk_data order by time;
+
+-- Unique violations between tuples in the same batch and with existing
+-- tuples
+create table uniq(time int not null, value int);
+select table_name from create_hypertable('uniq', 'time', chunk_time_interval => 10);
+create unique index on uniq(time);
+insert into uniq values (1, 1), (11, 1);
+do $$
+begin
+    insert into uniq values (2, 2), (12, 2), (2, 3);
+exception when unique_violation then
+    raise notice 'unique violation';
+end
+$$;
+do $$
+begin
+    insert into uniq values (3, 2), (11, 2);
+exception when unique_violation then
+    raise notice 'unique violation';
+end
+$$;
+-- ON CONFLICT does not batch and sees the tuples inserted before
+insert into uniq values (2, 2), (12, 2), (2, 3) on conflict do nothing;
+select * from uniq order by time;
+
+-- INSERT in a writable CTE, which the main query does not see
+with ins as (
+    insert into uniq values (3, 3), (13, 3), (4, 4)
+)
+select count(*) from uniq;
+with ins as (
+    insert into uniq values (5, 5), (15, 5) returning time
+)
+select count(*) from ins;
+select * from uniq order by time;
+
+drop table batched;
+drop table fk_data;
+drop table devices;
+drop table uniq;
+drop function log_insert;
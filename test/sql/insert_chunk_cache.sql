@@ -0,0 +1,49 @@
+-- This file and its contents are licensed under the Apache License 2.0.
+-- Please see the included NOTICE for copyright information and
+-- LICENSE-APACHE for a copy of the license.
+--
+-- Test the chunk caches used when routing inserted tuples to chunks, their
+-- statistics are shown by the chunk_cache_stats option of EXPLAIN ANALYZE
+--
+create table cached(time int not null, device int, value int);
+select table_name from create_hypertable('cached', 'time', chunk_time_interval => 10);
+insert into cached values (1, 1, 1), (11, 1, 1), (21, 1, 1);
+
+-- Reconnect to start with an empty chunk cache
+\c :TEST_DBNAME :ROLE_SUPERUSER
+set timescaledb.max_open_chunks_per_insert = 2;
+-- The chunk insert states are evicted in LRU order: the chunk of time 20
+-- evicts the chunk of time 10, since the chunk of time 0 was used after it,
+-- so only the chunk of time 10 has to be looked up again
+explain (analyze, costs off, timing off, summary off, chunk_cache_stats)
+insert into cached values (2, 1, 1), (12, 1, 1), (3, 1, 1), (22, 1, 1), (4, 1, 1), (13, 1, 1);
+-- The chunk cache of the hypertable is kept between statements
+explain (analyze, costs off, timing off, summary off, chunk_cache_stats)
+insert into cached values (5, 1, 1), (14, 1, 1), (6, 1, 1), (23, 1, 1), (7, 1, 1), (15, 1, 1);
+reset timescaledb.max_open_chunks_per_insert;
+explain (analyze, costs off, timing off, summary off, chunk_cache_stats)
+insert into cached values (8, 1, 1), (16, 1, 1), (9, 1, 1), (24, 1, 1), (9, 2, 2), (17, 1, 1);
+-- Without the option the statistics are not shown
+explain (analyze, costs off, timing off, summary off)
+insert into cached values (9, 3, 3);
+
+-- Changing the number of partitions gives new chunks space slices that
+-- overlap with the slices of the existing chunks
+create table space(time int not null, device int, value int);
+select table_name from create_hypertable('space', 'time', chunk_time_interval => 10);
+select column_name from add_dimension('space', 'device', number_partitions => 2);
+insert into space select 1, d, d from generate_series(1, 6) d;
+select set_number_partitions('space', 3);
+insert into space select 11, d, d from generate_series(1, 6) d;
+
+\c :TEST_DBNAME :ROLE_SUPERUSER
+-- The slices of both chunks of the device are in the cache, and each
+-- tuple is routed to the chunk of its own time slice
+explain (analyze, costs off, timing off, summary off, chunk_cache_stats)
+insert into space values (2, 1, 1), (12, 1, 1), (3, 1, 1), (13, 1, 1);
+insert into space select t, d, d from generate_series(4, 19) t, generate_series(1, 6) d;
+-- All tuples of a device and time slice are in the same chunk
+select time / 10 as slice, device, count(distinct tableoid) as chunks, count(*)
+from space
+group by 1, 2
+order by 1, 2;
@@ -0,0 +1,483 @@
+/*
+ * This file and its contents are licensed under the Timescale License.
+ * Please see the included NOTICE for copyright information and
+ * LICENSE-TIMESCALE for a copy of the license.
+ */
+
+#include "bool_compress.h"
+
+#include <catalog/pg_type.h>
+#include <libpq/pqformat.h>
+#include <port/pg_bitutils.h>
+#include <utils/builtins.h>
+
+#include "compression/arrow_c_data_interface.h"
+#include "compression/compression.h"
+#include "simple8b_rle.h"
+#include "simple8b_rle_bitmap.h"
+
+typedef struct BoolCompressed
+{
+	CompressedDataHeaderFields;
+	uint8 has_nulls; /* 1 if this has a NULLs bitmap after the values, 0 otherwise */
+	uint8 padding[2];
+	char values[FLEXIBLE_ARRAY_MEMBER];
+} BoolCompressed;
+
+static void
+pg_attribute_unused() assertions(void)
+{
+	BoolCompressed test_val = { .vl_len_ = { 0 } };
+	/* make sure no padding bytes make it to disk */
+	StaticAssertStmt(sizeof(BoolCompressed) ==
+						 sizeof(test_val.vl_len_) + sizeof(test_val.compression_algorithm) +
+							 sizeof(test_val.has_nulls) + sizeof(test_val.padding),
+					 "BoolCompressed wrong size");
+	StaticAssertStmt(sizeof(BoolCompressed) == 8, "BoolCompressed wrong size");
+}
+
+typedef struct BoolDecompressionIterator
+{
+	DecompressionIterator base;
+	Simple8bRleDecompressionIterator values;
+	Simple8bRleDecompressionIterator nulls;
+	bool has_nulls;
+} BoolDecompressionIterator;
+
+typedef struct BoolCompressor
+{
+	Simple8bRleCompressor values;
+	Simple8bRleCompressor nulls;
+	bool has_nulls;
+	bool has_values;
+	/*
+	 * The value we repeat for the null rows, so that they extend the current
+	 * RLE run instead of breaking it.
+	 */
+	bool last_value;
+} BoolCompressor;
+
+typedef struct ExtendedCompressor
+{
+	Compressor base;
+	BoolCompressor *internal;
+} ExtendedCompressor;
+
+bool
+bool_compressed_has_nulls(const CompressedDataHeader *header)
+{
+	const BoolCompressed *bc = (const BoolCompressed *) header;
+	return bc->has_nulls;
+}
+
+static void
+bool_compressor_append_bool(Compressor *compressor, Datum val)
+{
+	ExtendedCompressor *extended = (ExtendedCompressor *) compressor;
+	if (extended->internal == NULL)
+		extended->internal = bool_compressor_alloc();
+
+	bool_compressor_append_value(extended->internal, DatumGetBool(val));
+}
+
+static void
+bool_compressor_append_null_value(Compressor *compressor)
+{
+	ExtendedCompressor *extended = (ExtendedCompressor *) compressor;
+	if (extended->internal == NULL)
+		extended->internal = bool_compressor_alloc();
+
+	bool_compressor_append_null(extended->internal);
+}
+
+static void *
+bool_compressor_finish_and_reset(Compressor *compressor)
+{
+	ExtendedCompressor *extended = (ExtendedCompressor *) compressor;
+	void *compressed = bool_compressor_finish(extended->internal);
+	pfree(extended->internal);
+	extended->internal = NULL;
+	return compressed;
+}
+
+const Compressor bool_compressor = {
+	.append_val = bool_compressor_append_bool,
+	.append_null = bool_compressor_append_null_value,
+	.finish = bool_compressor_finish_and_reset,
+};
+
+Compressor *
+bool_compressor_for_type(Oid element_type)
+{
+	ExtendedCompressor *compressor = palloc(sizeof(*compressor));
+	switch (element_type)
+	{
+		case BOOLOID:
+			*compressor = (ExtendedCompressor){ .base = bool_compressor };
+			return &compressor->base;
+		default:
+			elog(ERROR, "invalid type for bool compressor \"%s\"", format_type_be(element_type));
+	}
+
+	pg_unreachable();
+}
+
+BoolCompressor *
+bool_compressor_alloc(void)
+{
+	BoolCompressor *compressor = palloc0(sizeof(*compressor));
+	simple8brle_compressor_init(&compressor->values);
+	simple8brle_compressor_init(&compressor->nulls);
+	return compressor;
+}
+
+void
+bool_compressor_append_null(BoolCompressor *compressor)
+{
+	compressor->has_nulls = true;
+	simple8brle_compressor_append(&compressor->values, compressor->last_value);
+	simple8brle_compressor_append(&compressor->nulls, 1);
+}
+
+void
+bool_compressor_append_value(BoolCompressor *compressor, bool next_val)
+{
+	compressor->has_values = true;
+	compressor->last_value = next_val;
+	simple8brle_compressor_append(&compressor->values, next_val);
+	simple8brle_compressor_append(&compressor->nulls, 0);
+}
+
+static BoolCompressed *
+bool_compressed_from_parts(Simple8bRleSerialized *values, Simple8bRleSerialized *nulls)
+{
+	uint32 nulls_size = 0;
+	Size compressed_size;
+	char *compressed_data;
+	BoolCompressed *compressed;
+
+	if (nulls != NULL)
+		nulls_size = simple8brle_serialized_total_size(nulls);
+
+	compressed_size = sizeof(BoolCompressed) + simple8brle_serialized_total_size(values) + nulls_size;
+
+	if (!AllocSizeIsValid(compressed_size))
+		ereport(ERROR,
+				(errcode(ERRCODE_PROGRAM_LIMIT_EXCEEDED),
+				 errmsg("compressed size exceeds the maximum allowed (%d)", (int) MaxAllocSize)));
+
+	compressed_data = palloc0(compressed_size);
+	compressed = (BoolCompressed *) compressed_data;
+	SET_VARSIZE(&compressed->vl_len_, compressed_size);
+
+	compressed->compression_algorithm = COMPRESSION_ALGORITHM_BOOL;
+	compressed->has_nulls = nulls_size != 0 ? 1 : 0;
+
+	compressed_data += sizeof(*compressed);
+	compressed_data =
+		bytes_serialize_simple8b_and_advance(compressed_data,
+											 simple8brle_serialized_total_size(values),
+											 values);
+
+	if (compressed->has_nulls == 1 && nulls != NULL)
+	{
+		/* Unlike the other algorithms, we store the values for the null rows as well. */
+		CheckCompressedData(nulls->num_elements == values->num_elements);
+		bytes_serialize_simple8b_and_advance(compressed_data, nulls_size, nulls);
+	}
+
+	return compressed;
+}
+
+void *
+bool_compressor_finish(BoolCompressor *compressor)
+{
+	if (compressor == NULL || !compressor->has_values)
+	{
+		/* All values are null, the compressed column is stored as null. */
+		return NULL;
+	}
+
+	Simple8bRleSerialized *values = simple8brle_compressor_finish(&compressor->values);
+	Simple8bRleSerialized *nulls = simple8brle_compressor_finish(&compressor->nulls);
+
+	Assert(values != NULL);
+
+	BoolCompressed *compressed =
+		bool_compressed_from_parts(values, compressor->has_nulls ? nulls : NULL);
+
+	Assert(compressed->compression_algorithm == COMPRESSION_ALGORITHM_BOOL);
+	return compressed;
+}
+
+/**********************************************************************************/
+/**********************************************************************************/
+
+static void
+bool_decompression_iterator_init(BoolDecompressionIterator *iter, void *compressed,
+								 Oid element_type, bool forward)
+{
+	StringInfoData si = { .data = compressed, .len = VARSIZE(compressed) };
+	BoolCompressed *header = consumeCompressedData(&si, sizeof(BoolCompressed));
+	Simple8bRleSerialized *values = bytes_deserialize_simple8b_and_advance(&si);
+
+	const bool has_nulls = header->has_nulls == 1;
+
+	CheckCompressedData(header->has_nulls == 0 || header->has_nulls == 1);
+	Assert(element_type == BOOLOID);
+
+	*iter = (BoolDecompressionIterator){
+		.base = {
+			.compression_algorithm = COMPRESSION_ALGORITHM_BOOL,
+			.forward = forward,
+			.element_type = element_type,
+			.try_next = forward ? bool_decompression_iterator_try_next_forward :
+								  bool_decompression_iterator_try_next_reverse,
+		},
+		.has_nulls = has_nulls,
+	};
+
+	if (forward)
+		simple8brle_decompression_iterator_init_forward(&iter->values, values);
+	else
+		simple8brle_decompression_iterator_init_reverse(&iter->values, values);
+
+	if (has_nulls)
+	{
+		Simple8bRleSerialized *nulls = bytes_deserialize_simple8b_and_advance(&si);
+		CheckCompressedData(nulls->num_elements == values->num_elements);
+
+		if (forward)
+			simple8brle_decompression_iterator_init_forward(&iter->nulls, nulls);
+		else
+			simple8brle_decompression_iterator_init_reverse(&iter->nulls, nulls);
+	}
+}
+
+DecompressionIterator *
+bool_decompression_iterator_from_datum_forward(Datum bool_compressed, Oid element_type)
+{
+	BoolDecompressionIterator *iterator = palloc(sizeof(*iterator));
+	bool_decompression_iterator_init(iterator,
+									 (void *) PG_DETOAST_DATUM(bool_compressed),
+									 element_type,
+									 /* forward = */ true);
+	return &iterator->base;
+}
+
+DecompressionIterator *
+bool_decompression_iterator_from_datum_reverse(Datum bool_compressed, Oid element_type)
+{
+	BoolDecompressionIterator *iterator = palloc(sizeof(*iterator));
+	bool_decompression_iterator_init(iterator,
+									 (void *) PG_DETOAST_DATUM(bool_compressed),
+									 element_type,
+									 /* forward = */ false);
+	return &iterator->base;
+}
+
+/*
+ * The values and the nulls have the same number of elements, so we advance
+ * them in lockstep in both directions.
+ */
+static pg_attribute_always_inline DecompressResult
+bool_decompression_iterator_try_next(BoolDecompressionIterator *iter, bool forward)
+{
+	Simple8bRleDecompressResult value =
+		forward ? simple8brle_decompression_iterator_try_next_forward(&iter->values) :
+				  simple8brle_decompression_iterator_try_next_reverse(&iter->values);
+
+	if (value.is_done)
+		return (DecompressResult){
+			.is_done = true,
+		};
+
+	if (iter->has_nulls)
+	{
+		Simple8bRleDecompressResult null =
+			forward ? simple8brle_decompression_iterator_try_next_forward(&iter->nulls) :
+					  simple8brle_decompression_iterator_try_next_reverse(&iter->nulls);
+
+		CheckCompressedData(!null.is_done);
+
+		if (null.val != 0)
+		{
+			CheckCompressedData(null.val == 1);
+			return (DecompressResult){
+				.is_null = true,
+			};
+		}
+	}
+
+	CheckCompressedData(value.val == 0 || value.val == 1);
+	return (DecompressResult){
+		.val = BoolGetDatum(value.val != 0),
+	};
+}
+
+DecompressResult
+bool_decompression_iterator_try_next_forward(DecompressionIterator *iter)
+{
+	Assert(iter->compression_algorithm == COMPRESSION_ALGORITHM_BOOL && iter->forward);
+	return bool_decompression_iterator_try_next((BoolDecompressionIterator *) iter,
+												/* forward = */ true);
+}
+
+DecompressResult
+bool_decompression_iterator_try_next_reverse(DecompressionIterator *iter)
+{
+	Assert(iter->compression_algorithm == COMPRESSION_ALGORITHM_BOOL && !iter->forward);
+	return bool_decompression_iterator_try_next((BoolDecompressionIterator *) iter,
+												/* forward = */ false);
+}
+
+/*
+ * Build the Arrow bool array. The values are a bitmap like the validity bitmap,
+ * and the values of the null rows are unspecified.
+ */
+static ArrowArray *
+make_bool_arrow_array(uint64 *values, uint64 *validity, int n_total, int null_count,
+					  MemoryContext dest_mctx)
+{
+	ArrowArray *result = MemoryContextAllocZero(dest_mctx, sizeof(ArrowArray) + sizeof(void *) * 2);
+	const void **buffers = (const void **) &result[1];
+	buffers[0] = null_count > 0 ? validity : NULL;
+	buffers[1] = values;
+	result->n_buffers = 2;
+	result->buffers = buffers;
+	result->length = n_total;
+	result->null_count = null_count;
+	return result;
+}
+
+ArrowArray *
+bool_decompress_all(Datum compressed, Oid element_type, MemoryContext dest_mctx)
+{
+	Assert(element_type == BOOLOID);
+
+	void *detoasted = PG_DETOAST_DATUM(compressed);
+	StringInfoData si = { .data = detoasted, .len = VARSIZE(detoasted) };
+	BoolCompressed *header = consumeCompressedData(&si, sizeof(BoolCompressed));
+	Simple8bRleSerialized *values_serialized = bytes_deserialize_simple8b_and_advance(&si);
+
+	CheckCompressedData(header->has_nulls == 0 || header->has_nulls == 1);
+
+	const int n_total = values_serialized->num_elements;
+	uint64 *values = simple8brle_bitmap_decompress_words(values_serialized, dest_mctx);
+
+	if (!header->has_nulls)
+	{
+		return make_bool_arrow_array(values, NULL, n_total, 0, dest_mctx);
+	}
+
+	Simple8bRleSerialized *nulls_serialized = bytes_deserialize_simple8b_and_advance(&si);
+	CheckCompressedData(nulls_serialized->num_elements == (uint32) n_total);
+
+	/*
+	 * The nulls bitmap has ones for the null rows, so the validity bitmap is
+	 * its inversion, with the tail bits zeroed out.
+	 */
+	uint64 *validity = simple8brle_bitmap_decompress_words(nulls_serialized, dest_mctx);
+	const int n_words = (n_total + 63) / 64;
+	int null_count = 0;
+	for (int i = 0; i < n_words; i++)
+	{
+		null_count += pg_popcount64(validity[i]);
+		validity[i] = ~validity[i];
+	}
+
+	if (n_total % 64)
+	{
+		const uint64 tail_mask = ~0ULL >> (64 - n_total % 64);
+		validity[n_total / 64] &= tail_mask;
+	}
+
+	return make_bool_arrow_array(values, validity, n_total, null_count, dest_mctx);
+}
+
+/*
+ * Bulk decompression of bool columns that were compressed with some other
+ * algorithm, e.g. before the bool compression was introduced. We still produce
+ * the bit-packed bool Arrow array, so that the bool columns can be used in the
+ * vectorized filters regardless of how they were compressed.
+ */
+ArrowArray *
+bool_decompress_all_generic(Datum compressed, Oid element_type, MemoryContext dest_mctx)
+{
+	Assert(element_type == BOOLOID);
+
+	const CompressedDataHeader *header = (const CompressedDataHeader *) PG_DETOAST_DATUM(compressed);
+	DecompressionIterator *iter =
+		tsl_get_decompression_iterator_init(header->compression_algorithm,
+											/* reverse = */ false)(PointerGetDatum(header),
+																	element_type);
+
+	const int n_words = GLOBAL_MAX_ROWS_PER_COMPRESSION / 64 + 1;
+	uint64 *restrict values = MemoryContextAllocZero(dest_mctx, sizeof(uint64) * n_words);
+	uint64 *restrict validity = MemoryContextAllocZero(dest_mctx, sizeof(uint64) * n_words);
+
+	int n_total = 0;
+	int null_count = 0;
+	for (DecompressResult r = iter->try_next(iter); !r.is_done; r = iter->try_next(iter))
+	{
+		CheckCompressedData(n_total < GLOBAL_MAX_ROWS_PER_COMPRESSION);
+
+		if (r.is_null)
+		{
+			null_count++;
+		}
+		else
+		{
+			arrow_set_row_validity(validity, n_total, true);
+			arrow_set_row_validity(values, n_total, DatumGetBool(r.val));
+		}
+
+		n_total++;
+	}
+
+	/* The validity bitmap is not used without nulls, don't keep it around. */
+	if (null_count == 0)
+	{
+		pfree(validity);
+		validity = NULL;
+	}
+
+	return make_bool_arrow_array(values, validity, n_total, null_count, dest_mctx);
+}
+
+/**********************************************************************************/
+/**********************************************************************************/
+
+void
+bool_compressed_send(CompressedDataHeader *header, StringInfo buffer)
+{
+	const BoolCompressed *data = (BoolCompressed *) header;
+	Assert(header->compression_algorithm == COMPRESSION_ALGORITHM_BOOL);
+	pq_sendbyte(buffer, data->has_nulls);
+	simple8brle_serialized_send(buffer, (Simple8bRleSerialized *) data->values);
+	if (data->has_nulls)
+	{
+		Simple8bRleSerialized *nulls =
+			(Simple8bRleSerialized *) (((char *) data->values) +
+									   simple8brle_serialized_total_size(
+										   (Simple8bRleSerialized *) data->values));
+		simple8brle_serialized_send(buffer, nulls);
+	}
+}
+
+Datum
+bool_compressed_recv(StringInfo buffer)
+{
+	uint8 has_nulls;
+	Simple8bRleSerialized *values;
+	Simple8bRleSerialized *nulls = NULL;
+
+	has_nulls = pq_getmsgbyte(buffer);
+	CheckCompressedData(has_nulls == 0 || has_nulls == 1);
+
+	values = simple8brle_serialized_recv(buffer);
+	if (has_nulls)
+		nulls = simple8brle_serialized_recv(buffer);
+
+	PG_RETURN_POINTER(bool_compressed_from_parts(values, nulls));
+}
@@ -0,0 +1,61 @@
+/*
+ * This file and its contents are licensed under the Timescale License.
+ * Please see the included NOTICE for copyright information and
+ * LICENSE-TIMESCALE for a copy of the license.
+ */
+#pragma once
+
+/*
+ * The bool compression stores the values as a simple8b_rle-compressed bitmap,
+ * which is bit-packed for the mixed stretches of values and RLE-encoded for the
+ * long stretches of the same value. The values are stored for every row,
+ * including the null ones, so that the bulk decompression doesn't have to move
+ * the values around to account for nulls. The nulls are stored in a separate
+ * bitmap, like for the other algorithms.
+ *
+ * The bulk decompression produces an Arrow bool array, i.e. the values are a
+ * bit-packed bitmap, not an array of bytes. This allows to use the values as a
+ * vectorized filter result directly.
+ */
+
+#include <postgres.h>
+#include <fmgr.h>
+#include <lib/stringinfo.h>
+
+#include "compression/compression.h"
+
+typedef struct BoolCompressor BoolCompressor;
+typedef struct BoolCompressed BoolCompressed;
+typedef struct BoolDecompressionIterator BoolDecompressionIterator;
+
+extern bool bool_compressed_has_nulls(const CompressedDataHeader *header);
+extern Compressor *bool_compressor_for_type(Oid element_type);
+extern BoolCompressor *bool_compressor_alloc(void);
+extern void bool_compressor_append_null(BoolCompressor *compressor);
+extern void bool_compressor_append_value(BoolCompressor *compressor, bool next_val);
+extern void *bool_compressor_finish(BoolCompressor *compressor);
+
+extern DecompressionIterator *bool_decompression_iterator_from_datum_forward(Datum bool_compressed,
+																			 Oid element_type);
+extern DecompressionIterator *bool_decompression_iterator_from_datum_reverse(Datum bool_compressed,
+																			 Oid element_type);
+extern DecompressResult bool_decompression_iterator_try_next_forward(DecompressionIterator *iter);
+extern DecompressResult bool_decompression_iterator_try_next_reverse(DecompressionIterator *iter);
+
+extern ArrowArray *bool_decompress_all(Datum compressed, Oid element_type, MemoryContext dest_mctx);
+extern ArrowArray *bool_decompress_all_generic(Datum compressed, Oid element_type,
+											   MemoryContext dest_mctx);
+
+extern void bool_compressed_send(CompressedDataHeader *header, StringInfo buffer);
+extern Datum bool_compressed_recv(StringInfo buf);
+
+#define BOOL_ALGORITHM_DEFINITION                                                                  \
+	{                                                                                              \
+		.iterator_init_forward = bool_decompression_iterator_from_datum_forward,                   \
+		.iterator_init_reverse = bool_decompression_iterator_from_datum_reverse,                   \
+		.decompress_all = bool_decompress_all,                                                     \
+		.compressed_data_send = bool_compressed_send,                                              \
+		.compressed_data_recv = bool_compressed_recv,                                              \
+		.compressor_for_type = bool_compressor_for_type,                                           \
+		.compressed_data_storage = TOAST_STORAGE_EXTERNAL,                                         \
+	}
@@ -904,6 +904,10 @@ unpack_leading_zeros_array(BitArray *bitarray, uint32 *_n)
 #include "simple8b_rle_decompress_all.h"
 #undef ELEMENT_TYPE
 
+#define ELEMENT_TYPE uint16
+#include "gorilla_impl.c"
+#undef ELEMENT_TYPE
+
 #define ELEMENT_TYPE uint32
 #include "gorilla_impl.c"
 #undef ELEMENT_TYPE
@@ -918,12 +922,20 @@ gorilla_decompress_all(Datum datum, Oid element_type, MemoryContext dest_mctx)
 	CompressedGorillaData gorilla_data;
 	compressed_gorilla_data_init_from_datum(&gorilla_data, datum);
 
+	/*
+	 * The integers are compressed as their unsigned bit patterns of the same
+	 * width, so we can decompress them the same way as the floats.
+	 */
 	switch (element_type)
 	{
 		case FLOAT8OID:
+		case INT8OID:
 			return gorilla_decompress_all_uint64(&gorilla_data, dest_mctx);
 		case FLOAT4OID:
+		case INT4OID:
 			return gorilla_decompress_all_uint32(&gorilla_data, dest_mctx);
+		case INT2OID:
+			return gorilla_decompress_all_uint16(&gorilla_data, dest_mctx);
 		default:
 			elog(ERROR,
 				 "type '%s' is not supported for gorilla decompression",
@@ -359,3 +359,118 @@ simple8brle_bitmap_decompress(Simple8bRleSerialized *compressed)
 
 	return result;
 }
+
+/*
+ * Set the bits [start, start + n) in the Arrow-style bitmap.
+ */
+pg_attribute_always_inline static void
+simple8brle_bitmap_words_set_range(uint64 *restrict words, uint32 start, uint32 n)
+{
+	const uint32 end = start + n;
+	while (start < end)
+	{
+		const uint32 bit = start % 64;
+		const uint32 span = Min(64 - bit, end - start);
+		const uint64 mask = (span == 64 ? ~0ULL : ((1ULL << span) - 1)) << bit;
+		words[start / 64] |= mask;
+		start += span;
+	}
+}
+
+/*
+ * Decompress the bitmap directly into the Arrow bit-packed layout, i.e. the
+ * element i is the bit i % 64 of the uint64 word i / 64. This is the layout of
+ * the Arrow bool arrays and of the vectorized filter results, so the result
+ * can be used as a filter directly. The bits past the last element are zero.
+ *
+ * The bit-packed blocks are copied as whole words, and the RLE blocks are
+ * filled as bit ranges, so this is much cheaper than decompressing into bools.
+ */
+static uint64 *simple8brle_bitmap_decompress_words(Simple8bRleSerialized *compressed,
+												   MemoryContext dest_mctx) pg_attribute_unused();
+
+static uint64 *
+simple8brle_bitmap_decompress_words(Simple8bRleSerialized *compressed, MemoryContext dest_mctx)
+{
+	CheckCompressedData(compressed->num_elements <= GLOBAL_MAX_ROWS_PER_COMPRESSION);
+	CheckCompressedData(compressed->num_blocks <= GLOBAL_MAX_ROWS_PER_COMPRESSION);
+
+	const uint32 num_elements = compressed->num_elements;
+
+	const uint32 num_selector_slots =
+		simple8brle_num_selector_slots_for_num_blocks(compressed->num_blocks);
+	const uint64 *compressed_data = compressed->slots + num_selector_slots;
+	const uint32 num_blocks = compressed->num_blocks;
+
+	/*
+	 * A bit-packed block that doesn't start at a word boundary spills into the
+	 * next word, so we need one more word of padding on the right.
+	 */
+	const uint32 num_words = (num_elements + 63) / 64 + 1;
+	uint64 *restrict words = MemoryContextAllocZero(dest_mctx, sizeof(uint64) * num_words);
+
+	uint32 decompressed_index = 0;
+	for (uint32 block_index = 0; block_index < num_blocks; block_index++)
+	{
+		const uint32 selector_slot = block_index / SIMPLE8B_SELECTORS_PER_SELECTOR_SLOT;
+		const uint32 selector_pos_in_slot = block_index % SIMPLE8B_SELECTORS_PER_SELECTOR_SLOT;
+		const uint64 slot_value = compressed->slots[selector_slot];
+		const uint8 selector_shift = selector_pos_in_slot * SIMPLE8B_BITS_PER_SELECTOR;
+		const uint64 selector_mask = 0xFULL << selector_shift;
+		const uint8 selector_value = (slot_value & selector_mask) >> selector_shift;
+		Assert(selector_value < 16);
+
+		uint64 block_data = compressed_data[block_index];
+
+		if (simple8brle_selector_is_rle(selector_value))
+		{
+			/*
+			 * RLE block.
+			 */
+			const uint32 n_block_values = simple8brle_rledata_repeatcount(block_data);
+			CheckCompressedData(n_block_values <= GLOBAL_MAX_ROWS_PER_COMPRESSION);
+			CheckCompressedData(decompressed_index + n_block_values <= num_elements);
+
+			/*
+			 * Explicitly truncate the value to 0/1, we might get an incorrect
+			 * value from the corrupt data.
+			 */
+			if (simple8brle_rledata_value(block_data) & 1)
+			{
+				simple8brle_bitmap_words_set_range(words, decompressed_index, n_block_values);
+			}
+
+			decompressed_index += n_block_values;
+		}
+		else
+		{
+			/*
+			 * Bit-packed block. Since this is a bitmap, this block has 64 bits
+			 * packed, but the last block might contain less elements.
+			 */
+			CheckCompressedData(selector_value == 1);
+			Assert(SIMPLE8B_BIT_LENGTH[selector_value] == 1);
+			Assert(SIMPLE8B_NUM_ELEMENTS[selector_value] == 64);
+
+			CheckCompressedData(decompressed_index < num_elements);
+
+			/* Zero out the unused bits, so that they don't leak into the result. */
+			const uint32 elements_this_block = Min(64, num_elements - decompressed_index);
+			block_data &= (~0ULL) >> (64 - elements_this_block);
+
+			const uint32 word = decompressed_index / 64;
+			const uint32 bit = decompressed_index % 64;
+			words[word] |= block_data << bit;
+			if (bit != 0)
+			{
+				words[word + 1] |= block_data >> (64 - bit);
+			}
+
+			decompressed_index += elements_this_block;
+		}
+	}
+
+	CheckCompressedData(decompressed_index == num_elements);
+
+	return words;
+}
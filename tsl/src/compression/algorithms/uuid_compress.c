@@ -0,0 +1,638 @@
+/*
+ * This file and its contents are licensed under the Timescale License.
+ * Please see the included NOTICE for copyright information and
+ * LICENSE-TIMESCALE for a copy of the license.
+ */
+
+#include "uuid_compress.h"
+
+#include <catalog/pg_type.h>
+#include <libpq/pqformat.h>
+#include <utils/builtins.h>
+#include <utils/uuid.h>
+
+#include "compression/arrow_c_data_interface.h"
+#include "compression/compression.h"
+#include "deltadelta.h"
+#include "simple8b_rle.h"
+#include "simple8b_rle_bitmap.h"
+
+/*
+ * All non-null UUIDs are v7, and are stored decomposed: the delta-delta
+ * compressed timestamps, then the bytes 8-15 as uint64, then the bytes 6-7
+ * (version and rand_a) as uint16.
+ */
+#define UUID_LAYOUT_V7 1
+
+/* The non-null UUIDs are stored as is. */
+#define UUID_LAYOUT_PLAIN 2
+
+/* The parts of the compressed data are aligned to this boundary. */
+#define UUID_PART_ALIGN 8
+
+typedef struct UuidCompressed
+{
+	CompressedDataHeaderFields;
+	uint8 has_nulls; /* 1 if this has a NULLs bitmap after the values, 0 otherwise */
+	uint8 layout;	 /* UUID_LAYOUT_V7 or UUID_LAYOUT_PLAIN */
+	uint8 padding;
+	uint32 num_values; /* number of non-null values */
+	uint32 padding2;
+	char data[FLEXIBLE_ARRAY_MEMBER];
+} UuidCompressed;
+
+static void
+pg_attribute_unused() assertions(void)
+{
+	UuidCompressed test_val = { .vl_len_ = { 0 } };
+	/* make sure no padding bytes make it to disk */
+	StaticAssertStmt(sizeof(UuidCompressed) ==
+						 sizeof(test_val.vl_len_) + sizeof(test_val.compression_algorithm) +
+							 sizeof(test_val.has_nulls) + sizeof(test_val.layout) +
+							 sizeof(test_val.padding) + sizeof(test_val.num_values) +
+							 sizeof(test_val.padding2),
+					 "UuidCompressed wrong size");
+	StaticAssertStmt(sizeof(UuidCompressed) == 16, "UuidCompressed wrong size");
+	StaticAssertStmt(sizeof(pg_uuid_t) == UUID_LEN, "pg_uuid_t wrong size");
+}
+
+typedef struct UuidCompressor
+{
+	pg_uuid_t *values;
+	uint32 num_values;
+	uint32 capacity;
+	Simple8bRleCompressor nulls;
+	bool has_nulls;
+	bool all_v7;
+} UuidCompressor;
+
+typedef struct ExtendedCompressor
+{
+	Compressor base;
+	UuidCompressor *internal;
+} ExtendedCompressor;
+
+/*
+ * The decompression iterator is backed by the bulk decompression, because the
+ * UUIDs are by-reference and we have to materialize them anyway.
+ */
+typedef struct UuidDecompressionIterator
+{
+	DecompressionIterator base;
+	ArrowArray *arrow;
+	int32 next_row;
+} UuidDecompressionIterator;
+
+pg_attribute_always_inline static bool
+uuid_is_v7(const pg_uuid_t *uuid)
+{
+	/* Version 7 in the high nibble of byte 6, RFC 9562 variant in byte 8. */
+	return (uuid->data[6] >> 4) == 7 && (uuid->data[8] & 0xC0) == 0x80;
+}
+
+pg_attribute_always_inline static int64
+uuid_v7_get_timestamp(const pg_uuid_t *uuid)
+{
+	int64 ts = 0;
+	for (int i = 0; i < 6; i++)
+	{
+		ts = (ts << 8) | uuid->data[i];
+	}
+	return ts;
+}
+
+pg_attribute_always_inline static void
+uuid_v7_set_timestamp(pg_uuid_t *uuid, uint64 ts)
+{
+	for (int i = 5; i >= 0; i--)
+	{
+		uuid->data[i] = ts & 0xFF;
+		ts >>= 8;
+	}
+}
+
+bool
+uuid_compressed_has_nulls(const CompressedDataHeader *header)
+{
+	const UuidCompressed *uc = (const UuidCompressed *) header;
+	return uc->has_nulls;
+}
+
+static void
+uuid_compressor_append_uuid(Compressor *compressor, Datum val)
+{
+	ExtendedCompressor *extended = (ExtendedCompressor *) compressor;
+	if (extended->internal == NULL)
+		extended->internal = uuid_compressor_alloc();
+
+	uuid_compressor_append_value(extended->internal, DatumGetUUIDP(val));
+}
+
+static void
+uuid_compressor_append_null_value(Compressor *compressor)
+{
+	ExtendedCompressor *extended = (ExtendedCompressor *) compressor;
+	if (extended->internal == NULL)
+		extended->internal = uuid_compressor_alloc();
+
+	uuid_compressor_append_null(extended->internal);
+}
+
+static void *
+uuid_compressor_finish_and_reset(Compressor *compressor)
+{
+	ExtendedCompressor *extended = (ExtendedCompressor *) compressor;
+	void *compressed = uuid_compressor_finish(extended->internal);
+	pfree(extended->internal);
+	extended->internal = NULL;
+	return compressed;
+}
+
+const Compressor uuid_compressor = {
+	.append_val = uuid_compressor_append_uuid,
+	.append_null = uuid_compressor_append_null_value,
+	.finish = uuid_compressor_finish_and_reset,
+};
+
+Compressor *
+uuid_compressor_for_type(Oid element_type)
+{
+	ExtendedCompressor *compressor = palloc(sizeof(*compressor));
+	switch (element_type)
+	{
+		case UUIDOID:
+			*compressor = (ExtendedCompressor){ .base = uuid_compressor };
+			return &compressor->base;
+		default:
+			elog(ERROR, "invalid type for uuid compressor \"%s\"", format_type_be(element_type));
+	}
+
+	pg_unreachable();
+}
+
+UuidCompressor *
+uuid_compressor_alloc(void)
+{
+	UuidCompressor *compressor = palloc0(sizeof(*compressor));
+	compressor->capacity = 64;
+	compressor->values = palloc(sizeof(pg_uuid_t) * compressor->capacity);
+	compressor->all_v7 = true;
+	simple8brle_compressor_init(&compressor->nulls);
+	return compressor;
+}
+
+void
+uuid_compressor_append_null(UuidCompressor *compressor)
+{
+	compressor->has_nulls = true;
+	simple8brle_compressor_append(&compressor->nulls, 1);
+}
+
+void
+uuid_compressor_append_value(UuidCompressor *compressor, const pg_uuid_t *next_val)
+{
+	if (compressor->num_values >= compressor->capacity)
+	{
+		compressor->capacity *= 2;
+		compressor->values =
+			repalloc(compressor->values, sizeof(pg_uuid_t) * compressor->capacity);
+	}
+
+	compressor->values[compressor->num_values++] = *next_val;
+	compressor->all_v7 = compressor->all_v7 && uuid_is_v7(next_val);
+	simple8brle_compressor_append(&compressor->nulls, 0);
+}
+
+static UuidCompressed *
+uuid_compressed_alloc(Size data_size, Simple8bRleSerialized *nulls, uint8 layout,
+					  uint32 num_values)
+{
+	const uint32 nulls_size = nulls != NULL ? simple8brle_serialized_total_size(nulls) : 0;
+	const Size compressed_size = sizeof(UuidCompressed) + data_size + nulls_size;
+
+	if (!AllocSizeIsValid(compressed_size))
+		ereport(ERROR,
+				(errcode(ERRCODE_PROGRAM_LIMIT_EXCEEDED),
+				 errmsg("compressed size exceeds the maximum allowed (%d)", (int) MaxAllocSize)));
+
+	UuidCompressed *compressed = palloc0(compressed_size);
+	SET_VARSIZE(&compressed->vl_len_, compressed_size);
+	compressed->compression_algorithm = COMPRESSION_ALGORITHM_UUID;
+	compressed->has_nulls = nulls_size != 0 ? 1 : 0;
+	compressed->layout = layout;
+	compressed->num_values = num_values;
+
+	if (nulls != NULL)
+	{
+		bytes_serialize_simple8b_and_advance(compressed->data + data_size, nulls_size, nulls);
+	}
+
+	return compressed;
+}
+
+static UuidCompressed *
+uuid_compressed_from_parts_v7(const DeltaDeltaCompressed *timestamps, const uint64 *tails,
+							  const uint16 *rand_a, uint32 num_values,
+							  Simple8bRleSerialized *nulls)
+{
+	const Size timestamps_size = pad_to_multiple(UUID_PART_ALIGN, VARSIZE(timestamps));
+	const Size tails_size = sizeof(uint64) * num_values;
+	const Size rand_a_size = pad_to_multiple(UUID_PART_ALIGN, sizeof(uint16) * num_values);
+
+	UuidCompressed *compressed = uuid_compressed_alloc(timestamps_size + tails_size + rand_a_size,
+													   nulls,
+													   UUID_LAYOUT_V7,
+													   num_values);
+	char *dest = compressed->data;
+	memcpy(dest, timestamps, VARSIZE(timestamps));
+	dest += timestamps_size;
+	memcpy(dest, tails, tails_size);
+	dest += tails_size;
+	memcpy(dest, rand_a, sizeof(uint16) * num_values);
+
+	return compressed;
+}
+
+static UuidCompressed *
+uuid_compressed_from_parts_plain(const pg_uuid_t *values, uint32 num_values,
+								 Simple8bRleSerialized *nulls)
+{
+	const Size values_size = sizeof(pg_uuid_t) * num_values;
+	UuidCompressed *compressed =
+		uuid_compressed_alloc(values_size, nulls, UUID_LAYOUT_PLAIN, num_values);
+	memcpy(compressed->data, values, values_size);
+	return compressed;
+}
+
+void *
+uuid_compressor_finish(UuidCompressor *compressor)
+{
+	if (compressor == NULL || compressor->num_values == 0)
+	{
+		/* All values are null, the compressed column is stored as null. */
+		return NULL;
+	}
+
+	Simple8bRleSerialized *nulls = simple8brle_compressor_finish(&compressor->nulls);
+	if (!compressor->has_nulls)
+		nulls = NULL;
+
+	const uint32 n = compressor->num_values;
+	if (!compressor->all_v7)
+	{
+		return uuid_compressed_from_parts_plain(compressor->values, n, nulls);
+	}
+
+	DeltaDeltaCompressor *timestamps_compressor = delta_delta_compressor_alloc();
+	uint64 *tails = palloc(sizeof(uint64) * n);
+	uint16 *rand_a = palloc(sizeof(uint16) * n);
+	for (uint32 i = 0; i < n; i++)
+	{
+		const pg_uuid_t *uuid = &compressor->values[i];
+		delta_delta_compressor_append_value(timestamps_compressor, uuid_v7_get_timestamp(uuid));
+		memcpy(&rand_a[i], &uuid->data[6], sizeof(uint16));
+		memcpy(&tails[i], &uuid->data[8], sizeof(uint64));
+	}
+
+	DeltaDeltaCompressed *timestamps = delta_delta_compressor_finish(timestamps_compressor);
+	Assert(timestamps != NULL);
+
+	UuidCompressed *compressed =
+		uuid_compressed_from_parts_v7(timestamps, tails, rand_a, n, nulls);
+
+	pfree(timestamps);
+	pfree(tails);
+	pfree(rand_a);
+	pfree(timestamps_compressor);
+
+	return compressed;
+}
+
+/**********************************************************************************/
+/**********************************************************************************/
+
+/*
+ * Decompress the non-null values into the beginning of the given buffer.
+ */
+static void
+uuid_decompress_values(StringInfo si, const UuidCompressed *header, pg_uuid_t *restrict values)
+{
+	const uint32 n = header->num_values;
+
+	if (header->layout == UUID_LAYOUT_PLAIN)
+	{
+		const void *src = consumeCompressedData(si, sizeof(pg_uuid_t) * n);
+		memcpy(values, src, sizeof(pg_uuid_t) * n);
+		return;
+	}
+
+	CheckCompressedData(header->layout == UUID_LAYOUT_V7);
+
+	/* The timestamps are a nested delta-delta compressed datum. */
+	CheckCompressedData(si->cursor + VARHDRSZ <= si->len);
+	const struct varlena *timestamps_compressed = (struct varlena *) (si->data + si->cursor);
+	CheckCompressedData(!VARATT_IS_EXTENDED(timestamps_compressed));
+	consumeCompressedData(si, pad_to_multiple(UUID_PART_ALIGN, VARSIZE(timestamps_compressed)));
+
+	const uint64 *tails = consumeCompressedData(si, sizeof(uint64) * n);
+	const uint16 *rand_a =
+		consumeCompressedData(si, pad_to_multiple(UUID_PART_ALIGN, sizeof(uint16) * n));
+
+	CheckCompressedData(((const CompressedDataHeader *) timestamps_compressed)
+							->compression_algorithm == COMPRESSION_ALGORITHM_DELTADELTA);
+	ArrowArray *timestamps = delta_delta_decompress_all(PointerGetDatum(timestamps_compressed),
+														INT8OID,
+														CurrentMemoryContext);
+	CheckCompressedData(timestamps->length == n);
+	CheckCompressedData(timestamps->null_count == 0);
+	const int64 *ts = timestamps->buffers[1];
+
+	for (uint32 i = 0; i < n; i++)
+	{
+		uuid_v7_set_timestamp(&values[i], ts[i]);
+		memcpy(&values[i].data[6], &rand_a[i], sizeof(uint16));
+		memcpy(&values[i].data[8], &tails[i], sizeof(uint64));
+	}
+
+	/*
+	 * The timestamps are allocated in the current context, which is the
+	 * per-batch context during the bulk decompression, so free them right away.
+	 */
+	if (timestamps->buffers[0] != NULL)
+		pfree((void *) timestamps->buffers[0]);
+	pfree((void *) timestamps->buffers[1]);
+	pfree(timestamps);
+}
+
+ArrowArray *
+uuid_decompress_all(Datum compressed, Oid element_type, MemoryContext dest_mctx)
+{
+	Assert(element_type == UUIDOID);
+
+	void *detoasted = PG_DETOAST_DATUM(compressed);
+	StringInfoData si = { .data = detoasted, .len = VARSIZE(detoasted) };
+	UuidCompressed *header = consumeCompressedData(&si, sizeof(UuidCompressed));
+
+	CheckCompressedData(header->has_nulls == 0 || header->has_nulls == 1);
+	CheckCompressedData(header->num_values <= GLOBAL_MAX_ROWS_PER_COMPRESSION);
+
+	const uint32 n_notnull = header->num_values;
+
+	/*
+	 * The values have to be decompressed before we can read the nulls bitmap
+	 * that follows them.
+	 */
+	pg_uuid_t *notnull_values = palloc(sizeof(pg_uuid_t) * n_notnull);
+	uuid_decompress_values(&si, header, notnull_values);
+
+	Simple8bRleBitmap nulls = { 0 };
+	if (header->has_nulls)
+	{
+		Simple8bRleSerialized *nulls_compressed = bytes_deserialize_simple8b_and_advance(&si);
+		nulls = simple8brle_bitmap_decompress(nulls_compressed);
+		CheckCompressedData(n_notnull + simple8brle_bitmap_num_ones(&nulls) ==
+							nulls.num_elements);
+	}
+
+	const uint32 n_total = header->has_nulls ? nulls.num_elements : n_notnull;
+
+	/* The 64-byte padding is required by the Arrow format. */
+	pg_uuid_t *restrict values =
+		MemoryContextAlloc(dest_mctx, pad_to_multiple(64, sizeof(pg_uuid_t) * n_total));
+
+	uint64 *restrict validity_bitmap = NULL;
+	if (!header->has_nulls)
+	{
+		memcpy(values, notnull_values, sizeof(pg_uuid_t) * n_total);
+	}
+	else
+	{
+		const int validity_bitmap_bytes = sizeof(uint64) * ((n_total + 64 - 1) / 64);
+		validity_bitmap = MemoryContextAlloc(dest_mctx, validity_bitmap_bytes);
+		memset(validity_bitmap, 0xFF, validity_bitmap_bytes);
+		if (n_total % 64)
+		{
+			const uint64 tail_mask = ~0ULL >> (64 - n_total % 64);
+			validity_bitmap[n_total / 64] &= tail_mask;
+		}
+
+		uint32 current_notnull_element = 0;
+		for (uint32 i = 0; i < n_total; i++)
+		{
+			if (simple8brle_bitmap_get_at(&nulls, i))
+			{
+				arrow_set_row_validity(validity_bitmap, i, false);
+				memset(&values[i], 0, sizeof(pg_uuid_t));
+			}
+			else
+			{
+				Assert(current_notnull_element < n_notnull);
+				values[i] = notnull_values[current_notnull_element++];
+			}
+		}
+		Assert(current_notnull_element == n_notnull);
+	}
+
+	pfree(notnull_values);
+	if (nulls.data != NULL)
+		pfree((void *) nulls.data);
+
+	ArrowArray *result = MemoryContextAllocZero(dest_mctx, sizeof(ArrowArray) + sizeof(void *) * 2);
+	const void **buffers = (const void **) &result[1];
+	buffers[0] = validity_bitmap;
+	buffers[1] = values;
+	result->n_buffers = 2;
+	result->buffers = buffers;
+	result->length = n_total;
+	result->null_count = n_total - n_notnull;
+	return result;
+}
+
+/*
+ * Bulk decompression of UUID columns that were compressed with some other
+ * algorithm, so that the UUID columns support vectorized filters regardless of
+ * how they were compressed.
+ */
+ArrowArray *
+uuid_decompress_all_generic(Datum compressed, Oid element_type, MemoryContext dest_mctx)
+{
+	Assert(element_type == UUIDOID);
+
+	const CompressedDataHeader *header =
+		(const CompressedDataHeader *) PG_DETOAST_DATUM(compressed);
+	DecompressionIterator *iter =
+		tsl_get_decompression_iterator_init(header->compression_algorithm,
+											/* reverse = */ false)(PointerGetDatum(header),
+																	element_type);
+
+	const int n_words = GLOBAL_MAX_ROWS_PER_COMPRESSION / 64 + 1;
+	pg_uuid_t *restrict values =
+		MemoryContextAllocZero(dest_mctx, sizeof(pg_uuid_t) * n_words * 64);
+	uint64 *restrict validity = MemoryContextAllocZero(dest_mctx, sizeof(uint64) * n_words);
+
+	int n_total = 0;
+	int null_count = 0;
+	for (DecompressResult r = iter->try_next(iter); !r.is_done; r = iter->try_next(iter))
+	{
+		CheckCompressedData(n_total < GLOBAL_MAX_ROWS_PER_COMPRESSION);
+
+		if (r.is_null)
+		{
+			null_count++;
+		}
+		else
+		{
+			arrow_set_row_validity(validity, n_total, true);
+			values[n_total] = *DatumGetUUIDP(r.val);
+		}
+
+		n_total++;
+	}
+
+	/* The validity bitmap is not used without nulls, don't keep it around. */
+	if (null_count == 0)
+	{
+		pfree(validity);
+		validity = NULL;
+	}
+
+	ArrowArray *result = MemoryContextAllocZero(dest_mctx, sizeof(ArrowArray) + sizeof(void *) * 2);
+	const void **buffers = (const void **) &result[1];
+	buffers[0] = validity;
+	buffers[1] = values;
+	result->n_buffers = 2;
+	result->buffers = buffers;
+	result->length = n_total;
+	result->null_count = null_count;
+	return result;
+}
+
+static DecompressionIterator *
+uuid_decompression_iterator_from_datum(Datum uuid_compressed, Oid element_type, bool forward)
+{
+	Assert(element_type == UUIDOID);
+
+	UuidDecompressionIterator *iterator = palloc(sizeof(*iterator));
+	ArrowArray *arrow = uuid_decompress_all(uuid_compressed, element_type, CurrentMemoryContext);
+	*iterator = (UuidDecompressionIterator){
+		.base = {
+			.compression_algorithm = COMPRESSION_ALGORITHM_UUID,
+			.forward = forward,
+			.element_type = element_type,
+			.try_next = forward ? uuid_decompression_iterator_try_next_forward :
+								  uuid_decompression_iterator_try_next_reverse,
+		},
+		.arrow = arrow,
+		.next_row = forward ? 0 : arrow->length - 1,
+	};
+	return &iterator->base;
+}
+
+DecompressionIterator *
+uuid_decompression_iterator_from_datum_forward(Datum uuid_compressed, Oid element_type)
+{
+	return uuid_decompression_iterator_from_datum(uuid_compressed,
+												  element_type,
+												  /* forward = */ true);
+}
+
+DecompressionIterator *
+uuid_decompression_iterator_from_datum_reverse(Datum uuid_compressed, Oid element_type)
+{
+	return uuid_decompression_iterator_from_datum(uuid_compressed,
+												  element_type,
+												  /* forward = */ false);
+}
+
+static pg_attribute_always_inline DecompressResult
+uuid_decompression_iterator_get_row(UuidDecompressionIterator *iter, int32 row)
+{
+	if (row < 0 || row >= iter->arrow->length)
+		return (DecompressResult){
+			.is_done = true,
+		};
+
+	if (!arrow_row_is_valid(iter->arrow->buffers[0], row))
+		return (DecompressResult){
+			.is_null = true,
+		};
+
+	const pg_uuid_t *values = iter->arrow->buffers[1];
+	return (DecompressResult){
+		.val = UUIDPGetDatum(&values[row]),
+	};
+}
+
+DecompressResult
+uuid_decompression_iterator_try_next_forward(DecompressionIterator *iter_base)
+{
+	Assert(iter_base->compression_algorithm == COMPRESSION_ALGORITHM_UUID && iter_base->forward);
+	UuidDecompressionIterator *iter = (UuidDecompressionIterator *) iter_base;
+	DecompressResult result = uuid_decompression_iterator_get_row(iter, iter->next_row);
+	if (!result.is_done)
+		iter->next_row++;
+	return result;
+}
+
+DecompressResult
+uuid_decompression_iterator_try_next_reverse(DecompressionIterator *iter_base)
+{
+	Assert(iter_base->compression_algorithm == COMPRESSION_ALGORITHM_UUID && !iter_base->forward);
+	UuidDecompressionIterator *iter = (UuidDecompressionIterator *) iter_base;
+	DecompressResult result = uuid_decompression_iterator_get_row(iter, iter->next_row);
+	if (!result.is_done)
+		iter->next_row--;
+	return result;
+}
+
+/**********************************************************************************/
+/**********************************************************************************/
+
+/*
+ * The binary format is the same for both layouts: the uuids are sent as is,
+ * and the receiver compresses them again.
+ */
+void
+uuid_compressed_send(CompressedDataHeader *header, StringInfo buffer)
+{
+	Assert(header->compression_algorithm == COMPRESSION_ALGORITHM_UUID);
+	ArrowArray *arrow = uuid_decompress_all(PointerGetDatum(header), UUIDOID, CurrentMemoryContext);
+	const pg_uuid_t *values = arrow->buffers[1];
+
+	pq_sendint32(buffer, arrow->length);
+	for (int i = 0; i < arrow->length; i++)
+	{
+		const bool valid = arrow_row_is_valid(arrow->buffers[0], i);
+		pq_sendbyte(buffer, valid);
+		if (valid)
+			pq_sendbytes(buffer, (const char *) &values[i], sizeof(pg_uuid_t));
+	}
+}
+
+Datum
+uuid_compressed_recv(StringInfo buffer)
+{
+	const uint32 n_total = pq_getmsgint(buffer, 4);
+	CheckCompressedData(n_total <= GLOBAL_MAX_ROWS_PER_COMPRESSION);
+
+	UuidCompressor *compressor = uuid_compressor_alloc();
+	for (uint32 i = 0; i < n_total; i++)
+	{
+		const uint8 valid = pq_getmsgbyte(buffer);
+		CheckCompressedData(valid == 0 || valid == 1);
+		if (valid)
+		{
+			pg_uuid_t value;
+			pq_copymsgbytes(buffer, (char *) &value, sizeof(pg_uuid_t));
+			uuid_compressor_append_value(compressor, &value);
+		}
+		else
+		{
+			uuid_compressor_append_null(compressor);
+		}
+	}
+
+	void *compressed = uuid_compressor_finish(compressor);
+	CheckCompressedData(compressed != NULL);
+	PG_RETURN_POINTER(compressed);
+}
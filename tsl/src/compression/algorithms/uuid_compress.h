@@ -0,0 +1,62 @@
+/*
+ * This file and its contents are licensed under the Timescale License.
+ * Please see the included NOTICE for copyright information and
+ * LICENSE-TIMESCALE for a copy of the license.
+ */
+#pragma once
+
+/*
+ * The UUID compression is aware of the time-ordered UUIDv7 layout (RFC 9562).
+ * If all UUIDs in the batch are v7, they are decomposed into the 48-bit
+ * millisecond timestamp prefix, which is compressed with delta-delta, and the
+ * 74-bit random tail, which is stored as is, because it doesn't compress. For
+ * the batches that have other UUID versions (e.g. random v4), we fall back to
+ * storing the UUIDs as is. Both layouts are smaller than the array compression
+ * of UUIDs, because we don't store the per-element headers.
+ *
+ * The bulk decompression produces a fixed-width Arrow array with 16-byte
+ * elements.
+ */
+
+#include <postgres.h>
+#include <fmgr.h>
+#include <lib/stringinfo.h>
+#include <utils/uuid.h>
+
+#include "compression/compression.h"
+
+typedef struct UuidCompressor UuidCompressor;
+typedef struct UuidCompressed UuidCompressed;
+typedef struct UuidDecompressionIterator UuidDecompressionIterator;
+
+extern bool uuid_compressed_has_nulls(const CompressedDataHeader *header);
+extern Compressor *uuid_compressor_for_type(Oid element_type);
+extern UuidCompressor *uuid_compressor_alloc(void);
+extern void uuid_compressor_append_null(UuidCompressor *compressor);
+extern void uuid_compressor_append_value(UuidCompressor *compressor, const pg_uuid_t *next_val);
+extern void *uuid_compressor_finish(UuidCompressor *compressor);
+
+extern DecompressionIterator *uuid_decompression_iterator_from_datum_forward(Datum uuid_compressed,
+																			 Oid element_type);
+extern DecompressionIterator *uuid_decompression_iterator_from_datum_reverse(Datum uuid_compressed,
+																			 Oid element_type);
+extern DecompressResult uuid_decompression_iterator_try_next_forward(DecompressionIterator *iter);
+extern DecompressResult uuid_decompression_iterator_try_next_reverse(DecompressionIterator *iter);
+
+extern ArrowArray *uuid_decompress_all(Datum compressed, Oid element_type, MemoryContext dest_mctx);
+extern ArrowArray *uuid_decompress_all_generic(Datum compressed, Oid element_type,
+											   MemoryContext dest_mctx);
+
+extern void uuid_compressed_send(CompressedDataHeader *header, StringInfo buffer);
+extern Datum uuid_compressed_recv(StringInfo buf);
+
+#define UUID_ALGORITHM_DEFINITION                                                                  \
+	{                                                                                              \
+		.iterator_init_forward = uuid_decompression_iterator_from_datum_forward,                   \
+		.iterator_init_reverse = uuid_decompression_iterator_from_datum_reverse,                   \
+		.decompress_all = uuid_decompress_all,                                                     \
+		.compressed_data_send = uuid_compressed_send,                                              \
+		.compressed_data_recv = uuid_compressed_recv,                                              \
+		.compressor_for_type = uuid_compressor_for_type,                                           \
+		.compressed_data_storage = TOAST_STORAGE_EXTERNAL,                                         \
+	}
@@ -4,14 +4,25 @@
  * LICENSE-TIMESCALE for a copy of the license.
  */
 #include <postgres.h>
+#include <access/htup_details.h>
+#include <access/parallel.h>
 #include <access/skey.h>
 #include <catalog/heap.h>
 #include <catalog/indexing.h>
 #include <catalog/pg_am.h>
 #include <common/base64.h>
+#include <common/hashfn.h>
 #include <libpq/pqformat.h>
+#include <miscadmin.h>
+#include <optimizer/paths.h>
+#include <pgstat.h>
+#include <storage/barrier.h>
+#include <storage/dsm.h>
 #include <storage/predicate.h>
+#include <storage/sharedfileset.h>
 #include <utils/datum.h>
+#include <utils/lsyscache.h>
+#include <utils/sharedtuplestore.h>
 #include <utils/snapmgr.h>
 #include <utils/syscache.h>
 #include <utils/typcache.h>
@@ -19,15 +30,19 @@
 #include "compat/compat.h"
 
 #include "algorithms/array.h"
+#include "algorithms/bool_compress.h"
 #include "algorithms/deltadelta.h"
 #include "algorithms/dictionary.h"
 #include "algorithms/gorilla.h"
+#include "algorithms/uuid_compress.h"
 #include "chunk.h"
 #include "compression.h"
 #include "create.h"
 #include "custom_type_cache.h"
 #include "debug_assert.h"
 #include "debug_point.h"
+#include "export.h"
+#include "extension_constants.h"
 #include "guc.h"
 #include "hypercore/hypercore_handler.h"
 #include "nodes/chunk_dispatch/chunk_insert_state.h"
@@ -47,6 +62,8 @@ static const CompressionAlgorithmDefinition definitions[_END_COMPRESSION_ALGORIT
 	[COMPRESSION_ALGORITHM_DICTIONARY] = DICTIONARY_ALGORITHM_DEFINITION,
 	[COMPRESSION_ALGORITHM_GORILLA] = GORILLA_ALGORITHM_DEFINITION,
 	[COMPRESSION_ALGORITHM_DELTADELTA] = DELTA_DELTA_ALGORITHM_DEFINITION,
+	[COMPRESSION_ALGORITHM_BOOL] = BOOL_ALGORITHM_DEFINITION,
+	[COMPRESSION_ALGORITHM_UUID] = UUID_ALGORITHM_DEFINITION,
 };
 
 static NameData compression_algorithm_name[] = {
@@ -55,6 +72,8 @@ static NameData compression_algorithm_name[] = {
 	[COMPRESSION_ALGORITHM_DICTIONARY] = { "DICTIONARY" },
 	[COMPRESSION_ALGORITHM_GORILLA] = { "GORILLA" },
 	[COMPRESSION_ALGORITHM_DELTADELTA] = { "DELTADELTA" },
+	[COMPRESSION_ALGORITHM_BOOL] = { "BOOL" },
+	[COMPRESSION_ALGORITHM_UUID] = { "UUID" },
 };
 
 Name
@@ -63,6 +82,254 @@ compression_get_algorithm_name(CompressionAlgorithm alg)
 	return &compression_algorithm_name[alg];
 }
 
+/*
+ * Weights of the compressed sizes when choosing the algorithm with
+ * COMPRESSION_ALGORITHM_SELECTION_SPEED. This is a coarse heuristic and not a
+ * measurement: the algorithms that have to look up a dictionary or combine the
+ * bit-packed XORs for each value are penalized, so that they are only chosen
+ * when they are substantially smaller than the direct encodings.
+ */
+static const double compression_algorithm_decompression_cost[_END_COMPRESSION_ALGORITHMS] = {
+	[COMPRESSION_ALGORITHM_ARRAY] = 1.0,	  [COMPRESSION_ALGORITHM_DICTIONARY] = 1.5,
+	[COMPRESSION_ALGORITHM_GORILLA] = 2.0,	  [COMPRESSION_ALGORITHM_DELTADELTA] = 1.0,
+	[COMPRESSION_ALGORITHM_BOOL] = 1.0,		  [COMPRESSION_ALGORITHM_UUID] = 1.0,
+};
+
+/*
+ * Fill the algorithms that can compress the given type, starting with the
+ * default one, and return their number.
+ *
+ * The vectorized decompression decides whether the column supports bulk
+ * decompression at planning time, based on the default algorithm for the type.
+ * So if the default algorithm supports it, all the candidates must support it
+ * as well, because the algorithm of a particular batch is only known at
+ * execution time.
+ */
+static int
+compression_get_candidate_algorithms(Oid typeoid,
+									 CompressionAlgorithm candidates[_END_COMPRESSION_ALGORITHMS])
+{
+	int n = 0;
+	const CompressionAlgorithm default_algorithm = compression_get_default_algorithm(typeoid);
+	candidates[n++] = default_algorithm;
+
+#define ADD_CANDIDATE(ALGORITHM)                                                                   \
+	do                                                                                             \
+	{                                                                                              \
+		if (default_algorithm != (ALGORITHM))                                                      \
+			candidates[n++] = (ALGORITHM);                                                         \
+	} while (0)
+
+	switch (typeoid)
+	{
+		case INT2OID:
+		case INT4OID:
+		case INT8OID:
+			ADD_CANDIDATE(COMPRESSION_ALGORITHM_DELTADELTA);
+			ADD_CANDIDATE(COMPRESSION_ALGORITHM_GORILLA);
+			break;
+
+		case NUMERICOID:
+			ADD_CANDIDATE(COMPRESSION_ALGORITHM_DICTIONARY);
+			break;
+
+		case BOOLOID:
+			if (ts_guc_enable_bool_compression)
+				ADD_CANDIDATE(COMPRESSION_ALGORITHM_BOOL);
+			ADD_CANDIDATE(COMPRESSION_ALGORITHM_DELTADELTA);
+			ADD_CANDIDATE(COMPRESSION_ALGORITHM_DICTIONARY);
+			break;
+
+		case UUIDOID:
+			if (ts_guc_enable_uuid_compression)
+				ADD_CANDIDATE(COMPRESSION_ALGORITHM_UUID);
+			ADD_CANDIDATE(COMPRESSION_ALGORITHM_DICTIONARY);
+			break;
+
+		default:
+			/*
+			 * The dictionary compressor already falls back to array when it
+			 * is smaller, so there is nothing to choose from for the other
+			 * types.
+			 */
+			break;
+	}
+
+#undef ADD_CANDIDATE
+
+#ifdef USE_ASSERT_CHECKING
+	const bool default_is_bulk =
+		tsl_get_decompress_all_function(default_algorithm, typeoid) != NULL;
+	for (int i = 0; i < n; i++)
+	{
+		Assert(!default_is_bulk || tsl_get_decompress_all_function(candidates[i], typeoid) != NULL);
+	}
+#endif
+
+	return n;
+}
+
+/*
+ * The adaptive compressor buffers the values of a batch, and when the batch is
+ * finished, compresses them with every candidate algorithm for the type and
+ * keeps the best result. The algorithm that was used is recorded in the header
+ * of the compressed data, so the decompression doesn't need to know about this.
+ */
+typedef struct AdaptiveCompressor
+{
+	Compressor base;
+	Oid type;
+	int16 typlen;
+	bool typbyval;
+	CompressionAlgorithmSelection selection;
+	int num_candidates;
+	CompressionAlgorithm candidates[_END_COMPRESSION_ALGORITHMS];
+
+	/* The buffered values of the current batch. */
+	int num_values;
+	int max_values;
+	Datum *values;
+	bool *nulls;
+} AdaptiveCompressor;
+
+static void
+adaptive_compressor_append(AdaptiveCompressor *compressor, Datum val, bool is_null)
+{
+	/*
+	 * Allocated lazily in the current memory context, like the state of the
+	 * other compressors, so that it is freed together with the batch.
+	 */
+	if (compressor->values == NULL)
+	{
+		compressor->max_values = TARGET_COMPRESSED_BATCH_SIZE;
+		compressor->values = palloc(sizeof(Datum) * compressor->max_values);
+		compressor->nulls = palloc(sizeof(bool) * compressor->max_values);
+	}
+	else if (compressor->num_values >= compressor->max_values)
+	{
+		compressor->max_values *= 2;
+		compressor->values = repalloc(compressor->values, sizeof(Datum) * compressor->max_values);
+		compressor->nulls = repalloc(compressor->nulls, sizeof(bool) * compressor->max_values);
+	}
+
+	compressor->values[compressor->num_values] =
+		is_null ? (Datum) 0 : datumCopy(val, compressor->typbyval, compressor->typlen);
+	compressor->nulls[compressor->num_values] = is_null;
+	compressor->num_values++;
+}
+
+static void
+adaptive_compressor_append_val(Compressor *compressor, Datum val)
+{
+	adaptive_compressor_append((AdaptiveCompressor *) compressor, val, false);
+}
+
+static void
+adaptive_compressor_append_null(Compressor *compressor)
+{
+	adaptive_compressor_append((AdaptiveCompressor *) compressor, (Datum) 0, true);
+}
+
+static void *
+adaptive_compressor_finish(Compressor *compressor)
+{
+	AdaptiveCompressor *adaptive = (AdaptiveCompressor *) compressor;
+	void *best = NULL;
+	double best_cost = 0;
+
+	for (int i = 0; i < adaptive->num_candidates; i++)
+	{
+		const CompressionAlgorithm algorithm = adaptive->candidates[i];
+		Compressor *trial = definitions[algorithm].compressor_for_type(adaptive->type);
+
+		for (int row = 0; row < adaptive->num_values; row++)
+		{
+			if (adaptive->nulls[row])
+				trial->append_null(trial);
+			else
+				trial->append_val(trial, adaptive->values[row]);
+		}
+
+		void *compressed = trial->finish(trial);
+		pfree(trial);
+
+		/* All values are null, this is the same for every algorithm. */
+		if (compressed == NULL)
+			break;
+
+		/*
+		 * Note that the compressor can deviate from the requested algorithm,
+		 * e.g. the dictionary compressor can produce an array, so we look at
+		 * the resulting header.
+		 */
+		const CompressedDataHeader *header = compressed;
+		double cost = VARSIZE(compressed);
+		if (adaptive->selection == COMPRESSION_ALGORITHM_SELECTION_SPEED)
+			cost *= compression_algorithm_decompression_cost[header->compression_algorithm];
+
+		/* Strict comparison so that the default algorithm wins the ties. */
+		if (best == NULL || cost < best_cost)
+		{
+			if (best != NULL)
+				pfree(best);
+			best = compressed;
+			best_cost = cost;
+		}
+		else
+		{
+			pfree(compressed);
+		}
+	}
+
+	if (adaptive->values != NULL)
+	{
+		if (!adaptive->typbyval)
+		{
+			for (int row = 0; row < adaptive->num_values; row++)
+			{
+				if (!adaptive->nulls[row])
+					pfree(DatumGetPointer(adaptive->values[row]));
+			}
+		}
+		pfree(adaptive->values);
+		pfree(adaptive->nulls);
+	}
+	adaptive->values = NULL;
+	adaptive->nulls = NULL;
+	adaptive->num_values = 0;
+	adaptive->max_values = 0;
+
+	return best;
+}
+
+/*
+ * Create a compressor that chooses the algorithm for each batch separately.
+ * Returns NULL if there is only one applicable algorithm for the type.
+ */
+Compressor *
+adaptive_compressor_for_type(Oid type, CompressionAlgorithmSelection selection)
+{
+	AdaptiveCompressor *compressor = palloc0(sizeof(*compressor));
+
+	compressor->num_candidates = compression_get_candidate_algorithms(type, compressor->candidates);
+	if (compressor->num_candidates < 2)
+	{
+		pfree(compressor);
+		return NULL;
+	}
+
+	compressor->base = (Compressor){
+		.append_val = adaptive_compressor_append_val,
+		.append_null = adaptive_compressor_append_null,
+		.finish = adaptive_compressor_finish,
+	};
+	compressor->type = type;
+	compressor->selection = selection;
+	get_typlenbyval(type, &compressor->typlen, &compressor->typbyval);
+
+	return &compressor->base;
+}
+
 static Compressor *
 compressor_for_type(Oid type)
 {
@@ -70,6 +337,14 @@ compressor_for_type(Oid type)
 	if (algorithm >= _END_COMPRESSION_ALGORITHMS)
 		elog(ERROR, "invalid compression algorithm %d", algorithm);
 
+	if (ts_guc_compression_algorithm_selection != COMPRESSION_ALGORITHM_SELECTION_DEFAULT)
+	{
+		Compressor *adaptive =
+			adaptive_compressor_for_type(type, ts_guc_compression_algorithm_selection);
+		if (adaptive != NULL)
+			return adaptive;
+	}
+
 	return definitions[algorithm].compressor_for_type(type);
 }
 
@@ -91,6 +366,26 @@ tsl_get_decompress_all_function(CompressionAlgorithm algorithm, Oid type)
 	if (algorithm >= _END_COMPRESSION_ALGORITHMS)
 		elog(ERROR, "invalid compression algorithm %d", algorithm);
 
+	if (type == BOOLOID)
+	{
+		/*
+		 * The bool columns are always decompressed into the bit-packed Arrow
+		 * bool arrays, even if they were compressed with another algorithm.
+		 */
+		return algorithm == COMPRESSION_ALGORITHM_BOOL ? bool_decompress_all :
+														 bool_decompress_all_generic;
+	}
+
+	if (type == UUIDOID)
+	{
+		/*
+		 * Same for UUID columns, they are decompressed into the fixed-width
+		 * Arrow arrays regardless of the compression algorithm.
+		 */
+		return algorithm == COMPRESSION_ALGORITHM_UUID ? uuid_decompress_all :
+														 uuid_decompress_all_generic;
+	}
+
 	if (type != TEXTOID &&
 		(algorithm == COMPRESSION_ALGORITHM_DICTIONARY || algorithm == COMPRESSION_ALGORITHM_ARRAY))
 	{
@@ -101,10 +396,40 @@ tsl_get_decompress_all_function(CompressionAlgorithm algorithm, Oid type)
 	return definitions[algorithm].decompress_all;
 }
 
+/*
+ * Check whether the columns of the given type are bulk decompressed, which is
+ * what the vectorized filters and aggregates need. This is decided at planning
+ * time based on the default algorithm for the type.
+ *
+ * The bit-packed bool arrays and the fixed-width uuid arrays are only used when
+ * the respective compression is enabled, so that the vectorized filters on these
+ * columns can be turned off together with it.
+ */
+bool
+tsl_bulk_decompression_possible(Oid typeoid)
+{
+	if (typeoid == BOOLOID && !ts_guc_enable_bool_compression)
+		return false;
+
+	if (typeoid == UUIDOID && !ts_guc_enable_uuid_compression)
+		return false;
+
+	return tsl_get_decompress_all_function(compression_get_default_algorithm(typeoid), typeoid) !=
+		   NULL;
+}
+
 static Tuplesortstate *compress_chunk_sort_relation(CompressionSettings *settings, Relation in_rel);
+static Tuplesortstate *compression_create_tuplesort_state_with_mem(CompressionSettings *settings,
+																   Relation rel, int sort_mem);
+static void compress_chunk_parallel(CompressionSettings *settings, Relation in_rel,
+									Relation out_rel, RowCompressor *row_compressor,
+									CommandId mycid, int nworkers);
+static CommandId row_compressor_command_id(RowCompressor *row_compressor);
 static void row_compressor_process_ordered_slot(RowCompressor *row_compressor, TupleTableSlot *slot,
 												CommandId mycid);
 static void row_compressor_update_group(RowCompressor *row_compressor, TupleTableSlot *row);
+static void row_compressor_insert_compressed_tuple(RowCompressor *row_compressor,
+												   HeapTuple compressed_tuple, CommandId mycid);
 static bool row_compressor_new_row_is_in_new_group(RowCompressor *row_compressor,
 												   TupleTableSlot *row);
 static void row_compressor_append_row(RowCompressor *row_compressor, TupleTableSlot *row);
@@ -485,13 +810,27 @@ compress_chunk(Oid in_table, Oid out_table, int insert_options)
 	}
 	else
 	{
-		elog(ts_guc_debug_compression_path_info ? INFO : DEBUG1,
-			 "using tuplesort to scan rows from \"%s\" for compression",
-			 RelationGetRelationName(in_rel));
+		int nworkers = compress_chunk_plan_parallel_workers(settings, in_rel);
+
+		if (nworkers > 0)
+		{
+			elog(ts_guc_debug_compression_path_info ? INFO : DEBUG1,
+				 "using %d parallel workers to compress \"%s\"",
+				 nworkers,
+				 RelationGetRelationName(in_rel));
+
+			compress_chunk_parallel(settings, in_rel, out_rel, &row_compressor, mycid, nworkers);
+		}
+		else
+		{
+			elog(ts_guc_debug_compression_path_info ? INFO : DEBUG1,
+				 "using tuplesort to scan rows from \"%s\" for compression",
+				 RelationGetRelationName(in_rel));
 
-		Tuplesortstate *sorted_rel = compress_chunk_sort_relation(settings, in_rel);
-		row_compressor_append_sorted_rows(&row_compressor, sorted_rel, in_desc, in_rel);
-		tuplesort_end(sorted_rel);
+			Tuplesortstate *sorted_rel = compress_chunk_sort_relation(settings, in_rel);
+			row_compressor_append_sorted_rows(&row_compressor, sorted_rel, in_desc, in_rel);
+			tuplesort_end(sorted_rel);
+		}
 	}
 
 	row_compressor_close(&row_compressor);
@@ -520,8 +859,541 @@ compress_chunk(Oid in_table, Oid out_table, int insert_options)
 	return cstat;
 }
 
+/*
+ * Parallel compression.
+ *
+ * The rows of the chunk are partitioned by the hash of their segmentby values,
+ * so that every segment is compressed by exactly one participant and the
+ * batches of a segment don't overlap, same as with the serial compression. The
+ * participants scan the chunk together with a parallel scan and spool the rows
+ * into their partitions. Then they claim the partitions one by one, and sort
+ * and compress the rows of each.
+ *
+ * The parallel workers are not allowed to insert, and the leader can't assign
+ * the TOAST OIDs in parallel mode either, so the compressed tuples are written
+ * into a shared tuplestore, and the leader inserts them after the parallel
+ * operation is finished. The shared tuplestore lives in a separate DSM segment
+ * created by the leader, so that it outlives the parallel context.
+ */
+
+#define PARALLEL_KEY_COMPRESS_CHUNK_SHARED UINT64CONST(0xC011E55000000001)
+#define PARALLEL_KEY_COMPRESS_CHUNK_SCAN UINT64CONST(0xC011E55000000002)
+
+typedef struct CompressChunkParallelShared
+{
+	Oid in_relid;
+	Oid out_relid;
+	dsm_handle output_handle;
+	dsm_handle spool_handle;
+	int sort_mem;
+	uint32 npartitions;
+	pg_atomic_uint32 next_partition;
+	/* Number of the uncompressed rows compressed by all the participants. */
+	pg_atomic_uint64 rowcnt_pre_compression;
+} CompressChunkParallelShared;
+
+/* Followed by the SharedTuplestore. */
+typedef struct CompressChunkParallelOutput
+{
+	SharedFileSet fileset;
+} CompressChunkParallelOutput;
+
+#define COMPRESS_CHUNK_PARALLEL_OUTPUT_STS(output)                                                 \
+	((SharedTuplestore *) ((char *) (output) + MAXALIGN(sizeof(CompressChunkParallelOutput))))
+
+/*
+ * Returns false if the rows can't be partitioned by the segmentby values,
+ * because there are none, or some of them are not hashable.
+ */
+bool
+segment_partitioner_init(SegmentPartitioner *partitioner, CompressionSettings *settings,
+						 Relation rel)
+{
+	TupleDesc tupdesc = RelationGetDescr(rel);
+	int nkeys = ts_array_length(settings->fd.segmentby);
+
+	if (nkeys == 0)
+		return false;
+
+	*partitioner = (SegmentPartitioner){
+		.nkeys = nkeys,
+		.attnos = palloc(sizeof(AttrNumber) * nkeys),
+		.collations = palloc(sizeof(Oid) * nkeys),
+		.hash_procs = palloc(sizeof(FmgrInfo) * nkeys),
+	};
+
+	for (int i = 0; i < nkeys; i++)
+	{
+		const char *attname = ts_array_get_element_text(settings->fd.segmentby, i + 1);
+		AttrNumber attno = get_attnum(RelationGetRelid(rel), attname);
+		Ensure(attno != InvalidAttrNumber, "segmentby column \"%s\" not found", attname);
+
+		Form_pg_attribute attr = TupleDescAttr(tupdesc, AttrNumberGetAttrOffset(attno));
+		TypeCacheEntry *tentry = lookup_type_cache(attr->atttypid, TYPECACHE_HASH_PROC_FINFO);
+		if (!OidIsValid(tentry->hash_proc))
+			return false;
+
+		partitioner->attnos[i] = attno;
+		partitioner->collations[i] = attr->attcollation;
+		fmgr_info_copy(&partitioner->hash_procs[i],
+					   &tentry->hash_proc_finfo,
+					   CurrentMemoryContext);
+	}
+
+	return true;
+}
+
+uint32
+segment_partitioner_get_partition(SegmentPartitioner *partitioner, TupleTableSlot *slot,
+								  uint32 npartitions)
+{
+	uint32 hash = 0;
+
+	for (int i = 0; i < partitioner->nkeys; i++)
+	{
+		bool isnull;
+		Datum value = slot_getattr(slot, partitioner->attnos[i], &isnull);
+		uint32 value_hash = 0;
+
+		if (!isnull)
+			value_hash = DatumGetUInt32(FunctionCall1Coll(&partitioner->hash_procs[i],
+														  partitioner->collations[i],
+														  value));
+		hash = hash_combine(hash, value_hash);
+	}
+
+	return hash % npartitions;
+}
+
+/*
+ * The segment spool lives in a separate DSM segment, which is created by the
+ * leader before launching the workers and destroyed after they exit, so that
+ * the temporary files of the shared tuplestores are removed right away.
+ */
+struct SegmentSpoolShared
+{
+	SharedFileSet fileset;
+	/* The partitions can be read once all participants finished writing. */
+	Barrier barrier;
+	int nparticipants;
+	uint32 npartitions;
+	/* Followed by a SharedTuplestore per partition. */
+};
+
+#define SEGMENT_SPOOL_PHASE_WRITE 0
+
+static Size
+segment_spool_sts_size(int nparticipants)
+{
+	return MAXALIGN(sts_estimate(nparticipants));
+}
+
+static SharedTuplestore *
+segment_spool_get_sts(SegmentSpoolShared *shared, uint32 partition)
+{
+	return (SharedTuplestore *) ((char *) shared + MAXALIGN(sizeof(SegmentSpoolShared)) +
+								 partition * segment_spool_sts_size(shared->nparticipants));
+}
+
+/*
+ * Create the segment spool in the leader. The leader participates with the
+ * number after the workers.
+ */
+dsm_handle
+segment_spool_create(SegmentSpool *spool, int nparticipants, uint32 npartitions)
+{
+	Size size = add_size(MAXALIGN(sizeof(SegmentSpoolShared)),
+						 mul_size(npartitions, segment_spool_sts_size(nparticipants)));
+	dsm_segment *seg = dsm_create(size, 0);
+	SegmentSpoolShared *shared = dsm_segment_address(seg);
+
+	shared->nparticipants = nparticipants;
+	shared->npartitions = npartitions;
+	SharedFileSetInit(&shared->fileset, seg);
+	BarrierInit(&shared->barrier, 0);
+
+	*spool = (SegmentSpool){
+		.shared = shared,
+		.seg = seg,
+		.npartitions = npartitions,
+		.partitions = palloc(sizeof(SharedTuplestoreAccessor *) * npartitions),
+	};
+
+	for (uint32 i = 0; i < npartitions; i++)
+	{
+		char name[NAMEDATALEN];
+		snprintf(name, sizeof(name), "segment_spool_%u", i);
+		spool->partitions[i] = sts_initialize(segment_spool_get_sts(shared, i),
+											  nparticipants,
+											  /* my_participant_number = */ nparticipants - 1,
+											  /* meta_data_size = */ 0,
+											  SHARED_TUPLESTORE_SINGLE_PASS,
+											  &shared->fileset,
+											  name);
+	}
+
+	return dsm_segment_handle(seg);
+}
+
+/*
+ * Attach to the segment spool created by the leader, in a parallel worker.
+ */
+void
+segment_spool_attach(SegmentSpool *spool, dsm_handle handle)
+{
+	dsm_segment *seg = dsm_attach(handle);
+	if (seg == NULL)
+		ereport(ERROR,
+				(errcode(ERRCODE_OBJECT_NOT_IN_PREREQUISITE_STATE),
+				 errmsg("could not map dynamic shared memory segment")));
+
+	SegmentSpoolShared *shared = dsm_segment_address(seg);
+	SharedFileSetAttach(&shared->fileset, seg);
+
+	*spool = (SegmentSpool){
+		.shared = shared,
+		.seg = seg,
+		.npartitions = shared->npartitions,
+		.partitions = palloc(sizeof(SharedTuplestoreAccessor *) * shared->npartitions),
+	};
+
+	for (uint32 i = 0; i < shared->npartitions; i++)
+		spool->partitions[i] =
+			sts_attach(segment_spool_get_sts(shared, i), ParallelWorkerNumber, &shared->fileset);
+}
+
+/*
+ * Write the rows returned by this participant's part of the parallel scan into
+ * their partitions, and wait until the other participants have done the same.
+ *
+ * A worker that starts after the others have already finished the scan has
+ * nothing left to scan, because the parallel scan hands out every block only
+ * once, so it goes straight to reading the partitions.
+ */
+void
+segment_spool_fill(SegmentSpool *spool, TableScanDesc scan, SegmentPartitioner *partitioner)
+{
+	Barrier *barrier = &spool->shared->barrier;
+
+	if (BarrierAttach(barrier) == SEGMENT_SPOOL_PHASE_WRITE)
+	{
+		TupleTableSlot *slot = table_slot_create(scan->rs_rd, NULL);
+
+		while (table_scan_getnextslot(scan, ForwardScanDirection, slot))
+		{
+			bool should_free;
+			uint32 partition =
+				segment_partitioner_get_partition(partitioner, slot, spool->npartitions);
+			MinimalTuple tuple = ExecFetchSlotMinimalTuple(slot, &should_free);
+
+			sts_puttuple(spool->partitions[partition], NULL, tuple);
+
+			if (should_free)
+				heap_free_minimal_tuple(tuple);
+		}
+
+		ExecDropSingleTupleTableSlot(slot);
+
+		for (uint32 i = 0; i < spool->npartitions; i++)
+			sts_end_write(spool->partitions[i]);
+
+		BarrierArriveAndWait(barrier, PG_WAIT_EXTENSION);
+	}
+
+	BarrierDetach(barrier);
+}
+
+void
+segment_spool_detach(SegmentSpool *spool)
+{
+	dsm_detach(spool->seg);
+	pfree(spool->partitions);
+}
+
+/*
+ * Return the number of parallel workers to use for compressing the relation,
+ * or zero if the parallel compression is not possible.
+ */
+int
+compress_chunk_plan_parallel_workers(CompressionSettings *settings, Relation in_rel)
+{
+	SegmentPartitioner partitioner;
+
+	if (ts_guc_compression_parallel_workers == 0 || max_parallel_maintenance_workers == 0)
+		return 0;
+
+	/* Same restrictions as for the parallel index builds. */
+	if (!IsUnderPostmaster || IsInParallelMode() ||
+		in_rel->rd_rel->relpersistence == RELPERSISTENCE_TEMP)
+		return 0;
+
+	/* Hypercore has to skip the compressed data, which the workers don't do. */
+	if (REL_IS_HYPERCORE(in_rel))
+		return 0;
+
+	/* Same threshold as for the parallel scans. */
+	if (RelationGetNumberOfBlocks(in_rel) < (BlockNumber) min_parallel_table_scan_size)
+		return 0;
+
+	if (!segment_partitioner_init(&partitioner, settings, in_rel))
+		return 0;
+
+	return Min(ts_guc_compression_parallel_workers, max_parallel_maintenance_workers);
+}
+
+/*
+ * Compress the sorted rows of a partition. The segments of the different
+ * partitions are unrelated, so the row compressor starts over. The command id
+ * is not used because the parallel participants don't insert.
+ */
+static void
+compress_chunk_parallel_compress_sorted(RowCompressor *row_compressor,
+										Tuplesortstate *sorted_rel, TupleTableSlot *sorted_slot)
+{
+	tuplesort_performsort(sorted_rel);
+
+	row_compressor_reset(row_compressor);
+	while (tuplesort_gettupleslot(sorted_rel,
+								  true /*=forward*/,
+								  false /*=copy*/,
+								  sorted_slot,
+								  NULL /*=abbrev*/))
+	{
+		row_compressor_process_ordered_slot(row_compressor, sorted_slot, InvalidCommandId);
+	}
+
+	if (row_compressor->rows_compressed_into_current_value > 0)
+		row_compressor_flush(row_compressor, InvalidCommandId, true);
+
+	tuplesort_end(sorted_rel);
+}
+
+/*
+ * Scan this participant's part of the relation into the segment spool, then
+ * compress the partitions claimed by this participant and write the
+ * compressed tuples to the shared tuplestore.
+ */
+static void
+compress_chunk_parallel_participate(CompressChunkParallelShared *shared,
+									ParallelTableScanDesc pscan, SegmentSpool *spool,
+									CompressionSettings *settings, Relation in_rel,
+									Relation out_rel, SharedTuplestoreAccessor *output)
+{
+	SegmentPartitioner partitioner;
+	RowCompressor row_compressor;
+	uint32 partition;
+
+	if (!segment_partitioner_init(&partitioner, settings, in_rel))
+		elog(ERROR,
+			 "cannot partition \"%s\" for parallel compression",
+			 RelationGetRelationName(in_rel));
+
+	row_compressor_init(settings,
+						&row_compressor,
+						in_rel,
+						out_rel,
+						RelationGetDescr(out_rel)->natts,
+						false /*need_bistate*/,
+						0 /*insert_options*/);
+	row_compressor.parallel_output = output;
+
+	TupleTableSlot *sorted_slot = MakeTupleTableSlot(RelationGetDescr(in_rel), &TTSOpsMinimalTuple);
+	TableScanDesc scan = table_beginscan_parallel(in_rel, pscan);
+
+	if (shared->npartitions == 1)
+	{
+		/* The leader is alone, so it can sort the rows without spooling them. */
+		TupleTableSlot *scan_slot = table_slot_create(in_rel, NULL);
+		Tuplesortstate *sorted_rel =
+			compression_create_tuplesort_state_with_mem(settings, in_rel, shared->sort_mem);
+
+		while (table_scan_getnextslot(scan, ForwardScanDirection, scan_slot))
+			tuplesort_puttupleslot(sorted_rel, scan_slot);
+
+		table_endscan(scan);
+		ExecDropSingleTupleTableSlot(scan_slot);
+		compress_chunk_parallel_compress_sorted(&row_compressor, sorted_rel, sorted_slot);
+	}
+	else
+	{
+		segment_spool_fill(spool, scan, &partitioner);
+		table_endscan(scan);
+
+		while ((partition = pg_atomic_fetch_add_u32(&shared->next_partition, 1)) <
+			   shared->npartitions)
+		{
+			SharedTuplestoreAccessor *input = spool->partitions[partition];
+			Tuplesortstate *sorted_rel =
+				compression_create_tuplesort_state_with_mem(settings, in_rel, shared->sort_mem);
+			MinimalTuple tuple;
+
+			sts_begin_parallel_scan(input);
+			while ((tuple = sts_parallel_scan_next(input, NULL)) != NULL)
+			{
+				ExecStoreMinimalTuple(tuple, sorted_slot, false);
+				tuplesort_puttupleslot(sorted_rel, sorted_slot);
+			}
+			sts_end_parallel_scan(input);
+
+			compress_chunk_parallel_compress_sorted(&row_compressor, sorted_rel, sorted_slot);
+		}
+	}
+
+	pg_atomic_fetch_add_u64(&shared->rowcnt_pre_compression,
+							row_compressor.rowcnt_pre_compression);
+
+	ExecDropSingleTupleTableSlot(sorted_slot);
+	row_compressor_close(&row_compressor);
+}
+
+/*
+ * Entry point of the parallel compression workers.
+ */
+PGDLLEXPORT void compress_chunk_parallel_worker_main(dsm_segment *seg, shm_toc *toc);
+
+void
+compress_chunk_parallel_worker_main(dsm_segment *seg, shm_toc *toc)
+{
+	CompressChunkParallelShared *shared =
+		shm_toc_lookup(toc, PARALLEL_KEY_COMPRESS_CHUNK_SHARED, false);
+	ParallelTableScanDesc pscan = shm_toc_lookup(toc, PARALLEL_KEY_COMPRESS_CHUNK_SCAN, false);
+
+	/* The leader holds the stronger locks, we are in its lock group. */
+	Relation in_rel = table_open(shared->in_relid, AccessShareLock);
+	Relation out_rel = table_open(shared->out_relid, AccessShareLock);
+	CompressionSettings *settings = ts_compression_settings_get(shared->out_relid);
+
+	dsm_segment *output_seg = dsm_attach(shared->output_handle);
+	if (output_seg == NULL)
+		ereport(ERROR,
+				(errcode(ERRCODE_OBJECT_NOT_IN_PREREQUISITE_STATE),
+				 errmsg("could not map dynamic shared memory segment")));
+
+	CompressChunkParallelOutput *output = dsm_segment_address(output_seg);
+	SharedFileSetAttach(&output->fileset, output_seg);
+	SharedTuplestoreAccessor *accessor = sts_attach(COMPRESS_CHUNK_PARALLEL_OUTPUT_STS(output),
+													ParallelWorkerNumber,
+													&output->fileset);
+
+	SegmentSpool spool;
+	segment_spool_attach(&spool, shared->spool_handle);
+
+	compress_chunk_parallel_participate(shared,
+										pscan,
+										&spool,
+										settings,
+										in_rel,
+										out_rel,
+										accessor);
+
+	sts_end_write(accessor);
+	segment_spool_detach(&spool);
+	dsm_detach(output_seg);
+
+	table_close(out_rel, AccessShareLock);
+	table_close(in_rel, AccessShareLock);
+}
+
+static void
+compress_chunk_parallel(CompressionSettings *settings, Relation in_rel, Relation out_rel,
+						RowCompressor *row_compressor, CommandId mycid, int nworkers)
+{
+	const int nparticipants = nworkers + 1;
+	Snapshot snapshot = RegisterSnapshot(GetLatestSnapshot());
+
+	/* The leader participates with the number after the workers. */
+	Size output_size =
+		add_size(MAXALIGN(sizeof(CompressChunkParallelOutput)), sts_estimate(nparticipants));
+	dsm_segment *output_seg = dsm_create(output_size, 0);
+	CompressChunkParallelOutput *output = dsm_segment_address(output_seg);
+	SharedFileSetInit(&output->fileset, output_seg);
+	SharedTuplestoreAccessor *accessor = sts_initialize(COMPRESS_CHUNK_PARALLEL_OUTPUT_STS(output),
+														nparticipants,
+														/* my_participant_number = */ nworkers,
+														/* meta_data_size = */ 0,
+														SHARED_TUPLESTORE_SINGLE_PASS,
+														&output->fileset,
+														"compress_chunk");
+
+	SegmentSpool spool;
+	dsm_handle spool_handle = segment_spool_create(&spool, nparticipants, nparticipants);
+
+	EnterParallelMode();
+
+	/* The active snapshot is passed to the workers. */
+	PushActiveSnapshot(snapshot);
+
+	ParallelContext *pcxt =
+		CreateParallelContext(EXTENSION_TSL_SO, "compress_chunk_parallel_worker_main", nworkers);
+	Size pscan_size = table_parallelscan_estimate(in_rel, snapshot);
+	shm_toc_estimate_chunk(&pcxt->estimator, sizeof(CompressChunkParallelShared));
+	shm_toc_estimate_chunk(&pcxt->estimator, pscan_size);
+	shm_toc_estimate_keys(&pcxt->estimator, 2);
+	InitializeParallelDSM(pcxt);
+
+	CompressChunkParallelShared *shared =
+		shm_toc_allocate(pcxt->toc, sizeof(CompressChunkParallelShared));
+	*shared = (CompressChunkParallelShared){
+		.in_relid = RelationGetRelid(in_rel),
+		.out_relid = RelationGetRelid(out_rel),
+		.output_handle = dsm_segment_handle(output_seg),
+		.spool_handle = spool_handle,
+		.sort_mem = Max(maintenance_work_mem / nparticipants, 64),
+		.npartitions = nparticipants,
+	};
+	pg_atomic_init_u32(&shared->next_partition, 0);
+	pg_atomic_init_u64(&shared->rowcnt_pre_compression, 0);
+	shm_toc_insert(pcxt->toc, PARALLEL_KEY_COMPRESS_CHUNK_SHARED, shared);
+
+	ParallelTableScanDesc pscan = shm_toc_allocate(pcxt->toc, pscan_size);
+	table_parallelscan_initialize(in_rel, pscan, snapshot);
+	shm_toc_insert(pcxt->toc, PARALLEL_KEY_COMPRESS_CHUNK_SCAN, pscan);
+
+	LaunchParallelWorkers(pcxt);
+
+	/*
+	 * If no workers were launched, nobody else looks at the partitions, so
+	 * don't spool the rows for nothing.
+	 */
+	if (pcxt->nworkers_launched == 0)
+		shared->npartitions = 1;
+
+	elog(DEBUG1,
+		 "launched %d parallel workers to compress \"%s\"",
+		 pcxt->nworkers_launched,
+		 RelationGetRelationName(in_rel));
+
+	compress_chunk_parallel_participate(shared, pscan, &spool, settings, in_rel, out_rel, accessor);
+	sts_end_write(accessor);
+
+	WaitForParallelWorkersToFinish(pcxt);
+	int64 rowcnt_pre_compression = pg_atomic_read_u64(&shared->rowcnt_pre_compression);
+
+	DestroyParallelContext(pcxt);
+	PopActiveSnapshot();
+	ExitParallelMode();
+
+	/* This removes the spooled rows. */
+	segment_spool_detach(&spool);
+
+	/* Insert the compressed tuples produced by all participants. */
+	row_compressor_insert_parallel_output(row_compressor, accessor, mycid);
+
+	row_compressor->rowcnt_pre_compression += rowcnt_pre_compression;
+
+	dsm_detach(output_seg);
+	UnregisterSnapshot(snapshot);
+}
+
 Tuplesortstate *
 compression_create_tuplesort_state(CompressionSettings *settings, Relation rel)
+{
+	return compression_create_tuplesort_state_with_mem(settings, rel, maintenance_work_mem);
+}
+
+static Tuplesortstate *
+compression_create_tuplesort_state_with_mem(CompressionSettings *settings, Relation rel,
+											int sort_mem)
 {
 	TupleDesc tupdesc = RelationGetDescr(rel);
 	int num_segmentby = ts_array_length(settings->fd.segmentby);
@@ -565,7 +1437,7 @@ compression_create_tuplesort_state(CompressionSettings *settings, Relation rel)
 								sort_operators,
 								sort_collations,
 								nulls_first,
-								maintenance_work_mem,
+								sort_mem,
 								NULL,
 								false /*=randomAccess*/);
 }
@@ -801,6 +1673,10 @@ row_compressor_init(CompressionSettings *settings, RowCompressor *row_compressor
 			 "missing metadata column '%s' in compressed table",
 			 COMPRESSION_COLUMN_METADATA_COUNT_NAME);
 
+	/* the batch size of the compression settings, if set */
+	uint32 batch_size =
+		settings->fd.batch_size > 0 ? settings->fd.batch_size : TARGET_COMPRESSED_BATCH_SIZE;
+
 	*row_compressor = (RowCompressor){
 		.per_row_ctx = AllocSetContextCreate(CurrentMemoryContext,
 											 "compress chunk per-row",
@@ -813,6 +1689,9 @@ row_compressor_init(CompressionSettings *settings, RowCompressor *row_compressor
 		.compressed_values = palloc(sizeof(Datum) * num_columns_in_compressed_table),
 		.compressed_is_null = palloc(sizeof(bool) * num_columns_in_compressed_table),
 		.rows_compressed_into_current_value = 0,
+		.max_rows_per_batch = batch_size,
+		.rows_per_batch = batch_size,
+		.target_batch_bytes = settings->fd.batch_target_size,
 		.rowcnt_pre_compression = 0,
 		.num_compressed_rows = 0,
 		.first_iteration = true,
@@ -834,7 +1713,7 @@ void
 row_compressor_append_sorted_rows(RowCompressor *row_compressor, Tuplesortstate *sorted_rel,
 								  TupleDesc sorted_desc, Relation in_rel)
 {
-	CommandId mycid = GetCurrentCommandId(true);
+	CommandId mycid = row_compressor_command_id(row_compressor);
 	TupleTableSlot *slot = MakeTupleTableSlot(sorted_desc, &TTSOpsMinimalTuple);
 	bool got_tuple;
 	int64 nrows_processed = 0;
@@ -872,6 +1751,33 @@ row_compressor_append_sorted_rows(RowCompressor *row_compressor, Tuplesortstate
 	ExecDropSingleTupleTableSlot(slot);
 }
 
+/*
+ * Append a single row, for callers that produce the rows in the order of
+ * row_compressor_append_sorted_rows() themselves. The last batch is written
+ * by row_compressor_finish_ordered_rows().
+ */
+void
+row_compressor_append_ordered_slot(RowCompressor *row_compressor, TupleTableSlot *slot)
+{
+	row_compressor_process_ordered_slot(row_compressor,
+										slot,
+										row_compressor_command_id(row_compressor));
+}
+
+void
+row_compressor_finish_ordered_rows(RowCompressor *row_compressor)
+{
+	if (row_compressor->rows_compressed_into_current_value > 0)
+		row_compressor_flush(row_compressor, row_compressor_command_id(row_compressor), true);
+}
+
+static CommandId
+row_compressor_command_id(RowCompressor *row_compressor)
+{
+	/* The parallel participants don't insert, and can't use a command id. */
+	return row_compressor->parallel_output != NULL ? InvalidCommandId : GetCurrentCommandId(true);
+}
+
 static void
 row_compressor_process_ordered_slot(RowCompressor *row_compressor, TupleTableSlot *slot,
 									CommandId mycid)
@@ -886,7 +1792,7 @@ row_compressor_process_ordered_slot(RowCompressor *row_compressor, TupleTableSlo
 	}
 	bool changed_groups = row_compressor_new_row_is_in_new_group(row_compressor, slot);
 	bool compressed_row_is_full =
-		row_compressor->rows_compressed_into_current_value >= TARGET_COMPRESSED_BATCH_SIZE;
+		row_compressor->rows_compressed_into_current_value >= row_compressor->rows_per_batch;
 	if (compressed_row_is_full || changed_groups)
 	{
 		if (row_compressor->rows_compressed_into_current_value > 0)
@@ -993,6 +1899,32 @@ row_compressor_append_row(RowCompressor *row_compressor, TupleTableSlot *row)
 	row_compressor->rows_compressed_into_current_value += 1;
 }
 
+/*
+ * Adapt the number of rows of the next batch so that the compressed batch
+ * reaches the target size, based on the size per row of the batch that was
+ * just compressed. The size of the compressed values is a good predictor for
+ * the next batch of the same segment, since the data is sorted. At the start of
+ * a new segment, we start again from the configured batch size.
+ */
+static void
+row_compressor_adapt_batch_size(RowCompressor *row_compressor, Size batch_bytes,
+								bool changed_groups)
+{
+	if (changed_groups)
+	{
+		row_compressor->rows_per_batch = row_compressor->max_rows_per_batch;
+		return;
+	}
+
+	double bytes_per_row =
+		(double) batch_bytes / row_compressor->rows_compressed_into_current_value;
+	double rows = row_compressor->target_batch_bytes / Max(bytes_per_row, 1.0);
+
+	rows = Max(rows, Min(MIN_ADAPTIVE_BATCH_SIZE, row_compressor->max_rows_per_batch));
+	rows = Min(rows, row_compressor->max_rows_per_batch);
+	row_compressor->rows_per_batch = (uint32) rows;
+}
+
 static void
 row_compressor_flush(RowCompressor *row_compressor, CommandId mycid, bool changed_groups)
 {
@@ -1062,15 +1994,18 @@ row_compressor_flush(RowCompressor *row_compressor, CommandId mycid, bool change
 	compressed_tuple = heap_form_tuple(RelationGetDescr(row_compressor->compressed_table),
 									   row_compressor->compressed_values,
 									   row_compressor->compressed_is_null);
-	Assert(row_compressor->bistate != NULL);
-	heap_insert(row_compressor->compressed_table,
-				compressed_tuple,
-				mycid,
-				row_compressor->insert_options /*=options*/,
-				row_compressor->bistate);
-	if (row_compressor->resultRelInfo->ri_NumIndices > 0)
+
+	if (row_compressor->target_batch_bytes > 0)
+		row_compressor_adapt_batch_size(row_compressor, compressed_tuple->t_len, changed_groups);
+	if (row_compressor->parallel_output != NULL)
 	{
-		ts_catalog_index_insert(row_compressor->resultRelInfo, compressed_tuple);
+		MinimalTuple minimal_tuple = minimal_tuple_from_heap_tuple(compressed_tuple);
+		sts_puttuple(row_compressor->parallel_output, NULL, minimal_tuple);
+		pfree(minimal_tuple);
+	}
+	else
+	{
+		row_compressor_insert_compressed_tuple(row_compressor, compressed_tuple, mycid);
 	}
 
 	heap_freetuple(compressed_tuple);
@@ -1127,10 +2062,48 @@ row_compressor_flush(RowCompressor *row_compressor, CommandId mycid, bool change
 	MemoryContextReset(row_compressor->per_row_ctx);
 }
 
+/*
+ * Insert the compressed tuples that the parallel participants wrote into the
+ * shared tuplestore, after the parallel operation is finished.
+ */
+void
+row_compressor_insert_parallel_output(RowCompressor *row_compressor,
+									  SharedTuplestoreAccessor *accessor, CommandId mycid)
+{
+	MinimalTuple minimal_tuple;
+
+	sts_begin_parallel_scan(accessor);
+	while ((minimal_tuple = sts_parallel_scan_next(accessor, NULL)) != NULL)
+	{
+		HeapTuple compressed_tuple = heap_tuple_from_minimal_tuple(minimal_tuple);
+		row_compressor_insert_compressed_tuple(row_compressor, compressed_tuple, mycid);
+		heap_freetuple(compressed_tuple);
+		row_compressor->num_compressed_rows++;
+	}
+	sts_end_parallel_scan(accessor);
+}
+
+static void
+row_compressor_insert_compressed_tuple(RowCompressor *row_compressor, HeapTuple compressed_tuple,
+									   CommandId mycid)
+{
+	Assert(row_compressor->bistate != NULL);
+	heap_insert(row_compressor->compressed_table,
+				compressed_tuple,
+				mycid,
+				row_compressor->insert_options /*=options*/,
+				row_compressor->bistate);
+	if (row_compressor->resultRelInfo->ri_NumIndices > 0)
+	{
+		ts_catalog_index_insert(row_compressor->resultRelInfo, compressed_tuple);
+	}
+}
+
 void
 row_compressor_reset(RowCompressor *row_compressor)
 {
 	row_compressor->first_iteration = true;
+	row_compressor->rows_per_batch = row_compressor->max_rows_per_batch;
 }
 
 void
@@ -1249,6 +2222,7 @@ build_decompressor(Relation in_rel, Relation out_rel)
 
 		.decompressed_slots =
 			(TupleTableSlot **) palloc0(sizeof(void *) * TARGET_COMPRESSED_BATCH_SIZE),
+		.num_decompressed_slots = TARGET_COMPRESSED_BATCH_SIZE,
 	};
 
 	create_per_compressed_column(&decompressor);
@@ -1473,6 +2447,20 @@ decompress_batch(RowDecompressor *decompressor)
 	CheckCompressedData(n_batch_rows > 0);
 	CheckCompressedData(n_batch_rows <= GLOBAL_MAX_ROWS_PER_COMPRESSION);
 
+	/*
+	 * The batches can be larger than the default batch size if they were
+	 * compressed with a larger timescaledb.compress_batch_size.
+	 */
+	if (n_batch_rows > decompressor->num_decompressed_slots)
+	{
+		decompressor->decompressed_slots =
+			repalloc(decompressor->decompressed_slots, sizeof(void *) * n_batch_rows);
+		memset(&decompressor->decompressed_slots[decompressor->num_decompressed_slots],
+			   0,
+			   sizeof(void *) * (n_batch_rows - decompressor->num_decompressed_slots));
+		decompressor->num_decompressed_slots = n_batch_rows;
+	}
+
 	/*
 	 * Decompress all compressed columns for each row of the batch.
 	 */
@@ -1827,6 +2815,12 @@ tsl_compressed_data_info(PG_FUNCTION_ARGS)
 		case COMPRESSION_ALGORITHM_DELTADELTA:
 			has_nulls = deltadelta_compressed_has_nulls(header);
 			break;
+		case COMPRESSION_ALGORITHM_BOOL:
+			has_nulls = bool_compressed_has_nulls(header);
+			break;
+		case COMPRESSION_ALGORITHM_UUID:
+			has_nulls = uuid_compressed_has_nulls(header);
+			break;
 		case COMPRESSION_ALGORITHM_ARRAY:
 			has_nulls = array_compressed_has_nulls(header);
 			break;
@@ -1884,6 +2878,18 @@ compression_get_default_algorithm(Oid typeoid)
 		case NUMERICOID:
 			return COMPRESSION_ALGORITHM_ARRAY;
 
+		case BOOLOID:
+			if (ts_guc_enable_bool_compression)
+				return COMPRESSION_ALGORITHM_BOOL;
+			else
+				return COMPRESSION_ALGORITHM_DICTIONARY;
+
+		case UUIDOID:
+			if (ts_guc_enable_uuid_compression)
+				return COMPRESSION_ALGORITHM_UUID;
+			else
+				return COMPRESSION_ALGORITHM_DICTIONARY;
+
 		default:
 		{
 			/* use dictionary if possible, otherwise use array */
@@ -6,16 +6,19 @@
 #pragma once
 
 #include <postgres.h>
+#include <access/tableam.h>
 #include <catalog/indexing.h>
 #include <executor/tuptable.h>
 #include <fmgr.h>
 #include <lib/stringinfo.h>
 #include <nodes/execnodes.h>
+#include <storage/dsm.h>
 #include <utils/relcache.h>
 
 typedef struct BulkInsertStateData *BulkInsertState;
 
 #include "compat/compat.h"
+#include "guc.h"
 #include "hypertable.h"
 #include "nodes/decompress_chunk/detoaster.h"
 #include "segment_meta.h"
@@ -34,6 +37,8 @@ typedef struct BulkInsertStateData *BulkInsertState;
 	uint8 compression_algorithm
 
 #define TARGET_COMPRESSED_BATCH_SIZE 1000
+/* Lower bound of the adaptive batch size, see row_compressor_adapt_batch_size */
+#define MIN_ADAPTIVE_BATCH_SIZE 100
 
 typedef struct CompressedDataHeader
 {
@@ -151,6 +156,7 @@ typedef struct RowDecompressor
 	int64 batches_deleted;
 
 	TupleTableSlot **decompressed_slots;
+	int num_decompressed_slots;
 	int unprocessed_tuples;
 
 	Detoaster detoaster;
@@ -193,6 +199,8 @@ typedef enum CompressionAlgorithm
 	COMPRESSION_ALGORITHM_DICTIONARY,
 	COMPRESSION_ALGORITHM_GORILLA,
 	COMPRESSION_ALGORITHM_DELTADELTA,
+	COMPRESSION_ALGORITHM_BOOL,
+	COMPRESSION_ALGORITHM_UUID,
 
 	/* When adding an algorithm also add a static assert statement below */
 	/* end of real values */
@@ -254,6 +262,12 @@ typedef struct RowCompressor
 
 	/* the number of uncompressed rows compressed into the current compressed row */
 	uint32 rows_compressed_into_current_value;
+	/* the maximum number of rows in a compressed batch */
+	uint32 max_rows_per_batch;
+	/* the number of rows in the next batch, adapted to target_batch_bytes if set */
+	uint32 rows_per_batch;
+	/* target size of a compressed batch for the adaptive batch size, or 0 */
+	int64 target_batch_bytes;
 	/* a unique monotonically increasing (according to order by) id for each compressed row */
 	int32 sequence_num;
 
@@ -270,6 +284,11 @@ typedef struct RowCompressor
 	/* Callback called on every flush. The ntuples argument is the number of
 	 * tuples flushed. Typically used for progress reporting. */
 	void (*on_flush)(struct RowCompressor *rowcompress, uint64 ntuples);
+
+	/* If set, the compressed tuples are written here instead of being
+	 * inserted into the compressed table. Used by the parallel compression
+	 * workers, which are not allowed to insert. */
+	struct SharedTuplestoreAccessor *parallel_output;
 } RowCompressor;
 
 /*
@@ -316,19 +335,23 @@ pg_attribute_unused() assert_num_compression_algorithms_sane(void)
 	StaticAssertStmt(COMPRESSION_ALGORITHM_DICTIONARY == 2, "algorithm index has changed");
 	StaticAssertStmt(COMPRESSION_ALGORITHM_GORILLA == 3, "algorithm index has changed");
 	StaticAssertStmt(COMPRESSION_ALGORITHM_DELTADELTA == 4, "algorithm index has changed");
+	StaticAssertStmt(COMPRESSION_ALGORITHM_BOOL == 5, "algorithm index has changed");
+	StaticAssertStmt(COMPRESSION_ALGORITHM_UUID == 6, "algorithm index has changed");
 
 	/*
 	 * This should change when adding a new algorithm after adding the new
 	 * algorithm to the assert list above. This statement prevents adding a
 	 * new algorithm without updating the asserts above
 	 */
-	StaticAssertStmt(_END_COMPRESSION_ALGORITHMS == 5,
+	StaticAssertStmt(_END_COMPRESSION_ALGORITHMS == 7,
 					 "number of algorithms have changed, the asserts should be updated");
 }
 
 extern Name compression_get_algorithm_name(CompressionAlgorithm alg);
 extern CompressionStorage compression_get_toast_storage(CompressionAlgorithm algo);
 extern CompressionAlgorithm compression_get_default_algorithm(Oid typeoid);
+extern Compressor *adaptive_compressor_for_type(Oid type,
+												CompressionAlgorithmSelection selection);
 
 extern CompressionStats compress_chunk(Oid in_table, Oid out_table, int insert_options);
 extern void decompress_chunk(Oid in_table, Oid out_table);
@@ -338,10 +361,16 @@ extern DecompressionIterator *(*tsl_get_decompression_iterator_init(
 
 extern DecompressAllFunction tsl_get_decompress_all_function(CompressionAlgorithm algorithm,
 															 Oid type);
+extern bool tsl_bulk_decompression_possible(Oid typeoid);
 
 typedef struct Chunk Chunk;
 typedef struct ChunkInsertState ChunkInsertState;
-extern void decompress_batches_for_insert(const ChunkInsertState *cis, TupleTableSlot *slot);
+typedef struct CompressedInsertBuffer CompressedInsertBuffer;
+extern void decompress_batches_for_insert(ChunkInsertState *cis, TupleTableSlot *slot);
+extern CompressedInsertBuffer *compressed_insert_buffer_create(const ChunkInsertState *cis);
+extern void compressed_insert_buffer_add(CompressedInsertBuffer *buffer, TupleTableSlot *slot);
+extern void compressed_insert_buffer_flush(CompressedInsertBuffer *buffer);
+extern void compressed_insert_buffer_finish(CompressedInsertBuffer *buffer);
 typedef struct HypertableModifyState HypertableModifyState;
 extern bool decompress_target_segments(HypertableModifyState *ht_state);
 /* CompressSingleRowState methods */
@@ -372,8 +401,56 @@ extern void row_compressor_close(RowCompressor *row_compressor);
 extern void row_compressor_append_sorted_rows(RowCompressor *row_compressor,
 											  Tuplesortstate *sorted_rel, TupleDesc sorted_desc,
 											  Relation in_rel);
+extern void row_compressor_append_ordered_slot(RowCompressor *row_compressor,
+											  TupleTableSlot *slot);
+extern void row_compressor_finish_ordered_rows(RowCompressor *row_compressor);
+extern void row_compressor_insert_parallel_output(RowCompressor *row_compressor,
+												  struct SharedTuplestoreAccessor *accessor,
+												  CommandId mycid);
 extern Oid get_compressed_chunk_index(ResultRelInfo *resultRelInfo, CompressionSettings *settings);
 
+/*
+ * Partitions the rows by the hash of their segmentby values, so that all rows
+ * of a segment end up in the same partition. Used to distribute the segments
+ * of a chunk over the parallel workers.
+ */
+typedef struct SegmentPartitioner
+{
+	int nkeys;
+	AttrNumber *attnos;
+	Oid *collations;
+	FmgrInfo *hash_procs;
+} SegmentPartitioner;
+
+extern bool segment_partitioner_init(SegmentPartitioner *partitioner,
+									 CompressionSettings *settings, Relation rel);
+extern uint32 segment_partitioner_get_partition(SegmentPartitioner *partitioner,
+												TupleTableSlot *slot, uint32 npartitions);
+extern int compress_chunk_plan_parallel_workers(CompressionSettings *settings, Relation in_rel);
+
+/*
+ * The rows of a relation split into the segment partitions, spooled into one
+ * shared tuplestore per partition. The parallel participants fill the spool
+ * together from a parallel scan, so that the relation is read only once, and
+ * then each of them reads back the partitions it claims.
+ */
+typedef struct SegmentSpoolShared SegmentSpoolShared;
+
+typedef struct SegmentSpool
+{
+	SegmentSpoolShared *shared;
+	dsm_segment *seg;
+	uint32 npartitions;
+	struct SharedTuplestoreAccessor **partitions;
+} SegmentSpool;
+
+extern dsm_handle segment_spool_create(SegmentSpool *spool, int nparticipants,
+									   uint32 npartitions);
+extern void segment_spool_attach(SegmentSpool *spool, dsm_handle handle);
+extern void segment_spool_fill(SegmentSpool *spool, TableScanDesc scan,
+							   SegmentPartitioner *partitioner);
+extern void segment_spool_detach(SegmentSpool *spool);
+
 extern void segment_info_update(SegmentInfo *segment_info, Datum val, bool is_null);
 
 extern RowDecompressor build_decompressor(Relation in_rel, Relation out_rel);
@@ -420,7 +497,10 @@ const CompressionAlgorithmDefinition *algorithm_definition(CompressionAlgorithm
 struct decompress_batches_stats
 {
 	int64 batches_deleted;
+	int64 batches_rewritten;
 	int64 batches_filtered;
 	int64 batches_decompressed;
 	int64 tuples_decompressed;
+	/* Rows deleted directly from the compressed chunk. */
+	int64 tuples_deleted;
 };
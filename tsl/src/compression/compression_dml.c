@@ -5,18 +5,22 @@
  */
 #include <postgres.h>
 #include <access/genam.h>
+#include <access/htup_details.h>
 #include <access/sdir.h>
 #include <access/tableam.h>
 #include <access/valid.h>
 #include <catalog/pg_am.h>
+#include <nodes/makefuncs.h>
 #include <nodes/nodeFuncs.h>
 #include <optimizer/optimizer.h>
 #include <parser/parse_coerce.h>
 #include <parser/parse_relation.h>
 #include <parser/parsetree.h>
+#include <utils/inval.h>
 #include <utils/lsyscache.h>
 #include <utils/relcache.h>
 #include <utils/snapmgr.h>
+#include <utils/tuplesort.h>
 #include <utils/typcache.h>
 
 #include <compat/compat.h>
@@ -28,16 +32,63 @@
 #include <indexing.h>
 #include <nodes/chunk_dispatch/chunk_dispatch.h>
 #include <nodes/chunk_dispatch/chunk_insert_state.h>
+#include <nodes/decompress_chunk/vector_quals.h>
 #include <nodes/hypertable_modify.h>
 #include <ts_catalog/array_utils.h>
 
+/*
+ * State for computing the vectorized filters of DML on the compressed batches,
+ * before decompressing them row by row.
+ */
+typedef struct BatchVectorQualState
+{
+	VectorQualState vqstate;
+
+	/* The uncompressed chunk attnos referenced by the vectorized quals. */
+	Bitmapset *attnos;
+
+	/*
+	 * Whether all predicates are vectorized, so the vectorized filter result
+	 * tells exactly which rows of the batch match.
+	 */
+	bool all_vectorized;
+
+	/* Arrow arrays for the current batch, indexed by uncompressed chunk attno. */
+	const ArrowArray **arrow_arrays;
+	bool *is_default_value;
+} BatchVectorQualState;
+
+/*
+ * The vectorized filters for the conflict checks of INSERT into a compressed
+ * chunk. They are built once per chunk insert state, and only the constants
+ * are updated for every inserted tuple.
+ */
+struct CompressedConflictFilter
+{
+	/* The vectorized equality quals on the key columns, or NULL. */
+	BatchVectorQualState *vector_quals;
+
+	/* The in-memory scankeys the quals were built from. */
+	int num_keys;
+	AttrNumber *key_attnos;
+	bool *key_isnull;
+
+	/* The constant of the qual of each scankey, NULL if not vectorized. */
+	Const **key_consts;
+
+	/* Whether the constants of all quals were found, so they can be reused. */
+	bool reusable;
+};
+
 static struct decompress_batches_stats
 decompress_batches_scan(Relation in_rel, Relation out_rel, Relation index_rel, Snapshot snapshot,
 						ScanKeyData *index_scankeys, int num_index_scankeys,
 						ScanKeyData *heap_scankeys, int num_heap_scankeys,
 						ScanKeyData *mem_scankeys, int num_mem_scankeys,
+						BatchVectorQualState *vector_quals,
 						tuple_filtering_constraints *constraints, bool *skip_current_tuple,
-						bool delete_only, Bitmapset *null_columns, List *is_nulls);
+						bool delete_only, CompressionSettings *rewrite_settings,
+						Bitmapset *null_columns, List *is_nulls);
 
 static bool batch_matches(RowDecompressor *decompressor, ScanKeyData *scankeys, int num_scankeys,
 						  tuple_filtering_constraints *constraints, bool *skip_current_tuple);
@@ -60,9 +111,29 @@ static bool key_column_is_null(tuple_filtering_constraints *constraints, Relatio
 static bool can_delete_without_decompression(HypertableModifyState *ht_state,
 											 CompressionSettings *settings, Chunk *chunk,
 											 List *predicates);
+static bool can_delete_rows_without_decompression(HypertableModifyState *ht_state,
+												  CompressionSettings *settings, Chunk *chunk,
+												  List *predicates);
+static bool delete_matching_rows_from_batch(RowDecompressor *decompressor,
+											RowCompressor *row_compressor,
+											Tuplesortstate *tuplesort, ScanKeyData *scankeys,
+											int num_scankeys, const uint64 *vector_qual_result,
+											int64 *tuples_deleted);
+static BatchVectorQualState *batch_vector_qual_init(Relation chunk_rel, Index scanrelid,
+													List *predicates);
+static List *build_vector_quals_from_mem_scankeys(Relation out_rel, Index rti,
+												  ScanKeyData *scankeys, int num_scankeys,
+												  bool *all_keys);
+static BatchVectorQualState *conflict_filter_get_vector_quals(ChunkInsertState *cis,
+															  ScanKeyData *scankeys,
+															  int num_scankeys);
+static void check_conflict(tuple_filtering_constraints *constraints, bool *skip_current_tuple);
+static bool batch_vector_qual_compute(BatchVectorQualState *bvqstate,
+									  RowDecompressor *decompressor,
+									  VectorQualSummary *summary);
 
 void
-decompress_batches_for_insert(const ChunkInsertState *cis, TupleTableSlot *slot)
+decompress_batches_for_insert(ChunkInsertState *cis, TupleTableSlot *slot)
 {
 	/*
 	 * This is supposed to be called with the actual tuple that is being
@@ -108,6 +179,7 @@ decompress_batches_for_insert(const ChunkInsertState *cis, TupleTableSlot *slot)
 	/* the scan keys used for in memory tests of the decompressed tuples */
 	int num_mem_scankeys = 0;
 	ScanKeyData *mem_scankeys = NULL;
+	BatchVectorQualState *vector_quals = NULL;
 	int num_index_scankeys = 0;
 	ScanKeyData *index_scankeys = NULL;
 	Relation index_rel = NULL;
@@ -124,6 +196,13 @@ decompress_batches_for_insert(const ChunkInsertState *cis, TupleTableSlot *slot)
 													slot,
 													&num_mem_scankeys);
 
+		/*
+		 * Probe the batches with the vectorized equality on the key columns,
+		 * so that only the key columns of the batches are decompressed when
+		 * looking for a conflict.
+		 */
+		vector_quals = conflict_filter_get_vector_quals(cis, mem_scankeys, num_mem_scankeys);
+
 		index_scankeys = build_index_scankeys_using_slot(cis->hypertable_relid,
 														 in_rel,
 														 out_rel,
@@ -182,9 +261,11 @@ decompress_batches_for_insert(const ChunkInsertState *cis, TupleTableSlot *slot)
 									num_heap_scankeys,
 									mem_scankeys,
 									num_mem_scankeys,
+									vector_quals,
 									constraints,
 									&skip_current_tuple,
 									false,
+									NULL,
 									null_columns, /* no null column check for non-segmentby
 											 columns */
 									NIL);
@@ -215,10 +296,15 @@ decompress_batches_for_insert(const ChunkInsertState *cis, TupleTableSlot *slot)
  *  4. Update catalog table to change status of moved chunk.
  *
  *  Returns true if it decompresses any data.
+ *
+ *  The compressed batches or rows can only be deleted directly when the
+ *  predicates are all the conditions that restrict the deleted rows of the
+ *  chunk, i.e. there are no joins, gating quals or TID quals.
  */
 static bool
 decompress_batches_for_update_delete(HypertableModifyState *ht_state, Chunk *chunk,
-									 List *predicates, EState *estate, bool has_joins)
+									 Index scanrelid, List *predicates, EState *estate,
+									 bool predicates_complete)
 {
 	/* process each chunk with its corresponding predicates */
 
@@ -240,11 +326,15 @@ decompress_batches_for_update_delete(HypertableModifyState *ht_state, Chunk *chu
 	struct decompress_batches_stats stats;
 	int num_mem_scankeys = 0;
 	ScanKeyData *mem_scankeys = NULL;
+	BatchVectorQualState *vector_quals = NULL;
 
 	comp_chunk = ts_chunk_get_by_id(chunk->fd.compressed_chunk_id, true);
 	CompressionSettings *settings = ts_compression_settings_get(comp_chunk->table_id);
-	bool delete_only = ht_state->mt->operation == CMD_DELETE && !has_joins &&
+	bool delete_only = ht_state->mt->operation == CMD_DELETE && predicates_complete &&
 					   can_delete_without_decompression(ht_state, settings, chunk, predicates);
+	bool delete_rows = !delete_only && ht_state->mt->operation == CMD_DELETE &&
+					   predicates_complete &&
+					   can_delete_rows_without_decompression(ht_state, settings, chunk, predicates);
 
 	process_predicates(chunk,
 					   settings,
@@ -277,6 +367,11 @@ decompress_batches_for_update_delete(HypertableModifyState *ht_state, Chunk *chu
 			build_index_scankeys(matching_index_rel, index_filters, &num_index_scankeys);
 	}
 
+	if (!delete_only)
+	{
+		vector_quals = batch_vector_qual_init(chunk_rel, scanrelid, predicates);
+	}
+
 	stats = decompress_batches_scan(comp_chunk_rel,
 									chunk_rel,
 									matching_index_rel,
@@ -287,9 +382,11 @@ decompress_batches_for_update_delete(HypertableModifyState *ht_state, Chunk *chu
 									num_scankeys,
 									mem_scankeys,
 									num_mem_scankeys,
+									vector_quals,
 									NULL,
 									NULL,
 									delete_only,
+									delete_rows ? settings : NULL,
 									null_columns,
 									is_null);
 
@@ -317,7 +414,11 @@ decompress_batches_for_update_delete(HypertableModifyState *ht_state, Chunk *chu
 		filter = lfirst(lc);
 		pfree(filter);
 	}
+	/* The rows deleted directly are not seen by ModifyTable, so count them here. */
+	estate->es_processed += stats.tuples_deleted;
+
 	ht_state->batches_deleted += stats.batches_deleted;
+	ht_state->batches_rewritten += stats.batches_rewritten;
 	ht_state->batches_filtered += stats.batches_filtered;
 	ht_state->batches_decompressed += stats.batches_decompressed;
 	ht_state->tuples_decompressed += stats.tuples_decompressed;
@@ -391,6 +492,14 @@ decompress_batch_endscan(DecompressBatchScanDesc scan)
  *  3.Delete this row from compressed chunk
  *  4.Insert decompressed rows to uncompressed chunk
  *
+ *  If vector_quals are given, they are computed on the bulk-decompressed
+ *  columns first, and the batches without matching rows are skipped without
+ *  decompressing them row by row.
+ *
+ *  If rewrite_settings is given, the rows matching the in-memory scankeys are
+ *  deleted from the batch and the remaining rows are compressed again into the
+ *  compressed chunk instead of step 4.
+ *
  *  Returns whether we decompressed anything.
  *
  */
@@ -399,12 +508,16 @@ decompress_batches_scan(Relation in_rel, Relation out_rel, Relation index_rel, S
 						ScanKeyData *index_scankeys, int num_index_scankeys,
 						ScanKeyData *heap_scankeys, int num_heap_scankeys,
 						ScanKeyData *mem_scankeys, int num_mem_scankeys,
+						BatchVectorQualState *vector_quals,
 						tuple_filtering_constraints *constraints, bool *skip_current_tuple,
-						bool delete_only, Bitmapset *null_columns, List *is_nulls)
+						bool delete_only, CompressionSettings *rewrite_settings,
+						Bitmapset *null_columns, List *is_nulls)
 {
 	HeapTuple compressed_tuple;
 	RowDecompressor decompressor;
 	bool decompressor_initialized = false;
+	RowCompressor row_compressor;
+	Tuplesortstate *tuplesort = NULL;
 	bool valid = false;
 	int num_scanned_rows = 0;
 	int num_filtered_rows = 0;
@@ -497,6 +610,19 @@ decompress_batches_scan(Relation in_rel, Relation out_rel, Relation index_rel, S
 			decompressor = build_decompressor(in_rel, out_rel);
 			decompressor.delete_only = delete_only;
 			decompressor_initialized = true;
+
+			if (rewrite_settings)
+			{
+				Assert(num_mem_scankeys > 0);
+				tuplesort = compression_create_tuplesort_state(rewrite_settings, out_rel);
+				row_compressor_init(rewrite_settings,
+									&row_compressor,
+									out_rel,
+									in_rel,
+									RelationGetDescr(in_rel)->natts,
+									true /*need_bistate*/,
+									0 /*insert options*/);
+			}
 		}
 
 		heap_deform_tuple(compressed_tuple,
@@ -504,11 +630,37 @@ decompress_batches_scan(Relation in_rel, Relation out_rel, Relation index_rel, S
 						  decompressor.compressed_datums,
 						  decompressor.compressed_is_nulls);
 
-		if (num_mem_scankeys && !batch_matches(&decompressor,
-											   mem_scankeys,
-											   num_mem_scankeys,
-											   constraints,
-											   skip_current_tuple))
+		const uint64 *vector_qual_result = NULL;
+		if (vector_quals)
+		{
+			VectorQualSummary vector_qual_summary;
+			if (batch_vector_qual_compute(vector_quals, &decompressor, &vector_qual_summary))
+			{
+				if (vector_qual_summary == NoRowsPass)
+				{
+					row_decompressor_reset(&decompressor);
+					stats.batches_filtered++;
+					continue;
+				}
+
+				/*
+				 * If all predicates are vectorized, the result says which rows
+				 * match, and we don't have to check the rows again.
+				 */
+				if (vector_quals->all_vectorized)
+				{
+					vector_qual_result = vector_quals->vqstate.vector_qual_result;
+					check_conflict(constraints, skip_current_tuple);
+				}
+			}
+		}
+
+		if (num_mem_scankeys && vector_qual_result == NULL &&
+			!batch_matches(&decompressor,
+						   mem_scankeys,
+						   num_mem_scankeys,
+						   constraints,
+						   skip_current_tuple))
 		{
 			row_decompressor_reset(&decompressor);
 			stats.batches_filtered++;
@@ -545,6 +697,21 @@ decompress_batches_scan(Relation in_rel, Relation out_rel, Relation index_rel, S
 		if (decompressor.delete_only)
 		{
 			stats.batches_deleted++;
+			stats.tuples_deleted += DatumGetInt32(
+				decompressor.compressed_datums[decompressor.count_compressed_attindex]);
+		}
+		else if (rewrite_settings)
+		{
+			if (delete_matching_rows_from_batch(&decompressor,
+												&row_compressor,
+												tuplesort,
+												mem_scankeys,
+												num_mem_scankeys,
+												vector_qual_result,
+												&stats.tuples_deleted))
+				stats.batches_rewritten++;
+			else
+				stats.batches_deleted++;
 		}
 		else
 		{
@@ -559,6 +726,11 @@ decompress_batches_scan(Relation in_rel, Relation out_rel, Relation index_rel, S
 	{
 		row_decompressor_close(&decompressor);
 	}
+	if (tuplesort)
+	{
+		row_compressor_close(&row_compressor);
+		tuplesort_end(tuplesort);
+	}
 
 	if (ts_guc_debug_compression_path_info)
 	{
@@ -603,27 +775,529 @@ batch_matches(RowDecompressor *decompressor, ScanKeyData *scankeys, int num_scan
 		valid = slot_keys_test(decompressed_slot, num_scankeys, scankeys);
 		if (valid)
 		{
-			if (constraints)
+			check_conflict(constraints, skip_current_tuple);
+			return true;
+		}
+	}
+
+	return false;
+}
+
+/*
+ * Handle a batch that has a row conflicting with the inserted tuple.
+ */
+static void
+check_conflict(tuple_filtering_constraints *constraints, bool *skip_current_tuple)
+{
+	if (constraints)
+	{
+		if (constraints->on_conflict == ONCONFLICT_NONE)
+		{
+			ereport(ERROR,
+					(errcode(ERRCODE_UNIQUE_VIOLATION),
+					 errmsg("duplicate key value violates unique constraint \"%s\"",
+							get_rel_name(constraints->index_relid))
+
+						 ));
+		}
+		if (constraints->on_conflict == ONCONFLICT_NOTHING && skip_current_tuple)
+		{
+			*skip_current_tuple = true;
+		}
+	}
+}
+
+/*
+ * VectorQualState->get_arrow_array() for the DML batch filtering.
+ * The arrays are prepared by batch_vector_qual_compute().
+ */
+static const ArrowArray *
+batch_vector_qual_get_arrow_array(VectorQualState *vqstate, Expr *expr, bool *is_default_value)
+{
+	BatchVectorQualState *bvqstate = (BatchVectorQualState *) vqstate;
+	const Var *var = castNode(Var, expr);
+
+	Ensure(bms_is_member(var->varattno, bvqstate->attnos),
+		   "column %d not found for vectorized filter",
+		   var->varattno);
+
+	*is_default_value = bvqstate->is_default_value[var->varattno];
+	return bvqstate->arrow_arrays[var->varattno];
+}
+
+static bool
+contain_param_walker(Node *node, void *context)
+{
+	if (node == NULL)
+		return false;
+
+	if (IsA(node, Param))
+		return true;
+
+	return expression_tree_walker(node, contain_param_walker, context);
+}
+
+/*
+ * Find the UPDATE/DELETE predicates that can be computed as vectorized filters
+ * on the compressed batches. This uses the same rules as the vectorized
+ * filters in DecompressChunk, except that the segmentby columns are also
+ * vectorized, so that the result tells exactly which rows match when all
+ * predicates are vectorized.
+ *
+ * Returns NULL if no predicates can be vectorized.
+ */
+static BatchVectorQualState *
+batch_vector_qual_init(Relation chunk_rel, Index scanrelid, List *predicates)
+{
+	if (!ts_guc_enable_bulk_decompression || !ts_guc_enable_dml_decompression_tuple_filtering)
+		return NULL;
+
+	TupleDesc tupdesc = RelationGetDescr(chunk_rel);
+	bool *vector_attrs = palloc0(sizeof(bool) * (tupdesc->natts + 1));
+	for (int i = 0; i < tupdesc->natts; i++)
+	{
+		Form_pg_attribute attr = TupleDescAttr(tupdesc, i);
+		if (attr->attisdropped)
+			continue;
+
+		vector_attrs[AttrOffsetGetAttrNumber(i)] = tsl_bulk_decompression_possible(attr->atttypid);
+	}
+
+	VectorQualInfo vqinfo = {
+		.rti = scanrelid,
+		.vector_attrs = vector_attrs,
+	};
+
+	/*
+	 * Constify the stable expressions the same way as process_predicates()
+	 * does, without the bound params.
+	 */
+	PlannerGlobal glob = { .boundParams = NULL };
+	PlannerInfo root = { .glob = &glob };
+
+	List *vectorized_quals = NIL;
+	bool all_vectorized = true;
+	ListCell *lc;
+	foreach (lc, predicates)
+	{
+		Node *constified = estimate_expression_value(&root, copyObject(lfirst(lc)));
+		Node *vectorized = vector_qual_make(constified, &vqinfo);
+
+		/*
+		 * We don't have the params here, so the arguments must be constants
+		 * already.
+		 */
+		if (vectorized == NULL || contain_param_walker(vectorized, NULL))
+		{
+			all_vectorized = false;
+			continue;
+		}
+
+		vectorized_quals = lappend(vectorized_quals, vectorized);
+	}
+
+	pfree(vector_attrs);
+
+	if (vectorized_quals == NIL)
+		return NULL;
+
+	BatchVectorQualState *bvqstate = palloc0(sizeof(BatchVectorQualState));
+	bvqstate->vqstate.vectorized_quals_constified = vectorized_quals;
+	bvqstate->vqstate.get_arrow_array = batch_vector_qual_get_arrow_array;
+	bvqstate->all_vectorized = all_vectorized;
+	bvqstate->arrow_arrays = palloc0(sizeof(ArrowArray *) * (tupdesc->natts + 1));
+	bvqstate->is_default_value = palloc0(sizeof(bool) * (tupdesc->natts + 1));
+
+	List *vars = pull_var_clause((Node *) vectorized_quals, 0);
+	foreach (lc, vars)
+	{
+		bvqstate->attnos = bms_add_member(bvqstate->attnos, castNode(Var, lfirst(lc))->varattno);
+	}
+
+	return bvqstate;
+}
+
+/*
+ * Build the equality quals on the key columns from the in-memory scankeys of
+ * INSERT, to probe the batches for conflicts with the vectorized filters.
+ *
+ * The scankeys with an operator that is not the default equality of the
+ * column type are skipped, all_keys tells whether there were any.
+ */
+static List *
+build_vector_quals_from_mem_scankeys(Relation out_rel, Index rti, ScanKeyData *scankeys,
+									 int num_scankeys, bool *all_keys)
+{
+	TupleDesc out_desc = RelationGetDescr(out_rel);
+	List *quals = NIL;
+
+	*all_keys = true;
+
+	for (int i = 0; i < num_scankeys; i++)
+	{
+		ScanKey key = &scankeys[i];
+		Form_pg_attribute attr = TupleDescAttr(out_desc, AttrNumberGetAttrOffset(key->sk_attno));
+		TypeCacheEntry *tce = lookup_type_cache(attr->atttypid, TYPECACHE_EQ_OPR);
+
+		if ((key->sk_flags & SK_ISNULL) || !OidIsValid(tce->eq_opr) ||
+			get_opcode(tce->eq_opr) != key->sk_func.fn_oid)
+		{
+			*all_keys = false;
+			continue;
+		}
+
+		Var *var = makeVar(rti,
+						   key->sk_attno,
+						   attr->atttypid,
+						   attr->atttypmod,
+						   attr->attcollation,
+						   0);
+		Const *value = makeConst(attr->atttypid,
+								 attr->atttypmod,
+								 attr->attcollation,
+								 attr->attlen,
+								 key->sk_argument,
+								 false,
+								 attr->attbyval);
+		quals = lappend(quals,
+						make_opclause(tce->eq_opr,
+									  BOOLOID,
+									  false,
+									  (Expr *) var,
+									  (Expr *) value,
+									  InvalidOid,
+									  key->sk_collation));
+	}
+
+	return quals;
+}
+
+/*
+ * Get the vectorized filters for the conflict checks of the tuple with the
+ * given in-memory scankeys.
+ *
+ * The filters are built for the first inserted tuple of the chunk insert
+ * state. For the next tuples, we only set the constants of the quals to the
+ * scankey arguments, which live as long as the scankeys. If the scankeys of a
+ * tuple have a different shape, e.g. because of a NULL key with NULLS NOT
+ * DISTINCT, the batches are checked row by row instead.
+ */
+static BatchVectorQualState *
+conflict_filter_get_vector_quals(ChunkInsertState *cis, ScanKeyData *scankeys, int num_scankeys)
+{
+	CompressedConflictFilter *filter = cis->conflict_filter;
+
+	if (filter == NULL)
+	{
+		MemoryContext old_mcxt = MemoryContextSwitchTo(cis->mctx);
+
+		filter = palloc0(sizeof(CompressedConflictFilter));
+		filter->num_keys = num_scankeys;
+		filter->key_attnos = palloc0(sizeof(AttrNumber) * (num_scankeys + 1));
+		filter->key_isnull = palloc0(sizeof(bool) * (num_scankeys + 1));
+		filter->key_consts = palloc0(sizeof(Const *) * (num_scankeys + 1));
+		for (int i = 0; i < num_scankeys; i++)
+		{
+			filter->key_attnos[i] = scankeys[i].sk_attno;
+			filter->key_isnull[i] = (scankeys[i].sk_flags & SK_ISNULL) != 0;
+		}
+
+		bool all_keys = false;
+		List *key_quals = build_vector_quals_from_mem_scankeys(cis->rel,
+															   /* rti = */ 1,
+															   scankeys,
+															   num_scankeys,
+															   &all_keys);
+		filter->vector_quals = batch_vector_qual_init(cis->rel, /* scanrelid = */ 1, key_quals);
+
+		if (filter->vector_quals)
+		{
+			if (!all_keys)
+				filter->vector_quals->all_vectorized = false;
+
+			/*
+			 * The vectorized quals are usually still "Var = Const" after the
+			 * constification, remember their constants to update them for the
+			 * next tuples. The constification can also simplify the boolean
+			 * equality, such quals can't be reused.
+			 */
+			filter->reusable = true;
+			ListCell *lc;
+			foreach (lc, filter->vector_quals->vqstate.vectorized_quals_constified)
 			{
-				if (constraints->on_conflict == ONCONFLICT_NONE)
+				OpExpr *opexpr = lfirst(lc);
+				if (!IsA(opexpr, OpExpr) || !IsA(linitial(opexpr->args), Var) ||
+					!IsA(lsecond(opexpr->args), Const))
 				{
-					ereport(ERROR,
-							(errcode(ERRCODE_UNIQUE_VIOLATION),
-							 errmsg("duplicate key value violates unique constraint \"%s\"",
-									get_rel_name(constraints->index_relid))
-
-								 ));
+					filter->reusable = false;
+					break;
 				}
-				if (constraints->on_conflict == ONCONFLICT_NOTHING && skip_current_tuple)
+
+				Var *var = linitial_node(Var, opexpr->args);
+				for (int i = 0; i < num_scankeys; i++)
 				{
-					*skip_current_tuple = true;
+					if (filter->key_attnos[i] == var->varattno && !filter->key_isnull[i])
+						filter->key_consts[i] = lsecond_node(Const, opexpr->args);
 				}
 			}
-			return true;
 		}
+
+		MemoryContextSwitchTo(old_mcxt);
+		cis->conflict_filter = filter;
+		return filter->vector_quals;
 	}
 
-	return false;
+	if (!filter->reusable || filter->num_keys != num_scankeys)
+		return NULL;
+
+	for (int i = 0; i < num_scankeys; i++)
+	{
+		if (filter->key_attnos[i] != scankeys[i].sk_attno ||
+			filter->key_isnull[i] != ((scankeys[i].sk_flags & SK_ISNULL) != 0))
+			return NULL;
+	}
+
+	for (int i = 0; i < num_scankeys; i++)
+	{
+		if (filter->key_consts[i] != NULL)
+			filter->key_consts[i]->constvalue = scankeys[i].sk_argument;
+	}
+
+	return filter->vector_quals;
+}
+
+/*
+ * Compute the vectorized filters for the current compressed tuple of the
+ * decompressor. Only the columns referenced by the filters are decompressed,
+ * using the bulk decompression. The results live in the per-row memory
+ * context of the decompressor until it is reset.
+ *
+ * Returns false if the filters can't be computed for this batch, because some
+ * column uses a compression algorithm without bulk decompression. Such a batch
+ * has to be checked row by row.
+ */
+static bool
+batch_vector_qual_compute(BatchVectorQualState *bvqstate, RowDecompressor *decompressor,
+						  VectorQualSummary *summary)
+{
+	const int n_batch_rows =
+		DatumGetInt32(decompressor->compressed_datums[decompressor->count_compressed_attindex]);
+	CheckCompressedData(n_batch_rows > 0);
+	CheckCompressedData(n_batch_rows <= GLOBAL_MAX_ROWS_PER_COMPRESSION);
+
+	MemoryContext old_ctx = MemoryContextSwitchTo(decompressor->per_compressed_row_ctx);
+
+	for (int input_column = 0; input_column < decompressor->num_compressed_columns; input_column++)
+	{
+		PerCompressedColumn *column_info = &decompressor->per_compressed_cols[input_column];
+		const int output_index = column_info->decompressed_column_offset;
+
+		/* Metadata column. */
+		if (output_index < 0)
+			continue;
+
+		const AttrNumber attno = AttrOffsetGetAttrNumber(output_index);
+		if (!bms_is_member(attno, bvqstate->attnos))
+			continue;
+
+		const Oid typeoid = column_info->decompressed_type;
+		bool isnull = decompressor->compressed_is_nulls[input_column];
+		Datum value = decompressor->compressed_datums[input_column];
+
+		if (column_info->is_compressed && !isnull)
+		{
+			Datum compressed_datum = PointerGetDatum(
+				detoaster_detoast_attr_copy((struct varlena *) DatumGetPointer(value),
+											&decompressor->detoaster,
+											CurrentMemoryContext));
+			CompressedDataHeader *header = (CompressedDataHeader *) DatumGetPointer(compressed_datum);
+			DecompressAllFunction decompress_all =
+				tsl_get_decompress_all_function(header->compression_algorithm, typeoid);
+			if (decompress_all == NULL)
+			{
+				MemoryContextSwitchTo(old_ctx);
+				return false;
+			}
+
+			ArrowArray *arrow = decompress_all(compressed_datum, typeoid, CurrentMemoryContext);
+			CheckCompressedData(arrow->length == n_batch_rows);
+			bvqstate->arrow_arrays[attno] = arrow;
+			bvqstate->is_default_value[attno] = false;
+			continue;
+		}
+
+		/*
+		 * Segmentby column or compressed column with default value, use the
+		 * same value for the entire batch.
+		 */
+		if (column_info->is_compressed)
+			value = getmissingattr(decompressor->out_desc, attno, &isnull);
+		else if (!isnull && typeoid == TEXTOID)
+			value = PointerGetDatum(pg_detoast_datum_packed((struct varlena *) DatumGetPointer(value)));
+
+		bvqstate->arrow_arrays[attno] = make_single_value_arrow(typeoid, value, isnull);
+		bvqstate->is_default_value[attno] = true;
+	}
+
+	bvqstate->vqstate.num_results = n_batch_rows;
+	bvqstate->vqstate.per_vector_mcxt = decompressor->per_compressed_row_ctx;
+	*summary = vector_qual_compute(&bvqstate->vqstate);
+
+	MemoryContextSwitchTo(old_ctx);
+	return true;
+}
+
+/*
+ * Delete the rows matching the scankeys from a batch that was already deleted
+ * from the compressed chunk, and compress the remaining rows into a new batch
+ * in the compressed chunk. This way a DELETE that affects only some rows of a
+ * batch doesn't have to move the rest of the batch into the uncompressed
+ * chunk.
+ *
+ * The remaining rows are a subset of the original batch, so the new batch has
+ * the same segmentby values and doesn't extend the orderby range of the
+ * original one.
+ *
+ * The matching rows are taken from the vectorized filter result if it is
+ * given, otherwise the rows are tested with the scankeys.
+ *
+ * Returns whether any rows remained in the batch.
+ */
+static bool
+delete_matching_rows_from_batch(RowDecompressor *decompressor, RowCompressor *row_compressor,
+								Tuplesortstate *tuplesort, ScanKeyData *scankeys, int num_scankeys,
+								const uint64 *vector_qual_result, int64 *tuples_deleted)
+{
+	int num_tuples = decompress_batch(decompressor);
+	bool rows_remain = false;
+
+	for (int row = 0; row < num_tuples; row++)
+	{
+		TupleTableSlot *decompressed_slot = decompressor->decompressed_slots[row];
+		const bool row_matches = vector_qual_result != NULL ?
+									 arrow_row_is_valid(vector_qual_result, row) :
+									 slot_keys_test(decompressed_slot, num_scankeys, scankeys);
+		if (row_matches)
+		{
+			(*tuples_deleted)++;
+			continue;
+		}
+
+		tuplesort_puttupleslot(tuplesort, decompressed_slot);
+		rows_remain = true;
+	}
+
+	if (rows_remain)
+	{
+		tuplesort_performsort(tuplesort);
+		row_compressor_reset(row_compressor);
+		row_compressor_append_sorted_rows(row_compressor,
+										  tuplesort,
+										  RelationGetDescr(decompressor->out_rel),
+										  decompressor->out_rel);
+		tuplesort_reset(tuplesort);
+	}
+
+	row_decompressor_reset(decompressor);
+
+	return rows_remain;
+}
+
+/*
+ * Direct compression of inserted tuples.
+ *
+ * The tuples inserted into a compressed chunk are collected in a tuplesort
+ * using the compression order, and are compressed into new batches of the
+ * compressed chunk at the end of the INSERT or COPY, before the AFTER
+ * triggers run, or when the chunk insert state is evicted. This avoids
+ * writing the tuples into the uncompressed chunk and compressing them again
+ * later.
+ */
+struct CompressedInsertBuffer
+{
+	Oid chunk_relid;
+	Oid compressed_chunk_relid;
+	CompressionSettings *settings;
+	Tuplesortstate *tuplesort;
+	int64 num_tuples;
+};
+
+CompressedInsertBuffer *
+compressed_insert_buffer_create(const ChunkInsertState *cis)
+{
+	MemoryContext oldcxt = MemoryContextSwitchTo(cis->mctx);
+	CompressedInsertBuffer *buffer = palloc0(sizeof(CompressedInsertBuffer));
+
+	buffer->chunk_relid = RelationGetRelid(cis->rel);
+	buffer->compressed_chunk_relid = cis->compressed_chunk_table_id;
+	buffer->settings = ts_compression_settings_get(cis->compressed_chunk_table_id);
+	Ensure(buffer->settings,
+		   "compression settings not found for chunk \"%s\"",
+		   get_rel_name(buffer->chunk_relid));
+	buffer->tuplesort = compression_create_tuplesort_state(buffer->settings, cis->rel);
+	MemoryContextSwitchTo(oldcxt);
+
+	return buffer;
+}
+
+void
+compressed_insert_buffer_add(CompressedInsertBuffer *buffer, TupleTableSlot *slot)
+{
+	tuplesort_puttupleslot(buffer->tuplesort, slot);
+	buffer->num_tuples++;
+}
+
+void
+compressed_insert_buffer_flush(CompressedInsertBuffer *buffer)
+{
+	if (buffer->num_tuples > 0)
+	{
+		/* The chunk is already locked by the chunk insert state */
+		Relation chunk_rel = table_open(buffer->chunk_relid, NoLock);
+		Relation compressed_rel = table_open(buffer->compressed_chunk_relid, RowExclusiveLock);
+		RowCompressor row_compressor;
+
+		tuplesort_performsort(buffer->tuplesort);
+		row_compressor_init(buffer->settings,
+							&row_compressor,
+							chunk_rel,
+							compressed_rel,
+							RelationGetDescr(compressed_rel)->natts,
+							true /*need_bistate*/,
+							0 /*insert options*/);
+		row_compressor_append_sorted_rows(&row_compressor,
+										  buffer->tuplesort,
+										  RelationGetDescr(chunk_rel),
+										  chunk_rel);
+		row_compressor_close(&row_compressor);
+
+		table_close(compressed_rel, NoLock);
+		table_close(chunk_rel, NoLock);
+
+		/*
+		 * The new batches overlap with the existing ones in the compression
+		 * order, so the chunk can no longer be scanned in order without
+		 * sorting.
+		 */
+		Chunk *chunk = ts_chunk_get_by_relid(buffer->chunk_relid, true);
+		if (!ts_chunk_is_unordered(chunk))
+		{
+			ts_chunk_set_unordered(chunk);
+			/* changed chunk status, so invalidate any plans involving this chunk */
+			CacheInvalidateRelcacheByRelid(buffer->chunk_relid);
+		}
+		CommandCounterIncrement();
+
+		tuplesort_reset(buffer->tuplesort);
+		buffer->num_tuples = 0;
+	}
+}
+
+void
+compressed_insert_buffer_finish(CompressedInsertBuffer *buffer)
+{
+	compressed_insert_buffer_flush(buffer);
+	tuplesort_end(buffer->tuplesort);
 }
 
 /*
@@ -639,6 +1313,8 @@ struct decompress_chunk_context
 	/* indicates decompression actually occurred */
 	bool batches_decompressed;
 	bool has_joins;
+	/* There are gating quals or other quals above the chunk scans. */
+	bool has_outer_quals;
 };
 
 static bool decompress_chunk_walker(PlanState *ps, struct decompress_chunk_context *ctx);
@@ -665,6 +1341,7 @@ decompress_chunk_walker(PlanState *ps, struct decompress_chunk_context *ctx)
 	RangeTblEntry *rte = NULL;
 	bool needs_decompression = false;
 	bool should_rescan = false;
+	bool predicates_complete = true;
 	bool batches_decompressed = false;
 	List *predicates = NIL;
 	Chunk *current_chunk;
@@ -698,6 +1375,8 @@ decompress_chunk_walker(PlanState *ps, struct decompress_chunk_context *ctx)
 		{
 			predicates = list_copy(ps->plan->qual);
 			needs_decompression = true;
+			/* The TID quals and the sampling don't show up in the predicates. */
+			predicates_complete = IsA(ps, SeqScanState);
 			break;
 		}
 		case T_NestLoopState:
@@ -707,7 +1386,16 @@ decompress_chunk_walker(PlanState *ps, struct decompress_chunk_context *ctx)
 			ctx->has_joins = true;
 			break;
 		}
+		case T_ResultState:
+		{
+			/* E.g. an uncorrelated EXISTS becomes a one-time gating qual. */
+			if (castNode(Result, ps->plan)->resconstantqual != NULL || ps->plan->qual != NIL)
+				ctx->has_outer_quals = true;
+			break;
+		}
 		default:
+			if (ps->plan->qual != NIL)
+				ctx->has_outer_quals = true;
 			break;
 	}
 	if (needs_decompression)
@@ -730,11 +1418,14 @@ decompress_chunk_walker(PlanState *ps, struct decompress_chunk_context *ctx)
 							 errmsg("UPDATE/DELETE is disabled on compressed chunks"),
 							 errhint("Set timescaledb.enable_dml_decompression to TRUE.")));
 
+				predicates_complete =
+					predicates_complete && !ctx->has_joins && !ctx->has_outer_quals;
 				batches_decompressed = decompress_batches_for_update_delete(ctx->ht_state,
 																			current_chunk,
+																			scanrelid,
 																			predicates,
 																			ps->state,
-																			ctx->has_joins);
+																			predicates_complete);
 				ctx->batches_decompressed |= batches_decompressed;
 
 				/* This is a workaround specifically for bitmap heap scans:
@@ -1445,3 +2136,74 @@ can_delete_without_decompression(HypertableModifyState *ht_state, CompressionSet
 	}
 	return true;
 }
+
+/*
+ * Check whether the rows can be deleted directly from the compressed batches,
+ * by compressing the rows not matching the predicates into a new batch.
+ *
+ * This requires all the predicates to be evaluated during the batch scan, so
+ * only comparisons of a column with a constant are supported, with at least
+ * one of them on a non-segmentby column. Otherwise the direct batch deletion
+ * applies.
+ */
+static bool
+can_delete_rows_without_decompression(HypertableModifyState *ht_state,
+									  CompressionSettings *settings, Chunk *chunk,
+									  List *predicates)
+{
+	ListCell *lc;
+	bool have_mem_predicates = false;
+
+	if (!ts_guc_enable_compressed_direct_row_delete ||
+		!ts_guc_enable_dml_decompression_tuple_filtering)
+		return false;
+
+	/*
+	 * The deleted rows are never materialized, so we can't support RETURNING
+	 * or DELETE row triggers.
+	 */
+	if (ht_state->mt->returningLists)
+		return false;
+
+	ModifyTableState *ps =
+		linitial_node(ModifyTableState, castNode(CustomScanState, ht_state)->custom_ps);
+	if (ps->rootResultRelInfo->ri_TrigDesc)
+	{
+		TriggerDesc *trigdesc = ps->rootResultRelInfo->ri_TrigDesc;
+		if (trigdesc->trig_delete_before_row || trigdesc->trig_delete_after_row ||
+			trigdesc->trig_delete_instead_row)
+		{
+			return false;
+		}
+	}
+
+	foreach (lc, predicates)
+	{
+		Node *node = lfirst(lc);
+		Var *var;
+		Expr *arg_value;
+		Oid opno;
+
+		if (!IsA(node, OpExpr) ||
+			!ts_extract_expr_args((Expr *) node, &var, &arg_value, &opno, NULL) ||
+			!IsA(arg_value, Const))
+			return false;
+
+		char *column_name = get_attname(chunk->table_id, var->varattno, false);
+		if (ts_array_is_member(settings->fd.segmentby, column_name))
+		{
+			/*
+			 * Segmentby predicates are only checked by the batch scan, which
+			 * ignores the operators that are not btree comparisons.
+			 */
+			TypeCacheEntry *tce = lookup_type_cache(var->vartype, TYPECACHE_BTREE_OPFAMILY);
+			if (get_op_opfamily_strategy(opno, tce->btree_opf) == InvalidStrategy)
+				return false;
+			continue;
+		}
+
+		have_mem_predicates = true;
+	}
+
+	return have_mem_predicates;
+}
@@ -6,6 +6,7 @@
 #include <postgres.h>
 #include <access/heapam.h>
 #include <access/reloptions.h>
+#include <access/toast_compression.h>
 #include <access/tupdesc.h>
 #include <access/xact.h>
 #include <catalog/index.h>
@@ -163,6 +164,26 @@ compressed_column_metadata_attno(CompressionSettings *settings, Oid chunk_reloid
 	return get_attnum(compressed_reloid, metadata_name);
 }
 
+/*
+ * Set the TOAST compression method of a column of the compressed chunk. This
+ * is the method from the compression settings if there is one, otherwise the
+ * method of the respective column of the uncompressed hypertable, so that
+ * e.g. lz4 can be used for the compressed text and jsonb data.
+ */
+static ColumnDef *
+columndef_copy_toast_compression(ColumnDef *coldef, CompressionSettings *settings,
+								 Form_pg_attribute attr)
+{
+	char method = settings->fd.toast_compression;
+
+	if (!CompressionMethodIsValid(method))
+		method = attr->attcompression;
+
+	if (CompressionMethodIsValid(method))
+		coldef->compression = pstrdup(GetCompressionMethodName(method));
+	return coldef;
+}
+
 /*
  * return the columndef list for compressed hypertable.
  * we do this by getting the source hypertable's attrs,
@@ -240,11 +261,13 @@ build_columndefs(CompressionSettings *settings, Oid src_relid)
 		bool is_segmentby = ts_array_is_member(segmentby, NameStr(attr->attname));
 		if (is_segmentby)
 		{
-			segmentby_column_defs = lappend(segmentby_column_defs,
-											makeColumnDef(NameStr(attr->attname),
-														  attr->atttypid,
-														  attr->atttypmod,
-														  attr->attcollation));
+			ColumnDef *coldef = makeColumnDef(NameStr(attr->attname),
+											  attr->atttypid,
+											  attr->atttypmod,
+											  attr->attcollation);
+			segmentby_column_defs =
+				lappend(segmentby_column_defs,
+						columndef_copy_toast_compression(coldef, settings, attr));
 			continue;
 		}
 
@@ -317,11 +340,13 @@ build_columndefs(CompressionSettings *settings, Oid src_relid)
 			}
 		}
 
-		compressed_column_defs = lappend(compressed_column_defs,
-										 makeColumnDef(NameStr(attr->attname),
-													   compresseddata_oid,
-													   /* typmod = */ -1,
-													   /* collOid = */ InvalidOid));
+		ColumnDef *coldef = makeColumnDef(NameStr(attr->attname),
+										  compresseddata_oid,
+										  /* typmod = */ -1,
+										  /* collOid = */ InvalidOid);
+		compressed_column_defs =
+			lappend(compressed_column_defs,
+					columndef_copy_toast_compression(coldef, settings, attr));
 	}
 
 	/*
@@ -1092,6 +1117,47 @@ compression_setting_orderby_get_default(Hypertable *ht, ArrayType *segmentby)
 	return ts_compress_parse_order_collist(orderby, ht);
 }
 
+/*
+ * Set the batch size and the batch target size of the hypertable.
+ *
+ * Unlike the other settings, these are also applied to the compressed chunks
+ * that already exist, since they only affect the batches written when the
+ * chunks are recompressed and not the layout of the compressed chunks.
+ */
+static void
+update_compress_batch_size(Hypertable *ht, CompressionSettings *settings,
+						   WithClauseResult *with_clause_options)
+{
+	bool set_size = !with_clause_options[CompressBatchSize].is_default;
+	bool set_target = !with_clause_options[CompressBatchTargetSize].is_default;
+	ListCell *lc;
+
+	if (set_size)
+		settings->fd.batch_size = ts_compress_hypertable_parse_batch_size(with_clause_options);
+	if (set_target)
+		settings->fd.batch_target_size =
+			ts_compress_hypertable_parse_batch_target_size(with_clause_options);
+
+	if (!TS_HYPERTABLE_HAS_COMPRESSION_TABLE(ht))
+		return;
+
+	List *chunks = ts_chunk_get_by_hypertable_id(ht->fd.compressed_hypertable_id);
+	foreach (lc, chunks)
+	{
+		Chunk *chunk = lfirst(lc);
+		CompressionSettings *chunk_settings = ts_compression_settings_get(chunk->table_id);
+
+		if (!chunk_settings)
+			continue;
+
+		if (set_size)
+			chunk_settings->fd.batch_size = settings->fd.batch_size;
+		if (set_target)
+			chunk_settings->fd.batch_target_size = settings->fd.batch_target_size;
+		ts_compression_settings_update(chunk_settings);
+	}
+}
+
 static void
 compression_settings_update(Hypertable *ht, CompressionSettings *settings,
 							WithClauseResult *with_clause_options)
@@ -1106,6 +1172,22 @@ compression_settings_update(Hypertable *ht, CompressionSettings *settings,
 		update_compress_chunk_time_interval(ht, with_clause_options);
 	}
 
+	/*
+	 * The method only applies to the columns of the compressed chunks created
+	 * from now on, the columns of the hypertable keep their own method.
+	 */
+	if (!with_clause_options[CompressToastCompression].is_default)
+	{
+		settings->fd.toast_compression =
+			ts_compress_hypertable_parse_toast_compression(with_clause_options);
+	}
+
+	if (!with_clause_options[CompressBatchSize].is_default ||
+		!with_clause_options[CompressBatchTargetSize].is_default)
+	{
+		update_compress_batch_size(ht, settings, with_clause_options);
+	}
+
 	if (!with_clause_options[CompressSegmentBy].is_default)
 	{
 		settings->fd.segmentby = ts_compress_hypertable_parse_segment_by(with_clause_options, ht);
@@ -1161,6 +1243,11 @@ tsl_process_compress_table_add_column(Hypertable *ht, ColumnDef *orig_def)
 		}
 		ColumnDef *coldef = build_columndef_singlecolumn(orig_def->colname, coloid);
 		CompressionSettings *settings = ts_compression_settings_get(chunk->table_id);
+		if (settings && CompressionMethodIsValid(settings->fd.toast_compression))
+			coldef->compression =
+				pstrdup(GetCompressionMethodName(settings->fd.toast_compression));
+		else
+			coldef->compression = orig_def->compression;
 		add_column_to_compression_table(chunk->table_id, settings, coldef);
 	}
 }
@@ -5,16 +5,27 @@
  */
 
 #include <postgres.h>
+#include <access/detoast.h>
+#include <access/parallel.h>
+#include <lib/binaryheap.h>
+#include <miscadmin.h>
 #include <parser/parse_coerce.h>
 #include <parser/parse_relation.h>
+#include <storage/dsm.h>
+#include <storage/sharedfileset.h>
+#include <storage/shm_toc.h>
 #include <utils/inval.h>
+#include <utils/sharedtuplestore.h>
 #include <utils/snapmgr.h>
+#include <utils/sortsupport.h>
 #include <utils/syscache.h>
+#include <utils/tuplestore.h>
 #include <utils/typcache.h>
 
 #include "compression.h"
 #include "compression_dml.h"
 #include "create.h"
+#include "extension_constants.h"
 #include "guc.h"
 #include "hypercore/hypercore_handler.h"
 #include "hypercore/utils.h"
@@ -23,8 +34,61 @@
 #include "ts_catalog/chunk_column_stats.h"
 #include "ts_catalog/compression_settings.h"
 
+typedef struct RecompressParticipant RecompressParticipant;
+
+/*
+ * Merge of the sorted runs of tuples of a segment.
+ *
+ * The tuples to recompress consist of the decompressed batches that overlap
+ * the new tuples, each of them already ordered by the orderby columns, and of
+ * the new tuples, which come ordered from the sorted uncompressed chunk. So
+ * instead of sorting them all over again, they are stored as sorted runs and
+ * merged when the segment is recompressed.
+ */
+typedef struct RecompressMergeRun
+{
+	int64 ntuples;
+	int readptr;
+	TupleTableSlot *slot;
+} RecompressMergeRun;
+
+typedef struct RecompressMerge
+{
+	TupleDesc tupdesc;
+	int sort_mem;
+	int nkeys;
+	SortSupport sortkeys;
+	/* The runs are stored one after the other */
+	Tuplestorestate *tuples;
+	RecompressMergeRun *runs;
+	int nruns;
+	int runs_capacity;
+	/* Whether the last run consists of new tuples, and can be extended */
+	bool last_run_is_new;
+	binaryheap *heap;
+} RecompressMerge;
+
+static void recompress_merge_init(RecompressMerge *merge, TupleDesc tupdesc, int nkeys,
+								  AttrNumber *sort_keys, Oid *sort_operators, Oid *sort_collations,
+								  bool *nulls_first, int sort_mem);
+static void recompress_merge_add_row(RecompressMerge *merge, TupleTableSlot *slot);
+static void recompress_merge_add_batch(RecompressMerge *merge, RowDecompressor *decompressor);
+static void recompress_merge_finish(RecompressMerge *merge, RowCompressor *row_compressor);
+static void recompress_merge_end(RecompressMerge *merge);
+
+static void recompress_segments(CompressionSettings *settings, Relation uncompressed_chunk_rel,
+								Relation compressed_chunk_rel, Snapshot snapshot, int sort_mem,
+								RecompressParticipant *participant);
+static void recompress_segments_parallel(CompressionSettings *settings,
+										 Relation uncompressed_chunk_rel,
+										 Relation compressed_chunk_rel, int nworkers);
 static bool fetch_uncompressed_chunk_into_tuplesort(Tuplesortstate *tuplesortstate,
-													Relation uncompressed_chunk_rel);
+													Relation uncompressed_chunk_rel,
+													Snapshot snapshot,
+													RecompressParticipant *participant,
+													uint32 partition);
+static void delete_compressed_batch(Relation compressed_chunk_rel, ItemPointer tid,
+									Snapshot snapshot, RecompressParticipant *participant);
 static void update_current_segment(CompressedSegmentInfo *current_segment, TupleTableSlot *slot,
 								   int nsegmentby_cols);
 static void create_segmentby_scankeys(CompressionSettings *settings, Relation index_rel,
@@ -154,6 +218,76 @@ recompress_chunk_segmentwise_impl(Chunk *uncompressed_chunk)
 	if (ht->range_space)
 		ts_chunk_column_stats_calculate(ht, uncompressed_chunk);
 
+	int nworkers = compress_chunk_plan_parallel_workers(settings, uncompressed_chunk_rel);
+
+	if (nworkers > 0)
+	{
+		elog(DEBUG1,
+			 "using %d parallel workers to recompress \"%s\"",
+			 nworkers,
+			 RelationGetRelationName(uncompressed_chunk_rel));
+
+		recompress_segments_parallel(settings,
+									 uncompressed_chunk_rel,
+									 compressed_chunk_rel,
+									 nworkers);
+	}
+	else
+	{
+		/*
+		 * Take the snapshot after acquiring the locks, so that it sees all the
+		 * tuples committed before, even in a REPEATABLE READ transaction.
+		 */
+		Snapshot snapshot = RegisterSnapshot(GetLatestSnapshot());
+
+		recompress_segments(settings,
+							uncompressed_chunk_rel,
+							compressed_chunk_rel,
+							snapshot,
+							maintenance_work_mem,
+							NULL);
+		UnregisterSnapshot(snapshot);
+	}
+
+	/* changed chunk status, so invalidate any plans involving this chunk */
+	CacheInvalidateRelcacheByRelid(uncompressed_chunk_id);
+
+	/* Need to rebuild indexes if the relation is using hypercore
+	 * TAM. Alternatively, we could insert into indexes when inserting into
+	 * the compressed rel. */
+	if (uncompressed_chunk_rel->rd_tableam == hypercore_routine())
+	{
+		ReindexParams params = {
+			.options = 0,
+			.tablespaceOid = InvalidOid,
+		};
+
+#if PG17_GE
+		reindex_relation(NULL, RelationGetRelid(uncompressed_chunk_rel), 0, &params);
+#else
+		reindex_relation(RelationGetRelid(uncompressed_chunk_rel), 0, &params);
+#endif
+	}
+
+	table_close(uncompressed_chunk_rel, NoLock);
+	table_close(compressed_chunk_rel, NoLock);
+
+	PG_RETURN_OID(uncompressed_chunk_id);
+}
+
+/*
+ * Recompress the segments that have uncompressed tuples.
+ *
+ * In a parallel recompression, every participant handles the segments of the
+ * partitions it claims, and records the batches to delete and the new batches
+ * in the shared tuplestores instead of modifying the compressed chunk, which
+ * is not allowed in parallel mode. The leader applies the changes afterwards.
+ */
+static void
+recompress_segments(CompressionSettings *settings, Relation uncompressed_chunk_rel,
+					Relation compressed_chunk_rel, Snapshot snapshot, int sort_mem,
+					RecompressParticipant *participant)
+{
 	TupleDesc compressed_rel_tupdesc = RelationGetDescr(compressed_chunk_rel);
 	TupleDesc uncompressed_rel_tupdesc = RelationGetDescr(uncompressed_chunk_rel);
 
@@ -207,14 +341,18 @@ recompress_chunk_segmentwise_impl(Chunk *uncompressed_chunk)
 						uncompressed_chunk_rel,
 						compressed_chunk_rel,
 						compressed_rel_tupdesc->natts,
-						true /*need_bistate*/,
+						participant == NULL /*need_bistate*/,
 						0 /*insert options*/);
+	if (participant != NULL)
+		row_compressor.parallel_output = participant->output;
 
-	Relation index_rel = index_open(row_compressor.index_oid, ExclusiveLock);
-	ereport(DEBUG1,
-			(errmsg("locks acquired for recompression: \"%s.%s\"",
-					NameStr(uncompressed_chunk->fd.schema_name),
-					NameStr(uncompressed_chunk->fd.table_name))));
+	/* The leader holds the stronger lock, the workers are in its lock group. */
+	Relation index_rel =
+		index_open(row_compressor.index_oid, IsParallelWorker() ? AccessShareLock : ExclusiveLock);
+	if (!IsParallelWorker())
+		ereport(DEBUG1,
+				(errmsg("locks acquired for recompression: \"%s\"",
+						RelationGetRelationName(uncompressed_chunk_rel))));
 
 	/* Setting up scankeys */
 	ScanKeyData *index_scankeys = palloc(sizeof(ScanKeyData) * num_segmentby);
@@ -232,27 +370,23 @@ recompress_chunk_segmentwise_impl(Chunk *uncompressed_chunk)
 																sort_operators,
 																sort_collations,
 																nulls_first,
-																maintenance_work_mem,
+																sort_mem,
 																NULL,
 																false);
 
-	/* Used for gathering and resorting the tuples that should be recompressed together.
-	 * Since we are working on a per-segment level here, we only need to sort them
-	 * based on the orderby settings.
+	/* Used for gathering the tuples that should be recompressed together.
+	 * Since we are working on a per-segment level here, we only need to merge
+	 * them based on the orderby settings.
 	 */
-	Tuplesortstate *recompress_tuplesortstate =
-		tuplesort_begin_heap(uncompressed_rel_tupdesc,
-							 num_orderby,
-							 &sort_keys[num_segmentby],
-							 &sort_operators[num_segmentby],
-							 &sort_collations[num_segmentby],
-							 &nulls_first[num_segmentby],
-							 maintenance_work_mem,
-							 NULL,
-							 false);
-
-	/************** snapshot ****************************/
-	Snapshot snapshot = RegisterSnapshot(GetTransactionSnapshot());
+	RecompressMerge merge;
+	recompress_merge_init(&merge,
+						  uncompressed_rel_tupdesc,
+						  num_orderby,
+						  &sort_keys[num_segmentby],
+						  &sort_operators[num_segmentby],
+						  &sort_collations[num_segmentby],
+						  &nulls_first[num_segmentby],
+						  sort_mem);
 
 	TupleTableSlot *uncompressed_slot =
 		MakeTupleTableSlot(uncompressed_rel_tupdesc, &TTSOpsMinimalTuple);
@@ -262,223 +396,809 @@ recompress_chunk_segmentwise_impl(Chunk *uncompressed_chunk)
 	IndexScanDesc index_scan =
 		index_beginscan(compressed_chunk_rel, index_rel, snapshot, num_segmentby, 0);
 
-	bool found_tuple =
-		fetch_uncompressed_chunk_into_tuplesort(input_tuplesortstate, uncompressed_chunk_rel);
-	if (!found_tuple)
-		goto finish;
-	tuplesort_performsort(input_tuplesortstate);
+	/*
+	 * The participants spool the uncompressed tuples into the partitions
+	 * together, so that the chunk is scanned only once.
+	 */
+	if (participant != NULL && participant->shared->npartitions > 1)
+	{
+		TableScanDesc scan = table_beginscan_parallel(uncompressed_chunk_rel, participant->pscan);
+		segment_spool_fill(&participant->spool, scan, &participant->partitioner);
+		table_endscan(scan);
+	}
+
+	/* Without parallelism, there is a single partition with all the segments */
+	uint32 next_partition = 0;
+	uint32 partition;
 
-	for (found_tuple = tuplesort_gettupleslot(input_tuplesortstate,
-											  true /*=forward*/,
-											  false /*=copy*/,
-											  uncompressed_slot,
-											  NULL /*=abbrev*/);
-		 found_tuple;)
+	while ((partition = participant != NULL ?
+							pg_atomic_fetch_add_u32(&participant->shared->next_partition, 1) :
+							next_partition++) <
+		   (participant != NULL ? participant->shared->npartitions : 1))
 	{
-		update_current_segment(current_segment, uncompressed_slot, num_segmentby);
+		bool found_tuple = fetch_uncompressed_chunk_into_tuplesort(input_tuplesortstate,
+																   uncompressed_chunk_rel,
+																   snapshot,
+																   participant,
+																   partition);
+		if (!found_tuple)
+		{
+			tuplesort_reset(input_tuplesortstate);
+			continue;
+		}
+		tuplesort_performsort(input_tuplesortstate);
+
+		for (found_tuple = tuplesort_gettupleslot(input_tuplesortstate,
+												  true /*=forward*/,
+												  false /*=copy*/,
+												  uncompressed_slot,
+												  NULL /*=abbrev*/);
+			 found_tuple;)
+		{
+			update_current_segment(current_segment, uncompressed_slot, num_segmentby);
 
-		/* Build scankeys based on uncompressed tuple values */
-		update_segmentby_scankeys(uncompressed_slot,
-								  current_segment,
-								  num_segmentby,
-								  index_scankeys);
+			/* Build scankeys based on uncompressed tuple values */
+			update_segmentby_scankeys(uncompressed_slot,
+									  current_segment,
+									  num_segmentby,
+									  index_scankeys);
 
-		update_orderby_scankeys(uncompressed_slot,
-								current_segment,
-								num_segmentby,
-								num_orderby,
-								orderby_scankeys);
+			update_orderby_scankeys(uncompressed_slot,
+									current_segment,
+									num_segmentby,
+									num_orderby,
+									orderby_scankeys);
 
-		index_rescan(index_scan, index_scankeys, num_segmentby, NULL, 0);
+			index_rescan(index_scan, index_scankeys, num_segmentby, NULL, 0);
 
-		bool done_with_segment = false;
-		bool tuples_for_recompression = false;
-		enum Batch_match_result result;
+			bool done_with_segment = false;
+			bool tuples_for_recompression = false;
+			enum Batch_match_result result;
 
-		while (index_getnext_slot(index_scan, ForwardScanDirection, compressed_slot))
-		{
-			/* Check if the uncompressed tuple is before, inside, or after the compressed batch */
-			result = match_tuple_batch(compressed_slot,
-									   num_orderby,
-									   orderby_scankeys,
-									   &nulls_first[num_segmentby]);
-
-			/* If the tuple is before the batch, add it for recompression
-			 * also keep adding uncompressed tuples while they are:
-			 * - any left
-			 * - before the current batch
-			 * - in the same segment group
-			 */
-			while (result == Tuple_before)
+			while (index_getnext_slot(index_scan, ForwardScanDirection, compressed_slot))
 			{
-				tuples_for_recompression = true;
-				tuplesort_puttupleslot(recompress_tuplesortstate, uncompressed_slot);
-				found_tuple = tuplesort_gettupleslot(input_tuplesortstate,
-													 true /*=forward*/,
-													 false /*=copy*/,
-													 uncompressed_slot,
-													 NULL /*=abbrev*/);
-				/* If we happen to hit the end of uncompressed tuples or tuple changed segment group
-				 * we are done with the segment group
+				/* Check if the uncompressed tuple is before, inside, or after the compressed
+				 * batch */
+				result = match_tuple_batch(compressed_slot,
+										   num_orderby,
+										   orderby_scankeys,
+										   &nulls_first[num_segmentby]);
+
+				/* If the tuple is before the batch, add it for recompression
+				 * also keep adding uncompressed tuples while they are:
+				 * - any left
+				 * - before the current batch
+				 * - in the same segment group
+				 */
+				while (result == Tuple_before)
+				{
+					tuples_for_recompression = true;
+					recompress_merge_add_row(&merge, uncompressed_slot);
+					found_tuple = tuplesort_gettupleslot(input_tuplesortstate,
+														 true /*=forward*/,
+														 false /*=copy*/,
+														 uncompressed_slot,
+														 NULL /*=abbrev*/);
+					/* If we happen to hit the end of uncompressed tuples or tuple changed segment
+					 * group we are done with the segment group
+					 */
+					if (!found_tuple ||
+						check_changed_group(current_segment, uncompressed_slot, num_segmentby))
+					{
+						done_with_segment = true;
+						break;
+					}
+
+					slot_getallattrs(uncompressed_slot);
+
+					update_orderby_scankeys(uncompressed_slot,
+											current_segment,
+											num_segmentby,
+											num_orderby,
+											orderby_scankeys);
+					result = match_tuple_batch(compressed_slot,
+											   num_orderby,
+											   orderby_scankeys,
+											   &nulls_first[num_segmentby]);
+				}
+
+				/* If we are done with segment, recompress everything we have so far
+				 * and break out of this segment index scan
 				 */
-				if (!found_tuple ||
-					check_changed_group(current_segment, uncompressed_slot, num_segmentby))
+				if (done_with_segment)
 				{
-					done_with_segment = true;
+					tuples_for_recompression = false;
+					recompress_merge_finish(&merge, &row_compressor);
 					break;
 				}
 
-				slot_getallattrs(uncompressed_slot);
+				/* If the tuple matches the batch, add the batch for recompression */
+				if (result == Tuple_match)
+				{
+					tuples_for_recompression = true;
+					bool should_free;
 
-				update_orderby_scankeys(uncompressed_slot,
-										current_segment,
-										num_segmentby,
-										num_orderby,
-										orderby_scankeys);
-				result = match_tuple_batch(compressed_slot,
-										   num_orderby,
-										   orderby_scankeys,
-										   &nulls_first[num_segmentby]);
-			}
+					compressed_tuple = ExecFetchSlotHeapTuple(compressed_slot, false, &should_free);
 
-			/* If we are done with segment, recompress everything we have so far
-			 * and break out of this segment index scan
-			 */
-			if (done_with_segment)
-			{
-				tuples_for_recompression = false;
-				recompress_segment(recompress_tuplesortstate,
-								   uncompressed_chunk_rel,
-								   &row_compressor);
-				break;
-			}
+					heap_deform_tuple(compressed_tuple,
+									  compressed_rel_tupdesc,
+									  decompressor.compressed_datums,
+									  decompressor.compressed_is_nulls);
 
-			/* If the tuple matches the batch, add the batch for recompression */
-			/* Potential optimization: merge uncompressed tuples and decompressed tuples
-			 * into the tuplesortstate since they are both already sorted
-			 */
-			if (result == Tuple_match)
-			{
-				tuples_for_recompression = true;
-				bool should_free;
+					recompress_merge_add_batch(&merge, &decompressor);
 
-				compressed_tuple = ExecFetchSlotHeapTuple(compressed_slot, false, &should_free);
+					delete_compressed_batch(compressed_chunk_rel,
+											&(compressed_slot->tts_tid),
+											snapshot,
+											participant);
 
-				heap_deform_tuple(compressed_tuple,
-								  compressed_rel_tupdesc,
-								  decompressor.compressed_datums,
-								  decompressor.compressed_is_nulls);
+					if (should_free)
+						heap_freetuple(compressed_tuple);
 
-				row_decompressor_decompress_row_to_tuplesort(&decompressor,
-															 recompress_tuplesortstate);
+					continue;
+				}
 
-				simple_table_tuple_delete(compressed_chunk_rel,
-										  &(compressed_slot->tts_tid),
-										  snapshot);
-				CommandCounterIncrement();
+				/* At this point, tuple is after the batch
+				 * If there are tuples added for recompression, do it
+				 * and continue to the next batch
+				 */
+				if (tuples_for_recompression)
+				{
+					tuples_for_recompression = false;
+					recompress_merge_finish(&merge, &row_compressor);
+				}
+			}
 
-				if (should_free)
-					heap_freetuple(compressed_tuple);
+			/* End if we are finished with all uncompressed tuples */
+			if (!found_tuple)
+			{
+				break;
+			}
 
+			/* Reset index scan if we are done with with this segment */
+			if (done_with_segment)
+			{
 				continue;
 			}
 
-			/* At this point, tuple is after the batch
-			 * If there are tuples added for recompression, do it
-			 * and continue to the next batch
+			/* We are done with existing batches for this segment group
+			 * Everything after this point goes into new batches
+			 * until we hit a new segment group or exhaust the uncompressed tuples
 			 */
-			if (tuples_for_recompression)
+			while (!check_changed_group(current_segment, uncompressed_slot, num_segmentby))
 			{
-				tuples_for_recompression = false;
-				recompress_segment(recompress_tuplesortstate,
-								   uncompressed_chunk_rel,
-								   &row_compressor);
-			}
-		}
-
-		/* End if we are finished with all uncompressed tuples */
-		if (!found_tuple)
-		{
-			break;
-		}
+				tuples_for_recompression = true;
+				recompress_merge_add_row(&merge, uncompressed_slot);
+				found_tuple = tuplesort_gettupleslot(input_tuplesortstate,
+													 true /*=forward*/,
+													 false /*=copy*/,
+													 uncompressed_slot,
+													 NULL /*=abbrev*/);
+				if (!found_tuple)
+				{
+					tuples_for_recompression = false;
+					recompress_merge_finish(&merge, &row_compressor);
+					break;
+				}
 
-		/* Reset index scan if we are done with with this segment */
-		if (done_with_segment)
-		{
-			continue;
-		}
+				slot_getallattrs(uncompressed_slot);
+			}
 
-		/* We are done with existing batches for this segment group
-		 * Everything after this point goes into new batches
-		 * until we hit a new segment group or exhaust the uncompressed tuples
-		 */
-		while (!check_changed_group(current_segment, uncompressed_slot, num_segmentby))
-		{
-			tuples_for_recompression = true;
-			tuplesort_puttupleslot(recompress_tuplesortstate, uncompressed_slot);
-			found_tuple = tuplesort_gettupleslot(input_tuplesortstate,
-												 true /*=forward*/,
-												 false /*=copy*/,
-												 uncompressed_slot,
-												 NULL /*=abbrev*/);
-			if (!found_tuple)
+			if (tuples_for_recompression)
 			{
-				tuples_for_recompression = false;
-				recompress_segment(recompress_tuplesortstate,
-								   uncompressed_chunk_rel,
-								   &row_compressor);
-				break;
+				recompress_merge_finish(&merge, &row_compressor);
 			}
-
-			slot_getallattrs(uncompressed_slot);
 		}
 
-		if (tuples_for_recompression)
-		{
-			recompress_segment(recompress_tuplesortstate, uncompressed_chunk_rel, &row_compressor);
-		}
+		tuplesort_reset(input_tuplesortstate);
 	}
 
-finish:
 	row_compressor_close(&row_compressor);
 	ExecDropSingleTupleTableSlot(uncompressed_slot);
 	ExecDropSingleTupleTableSlot(compressed_slot);
 	index_endscan(index_scan);
-	UnregisterSnapshot(snapshot);
 	index_close(index_rel, NoLock);
 	row_decompressor_close(&decompressor);
 
 	tuplesort_end(input_tuplesortstate);
-	tuplesort_end(recompress_tuplesortstate);
+	recompress_merge_end(&merge);
 
 	pfree(current_segment);
 	pfree(index_scankeys);
 	pfree(orderby_scankeys);
+}
 
-	/* changed chunk status, so invalidate any plans involving this chunk */
-	CacheInvalidateRelcacheByRelid(uncompressed_chunk_id);
+/*
+ * Parallel segmentwise recompression.
+ *
+ * The segments are partitioned by the hash of the segmentby values, like for
+ * the parallel compression, and every participant recompresses the segments
+ * of the partitions it claims: it sorts the uncompressed tuples of the
+ * partition, and merges them with the affected compressed batches.
+ *
+ * Since modifications are not allowed in parallel mode, the participants
+ * write the new compressed batches and the TIDs of the batches to delete into
+ * shared tuplestores, and the leader applies them after the parallel
+ * operation. The leader also deletes the recompressed uncompressed tuples,
+ * i.e. all the tuples visible to the snapshot of the parallel operation.
+ */
 
-	/* Need to rebuild indexes if the relation is using hypercore
-	 * TAM. Alternatively, we could insert into indexes when inserting into
-	 * the compressed rel. */
-	if (uncompressed_chunk_rel->rd_tableam == hypercore_routine())
+#define PARALLEL_KEY_RECOMPRESS_SHARED UINT64CONST(0xC011E55000000002)
+#define PARALLEL_KEY_RECOMPRESS_SCAN UINT64CONST(0xC011E55000000003)
+
+typedef struct RecompressParallelShared
+{
+	Oid uncompressed_relid;
+	Oid compressed_relid;
+	dsm_handle output_handle;
+	dsm_handle spool_handle;
+	int sort_mem;
+	int nparticipants;
+	uint32 npartitions;
+	pg_atomic_uint32 next_partition;
+} RecompressParallelShared;
+
+/* Followed by the SharedTuplestores for the new and the deleted batches. */
+typedef struct RecompressParallelOutput
+{
+	SharedFileSet fileset;
+} RecompressParallelOutput;
+
+#define RECOMPRESS_PARALLEL_OUTPUT_STS(output)                                                     \
+	((SharedTuplestore *) ((char *) (output) + MAXALIGN(sizeof(RecompressParallelOutput))))
+#define RECOMPRESS_PARALLEL_DELETED_STS(output, nparticipants)                                     \
+	((SharedTuplestore *) ((char *) RECOMPRESS_PARALLEL_OUTPUT_STS(output) +                       \
+						   MAXALIGN(sts_estimate(nparticipants))))
+
+struct RecompressParticipant
+{
+	RecompressParallelShared *shared;
+	SegmentPartitioner partitioner;
+	/* The parallel scan of the uncompressed chunk */
+	ParallelTableScanDesc pscan;
+	/* The uncompressed tuples split into the partitions */
+	SegmentSpool spool;
+	/* The new compressed batches */
+	SharedTuplestoreAccessor *output;
+	/* The TIDs of the compressed batches to delete, as tuple metadata */
+	SharedTuplestoreAccessor *deleted_batches;
+	/* Empty tuple stored along with the TIDs of the deleted batches */
+	MinimalTuple empty_tuple;
+};
+
+static void
+recompress_participant_init(RecompressParticipant *participant, RecompressParallelShared *shared,
+							RecompressParallelOutput *output, int participant_number,
+							CompressionSettings *settings, Relation uncompressed_chunk_rel,
+							bool initialize)
+{
+	participant->shared = shared;
+	if (!segment_partitioner_init(&participant->partitioner, settings, uncompressed_chunk_rel))
+		elog(ERROR,
+			 "cannot partition \"%s\" for parallel recompression",
+			 RelationGetRelationName(uncompressed_chunk_rel));
+
+	if (initialize)
 	{
-		ReindexParams params = {
-			.options = 0,
-			.tablespaceOid = InvalidOid,
-		};
+		participant->output = sts_initialize(RECOMPRESS_PARALLEL_OUTPUT_STS(output),
+											 shared->nparticipants,
+											 participant_number,
+											 /* meta_data_size = */ 0,
+											 SHARED_TUPLESTORE_SINGLE_PASS,
+											 &output->fileset,
+											 "recompress_chunk");
+		participant->deleted_batches =
+			sts_initialize(RECOMPRESS_PARALLEL_DELETED_STS(output, shared->nparticipants),
+						   shared->nparticipants,
+						   participant_number,
+						   sizeof(ItemPointerData),
+						   SHARED_TUPLESTORE_SINGLE_PASS,
+						   &output->fileset,
+						   "recompress_chunk_deleted");
+	}
+	else
+	{
+		participant->output = sts_attach(RECOMPRESS_PARALLEL_OUTPUT_STS(output),
+										 participant_number,
+										 &output->fileset);
+		participant->deleted_batches =
+			sts_attach(RECOMPRESS_PARALLEL_DELETED_STS(output, shared->nparticipants),
+					   participant_number,
+					   &output->fileset);
+	}
+
+	participant->empty_tuple = heap_form_minimal_tuple(CreateTemplateTupleDesc(0), NULL, NULL);
+}
+
+static void
+recompress_participant_end(RecompressParticipant *participant)
+{
+	sts_end_write(participant->output);
+	sts_end_write(participant->deleted_batches);
+}
+
+/*
+ * Entry point of the parallel recompression workers.
+ */
+PGDLLEXPORT void recompress_segments_parallel_worker_main(dsm_segment *seg, shm_toc *toc);
+
+void
+recompress_segments_parallel_worker_main(dsm_segment *seg, shm_toc *toc)
+{
+	RecompressParallelShared *shared = shm_toc_lookup(toc, PARALLEL_KEY_RECOMPRESS_SHARED, false);
+	RecompressParticipant participant = {
+		.pscan = shm_toc_lookup(toc, PARALLEL_KEY_RECOMPRESS_SCAN, false),
+	};
+
+	/* The leader holds the stronger locks, we are in its lock group. */
+	Relation uncompressed_chunk_rel = table_open(shared->uncompressed_relid, AccessShareLock);
+	Relation compressed_chunk_rel = table_open(shared->compressed_relid, AccessShareLock);
+	CompressionSettings *settings = ts_compression_settings_get(shared->compressed_relid);
+
+	dsm_segment *output_seg = dsm_attach(shared->output_handle);
+	if (output_seg == NULL)
+		ereport(ERROR,
+				(errcode(ERRCODE_OBJECT_NOT_IN_PREREQUISITE_STATE),
+				 errmsg("could not map dynamic shared memory segment")));
+
+	RecompressParallelOutput *output = dsm_segment_address(output_seg);
+	SharedFileSetAttach(&output->fileset, output_seg);
+	recompress_participant_init(&participant,
+								shared,
+								output,
+								ParallelWorkerNumber,
+								settings,
+								uncompressed_chunk_rel,
+								false);
+	segment_spool_attach(&participant.spool, shared->spool_handle);
+
+	recompress_segments(settings,
+						uncompressed_chunk_rel,
+						compressed_chunk_rel,
+						GetActiveSnapshot(),
+						shared->sort_mem,
+						&participant);
+
+	recompress_participant_end(&participant);
+	segment_spool_detach(&participant.spool);
+	dsm_detach(output_seg);
+
+	table_close(compressed_chunk_rel, AccessShareLock);
+	table_close(uncompressed_chunk_rel, AccessShareLock);
+}
+
+static void
+recompress_segments_parallel(CompressionSettings *settings, Relation uncompressed_chunk_rel,
+							 Relation compressed_chunk_rel, int nworkers)
+{
+	const int nparticipants = nworkers + 1;
+	RecompressParticipant participant = { 0 };
+	/* The locks are held, so the latest snapshot sees all committed tuples. */
+	Snapshot snapshot = RegisterSnapshot(GetLatestSnapshot());
+
+	Size output_size = add_size(MAXALIGN(sizeof(RecompressParallelOutput)),
+								add_size(MAXALIGN(sts_estimate(nparticipants)),
+										 sts_estimate(nparticipants)));
+	dsm_segment *output_seg = dsm_create(output_size, 0);
+	RecompressParallelOutput *output = dsm_segment_address(output_seg);
+	SharedFileSetInit(&output->fileset, output_seg);
+	dsm_handle spool_handle =
+		segment_spool_create(&participant.spool, nparticipants, nparticipants);
+
+	EnterParallelMode();
+
+	/* The active snapshot is passed to the workers. */
+	PushActiveSnapshot(snapshot);
+
+	ParallelContext *pcxt = CreateParallelContext(EXTENSION_TSL_SO,
+												  "recompress_segments_parallel_worker_main",
+												  nworkers);
+	Size pscan_size = table_parallelscan_estimate(uncompressed_chunk_rel, snapshot);
+	shm_toc_estimate_chunk(&pcxt->estimator, sizeof(RecompressParallelShared));
+	shm_toc_estimate_chunk(&pcxt->estimator, pscan_size);
+	shm_toc_estimate_keys(&pcxt->estimator, 2);
+	InitializeParallelDSM(pcxt);
+
+	RecompressParallelShared *shared =
+		shm_toc_allocate(pcxt->toc, sizeof(RecompressParallelShared));
+	*shared = (RecompressParallelShared){
+		.uncompressed_relid = RelationGetRelid(uncompressed_chunk_rel),
+		.compressed_relid = RelationGetRelid(compressed_chunk_rel),
+		.output_handle = dsm_segment_handle(output_seg),
+		.spool_handle = spool_handle,
+		/* Every participant has two sorts */
+		.sort_mem = Max(maintenance_work_mem / (2 * nparticipants), 64),
+		.nparticipants = nparticipants,
+		.npartitions = nparticipants,
+	};
+	pg_atomic_init_u32(&shared->next_partition, 0);
+	shm_toc_insert(pcxt->toc, PARALLEL_KEY_RECOMPRESS_SHARED, shared);
+
+	participant.pscan = shm_toc_allocate(pcxt->toc, pscan_size);
+	table_parallelscan_initialize(uncompressed_chunk_rel, participant.pscan, snapshot);
+	shm_toc_insert(pcxt->toc, PARALLEL_KEY_RECOMPRESS_SCAN, participant.pscan);
+
+	/* The leader participates with the number after the workers. */
+	recompress_participant_init(&participant,
+								shared,
+								output,
+								nworkers,
+								settings,
+								uncompressed_chunk_rel,
+								true);
+
+	LaunchParallelWorkers(pcxt);
+
+	/*
+	 * If no workers were launched, nobody else looks at the partitions, so
+	 * don't spool the tuples for nothing.
+	 */
+	if (pcxt->nworkers_launched == 0)
+		shared->npartitions = 1;
+
+	elog(DEBUG1,
+		 "launched %d parallel workers to recompress \"%s\"",
+		 pcxt->nworkers_launched,
+		 RelationGetRelationName(uncompressed_chunk_rel));
+
+	recompress_segments(settings,
+						uncompressed_chunk_rel,
+						compressed_chunk_rel,
+						snapshot,
+						shared->sort_mem,
+						&participant);
+	recompress_participant_end(&participant);
+
+	WaitForParallelWorkersToFinish(pcxt);
+	DestroyParallelContext(pcxt);
+	PopActiveSnapshot();
+	ExitParallelMode();
+
+	/* This removes the spooled tuples. */
+	segment_spool_detach(&participant.spool);
+
+	/* Delete the batches that were recompressed by the participants. */
+	ItemPointerData tid;
+	sts_begin_parallel_scan(participant.deleted_batches);
+	while (sts_parallel_scan_next(participant.deleted_batches, &tid) != NULL)
+		simple_table_tuple_delete(compressed_chunk_rel, &tid, snapshot);
+	sts_end_parallel_scan(participant.deleted_batches);
+
+	/* Insert the new batches. */
+	RowCompressor row_compressor;
+	row_compressor_init(settings,
+						&row_compressor,
+						uncompressed_chunk_rel,
+						compressed_chunk_rel,
+						RelationGetDescr(compressed_chunk_rel)->natts,
+						true /*need_bistate*/,
+						0 /*insert options*/);
+	row_compressor_insert_parallel_output(&row_compressor,
+										  participant.output,
+										  GetCurrentCommandId(true));
+	row_compressor_close(&row_compressor);
+
+	/* All the uncompressed tuples visible to the snapshot were recompressed. */
+	TableScanDesc scan = table_beginscan(uncompressed_chunk_rel, snapshot, 0, 0);
+	TupleTableSlot *slot = table_slot_create(uncompressed_chunk_rel, NULL);
+	while (table_scan_getnextslot(scan, ForwardScanDirection, slot))
+		simple_table_tuple_delete(uncompressed_chunk_rel, &slot->tts_tid, snapshot);
+	ExecDropSingleTupleTableSlot(slot);
+	table_endscan(scan);
+
+	CommandCounterIncrement();
+
+	dsm_detach(output_seg);
+	UnregisterSnapshot(snapshot);
+}
+
+/*
+ * Merge adjacent undersized batches of the same segment into full batches.
+ *
+ * 0 uncompressed_chunk REGCLASS
+ * 1 min_fill_factor FLOAT8 = 0.5
+ */
+Datum
+tsl_compact_chunk(PG_FUNCTION_ARGS)
+{
+	Oid uncompressed_chunk_id = PG_ARGISNULL(0) ? InvalidOid : PG_GETARG_OID(0);
+	float8 min_fill_factor = PG_ARGISNULL(1) ? 0.5 : PG_GETARG_FLOAT8(1);
+
+	ts_feature_flag_check(FEATURE_HYPERTABLE_COMPRESSION);
+	TS_PREVENT_FUNC_IF_READ_ONLY();
+
+	if (min_fill_factor <= 0 || min_fill_factor > 1)
+		ereport(ERROR,
+				(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+				 errmsg("invalid fill factor %g", min_fill_factor),
+				 errhint("The fill factor must be greater than 0 and at most 1.")));
+
+	Chunk *chunk = ts_chunk_get_by_relid(uncompressed_chunk_id, true);
+
+	if (!ts_chunk_is_compressed(chunk))
+		ereport(ERROR,
+				(errcode(ERRCODE_OBJECT_NOT_IN_PREREQUISITE_STATE),
+				 errmsg("chunk %s.%s is not compressed",
+						NameStr(chunk->fd.schema_name),
+						NameStr(chunk->fd.table_name))));
+
+	PG_RETURN_INT32(compact_chunk_impl(chunk, min_fill_factor));
+}
+
+/*
+ * The size of a compressed batch before TOAST, which is the size the row
+ * compressor compares with timescaledb.compress_batch_target_size.
+ */
+static Size
+compressed_batch_bytes(TupleTableSlot *slot)
+{
+	TupleDesc tupdesc = slot->tts_tupleDescriptor;
+	Size bytes = 0;
+
+	slot_getallattrs(slot);
+	for (int i = 0; i < tupdesc->natts; i++)
+	{
+		Form_pg_attribute attr = TupleDescAttr(tupdesc, i);
+
+		if (slot->tts_isnull[i])
+			continue;
+
+		if (attr->attlen == -1)
+			bytes += toast_raw_datum_size(slot->tts_values[i]);
+		else
+			bytes = att_addlength_datum(bytes, attr->attlen, slot->tts_values[i]);
+	}
+
+	return bytes;
+}
+
+/*
+ * Decompress the batches of the run and compress them again as one batch.
+ *
+ * Returns the number of batches that were merged.
+ */
+static int
+compact_batch_run(List **run, Relation compressed_chunk_rel, Relation uncompressed_chunk_rel,
+				  RowDecompressor *decompressor, RowCompressor *row_compressor,
+				  Tuplesortstate *tuplesortstate, TupleTableSlot *compressed_slot,
+				  Snapshot snapshot)
+{
+	ListCell *lc;
+	int nbatches = list_length(*run);
+
+	/* A single batch is already as small as it gets */
+	if (nbatches < 2)
+	{
+		list_free_deep(*run);
+		*run = NIL;
+		return 0;
+	}
+
+	foreach (lc, *run)
+	{
+		ItemPointer tid = lfirst(lc);
+		bool should_free;
+
+		if (!table_tuple_fetch_row_version(compressed_chunk_rel, tid, snapshot, compressed_slot))
+			elog(ERROR, "could not fetch compressed batch for compaction");
+
+		HeapTuple compressed_tuple = ExecFetchSlotHeapTuple(compressed_slot, false, &should_free);
+		heap_deform_tuple(compressed_tuple,
+						  RelationGetDescr(compressed_chunk_rel),
+						  decompressor->compressed_datums,
+						  decompressor->compressed_is_nulls);
+		row_decompressor_decompress_row_to_tuplesort(decompressor, tuplesortstate);
+		simple_table_tuple_delete(compressed_chunk_rel, tid, snapshot);
+
+		if (should_free)
+			heap_freetuple(compressed_tuple);
+	}
+
+	recompress_segment(tuplesortstate, uncompressed_chunk_rel, row_compressor);
+
+	list_free_deep(*run);
+	*run = NIL;
+	return nbatches;
+}
+
+/*
+ * Compact the compressed batches of a chunk.
+ *
+ * Segmentwise recompression and DML can leave a chunk with many batches far
+ * below the target batch size, and since the scan cost is per batch, these
+ * slow down the queries. The batches are read in the order of the compressed
+ * chunk index, i.e. by segment and then by the orderby metadata, and runs of
+ * consecutive batches that are below the fill factor are merged into one
+ * batch of at most timescaledb.compress_batch_size rows. With
+ * timescaledb.compress_batch_target_size, the fill factor and the size of the
+ * merged batch are also relative to the target size, so a batch that reached
+ * the target size with fewer rows is not merged. Only adjacent batches are
+ * merged, so the compacted batches don't overlap more than the original ones
+ * did and the chunk status doesn't change.
+ *
+ * Returns the number of batches that were merged.
+ */
+int
+compact_chunk_impl(Chunk *uncompressed_chunk, double min_fill_factor)
+{
+	int64 nbatches = 0;
+	int64 nrows = 0;
+	int nmerged = 0;
+
+	Chunk *compressed_chunk = ts_chunk_get_by_id(uncompressed_chunk->fd.compressed_chunk_id, true);
+	CompressionSettings *settings = ts_compression_settings_get(compressed_chunk->table_id);
+
+	/* Same locks as segmentwise recompression */
+	Relation uncompressed_chunk_rel = table_open(uncompressed_chunk->table_id, ExclusiveLock);
+	Relation compressed_chunk_rel = table_open(compressed_chunk->table_id, ExclusiveLock);
+	TupleDesc compressed_rel_tupdesc = RelationGetDescr(compressed_chunk_rel);
+
+	RowCompressor row_compressor;
+	row_compressor_init(settings,
+						&row_compressor,
+						uncompressed_chunk_rel,
+						compressed_chunk_rel,
+						compressed_rel_tupdesc->natts,
+						true /*need_bistate*/,
+						0 /*insert options*/);
+
+	if (!OidIsValid(row_compressor.index_oid))
+	{
+		ereport(NOTICE,
+				(errmsg("cannot compact chunk %s.%s without an index on the compressed chunk",
+						NameStr(uncompressed_chunk->fd.schema_name),
+						NameStr(uncompressed_chunk->fd.table_name))));
+		row_compressor_close(&row_compressor);
+		table_close(uncompressed_chunk_rel, NoLock);
+		table_close(compressed_chunk_rel, NoLock);
+		return 0;
+	}
+
+	int32 batch_rows = row_compressor.max_rows_per_batch;
+	int32 small_batch_rows = (int32) (min_fill_factor * batch_rows);
+	int64 target_bytes = row_compressor.target_batch_bytes;
+	int64 small_batch_bytes = (int64) (min_fill_factor * target_bytes);
+	Relation index_rel = index_open(row_compressor.index_oid, ExclusiveLock);
+	RowDecompressor decompressor = build_decompressor(compressed_chunk_rel, uncompressed_chunk_rel);
+	Tuplesortstate *tuplesortstate =
+		compression_create_tuplesort_state(settings, uncompressed_chunk_rel);
+
+	/* The segment is tracked on the compressed tuples, so the offsets are
+	 * into the compressed chunk here. */
+	int num_segmentby = ts_array_length(settings->fd.segmentby);
+	CompressedSegmentInfo *current_segment =
+		palloc0(sizeof(CompressedSegmentInfo) * Max(num_segmentby, 1));
+	for (int i = 0; i < num_segmentby; i++)
+	{
+		const char *attname = ts_array_get_element_text(settings->fd.segmentby, i + 1);
+		AttrNumber attno = get_attnum(RelationGetRelid(compressed_chunk_rel), attname);
+
+		current_segment[i].decompressed_chunk_offset = AttrNumberGetAttrOffset(attno);
+		current_segment[i].segment_info =
+			segment_info_new(TupleDescAttr(compressed_rel_tupdesc, AttrNumberGetAttrOffset(attno)));
+	}
+	AttrNumber count_attno =
+		get_attnum(RelationGetRelid(compressed_chunk_rel), COMPRESSION_COLUMN_METADATA_COUNT_NAME);
+	Ensure(count_attno != InvalidAttrNumber, "count metadata column not found");
+
+	Snapshot snapshot = RegisterSnapshot(GetTransactionSnapshot());
+	TupleTableSlot *compressed_slot = table_slot_create(compressed_chunk_rel, NULL);
+	TupleTableSlot *fetch_slot = table_slot_create(compressed_chunk_rel, NULL);
+	IndexScanDesc index_scan = index_beginscan(compressed_chunk_rel, index_rel, snapshot, 0, 0);
+	index_rescan(index_scan, NULL, 0, NULL, 0);
+
+	List *run = NIL;
+	int32 run_rows = 0;
+	int64 run_bytes = 0;
+	bool first = true;
+
+	while (index_getnext_slot(index_scan, ForwardScanDirection, compressed_slot))
+	{
+		bool is_null;
+		int32 count = DatumGetInt32(slot_getattr(compressed_slot, count_attno, &is_null));
+
+		Assert(!is_null);
+		nbatches++;
+		nrows += count;
+
+		if (first || check_changed_group(current_segment, compressed_slot, num_segmentby))
+		{
+			nmerged += compact_batch_run(&run,
+										 compressed_chunk_rel,
+										 uncompressed_chunk_rel,
+										 &decompressor,
+										 &row_compressor,
+										 tuplesortstate,
+										 fetch_slot,
+										 snapshot);
+			run_rows = 0;
+			run_bytes = 0;
+			update_current_segment(current_segment, compressed_slot, num_segmentby);
+			first = false;
+		}
+
+		int64 bytes = target_bytes > 0 ? compressed_batch_bytes(compressed_slot) : 0;
+		bool full = count >= small_batch_rows || (target_bytes > 0 && bytes >= small_batch_bytes);
+
+		/* A full batch, or one that doesn't fit, ends the current run */
+		if (full || run_rows + count > batch_rows ||
+			(target_bytes > 0 && run_bytes + bytes > target_bytes))
+		{
+			nmerged += compact_batch_run(&run,
+										 compressed_chunk_rel,
+										 uncompressed_chunk_rel,
+										 &decompressor,
+										 &row_compressor,
+										 tuplesortstate,
+										 fetch_slot,
+										 snapshot);
+			run_rows = 0;
+			run_bytes = 0;
+
+			if (full)
+				continue;
+		}
+
+		ItemPointer tid = palloc(sizeof(ItemPointerData));
+		ItemPointerCopy(&compressed_slot->tts_tid, tid);
+		run = lappend(run, tid);
+		run_rows += count;
+		run_bytes += bytes;
+	}
+
+	nmerged += compact_batch_run(&run,
+								 compressed_chunk_rel,
+								 uncompressed_chunk_rel,
+								 &decompressor,
+								 &row_compressor,
+								 tuplesortstate,
+								 fetch_slot,
+								 snapshot);
+
+	ereport(DEBUG1,
+			(errmsg("compacted chunk \"%s.%s\": merged %d of " INT64_FORMAT
+					" batches, fill factor %.2f",
+					NameStr(uncompressed_chunk->fd.schema_name),
+					NameStr(uncompressed_chunk->fd.table_name),
+					nmerged,
+					nbatches,
+					nbatches > 0 ? (double) nrows / (nbatches * batch_rows) : 0)));
+
+	index_endscan(index_scan);
+	ExecDropSingleTupleTableSlot(compressed_slot);
+	ExecDropSingleTupleTableSlot(fetch_slot);
+	UnregisterSnapshot(snapshot);
+	index_close(index_rel, NoLock);
+	row_compressor_close(&row_compressor);
+	row_decompressor_close(&decompressor);
+	tuplesort_end(tuplesortstate);
+	pfree(current_segment);
+
+	if (nmerged > 0)
+	{
+		CacheInvalidateRelcacheByRelid(uncompressed_chunk->table_id);
+
+		/* The compressed tuples moved, so the indexes of hypercore chunks
+		 * have to be rebuilt, like for the segmentwise recompression. */
+		if (uncompressed_chunk_rel->rd_tableam == hypercore_routine())
+		{
+			ReindexParams params = {
+				.options = 0,
+				.tablespaceOid = InvalidOid,
+			};
 
 #if PG17_GE
-		reindex_relation(NULL, RelationGetRelid(uncompressed_chunk_rel), 0, &params);
+			reindex_relation(NULL, RelationGetRelid(uncompressed_chunk_rel), 0, &params);
 #else
-		reindex_relation(RelationGetRelid(uncompressed_chunk_rel), 0, &params);
+			reindex_relation(RelationGetRelid(uncompressed_chunk_rel), 0, &params);
 #endif
+		}
 	}
 
 	table_close(uncompressed_chunk_rel, NoLock);
 	table_close(compressed_chunk_rel, NoLock);
 
-	PG_RETURN_OID(uncompressed_chunk_id);
+	return nmerged;
 }
 
 static void
@@ -548,10 +1268,36 @@ match_tuple_batch(TupleTableSlot *compressed_slot, int num_orderby, ScanKey orde
 
 static bool
 fetch_uncompressed_chunk_into_tuplesort(Tuplesortstate *tuplesortstate,
-										Relation uncompressed_chunk_rel)
+										Relation uncompressed_chunk_rel, Snapshot snapshot,
+										RecompressParticipant *participant, uint32 partition)
 {
 	bool matching_exist = false;
-	Snapshot snapshot = GetLatestSnapshot();
+
+	/*
+	 * In a parallel recompression, the participants read the tuples of their
+	 * partition back from the spool, and the leader deletes all the tuples
+	 * visible to the snapshot of the parallel operation at the end.
+	 */
+	if (participant != NULL && participant->shared->npartitions > 1)
+	{
+		SharedTuplestoreAccessor *input = participant->spool.partitions[partition];
+		TupleTableSlot *slot =
+			MakeSingleTupleTableSlot(RelationGetDescr(uncompressed_chunk_rel), &TTSOpsMinimalTuple);
+		MinimalTuple tuple;
+
+		sts_begin_parallel_scan(input);
+		while ((tuple = sts_parallel_scan_next(input, NULL)) != NULL)
+		{
+			matching_exist = true;
+			ExecStoreMinimalTuple(tuple, slot, false);
+			tuplesort_puttupleslot(tuplesortstate, slot);
+		}
+		sts_end_parallel_scan(input);
+		ExecDropSingleTupleTableSlot(slot);
+
+		return matching_exist;
+	}
+
 	/* Let compression TAM know it should only return tuples from the
 	 * non-compressed relation. */
 
@@ -566,7 +1312,8 @@ fetch_uncompressed_chunk_into_tuplesort(Tuplesortstate *tuplesortstate,
 		tuplesort_puttupleslot(tuplesortstate, slot);
 		/* simple_table_tuple_delete since we don't expect concurrent
 		 * updates, have exclusive lock on the relation */
-		simple_table_tuple_delete(uncompressed_chunk_rel, &slot->tts_tid, snapshot);
+		if (participant == NULL)
+			simple_table_tuple_delete(uncompressed_chunk_rel, &slot->tts_tid, snapshot);
 	}
 	ExecDropSingleTupleTableSlot(slot);
 	table_endscan(scan);
@@ -574,6 +1321,26 @@ fetch_uncompressed_chunk_into_tuplesort(Tuplesortstate *tuplesortstate,
 	return matching_exist;
 }
 
+/*
+ * Delete a compressed batch that is recompressed.
+ *
+ * Parallel participants only record the TID of the batch, which is deleted by
+ * the leader.
+ */
+static void
+delete_compressed_batch(Relation compressed_chunk_rel, ItemPointer tid, Snapshot snapshot,
+						RecompressParticipant *participant)
+{
+	if (participant != NULL)
+	{
+		sts_puttuple(participant->deleted_batches, tid, participant->empty_tuple);
+		return;
+	}
+
+	simple_table_tuple_delete(compressed_chunk_rel, tid, snapshot);
+	CommandCounterIncrement();
+}
+
 /* Sort the tuples and recompress them */
 static void
 recompress_segment(Tuplesortstate *tuplesortstate, Relation compressed_chunk_rel,
@@ -586,7 +1353,230 @@ recompress_segment(Tuplesortstate *tuplesortstate, Relation compressed_chunk_rel
 									  RelationGetDescr(compressed_chunk_rel),
 									  compressed_chunk_rel);
 	tuplesort_reset(tuplesortstate);
-	CommandCounterIncrement();
+
+	/* Parallel participants don't modify the compressed chunk. */
+	if (row_compressor->parallel_output == NULL)
+		CommandCounterIncrement();
+}
+
+static void
+recompress_merge_init(RecompressMerge *merge, TupleDesc tupdesc, int nkeys, AttrNumber *sort_keys,
+					  Oid *sort_operators, Oid *sort_collations, bool *nulls_first, int sort_mem)
+{
+	*merge = (RecompressMerge){
+		.tupdesc = tupdesc,
+		.sort_mem = sort_mem,
+		.nkeys = nkeys,
+		.sortkeys = palloc0(sizeof(SortSupportData) * nkeys),
+	};
+
+	for (int i = 0; i < nkeys; i++)
+	{
+		SortSupport sortkey = &merge->sortkeys[i];
+
+		sortkey->ssup_cxt = CurrentMemoryContext;
+		sortkey->ssup_collation = sort_collations[i];
+		sortkey->ssup_nulls_first = nulls_first[i];
+		sortkey->ssup_attno = sort_keys[i];
+		PrepareSortSupportFromOrderingOp(sort_operators[i], sortkey);
+	}
+}
+
+static void
+recompress_merge_start_run(RecompressMerge *merge, bool is_new)
+{
+	if (merge->tuples == NULL)
+		merge->tuples = tuplestore_begin_heap(false, false, merge->sort_mem);
+
+	if (merge->nruns == merge->runs_capacity)
+	{
+		int capacity = Max(8, merge->runs_capacity * 2);
+
+		if (merge->runs == NULL)
+			merge->runs = palloc0(sizeof(RecompressMergeRun) * capacity);
+		else
+		{
+			merge->runs = repalloc(merge->runs, sizeof(RecompressMergeRun) * capacity);
+			memset(&merge->runs[merge->runs_capacity],
+				   0,
+				   sizeof(RecompressMergeRun) * (capacity - merge->runs_capacity));
+		}
+		merge->runs_capacity = capacity;
+	}
+
+	RecompressMergeRun *run = &merge->runs[merge->nruns++];
+	run->ntuples = 0;
+	if (run->slot == NULL)
+		run->slot = MakeSingleTupleTableSlot(merge->tupdesc, &TTSOpsMinimalTuple);
+	merge->last_run_is_new = is_new;
+}
+
+/* Add a new tuple. The new tuples have to be added in order. */
+static void
+recompress_merge_add_row(RecompressMerge *merge, TupleTableSlot *slot)
+{
+	if (!merge->last_run_is_new)
+		recompress_merge_start_run(merge, true);
+
+	tuplestore_puttupleslot(merge->tuples, slot);
+	merge->runs[merge->nruns - 1].ntuples++;
+}
+
+/* Add the tuples of the compressed batch the decompressor was set up with. */
+static void
+recompress_merge_add_batch(RecompressMerge *merge, RowDecompressor *decompressor)
+{
+	const int n_batch_rows = decompress_batch(decompressor);
+
+	recompress_merge_start_run(merge, false);
+
+	MemoryContext old_ctx = MemoryContextSwitchTo(decompressor->per_compressed_row_ctx);
+	for (int i = 0; i < n_batch_rows; i++)
+		tuplestore_puttupleslot(merge->tuples, decompressor->decompressed_slots[i]);
+	MemoryContextSwitchTo(old_ctx);
+
+	merge->runs[merge->nruns - 1].ntuples += n_batch_rows;
+	row_decompressor_reset(decompressor);
+}
+
+static int32
+recompress_merge_compare_runs(Datum a, Datum b, void *arg)
+{
+	RecompressMerge *merge = (RecompressMerge *) arg;
+	TupleTableSlot *slot_a = merge->runs[DatumGetInt32(a)].slot;
+	TupleTableSlot *slot_b = merge->runs[DatumGetInt32(b)].slot;
+
+	for (int i = 0; i < merge->nkeys; i++)
+	{
+		SortSupport sortkey = &merge->sortkeys[i];
+		bool isnull_a, isnull_b;
+		Datum value_a = slot_getattr(slot_a, sortkey->ssup_attno, &isnull_a);
+		Datum value_b = slot_getattr(slot_b, sortkey->ssup_attno, &isnull_b);
+
+		int compare = ApplySortComparator(value_a, isnull_a, value_b, isnull_b, sortkey);
+		if (compare != 0)
+		{
+			/* The binaryheap is a max-heap, invert the comparison */
+			return -compare;
+		}
+	}
+
+	return 0;
+}
+
+static bool
+recompress_merge_next(RecompressMerge *merge, int run_index)
+{
+	RecompressMergeRun *run = &merge->runs[run_index];
+
+	if (run->ntuples == 0)
+		return false;
+
+	tuplestore_select_read_pointer(merge->tuples, run->readptr);
+	if (!tuplestore_gettupleslot(merge->tuples, true, false, run->slot))
+		elog(ERROR, "unexpected end of recompressed tuples");
+	run->ntuples--;
+	return true;
+}
+
+/*
+ * Recompress the merged runs of tuples and reset the merge for the next
+ * group of tuples.
+ */
+static void
+recompress_merge_finish(RecompressMerge *merge, RowCompressor *row_compressor)
+{
+	int64 offset = 0;
+
+	if (merge->nruns == 0)
+		return;
+
+	/*
+	 * Every run gets a read pointer positioned at its start. The tuples are
+	 * not copied when read, which is fine since nothing is removed from the
+	 * tuplestore before the end of the merge.
+	 */
+	for (int i = 0; i < merge->nruns; i++)
+	{
+		RecompressMergeRun *run = &merge->runs[i];
+
+		run->readptr = i == 0 ? 0 : tuplestore_alloc_read_pointer(merge->tuples, 0);
+		if (offset > 0)
+		{
+			tuplestore_select_read_pointer(merge->tuples, run->readptr);
+			tuplestore_skiptuples(merge->tuples, offset, true);
+		}
+		offset += run->ntuples;
+	}
+
+	row_compressor_reset(row_compressor);
+
+	if (merge->nruns == 1)
+	{
+		while (recompress_merge_next(merge, 0))
+			row_compressor_append_ordered_slot(row_compressor, merge->runs[0].slot);
+	}
+	else
+	{
+		if (merge->heap == NULL)
+			merge->heap =
+				binaryheap_allocate(merge->runs_capacity, recompress_merge_compare_runs, merge);
+		else if (merge->heap->bh_space < merge->nruns)
+		{
+			binaryheap_free(merge->heap);
+			merge->heap =
+				binaryheap_allocate(merge->runs_capacity, recompress_merge_compare_runs, merge);
+		}
+
+		for (int i = 0; i < merge->nruns; i++)
+		{
+			if (recompress_merge_next(merge, i))
+				binaryheap_add_unordered(merge->heap, Int32GetDatum(i));
+		}
+		binaryheap_build(merge->heap);
+
+		while (!binaryheap_empty(merge->heap))
+		{
+			int top = DatumGetInt32(binaryheap_first(merge->heap));
+
+			row_compressor_append_ordered_slot(row_compressor, merge->runs[top].slot);
+
+			if (recompress_merge_next(merge, top))
+				binaryheap_replace_first(merge->heap, Int32GetDatum(top));
+			else
+				(void) binaryheap_remove_first(merge->heap);
+		}
+		binaryheap_reset(merge->heap);
+	}
+
+	row_compressor_finish_ordered_rows(row_compressor);
+
+	/* The read pointers can't be freed, so start with a new tuplestore */
+	tuplestore_end(merge->tuples);
+	merge->tuples = NULL;
+	merge->nruns = 0;
+	merge->last_run_is_new = false;
+
+	/* Parallel participants don't modify the compressed chunk. */
+	if (row_compressor->parallel_output == NULL)
+		CommandCounterIncrement();
+}
+
+static void
+recompress_merge_end(RecompressMerge *merge)
+{
+	if (merge->tuples != NULL)
+		tuplestore_end(merge->tuples);
+	for (int i = 0; i < merge->runs_capacity; i++)
+	{
+		if (merge->runs[i].slot != NULL)
+			ExecDropSingleTupleTableSlot(merge->runs[i].slot);
+	}
+	if (merge->heap != NULL)
+		binaryheap_free(merge->heap);
+	if (merge->runs != NULL)
+		pfree(merge->runs);
+	pfree(merge->sortkeys);
 }
 
 static void
@@ -15,6 +15,10 @@ extern Datum tsl_recompress_chunk_segmentwise(PG_FUNCTION_ARGS);
 
 Oid recompress_chunk_segmentwise_impl(Chunk *chunk);
 
+extern Datum tsl_compact_chunk(PG_FUNCTION_ARGS);
+
+int compact_chunk_impl(Chunk *chunk, double min_fill_factor);
+
 /* Result of matching an uncompressed tuple against a compressed batch */
 enum Batch_match_result
 {
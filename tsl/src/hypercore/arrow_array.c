@@ -6,6 +6,7 @@
 
 #include <postgres.h>
 #include <access/tupmacs.h>
+#include <catalog/pg_type.h>
 #include <fmgr.h>
 #include <utils/datum.h>
 #include <utils/palloc.h>
@@ -474,6 +475,12 @@ arrow_get_datum_fixlen(const ArrowArray *array, Oid typid, int16 typlen, uint16
 	if (!arrow_row_is_valid(validity, index))
 		return (NullableDatum){ .isnull = true };
 
+	/* The bool values are bit-packed, see bool_compress.h */
+	if (typid == BOOLOID)
+		return (NullableDatum){ .isnull = false,
+								.value = BoolGetDatum(
+									arrow_row_is_valid((const uint64 *) values, index)) };
+
 	/* In order to handle fixed-length values of arbitrary size that are byref
 	 * and byval, we use fetch_all() rather than rolling our own. This is
 	 * taken from utils/adt/rangetypes.c */
@@ -5,6 +5,8 @@
  */
 #include <postgres.h>
 #include <access/attnum.h>
+#include <access/detoast.h>
+#include <access/sysattr.h>
 #include <access/tupdesc.h>
 #include <c.h>
 #include <catalog/pg_attribute.h>
@@ -15,18 +17,53 @@
 #include <utils/hsearch.h>
 #include <utils/memutils.h>
 #include <utils/palloc.h>
+#include <utils/rel.h>
+#include <utils/relcache.h>
+#include <utils/resowner.h>
 #include <utils/syscache.h>
 
 #include "arrow_array.h"
 #include "arrow_cache.h"
 #include "arrow_cache_explain.h"
 #include "arrow_tts.h"
+#include "compat/compat.h"
 #include "compression/compression.h"
+#include "guc.h"
 
-#define ARROW_DECOMPRESSION_CACHE_LRU_ENTRIES 100
+/*
+ * The cache is limited by the memory used, see
+ * timescaledb.hypercore_arrow_cache_size, so the number of entries is
+ * only limited for testing.
+ */
+#define ARROW_DECOMPRESSION_CACHE_LRU_ENTRIES UINT16_MAX
+
+/*
+ * Number of least recently used entries considered when evicting entries to
+ * stay within the memory budget.
+ */
+#define ARROW_DECOMPRESSION_CACHE_EVICTION_CANDIDATES 4
 
+/*
+ * The relation is part of the key since a shared cache contains tuples of
+ * several relations. The rest of the key identifies the compressed tuple
+ * within the transaction, since a TID can be reused for a new tuple:
+ *
+ * - A TRUNCATE gives the relation a new file where the TIDs start over. The
+ *   new tuples can have the same xmin as the old ones, since both can be
+ *   inserted by the transaction, or both can be frozen.
+ *
+ * - A TRUNCATE of a relation whose file was created by the same
+ *   subtransaction keeps the file. The new tuples are then inserted by a
+ *   later command than the old ones.
+ *
+ * The key is hashed as a blob, so it must be zeroed before it is filled in.
+ */
 typedef struct ArrowColumnKey
 {
+	Oid relid;			  /* Compressed relation */
+	Oid relfilenumber;	  /* File of the compressed relation */
+	TransactionId xmin;	  /* Inserting transaction of the compressed tuple */
+	CommandId cmin;		  /* Inserting command of the compressed tuple */
 	ItemPointerData ctid; /* Compressed TID for the compressed tuple. */
 } ArrowColumnKey;
 
@@ -43,8 +80,40 @@ typedef struct ArrowColumnCacheEntry
 	dlist_node node; /* List link in LRU list. */
 	ArrowArray **arrow_arrays;
 	int16 num_arrays; /* Number of entries in arrow_arrays */
+	int16 pincount;	  /* Number of slots using the entry */
+	size_t nbytes;	  /* Memory used by the arrow arrays */
+	size_t cost;	  /* Size of the compressed data of the arrow arrays */
 } ArrowColumnCacheEntry;
 
+/*
+ * Pin of an entry of the shared cache by a slot.
+ *
+ * The slots of an aborted (sub)transaction are not cleared, so they never
+ * unpin their entries. Like for buffer pins, the pins are therefore tracked
+ * with the resource owner that was current when the entry was pinned, and
+ * released when the resource owner is released on abort. A slot that
+ * survives the abort, like the slot of a cursor that was fetched from in a
+ * rolled back savepoint, finds its pin released when it unpins the entry.
+ */
+typedef struct ArrowColumnCachePin
+{
+	dlist_node node;
+	ArrowColumnCacheEntry *entry; /* NULL if released on abort */
+	ResourceOwner owner;
+} ArrowColumnCachePin;
+
+/*
+ * Cache shared by the scans of the transaction.
+ *
+ * It is allocated in the transaction memory context, so it is forgotten at
+ * the end of the transaction, and the generation is advanced so that slots
+ * that outlive the transaction don't touch it.
+ */
+static ArrowColumnCache *shared_cache = NULL;
+static uint64 shared_cache_generation = 1;
+
+static void arrow_cache_make_room(ArrowColumnCache *acache, bool new_entry);
+
 /*
  * The function dlist_move_tail only exists for PG14 and above, so provide it
  * for PG13 here.
@@ -97,8 +166,8 @@ get_cache_maxsize(void)
 #endif
 }
 
-void
-arrow_column_cache_init(ArrowColumnCache *acache, MemoryContext mcxt)
+static void
+arrow_column_cache_create(ArrowColumnCache *acache, MemoryContext mcxt)
 {
 	HASHCTL ctl;
 
@@ -116,6 +185,13 @@ arrow_column_cache_init(ArrowColumnCache *acache, MemoryContext mcxt)
 													   /* initBlockSize = */ 64 * 1024,
 													   /* maxBlockSize = */ 64 * 1024);
 	acache->maxsize = get_cache_maxsize();
+	acache->maxbytes = (size_t) ts_guc_hypercore_arrow_cache_size * 1024;
+	acache->nbytes = 0;
+	acache->shared = NULL;
+	acache->shared_generation = 0;
+	acache->pin_generation = 0;
+	acache->pin = NULL;
+	dlist_init(&acache->pins);
 
 	ctl.keysize = sizeof(ArrowColumnKey);
 	ctl.entrysize = sizeof(ArrowColumnCacheEntry);
@@ -126,6 +202,26 @@ arrow_column_cache_init(ArrowColumnCache *acache, MemoryContext mcxt)
 	dlist_init(&acache->arrow_column_cache_lru);
 }
 
+void
+arrow_column_cache_init(ArrowColumnCache *acache, MemoryContext mcxt)
+{
+	arrow_column_cache_create(acache, mcxt);
+
+	if (ts_guc_hypercore_arrow_cache_shared && IsTransactionState())
+	{
+		if (shared_cache == NULL)
+		{
+			ArrowColumnCache *cache =
+				MemoryContextAlloc(TopTransactionContext, sizeof(ArrowColumnCache));
+			arrow_column_cache_create(cache, TopTransactionContext);
+			shared_cache = cache;
+		}
+
+		acache->shared = shared_cache;
+		acache->shared_generation = shared_cache_generation;
+	}
+}
+
 void
 arrow_column_cache_release(ArrowColumnCache *acache)
 {
@@ -133,11 +229,112 @@ arrow_column_cache_release(ArrowColumnCache *acache)
 	MemoryContextDelete(acache->mcxt);
 }
 
+/*
+ * Forget the shared cache at the end of the transaction. The memory is
+ * released with the transaction memory context.
+ */
+void
+arrow_column_cache_xact_event(XactEvent event, void *arg)
+{
+	switch (event)
+	{
+		case XACT_EVENT_COMMIT:
+		case XACT_EVENT_PARALLEL_COMMIT:
+		case XACT_EVENT_ABORT:
+		case XACT_EVENT_PARALLEL_ABORT:
+		case XACT_EVENT_PREPARE:
+			if (shared_cache != NULL)
+			{
+				shared_cache = NULL;
+				++shared_cache_generation;
+			}
+			break;
+		default:
+			break;
+	}
+}
+
+/*
+ * Release the pins of the shared cache held by the resource owner that is
+ * released on abort. On commit, the pins still held are handed over to the
+ * parent resource owner, since the resource owner is deleted afterwards.
+ */
+void
+arrow_column_cache_resource_release(ResourceReleasePhase phase, bool is_commit,
+									bool is_top_level, void *arg)
+{
+	dlist_mutable_iter iter;
+
+	if (phase != RESOURCE_RELEASE_AFTER_LOCKS || shared_cache == NULL)
+		return;
+
+	dlist_foreach_modify (iter, &shared_cache->pins)
+	{
+		ArrowColumnCachePin *pin = dlist_container(ArrowColumnCachePin, node, iter.cur);
+
+		if (pin->owner != CurrentResourceOwner)
+			continue;
+
+		if (is_commit)
+			pin->owner = ResourceOwnerGetParent(CurrentResourceOwner);
+		else
+		{
+			Assert(pin->entry->pincount > 0);
+			--pin->entry->pincount;
+			pin->entry = NULL;
+			dlist_delete(&pin->node);
+		}
+	}
+}
+
+/*
+ * Get the cache to use for the slot: the shared cache if the slot was set up
+ * to use it and it still exists, otherwise the cache of the slot.
+ */
+static pg_attribute_always_inline ArrowColumnCache *
+arrow_cache_get_cache(ArrowColumnCache *acache)
+{
+	if (acache->shared != NULL && acache->shared_generation == shared_cache_generation)
+		return acache->shared;
+
+	return acache;
+}
+
+/*
+ * Size of the memory used by an arrow array.
+ *
+ * Computed from the buffers rather than from the memory context, since the
+ * memory of evicted entries is reused for new entries.
+ */
+static size_t
+arrow_array_size(const ArrowArray *array, int16 typlen)
+{
+	size_t size = sizeof(ArrowArray);
+
+	if (array->n_buffers > 0 && array->buffers[0] != NULL)
+		size += sizeof(uint64) * ((array->length + 63) / 64);
+
+	if (array->n_buffers == 3)
+	{
+		/* Variable-size layout with offsets and data */
+		const int32 *offsets = array->buffers[1];
+		size += sizeof(int32) * (array->length + 1) + offsets[array->length];
+	}
+	else if (array->dictionary != NULL)
+	{
+		/* Dictionary indexes and the dictionary */
+		size += sizeof(int16) * array->length + arrow_array_size(array->dictionary, typlen);
+	}
+	else if (array->n_buffers == 2)
+		size += (size_t) Max(typlen, 1) * array->length;
+
+	return size;
+}
+
 static void
-decompress_one_attr(const ArrowTupleTableSlot *aslot, ArrowColumnCacheEntry *entry,
-					AttrNumber attno, AttrNumber cattno)
+decompress_one_attr(const ArrowTupleTableSlot *aslot, ArrowColumnCache *acache,
+					ArrowColumnCacheEntry *entry, AttrNumber attno, AttrNumber cattno)
 {
-	const ArrowColumnCache *acache = &aslot->arrow_cache;
 	const TupleDesc tupdesc = aslot->base.base.tts_tupleDescriptor;
 	const TupleDesc PG_USED_FOR_ASSERTS_ONLY compressed_tupdesc =
 		aslot->compressed_slot->tts_tupleDescriptor;
@@ -188,7 +385,18 @@ decompress_one_attr(const ArrowTupleTableSlot *aslot, ArrowColumnCacheEntry *ent
 																acache->mcxt,
 																acache->decompression_mcxt);
 
+			/*
+			 * The amount of compressed data is a measure of the work that is
+			 * needed to decompress the arrow array again if it is evicted.
+			 */
+			const size_t nbytes = arrow_array_size(entry->arrow_arrays[attoff], attr->attlen);
+			entry->nbytes += nbytes;
+			entry->cost += toast_raw_datum_size(value);
+			acache->nbytes += nbytes;
+
 			DECOMPRESS_CACHE_STATS_INCREMENT(decompressions);
+
+			arrow_cache_make_room(acache, false);
 		}
 	}
 }
@@ -215,18 +423,116 @@ arrow_cache_clear_entry(ArrowColumnCacheEntry *restrict entry)
 	entry->arrow_arrays = NULL;
 }
 
+static void
+arrow_cache_evict_entry(ArrowColumnCache *acache, ArrowColumnCacheEntry *entry)
+{
+	dlist_delete(&entry->node);
+	--acache->arrow_column_cache_lru_count;
+	acache->nbytes -= entry->nbytes;
+
+	/*
+	 * Free allocated memory in the entry.
+	 *
+	 * The entry itself is managed by the hash table and might be recycled so
+	 * should not be freed here.
+	 */
+	arrow_cache_clear_entry(entry);
+
+	if (!hash_search(acache->htab, &entry->key, HASH_REMOVE, NULL))
+		elog(ERROR, "LRU cache for compressed rows corrupt");
+
+	DECOMPRESS_CACHE_STATS_INCREMENT(evictions);
+}
+
+/*
+ * Pick the entry to evict, or NULL if all entries are in use.
+ *
+ * If the cache has too many entries, the least recently used entry is
+ * picked. If the cache uses too much memory, the few least recently used
+ * entries are considered and the one that is cheapest to decompress again per
+ * byte of memory is picked. This evicts large arrays that are cheap to
+ * decompress, like dictionary-compressed text, before small arrays that were
+ * expensive to decompress.
+ */
+static ArrowColumnCacheEntry *
+arrow_cache_pick_victim(ArrowColumnCache *acache, bool cost_aware)
+{
+	ArrowColumnCacheEntry *victim = NULL;
+	int ncandidates = 0;
+	dlist_iter iter;
+
+	dlist_foreach (iter, &acache->arrow_column_cache_lru)
+	{
+		ArrowColumnCacheEntry *entry = dlist_container(ArrowColumnCacheEntry, node, iter.cur);
+
+		if (entry->pincount > 0)
+			continue;
+
+		if (victim == NULL ||
+			(double) entry->cost * victim->nbytes < (double) victim->cost * entry->nbytes)
+			victim = entry;
+
+		if (!cost_aware || ++ncandidates >= ARROW_DECOMPRESSION_CACHE_EVICTION_CANDIDATES)
+			break;
+	}
+
+	return victim;
+}
+
+/*
+ * Evict entries until there is room for a new entry, or until the cache is
+ * within its memory budget. Entries used by slots are not evicted, so the
+ * cache can temporarily exceed its limits.
+ */
+static void
+arrow_cache_make_room(ArrowColumnCache *acache, bool new_entry)
+{
+	for (;;)
+	{
+		const bool too_many = new_entry && acache->arrow_column_cache_lru_count >= acache->maxsize;
+		ArrowColumnCacheEntry *victim;
+
+		if (!too_many && acache->nbytes <= acache->maxbytes)
+			break;
+
+		victim = arrow_cache_pick_victim(acache, !too_many);
+		if (victim == NULL)
+			break;
+
+		arrow_cache_evict_entry(acache, victim);
+	}
+}
+
 /*
  * Lookup the Arrow cache entry for the tuple.
  *
- * If the entry does not exist, a new entry is created via LRU eviction.
+ * If the entry does not exist, a new entry is created, evicting other entries
+ * if the cache is full. The entry is pinned so that it is not evicted while
+ * the slot is using it.
  */
 static ArrowColumnCacheEntry *
 arrow_cache_get_entry_resolve(ArrowColumnCache *acache, const TupleDesc tupdesc,
-							  const ItemPointer compressed_tid)
+							  TupleTableSlot *compressed_slot)
 {
-	const ArrowColumnKey key = { .ctid = *compressed_tid };
+	bool isnull;
+	ArrowColumnKey key;
+	Relation rel;
 	bool found;
 
+	memset(&key, 0, sizeof(key));
+	key.relid = compressed_slot->tts_tableOid;
+	key.xmin = DatumGetTransactionId(
+		slot_getsysattr(compressed_slot, MinTransactionIdAttributeNumber, &isnull));
+	key.cmin =
+		DatumGetCommandId(slot_getsysattr(compressed_slot, MinCommandIdAttributeNumber, &isnull));
+	ItemPointerCopy(&compressed_slot->tts_tid, &key.ctid);
+
+	/* The scan holds a lock on the relation, so this is a relcache hit */
+	rel = RelationIdGetRelation(key.relid);
+	Ensure(RelationIsValid(rel), "could not open compressed relation %u", key.relid);
+	key.relfilenumber = RelationGetRelfilenumberCompat(rel);
+	RelationClose(rel);
+
 	ArrowColumnCacheEntry *restrict entry = hash_search(acache->htab, &key, HASH_FIND, &found);
 
 	/* If entry was not found, we might have to prune the LRU list before
@@ -235,27 +541,7 @@ arrow_cache_get_entry_resolve(ArrowColumnCache *acache, const TupleDesc tupdesc,
 	{
 		DECOMPRESS_CACHE_STATS_INCREMENT(misses);
 
-		if (acache->arrow_column_cache_lru_count >= acache->maxsize)
-		{
-			/* If we don't have room in the cache for the new entry, pick the
-			 * least recently used and remove it. */
-			entry = dlist_container(ArrowColumnCacheEntry,
-									node,
-									dlist_pop_head_node(&acache->arrow_column_cache_lru));
-			if (!hash_search(acache->htab, &entry->key, HASH_REMOVE, NULL))
-				elog(ERROR, "LRU cache for compressed rows corrupt");
-			--acache->arrow_column_cache_lru_count;
-
-			/*
-			 * Free allocated memory in the entry.
-			 *
-			 * The entry itself is managed by the hash table and might be
-			 * recycled so should not be freed here.
-			 */
-			arrow_cache_clear_entry(entry);
-
-			DECOMPRESS_CACHE_STATS_INCREMENT(evictions);
-		}
+		arrow_cache_make_room(acache, true);
 
 		/* Allocate a new entry in the hash table. */
 		entry = hash_search(acache->htab, &key, HASH_ENTER, &found);
@@ -283,28 +569,90 @@ arrow_cache_get_entry_resolve(ArrowColumnCache *acache, const TupleDesc tupdesc,
 		entry->arrow_arrays =
 			(ArrowArray **) MemoryContextAllocZero(acache->mcxt,
 												   sizeof(ArrowArray *) * entry->num_arrays);
+		entry->pincount = 0;
+		entry->nbytes = sizeof(ArrowColumnCacheEntry) + sizeof(ArrowArray *) * entry->num_arrays;
+		entry->cost = 0;
+		acache->nbytes += entry->nbytes;
 	}
-	else
+	else if (entry->num_arrays < tupdesc->natts)
 	{
-		/* Move the entry found to the front of the LRU list */
-		dlist_move_tail(&acache->arrow_column_cache_lru, &entry->node);
+		/* A shared entry might have been created before columns were added */
+		entry->arrow_arrays =
+			(ArrowArray **) repalloc(entry->arrow_arrays, sizeof(ArrowArray *) * tupdesc->natts);
+		memset(&entry->arrow_arrays[entry->num_arrays],
+			   0,
+			   sizeof(ArrowArray *) * (tupdesc->natts - entry->num_arrays));
+		entry->nbytes += sizeof(ArrowArray *) * (tupdesc->natts - entry->num_arrays);
+		acache->nbytes += sizeof(ArrowArray *) * (tupdesc->natts - entry->num_arrays);
+		entry->num_arrays = tupdesc->natts;
 	}
 
+	++entry->pincount;
+
 	return entry;
 }
 
 static pg_attribute_always_inline ArrowColumnCacheEntry *
-arrow_cache_get_entry(ArrowTupleTableSlot *aslot)
+arrow_cache_get_entry(ArrowTupleTableSlot *aslot, ArrowColumnCache *acache)
 {
 	if (aslot->arrow_cache_entry == NULL)
+	{
 		aslot->arrow_cache_entry =
-			arrow_cache_get_entry_resolve(&aslot->arrow_cache,
+			arrow_cache_get_entry_resolve(acache,
 										  aslot->base.base.tts_tupleDescriptor,
-										  &aslot->compressed_slot->tts_tid);
+										  aslot->compressed_slot);
+		aslot->arrow_cache.pin_generation =
+			acache == &aslot->arrow_cache ? 0 : aslot->arrow_cache.shared_generation;
+
+		if (acache != &aslot->arrow_cache)
+		{
+			ArrowColumnCachePin *pin = MemoryContextAlloc(acache->mcxt, sizeof(*pin));
+
+			pin->entry = aslot->arrow_cache_entry;
+			pin->owner = CurrentResourceOwner;
+			dlist_push_tail(&acache->pins, &pin->node);
+			aslot->arrow_cache.pin = pin;
+		}
+	}
 
 	return aslot->arrow_cache_entry;
 }
 
+/*
+ * Release the cache entry used by the slot, when the slot stops using it.
+ */
+void
+arrow_column_cache_unpin_entry(ArrowTupleTableSlot *aslot)
+{
+	ArrowColumnCacheEntry *entry = aslot->arrow_cache_entry;
+
+	if (entry == NULL)
+		return;
+
+	if (aslot->arrow_cache.pin_generation == 0)
+	{
+		Assert(entry->pincount > 0);
+		--entry->pincount;
+	}
+	else if (aslot->arrow_cache.pin_generation == shared_cache_generation)
+	{
+		/* An entry in a shared cache that is already gone needs no unpinning */
+		ArrowColumnCachePin *pin = aslot->arrow_cache.pin;
+
+		/* The pin is already released if its resource owner was aborted */
+		if (pin->entry != NULL)
+		{
+			Assert(pin->entry == entry && entry->pincount > 0);
+			--entry->pincount;
+			dlist_delete(&pin->node);
+		}
+		pfree(pin);
+	}
+
+	aslot->arrow_cache_entry = NULL;
+	aslot->arrow_cache.pin = NULL;
+}
+
 /*
  * Fetch and decompress data into an arrow array for the given
  * attribute. Arrays for other attributes are returned too, and these may be
@@ -321,10 +669,11 @@ arrow_column_cache_read_one(ArrowTupleTableSlot *aslot, AttrNumber attno)
 	const AttrNumber cattno =
 		AttrOffsetGetAttrNumber(attrs_offset_map[AttrNumberGetAttrOffset(attno)]);
 	const TupleDesc compressed_tupdesc = aslot->compressed_slot->tts_tupleDescriptor;
-	ArrowColumnCacheEntry *restrict entry = arrow_cache_get_entry(aslot);
+	ArrowColumnCache *acache = arrow_cache_get_cache(&aslot->arrow_cache);
+	ArrowColumnCacheEntry *restrict entry = arrow_cache_get_entry(aslot, acache);
 
 	if (is_compressed_col(compressed_tupdesc, cattno))
-		decompress_one_attr(aslot, entry, attno, cattno);
+		decompress_one_attr(aslot, acache, entry, attno, cattno);
 
 	return entry->arrow_arrays;
 }
@@ -38,11 +38,13 @@
 #include <postgres.h>
 
 #include <access/tupdesc.h>
+#include <access/xact.h>
 #include <catalog/pg_attribute.h>
 #include <lib/ilist.h>
 #include <nodes/bitmapset.h>
 #include <storage/itemptr.h>
 #include <utils/hsearch.h>
+#include <utils/resowner.h>
 
 #include "compression/arrow_c_data_interface.h"
 
@@ -54,6 +56,14 @@ typedef struct ArrowColumnCache
 	dlist_head arrow_column_cache_lru;	 /* Arrow column cache LRU list */
 	HTAB *htab;							 /* Arrow column cache */
 	uint16 maxsize;
+	size_t maxbytes;				 /* Memory budget for the cached arrow arrays */
+	size_t nbytes;					 /* Memory used by the cached arrow arrays */
+	struct ArrowColumnCache *shared; /* Transaction-wide cache to use, if any */
+	uint64 shared_generation;		 /* Generation of the shared cache */
+	uint64 pin_generation;			 /* Generation of the cache of the pinned entry,
+									  * or zero if pinned in this cache */
+	struct ArrowColumnCachePin *pin; /* Pin of the entry of the shared cache */
+	dlist_head pins;				 /* Pins of the entries, in a shared cache */
 } ArrowColumnCache;
 
 typedef struct ArrowTupleTableSlot ArrowTupleTableSlot;
@@ -61,3 +71,7 @@ typedef struct ArrowTupleTableSlot ArrowTupleTableSlot;
 extern void arrow_column_cache_init(ArrowColumnCache *acache, MemoryContext mcxt);
 extern void arrow_column_cache_release(ArrowColumnCache *acache);
 extern ArrowArray **arrow_column_cache_read_one(ArrowTupleTableSlot *aslot, AttrNumber attno);
+extern void arrow_column_cache_unpin_entry(ArrowTupleTableSlot *aslot);
+extern void arrow_column_cache_xact_event(XactEvent event, void *arg);
+extern void arrow_column_cache_resource_release(ResourceReleasePhase phase, bool is_commit,
+												bool is_top_level, void *arg);
@@ -135,6 +135,7 @@ tts_arrow_release(TupleTableSlot *slot)
 {
 	ArrowTupleTableSlot *aslot = (ArrowTupleTableSlot *) slot;
 
+	arrow_column_cache_unpin_entry(aslot);
 	arrow_column_cache_release(&aslot->arrow_cache);
 
 	ExecDropSingleTupleTableSlot(aslot->noncompressed_slot);
@@ -146,7 +147,6 @@ tts_arrow_release(TupleTableSlot *slot)
 	/* Do we need these? The slot is being released after all. */
 	aslot->compressed_slot = NULL;
 	aslot->noncompressed_slot = NULL;
-	aslot->arrow_cache_entry = NULL;
 }
 
 static void
@@ -261,7 +261,7 @@ tts_arrow_clear(TupleTableSlot *slot)
 
 	/* Clear arrow slot fields */
 	memset(aslot->valid_attrs, 0, sizeof(bool) * slot->tts_tupleDescriptor->natts);
-	aslot->arrow_cache_entry = NULL;
+	arrow_column_cache_unpin_entry(aslot);
 }
 
 static inline void
@@ -330,7 +330,7 @@ tts_arrow_store_tuple(TupleTableSlot *slot, TupleTableSlot *child_slot, uint16 t
 	slot->tts_nvalid = 0;
 	aslot->child_slot = child_slot;
 	aslot->tuple_index = tuple_index;
-	aslot->arrow_cache_entry = NULL;
+	arrow_column_cache_unpin_entry(aslot);
 	/* Clear valid attributes */
 	memset(aslot->valid_attrs, 0, sizeof(bool) * slot->tts_tupleDescriptor->natts);
 }
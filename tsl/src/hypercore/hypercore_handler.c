@@ -398,6 +398,10 @@ typedef struct HypercoreScanDescData
 	HypercoreScanState hs_scan_state;
 	bool reset;
 	bool skip_compressed; /* Skip compressed data when scanning */
+	uint16 analyze_row_stride; /* Distance between the rows sampled during
+								* ANALYZE, or 0 if not computed yet */
+	uint16 analyze_skip_rows;  /* Non-compressed rows to skip before
+								* returning the next one during ANALYZE */
 #if PG17_GE
 	/* These fields are only used for ANALYZE */
 	ReadStream *canalyze_read_stream;
@@ -2573,6 +2577,61 @@ hypercore_scan_analyze_next_block(TableScanDesc scan, ReadStream *stream)
 }
 #endif
 
+/*
+ * Number of rows to return to ANALYZE for every row it ends up keeping when
+ * sampling compressed batches.
+ */
+#define ANALYZE_COMPRESSED_OVERSAMPLING 10
+
+/*
+ * Compute the distance between rows sampled during ANALYZE.
+ *
+ * ANALYZE keeps a uniform random sample ("reservoir") of all the rows
+ * returned by scan_analyze_next_tuple(). Returning every row of every
+ * sampled batch means that a large fraction of the batches have at least one
+ * row copied into the reservoir, and every copy of a row from a new batch
+ * detoasts and decompresses that batch.
+ *
+ * Instead, return only every Nth row, starting at a random offset. This is
+ * done for both compressed and non-compressed rows, so every row has the
+ * same probability (1/N) of being returned and the sample stays uniform,
+ * while the number of batches that need decompression goes down by roughly
+ * a factor N. N is picked so that the expected number of returned
+ * compressed rows is still a multiple of the number of rows ANALYZE wants to
+ * keep.
+ *
+ * The number of compressed rows is estimated from the number of batches in
+ * the compressed relation's relstats and the average number of rows per
+ * batch recorded when the chunk was compressed. Without stats, every row is
+ * returned.
+ */
+static uint16
+analyze_row_stride(HypercoreScanDesc scan)
+{
+	const Relation crel = scan->compressed_rel;
+	const HypercoreInfo *hsinfo = RelationGetHypercoreInfo(scan->rs_base.rs_rd);
+	const double nbatches = crel->rd_rel->reltuples;
+	/* Number of blocks in both the non-compressed and compressed relation */
+	const BlockNumber nblocks = RelationGetNumberOfBlocks(scan->rs_base.rs_rd);
+	/* Same as the minimum number of sample rows in std_typanalyze() */
+	const double targrows = 300.0 * default_statistics_target;
+	FormData_compression_chunk_size sizes;
+
+	if (nbatches <= 0 || nblocks == 0 || targrows <= 0 ||
+		!ts_compression_chunk_size_get(hsinfo->relation_id, &sizes) ||
+		sizes.numrows_post_compression <= 0 || sizes.numrows_pre_compression <= 0)
+		return 1;
+
+	const double rows_per_batch =
+		(double) sizes.numrows_pre_compression / sizes.numrows_post_compression;
+	/* ANALYZE samples at most targrows blocks */
+	const double sampled_frac = Min(1.0, targrows / nblocks);
+	const double sampled_rows = nbatches * rows_per_batch * sampled_frac;
+	const double stride = floor(sampled_rows / (ANALYZE_COMPRESSED_OVERSAMPLING * targrows));
+
+	return (uint16) Max(1.0, Min(stride, ceil(rows_per_batch)));
+}
+
 /*
  * Get the next tuple to sample during ANALYZE.
  *
@@ -2581,18 +2640,18 @@ hypercore_scan_analyze_next_block(TableScanDesc scan, ReadStream *stream)
  * tuple. This is driven by scan_analyze_next_block() above.
  *
  * When sampling from the compressed relation, a compressed segment is read
- * and it is then necessary to return all tuples in the segment.
- *
- * NOTE: the function currently relies on heapAM's scan_analyze_next_tuple()
- * to read compressed segments. This can lead to misrepresenting liverows and
- * deadrows numbers since heap AM might skip tuples that are dead or
- * concurrently inserted, but still count them in liverows or deadrows. Each
- * compressed tuple represents many rows, but heapAM only counts each
- * compressed tuple as one row. The only way to fix this is to either check
- * the diff between the count before and after calling the heap AM function
- * and then estimate the actual number of rows from that, or, reimplement the
- * heapam_scan_analyze_next_tuple() function so that it can properly account
- * for compressed tuples.
+ * and rows are returned from it at a fixed distance, starting at a random
+ * offset (see analyze_row_stride()). Rows are only decompressed if ANALYZE
+ * decides to keep one of them. Non-compressed rows are returned at the same
+ * distance so that they are not overrepresented in the sample.
+ *
+ * The heap AM's scan_analyze_next_tuple() is used to read compressed
+ * segments and it counts each live compressed tuple as one row. Since the
+ * live rows are used to extrapolate the total number of rows in the
+ * relation, the count is corrected using the number of rows in the segment
+ * (the "count" metadata column), regardless of how many of the rows are
+ * returned. Dead compressed tuples are still counted as one dead row each
+ * since heap AM does not return them.
  */
 static bool
 hypercore_scan_analyze_next_tuple(TableScanDesc scan, TransactionId OldestXmin, double *liverows,
@@ -2603,6 +2662,15 @@ hypercore_scan_analyze_next_tuple(TableScanDesc scan, TransactionId OldestXmin,
 	uint16 tuple_index;
 	bool result;
 
+	if (cscan->analyze_row_stride == 0)
+	{
+		cscan->analyze_row_stride = analyze_row_stride(cscan);
+		cscan->analyze_skip_rows =
+			pg_prng_uint64_range(&pg_global_prng_state, 0, cscan->analyze_row_stride - 1);
+	}
+
+	const uint16 stride = cscan->analyze_row_stride;
+
 	/*
 	 * Since non-compressed blocks are always sampled first, the current
 	 * buffer for the compressed relation will be invalid until we reach the
@@ -2616,36 +2684,71 @@ hypercore_scan_analyze_next_tuple(TableScanDesc scan, TransactionId OldestXmin,
 		{
 			tuple_index = arrow_slot_row_index(slot);
 
-			if (tuple_index != InvalidTupleIndex && !arrow_slot_is_last(slot))
+			if (tuple_index != InvalidTupleIndex &&
+				tuple_index + stride <= arrow_slot_total_row_count(slot))
 			{
-				ExecIncrArrowTuple(slot, 1);
-				*liverows += 1;
+				ExecIncrArrowTuple(slot, stride);
 				return true;
 			}
 		}
 
+		const HypercoreInfo *hsinfo = RelationGetHypercoreInfo(scan->rs_rd);
 		TupleTableSlot *child_slot =
 			arrow_slot_get_compressed_slot(slot, RelationGetDescr(cscan->compressed_rel));
 
-		result = cscan->compressed_rel->rd_tableam->scan_analyze_next_tuple(cscan->cscan_desc,
-																			OldestXmin,
-																			liverows,
-																			deadrows,
-																			child_slot);
-		/* Need to pick a row from the segment to sample. Might as well pick
-		 * the first one, but might consider picking a random one. */
-		tuple_index = 1;
+		/* Skip segments that are smaller than the random start offset */
+		while (true)
+		{
+			double prev_liverows = *liverows;
+
+			result = cscan->compressed_rel->rd_tableam->scan_analyze_next_tuple(cscan->cscan_desc,
+																				OldestXmin,
+																				liverows,
+																				deadrows,
+																				child_slot);
+			if (!result)
+				break;
+
+			bool isnull;
+			const int32 count =
+				DatumGetInt32(slot_getattr(child_slot, hsinfo->count_cattno, &isnull));
+
+			Assert(!isnull && count > 0);
+
+			/* Count all rows in the segment, not only the compressed tuple */
+			if (*liverows > prev_liverows)
+				*liverows += count - 1;
+
+			tuple_index = pg_prng_uint64_range(&pg_global_prng_state, 1, stride);
+
+			if (tuple_index <= count)
+				break;
+		}
 	}
 	else
 	{
 		TupleTableSlot *child_slot = arrow_slot_get_noncompressed_slot(slot);
 		Relation rel = scan->rs_rd;
 		const TableAmRoutine *oldtam = switch_to_heapam(rel);
-		result = rel->rd_tableam->scan_analyze_next_tuple(cscan->uscan_desc,
-														  OldestXmin,
-														  liverows,
-														  deadrows,
-														  child_slot);
+
+		/* Skipped rows are still counted as live rows by heap AM. The skip
+		 * count carries over to the next block. */
+		while (true)
+		{
+			result = rel->rd_tableam->scan_analyze_next_tuple(cscan->uscan_desc,
+															  OldestXmin,
+															  liverows,
+															  deadrows,
+															  child_slot);
+			if (!result || cscan->analyze_skip_rows == 0)
+				break;
+
+			cscan->analyze_skip_rows--;
+		}
+
+		if (result)
+			cscan->analyze_skip_rows = stride - 1;
+
 		rel->rd_tableam = oldtam;
 		tuple_index = InvalidTupleIndex;
 	}
@@ -2685,7 +2788,8 @@ typedef struct IndexBuildCallbackState
 	Bitmapset *segmentby_cols;
 	Bitmapset *orderby_cols;
 	bool is_segmentby_index;
-	MemoryContext decompression_mcxt;
+	MemoryContext batch_mcxt;		  /* Arrow arrays of the compressed tuple */
+	MemoryContext decompression_mcxt; /* Temporary data during decompression */
 	ArrowArray **arrow_columns;
 } IndexBuildCallbackState;
 
@@ -2757,6 +2861,14 @@ hypercore_index_build_callback(Relation index, ItemPointer tid, Datum *values, b
 	}
 	else
 	{
+		/* The arrays decompressed for the previous compressed tuple are no
+		 * longer needed since the index build callback copies the values it
+		 * indexes. Release them here so that memory usage stays bounded by a
+		 * single batch instead of growing with the size of the relation,
+		 * which matters even more when several participants decompress
+		 * batches concurrently in a parallel build. */
+		MemoryContextReset(icstate->batch_mcxt);
+
 		for (int i = 0; i < natts; i++)
 		{
 			const AttrNumber attno = icstate->index_info->ii_IndexAttrNumbers[i];
@@ -2774,7 +2886,7 @@ hypercore_index_build_callback(Relation index, ItemPointer tid, Datum *values, b
 					TupleDescAttr(tupdesc, AttrNumberGetAttrOffset(attno));
 				icstate->arrow_columns[i] = arrow_from_compressed(values[i],
 																  attr->atttypid,
-																  CurrentMemoryContext,
+																  icstate->batch_mcxt,
 																  icstate->decompression_mcxt);
 
 				/* The number of elements in the arrow array should be the
@@ -2888,6 +3000,17 @@ hypercore_index_build_callback(Relation index, ItemPointer tid, Datum *values, b
  * non-indexed predicate columns will be included in the values array passed
  * on to the "our" index build callback. Then we can reconstruct a table tuple
  * from those values in order to do the predicate check.
+ *
+ * In a parallel index build, every participant (workers and the leader) calls
+ * this function with a scan descriptor attached to the shared
+ * HypercoreParallelScanDesc. The descriptor contains separate block
+ * allocators for the compressed and the non-compressed relation, so the
+ * participants first divide the compressed blocks among themselves, each
+ * decompressing the batches it gets, and then move on to divide the
+ * non-compressed blocks. Since a compressed block can hold a lot more rows
+ * than a non-compressed one, scanning the compressed relation first means that
+ * the cheaper non-compressed blocks balance the load towards the end of the
+ * scan.
  */
 static double
 hypercore_index_build_range_scan(Relation relation, Relation indexRelation, IndexInfo *indexInfo,
@@ -3005,6 +3128,7 @@ hypercore_index_build_range_scan(Relation relation, Relation indexRelation, Inde
 		 * snapshot, based on same criteria as serial case.
 		 */
 		Assert(allow_sync);
+		Assert(start_blockno == 0 && numblocks == InvalidBlockNumber);
 		snapshot = scan->rs_snapshot;
 	}
 
@@ -3021,6 +3145,9 @@ hypercore_index_build_range_scan(Relation relation, Relation indexRelation, Inde
 		.index_info = indexInfo,
 		.tuple_index = -1,
 		.ntuples = 0,
+		.batch_mcxt = AllocSetContextCreate(CurrentMemoryContext,
+											"index build batch",
+											ALLOCSET_DEFAULT_SIZES),
 		.decompression_mcxt = AllocSetContextCreate(CurrentMemoryContext,
 													"bulk decompression",
 													/* minContextSize = */ 0,
@@ -3095,8 +3222,7 @@ hypercore_index_build_range_scan(Relation relation, Relation indexRelation, Inde
 				const int num_index_attrs =
 					compress_iinfo.ii_NumIndexAttrs + icstate.num_non_index_predicates;
 
-				Ensure(compress_iinfo.ii_NumIndexAttrs < INDEX_MAX_KEYS,
-					   "too many predicate attributes in index");
+				Ensure(num_index_attrs < INDEX_MAX_KEYS, "too many predicate attributes in index");
 
 				/* If the predicate column is not part of the index, we need
 				 * to include it in the index info passed to heap AM when
@@ -3161,6 +3287,7 @@ hypercore_index_build_range_scan(Relation relation, Relation indexRelation, Inde
 	FreeExecutorState(icstate.estate);
 	ExecDropSingleTupleTableSlot(icstate.slot);
 	MemoryContextDelete(icstate.decompression_mcxt);
+	MemoryContextDelete(icstate.batch_mcxt);
 	pfree((void *) icstate.arrow_columns);
 	bms_free(icstate.segmentby_cols);
 	bms_free(icstate.orderby_cols);
@@ -35,6 +35,7 @@
 #include "continuous_aggs/utils.h"
 #include "cross_module_fn.h"
 #include "export.h"
+#include "hypercore/arrow_cache.h"
 #include "hypercore/arrow_cache_explain.h"
 #include "hypercore/arrow_tts.h"
 #include "hypercore/attr_capture.h"
@@ -68,6 +69,7 @@ static void
 tsl_xact_event(XactEvent event, void *arg)
 {
 	hypercore_xact_event(event, arg);
+	arrow_column_cache_xact_event(event, arg);
 }
 
 /*
@@ -173,6 +175,10 @@ CrossModuleFunctions tsl_cm_functions = {
 	.compress_chunk = tsl_compress_chunk,
 	.decompress_chunk = tsl_decompress_chunk,
 	.decompress_batches_for_insert = decompress_batches_for_insert,
+	.compressed_insert_buffer_create = compressed_insert_buffer_create,
+	.compressed_insert_buffer_add = compressed_insert_buffer_add,
+	.compressed_insert_buffer_flush = compressed_insert_buffer_flush,
+	.compressed_insert_buffer_finish = compressed_insert_buffer_finish,
 	.decompress_target_segments = decompress_target_segments,
 	.hypercore_handler = hypercore_handler,
 	.hypercore_proxy_handler = hypercore_proxy_handler,
@@ -190,6 +196,7 @@ CrossModuleFunctions tsl_cm_functions = {
 	.recompress_chunk_segmentwise = tsl_recompress_chunk_segmentwise,
 	.get_compressed_chunk_index_for_recompression =
 		tsl_get_compressed_chunk_index_for_recompression,
+	.compact_chunk = tsl_compact_chunk,
 	.preprocess_query_tsl = tsl_preprocess_query,
 };
 
@@ -198,6 +205,7 @@ ts_module_cleanup_on_pg_exit(int code, Datum arg)
 {
 	_continuous_aggs_cache_inval_fini();
 	UnregisterXactCallback(tsl_xact_event, NULL);
+	UnregisterResourceReleaseCallback(arrow_column_cache_resource_release, NULL);
 }
 
 TS_FUNCTION_INFO_V1(ts_module_init);
@@ -223,6 +231,7 @@ ts_module_init(PG_FUNCTION_ARGS)
 		on_proc_exit(ts_module_cleanup_on_pg_exit, 0);
 
 	RegisterXactCallback(tsl_xact_event, NULL);
+	RegisterResourceReleaseCallback(arrow_column_cache_resource_release, NULL);
 	PG_RETURN_BOOL(true);
 }
 
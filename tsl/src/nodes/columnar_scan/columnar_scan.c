@@ -864,8 +864,7 @@ columnar_scan_build_vector_attrs(const ColumnCompressionSettings *columns, int n
 		Assert(column->attnum == attnum || column->attnum == InvalidAttrNumber);
 		vector_attrs[attnum] =
 			(!column->is_segmentby && column->attnum != InvalidAttrNumber &&
-			 tsl_get_decompress_all_function(compression_get_default_algorithm(column->typid),
-											 column->typid) != NULL);
+			 tsl_bulk_decompression_possible(column->typid));
 	}
 	return vector_attrs;
 }
@@ -11,6 +11,7 @@
 #include <utils/builtins.h>
 #include <utils/date.h>
 #include <utils/timestamp.h>
+#include <utils/uuid.h>
 
 #include "compression/arrow_c_data_interface.h"
 #include "compression/compression.h"
@@ -57,6 +58,20 @@ make_single_value_arrow_arithmetic(Oid arithmetic_type, Datum datum, bool isnull
 
 	arrow_set_row_validity((uint64 *) arrow->buffers[0], 0, true);
 
+	if (arithmetic_type == BOOLOID)
+	{
+		/* The bool values are bit-packed. */
+		arrow_set_row_validity((uint64 *) arrow->buffers[1], 0, DatumGetBool(datum));
+		return arrow;
+	}
+
+	if (arithmetic_type == UUIDOID)
+	{
+		/* UUID is a fixed-width by-reference type. */
+		memcpy((void *) arrow->buffers[1], DatumGetUUIDP(datum), UUID_LEN);
+		return arrow;
+	}
+
 #define FOR_TYPE(PGTYPE, CTYPE, FROMDATUM)                                                         \
 	case PGTYPE:                                                                                   \
 		*((CTYPE *) arrow->buffers[1]) = FROMDATUM(datum);                                         \
@@ -247,7 +262,16 @@ decompress_column(DecompressContext *dcontext, DecompressBatchState *batch_state
 
 	column_values->arrow = arrow;
 
-	if (value_bytes > 0)
+	if (column_description->typid == BOOLOID)
+	{
+		/* Bit-packed bool column. */
+		column_values->decompression_type = DT_ArrowBits;
+		column_values->buffers[0] = arrow->buffers[0];
+		column_values->buffers[1] = arrow->buffers[1];
+		column_values->buffers[2] = NULL;
+		column_values->buffers[3] = NULL;
+	}
+	else if (value_bytes > 0)
 	{
 		/* Fixed-width column. */
 		column_values->decompression_type = value_bytes;
@@ -479,7 +503,7 @@ compute_plain_qual(VectorQualState *vqstate, TupleTableSlot *slot, Node *qual,
 	}
 
 	/*
-	 * For now, we support NullTest, "Var ? Const" predicates and
+	 * For now, we support NullTest, BooleanTest, "Var ? Const" predicates and
 	 * ScalarArrayOperations.
 	 */
 	List *args = NULL;
@@ -487,11 +511,17 @@ compute_plain_qual(VectorQualState *vqstate, TupleTableSlot *slot, Node *qual,
 	ScalarArrayOpExpr *saop = NULL;
 	OpExpr *opexpr = NULL;
 	NullTest *nulltest = NULL;
+	BooleanTest *booleantest = NULL;
 	if (IsA(qual, NullTest))
 	{
 		nulltest = castNode(NullTest, qual);
 		args = list_make1(nulltest->arg);
 	}
+	else if (IsA(qual, BooleanTest))
+	{
+		booleantest = castNode(BooleanTest, qual);
+		args = list_make1(booleantest->arg);
+	}
 	else if (IsA(qual, ScalarArrayOpExpr))
 	{
 		saop = castNode(ScalarArrayOpExpr, qual);
@@ -529,6 +559,10 @@ compute_plain_qual(VectorQualState *vqstate, TupleTableSlot *slot, Node *qual,
 	{
 		vector_nulltest(vector, nulltest->nulltesttype, predicate_result);
 	}
+	else if (booleantest)
+	{
+		vector_booleantest(vector, booleantest->booltesttype, predicate_result);
+	}
 	else
 	{
 		/*
@@ -1107,6 +1141,13 @@ make_next_tuple(DecompressBatchState *batch_state, uint16 arrow_row, int num_dat
 			*column_values->output_isnull =
 				!arrow_row_is_valid(column_values->buffers[0], arrow_row);
 		}
+		else if (column_values->decompression_type == DT_ArrowBits)
+		{
+			*column_values->output_value =
+				BoolGetDatum(arrow_row_is_valid(column_values->buffers[1], arrow_row));
+			*column_values->output_isnull =
+				!arrow_row_is_valid(column_values->buffers[0], arrow_row);
+		}
 		else if (column_values->decompression_type == DT_ArrowText)
 		{
 			store_text_datum(column_values, arrow_row);
@@ -15,6 +15,12 @@ typedef struct ArrowArray ArrowArray;
 /* How to obtain the decompressed datum for individual row. */
 typedef enum
 {
+	/*
+	 * Arrow bool array, the values are bit-packed in the same way as the
+	 * validity bitmap.
+	 */
+	DT_ArrowBits = -5,
+
 	DT_ArrowTextDict = -4,
 
 	DT_ArrowText = -3,
@@ -8,6 +8,7 @@
 #include <access/sysattr.h>
 #include <catalog/pg_namespace.h>
 #include <catalog/pg_operator.h>
+#include <catalog/pg_type.h>
 #include <nodes/bitmapset.h>
 #include <nodes/extensible.h>
 #include <nodes/makefuncs.h>
@@ -390,9 +391,7 @@ build_decompression_map(DecompressionMapContext *context, List *compressed_scan_
 		 */
 		Oid typoid = get_atttype(info->chunk_rte->relid, uncompressed_chunk_attno);
 		const bool bulk_decompression_possible =
-			!is_segment && destination_attno > 0 &&
-			tsl_get_decompress_all_function(compression_get_default_algorithm(typoid), typoid) !=
-				NULL;
+			!is_segment && destination_attno > 0 && tsl_bulk_decompression_possible(typoid);
 		context->have_bulk_decompression_columns |= bulk_decompression_possible;
 
 		/*
@@ -661,6 +660,38 @@ is_not_runtime_constant(Node *node)
 	return result;
 }
 
+/*
+ * Check whether the expression is a bulk-decompressed bool column of the
+ * current relation.
+ */
+static bool
+is_vector_bool_var(Node *node, const VectorQualInfo *vqinfo)
+{
+	if (!IsA(node, Var))
+	{
+		return false;
+	}
+
+	Var *var = castNode(Var, node);
+	return (Index) var->varno == vqinfo->rti && var->varattno > 0 &&
+		   vqinfo->vector_attrs[var->varattno] && var->vartype == BOOLOID;
+}
+
+/*
+ * Make a BooleanTest for the bare bool column used as a qual. It has the same
+ * result as the column itself when used at the top level of a qual, where null
+ * is treated as false.
+ */
+static Node *
+make_vector_booleantest(Node *arg, BoolTestType booltesttype)
+{
+	BooleanTest *booleantest = makeNode(BooleanTest);
+	booleantest->arg = (Expr *) arg;
+	booleantest->booltesttype = booltesttype;
+	booleantest->location = -1;
+	return (Node *) booleantest;
+}
+
 /*
  * Try to check if the current qual is vectorizable, and if needed make a
  * commuted copy. If not, return NULL.
@@ -668,6 +699,15 @@ is_not_runtime_constant(Node *node)
 Node *
 vector_qual_make(Node *qual, const VectorQualInfo *vqinfo)
 {
+	/*
+	 * A bool column can be used as a qual directly, we vectorize it as a
+	 * BooleanTest.
+	 */
+	if (is_vector_bool_var(qual, vqinfo))
+	{
+		return make_vector_booleantest(qual, IS_TRUE);
+	}
+
 	/*
 	 * We can vectorize BoolExpr (AND/OR/NOT).
 	 */
@@ -679,8 +719,15 @@ vector_qual_make(Node *qual, const VectorQualInfo *vqinfo)
 		{
 			/*
 			 * NOT should be removed by Postgres for all operators we can
-			 * vectorize (see prepqual.c), so we don't support it.
+			 * vectorize (see prepqual.c), so we don't support it. The exception
+			 * is the negated bool column, which we vectorize as a BooleanTest.
 			 */
+			if (list_length(boolexpr->args) == 1 &&
+				is_vector_bool_var(linitial(boolexpr->args), vqinfo))
+			{
+				return make_vector_booleantest(linitial(boolexpr->args), IS_FALSE);
+			}
+
 			return NULL;
 		}
 
@@ -748,6 +795,16 @@ vector_qual_make(Node *qual, const VectorQualInfo *vqinfo)
 		nulltest = castNode(NullTest, qual);
 		arg1 = (Node *) nulltest->arg;
 	}
+	else if (IsA(qual, BooleanTest))
+	{
+		BooleanTest *booleantest = castNode(BooleanTest, qual);
+		if (!is_vector_bool_var((Node *) booleantest->arg, vqinfo))
+		{
+			return NULL;
+		}
+
+		return (Node *) booleantest;
+	}
 	else
 	{
 		return NULL;
@@ -0,0 +1,70 @@
+/*
+ * This file and its contents are licensed under the Timescale License.
+ * Please see the included NOTICE for copyright information and
+ * LICENSE-TIMESCALE for a copy of the license.
+ */
+
+#include "pred_uuid.h"
+
+#include <utils/uuid.h>
+
+/*
+ * Compare the fixed-width 16-byte UUID Arrow array with a constant. We compare
+ * the UUIDs as two 64-bit words, which the compilers vectorize well.
+ */
+static void
+vector_const_uuid_comparison(const ArrowArray *arrow, const Datum constdatum, bool needequal,
+							 uint64 *restrict result)
+{
+	Assert(!arrow->dictionary);
+
+	const pg_uuid_t *constuuid = DatumGetUUIDP(constdatum);
+	uint64 const_lo;
+	uint64 const_hi;
+	memcpy(&const_lo, &constuuid->data[0], sizeof(uint64));
+	memcpy(&const_hi, &constuuid->data[8], sizeof(uint64));
+
+	const uint64 *values = (const uint64 *) arrow->buffers[1];
+
+	const size_t n = arrow->length;
+	for (size_t outer = 0; outer < n / 64; outer++)
+	{
+		uint64 word = 0;
+		for (size_t inner = 0; inner < 64; inner++)
+		{
+			const size_t row = (outer * 64) + inner;
+			const size_t bit_index = inner;
+#define INNER_LOOP                                                                                 \
+	const bool isequal = (values[2 * row] == const_lo) & (values[2 * row + 1] == const_hi);       \
+	word |= ((uint64) (isequal == needequal)) << bit_index;
+
+			INNER_LOOP
+		}
+		result[outer] &= word;
+	}
+
+	if (n % 64)
+	{
+		uint64 word = 0;
+		for (size_t row = (n / 64) * 64; row < n; row++)
+		{
+			const size_t bit_index = row % 64;
+			INNER_LOOP
+		}
+		result[n / 64] &= word;
+	}
+
+#undef INNER_LOOP
+}
+
+void
+vector_const_uuideq(const ArrowArray *arrow, const Datum constdatum, uint64 *restrict result)
+{
+	vector_const_uuid_comparison(arrow, constdatum, /* needequal = */ true, result);
+}
+
+void
+vector_const_uuidne(const ArrowArray *arrow, const Datum constdatum, uint64 *restrict result)
+{
+	vector_const_uuid_comparison(arrow, constdatum, /* needequal = */ false, result);
+}
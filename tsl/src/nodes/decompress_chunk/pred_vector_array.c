@@ -113,9 +113,9 @@ vector_array_predicate(VectorPredicate *vector_const_predicate, bool is_or,
 		}
 
 		/*
-		 * The bitmaps are small, no more than 15 qwords for our maximal
-		 * compressed batch size of 1000 rows, so we can check for early exit
-		 * after every row.
+		 * The bitmaps are small, 15 qwords for the default compressed batch
+		 * size of 1000 rows and no more than 512 qwords for the maximal one,
+		 * so we can check for early exit after every row.
 		 */
 		VectorQualSummary summary = get_vector_qual_summary(array_result, n_rows);
 		if (summary == (is_or ? AllRowsPass : NoRowsPass))
@@ -29,6 +29,7 @@
 #include "pred_vector_const_arithmetic_all.c"
 
 #include "pred_text.h"
+#include "pred_uuid.h"
 
 /*
  * Look up the vectorized implementation for a Postgres predicate, specified by
@@ -49,6 +50,12 @@ get_vector_const_predicate(Oid pg_predicate)
 		case F_TEXTNE:
 			return vector_const_textne;
 
+		case F_UUID_EQ:
+			return vector_const_uuideq;
+
+		case F_UUID_NE:
+			return vector_const_uuidne;
+
 		default:
 			/*
 			 * More checks below, this branch is to placate the static analyzers.
@@ -96,3 +103,42 @@ vector_nulltest(const ArrowArray *arrow, int test_type, uint64 *restrict result)
 		}
 	}
 }
+
+/*
+ * Compute the BooleanTest for a bool column. The bool Arrow arrays are
+ * bit-packed, so we can compute the result for 64 rows at a time.
+ */
+void
+vector_booleantest(const ArrowArray *arrow, int test_type, uint64 *restrict result)
+{
+	const uint16 bitmap_words = (arrow->length + 63) / 64;
+	const uint64 *values = (const uint64 *) arrow->buffers[1];
+	const uint64 *validity = (const uint64 *) arrow->buffers[0];
+	for (uint16 i = 0; i < bitmap_words; i++)
+	{
+		const uint64 validity_word = validity != NULL ? validity[i] : ~0ULL;
+		const uint64 true_word = values[i] & validity_word;
+		const uint64 false_word = ~values[i] & validity_word;
+		switch ((BoolTestType) test_type)
+		{
+			case IS_TRUE:
+				result[i] &= true_word;
+				break;
+			case IS_NOT_TRUE:
+				result[i] &= ~true_word;
+				break;
+			case IS_FALSE:
+				result[i] &= false_word;
+				break;
+			case IS_NOT_FALSE:
+				result[i] &= ~false_word;
+				break;
+			case IS_UNKNOWN:
+				result[i] &= ~validity_word;
+				break;
+			case IS_NOT_UNKNOWN:
+				result[i] &= validity_word;
+				break;
+		}
+	}
+}
@@ -20,9 +20,9 @@ FUNCTION_NAME(vector_impl)(void *agg_state, int n, const CTYPE *values, const ui
 	 * We accumulate the sum as int64, so we can sum INT_MAX = 2^31 - 1
 	 * at least 2^31 times without incurring an overflow of the int64
 	 * accumulator. The same is true for negative numbers. The
-	 * compressed batch size is currently capped at 1000 rows, but even
-	 * if it's changed in the future, it's unlikely that we support
-	 * batches larger than 65536 rows, not to mention 2^31. Therefore,
+	 * compressed batch size is capped at GLOBAL_MAX_ROWS_PER_COMPRESSION
+	 * rows, and it's unlikely that we support batches larger than 65536
+	 * rows, not to mention 2^31. Therefore,
 	 * we don't need to check for overflows within the loop, which would
 	 * slow down the calculation.
 	 */
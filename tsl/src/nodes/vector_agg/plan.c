@@ -515,6 +515,12 @@ get_vectorized_grouping_type(Agg *agg, CustomScan *custom, List *resolved_target
 		{
 			switch (typlen)
 			{
+				case 1:
+					/*
+					 * The bool columns are bit-packed and not supported for
+					 * hash grouping.
+					 */
+					return VAGT_Invalid;
 				case 2:
 					return VAGT_HashSingleFixed2;
 				case 4:
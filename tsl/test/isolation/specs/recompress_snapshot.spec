@@ -0,0 +1,50 @@
+# This file and its contents are licensed under the Timescale License.
+# Please see the included NOTICE for copyright information and
+# LICENSE-TIMESCALE for a copy of the license.
+
+###
+# Test that segmentwise recompression in a REPEATABLE READ transaction
+# recompresses the rows committed before it acquired its locks, both serially
+# and in parallel.
+###
+
+setup
+{
+  CREATE TABLE recomp(ts int not null, device int, val float8);
+  SELECT FROM create_hypertable('recomp', 'ts', chunk_time_interval => 100000);
+  ALTER TABLE recomp SET (timescaledb.compress, timescaledb.compress_segmentby = 'device',
+    timescaledb.compress_orderby = 'ts');
+  INSERT INTO recomp SELECT x, x % 17, x FROM generate_series(1, 20000) x;
+  SELECT FROM compress_chunk(show_chunks('recomp'));
+  INSERT INTO recomp SELECT x, x % 17, x FROM generate_series(20001, 21000) x;
+
+  CREATE FUNCTION uncompressed_rows() RETURNS bigint AS $$
+  DECLARE
+    n bigint;
+  BEGIN
+    EXECUTE format('SELECT count(*) FROM ONLY %s', (SELECT c FROM show_chunks('recomp') c))
+    INTO n;
+    RETURN n;
+  END
+  $$ LANGUAGE plpgsql;
+}
+
+teardown
+{
+  DROP TABLE recomp;
+  DROP FUNCTION uncompressed_rows();
+}
+
+session "s1"
+step "s1_serial" { SET timescaledb.compression_parallel_workers = 0; }
+step "s1_parallel" { SET max_parallel_maintenance_workers = 2; SET timescaledb.compression_parallel_workers = 2; SET min_parallel_table_scan_size = 0; }
+step "s1_begin" { BEGIN ISOLATION LEVEL REPEATABLE READ; SELECT count(*) FROM recomp; }
+step "s1_recompress" { SELECT count(_timescaledb_functions.recompress_chunk_segmentwise(c)) AS recompress FROM show_chunks('recomp') c; }
+step "s1_commit" { COMMIT; }
+step "s1_check" { SELECT count(*) FROM recomp; SELECT uncompressed_rows(); }
+
+session "s2"
+step "s2_insert" { INSERT INTO recomp SELECT x, x % 17, x FROM generate_series(21001, 21500) x; }
+
+permutation "s1_serial" "s1_begin" "s2_insert" "s1_recompress" "s1_commit" "s1_check"
+permutation "s1_parallel" "s1_begin" "s2_insert" "s1_recompress" "s1_commit" "s1_check"
@@ -0,0 +1,80 @@
+-- This file and its contents are licensed under the Timescale License.
+-- Please see the included NOTICE for copyright information and
+-- LICENSE-TIMESCALE for a copy of the license.
+--
+-- Test runtime chunk exclusion on columns with chunk skipping enabled.
+-- A nested loop with a lateral subquery probes the hypertable with a
+-- parameter, and ChunkAppend excludes the chunks whose tracked range
+-- does not contain the parameter value on each rescan.
+--
+create table skip(time timestamptz not null, sensor_id int, other int, value float);
+select table_name from create_hypertable('skip', 'time', chunk_time_interval => interval '1 day');
+create index on skip(sensor_id);
+set timescaledb.enable_chunk_skipping to on;
+select * from enable_chunk_skipping('skip', 'sensor_id');
+
+-- Three chunks with sensors 1-10, 11-20, and 21-30
+insert into skip
+select '2024-01-01'::timestamptz + ((s - 1) / 10) * interval '1 day' + h * interval '1 hour', s, s, s
+from generate_series(1, 30) s, generate_series(0, 3) h;
+
+-- Show the ChunkAppend node and its runtime exclusion of a query
+create function runtime_exclusion(query text) returns setof text as $$
+declare
+    line text;
+begin
+    for line in execute 'explain (analyze, costs off, timing off, summary off) ' || query loop
+        if line ~ '(ChunkAppend|excluded during runtime)' then
+            return next regexp_replace(regexp_replace(line, '^\s*(->\s*)?', ''),
+                                       '\s*\(actual.*\)$', '');
+        end if;
+    end loop;
+end
+$$ language plpgsql;
+
+-- The ranges are computed when compressing, so nothing is excluded yet
+select g.id, count(m.value) from generate_series(5, 25, 10) g(id) left join lateral (select value from skip where sensor_id = g.id order by value limit 10) m on true group by g.id order by g.id;
+select * from runtime_exclusion($$select g.id, count(m.value) from generate_series(5, 25, 10) g(id) left join lateral (select value from skip where sensor_id = g.id order by value limit 10) m on true group by g.id order by g.id$$);
+
+alter table skip set (timescaledb.compress, timescaledb.compress_segmentby = '', timescaledb.compress_orderby = 'time');
+select count(compress_chunk(c)) from show_chunks('skip') c;
+select chunk_id, range_start, range_end, valid
+from _timescaledb_catalog.chunk_column_stats
+where chunk_id > 0
+order by chunk_id;
+
+-- Each rescan excludes the two chunks not containing the sensor
+select g.id, count(m.value) from generate_series(5, 25, 10) g(id) left join lateral (select value from skip where sensor_id = g.id order by value limit 10) m on true group by g.id order by g.id;
+select * from runtime_exclusion($$select g.id, count(m.value) from generate_series(5, 25, 10) g(id) left join lateral (select value from skip where sensor_id = g.id order by value limit 10) m on true group by g.id order by g.id$$);
+
+-- Only parent exclusion for columns without chunk skipping, or with
+-- chunk skipping turned off
+select g.id, count(m.value) from generate_series(5, 25, 10) g(id) left join lateral (select value from skip where other = g.id order by value limit 10) m on true group by g.id order by g.id;
+select * from runtime_exclusion($$select g.id, count(m.value) from generate_series(5, 25, 10) g(id) left join lateral (select value from skip where other = g.id order by value limit 10) m on true group by g.id order by g.id$$);
+set timescaledb.enable_chunk_skipping to off;
+select g.id, count(m.value) from generate_series(5, 25, 10) g(id) left join lateral (select value from skip where sensor_id = g.id order by value limit 10) m on true group by g.id order by g.id;
+select * from runtime_exclusion($$select g.id, count(m.value) from generate_series(5, 25, 10) g(id) left join lateral (select value from skip where sensor_id = g.id order by value limit 10) m on true group by g.id order by g.id$$);
+reset timescaledb.enable_chunk_skipping;
+set timescaledb.enable_chunk_skipping to on;
+
+-- A row outside the range makes the range of the first chunk invalid,
+-- so that chunk can no longer be excluded
+insert into skip values ('2024-01-01 02:30', 25, 25, 25.5);
+select chunk_id, range_start, range_end, valid
+from _timescaledb_catalog.chunk_column_stats
+where chunk_id > 0
+order by chunk_id;
+select g.id, count(m.value) from generate_series(5, 25, 10) g(id) left join lateral (select value from skip where sensor_id = g.id order by value limit 10) m on true group by g.id order by g.id;
+select * from runtime_exclusion($$select g.id, count(m.value) from generate_series(5, 25, 10) g(id) left join lateral (select value from skip where sensor_id = g.id order by value limit 10) m on true group by g.id order by g.id$$);
+
+-- Recompressing makes the range valid again
+select compress_chunk(c) from show_chunks('skip') c order by c limit 1;
+select chunk_id, range_start, range_end, valid
+from _timescaledb_catalog.chunk_column_stats
+where chunk_id > 0
+order by chunk_id;
+select g.id, count(m.value) from generate_series(5, 25, 10) g(id) left join lateral (select value from skip where sensor_id = g.id order by value limit 10) m on true group by g.id order by g.id;
+select * from runtime_exclusion($$select g.id, count(m.value) from generate_series(5, 25, 10) g(id) left join lateral (select value from skip where sensor_id = g.id order by value limit 10) m on true group by g.id order by g.id$$);
+
+drop table skip;
+drop function runtime_exclusion;
@@ -0,0 +1,48 @@
+-- This file and its contents are licensed under the Timescale License.
+-- Please see the included NOTICE for copyright information and
+-- LICENSE-TIMESCALE for a copy of the license.
+
+create table toasttab(ts int not null, device text, payload text, val float8);
+select create_hypertable('toasttab', 'ts', chunk_time_interval => 1000);
+insert into toasttab select x, 'd' || x % 2, repeat('p', 4000), x from generate_series(1, 10) x;
+
+-- The option is stored in the compression settings and leaves the columns
+-- of the hypertable and of the uncompressed chunks untouched.
+alter table toasttab set (timescaledb.compress, timescaledb.compress_segmentby = 'device',
+    timescaledb.compress_orderby = 'ts', timescaledb.compress_toast_compression = 'lz4');
+select relid, toast_compression from _timescaledb_catalog.compression_settings
+where relid = 'toasttab'::regclass;
+
+select attname, attcompression from pg_attribute
+where attrelid = 'toasttab'::regclass and attnum > 0 and not attisdropped order by attnum;
+select attname, attcompression from pg_attribute
+where attrelid = '_timescaledb_internal._hyper_1_1_chunk'::regclass and attnum > 0
+    and not attisdropped order by attnum;
+select distinct pg_column_compression(payload) from _timescaledb_internal._hyper_1_1_chunk;
+
+-- The compressed chunks use the method for all their columns and the values
+-- stored in them are compressed with it.
+select count(compress_chunk(x)) from show_chunks('toasttab') x;
+select attname, attcompression from pg_attribute
+where attrelid = '_timescaledb_internal.compress_hyper_2_2_chunk'::regclass and attnum > 0
+    and attname not like '\_ts\_meta%' order by attname;
+select device, pg_column_compression(payload)
+from _timescaledb_internal.compress_hyper_2_2_chunk order by device;
+select toast_compression from _timescaledb_catalog.compression_settings
+where relid = '_timescaledb_internal.compress_hyper_2_2_chunk'::regclass;
+
+-- The columns added later also use the method in the existing compressed
+-- chunks, while the hypertable keeps the method of the column definition.
+alter table toasttab add column extra text compression pglz;
+alter table toasttab add column other text;
+select attname, attcompression from pg_attribute
+where attrelid = 'toasttab'::regclass and attname in ('extra', 'other') order by attname;
+select attname, attcompression from pg_attribute
+where attrelid = '_timescaledb_internal.compress_hyper_2_2_chunk'::regclass
+    and attname in ('extra', 'other') order by attname;
+
+\set ON_ERROR_STOP 0
+alter table toasttab set (timescaledb.compress_toast_compression = 'zstd');
+\set ON_ERROR_STOP 1
+
+select count(*), count(distinct payload), sum(length(payload)) from toasttab;
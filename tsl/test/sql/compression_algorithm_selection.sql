@@ -0,0 +1,103 @@
+-- This file and its contents are licensed under the Timescale License.
+-- Please see the included NOTICE for copyright information and
+-- LICENSE-TIMESCALE for a copy of the license.
+
+\c :TEST_DBNAME :ROLE_SUPERUSER
+
+-- Check the algorithm chosen for every column with each of the algorithm
+-- selection modes. The device 0 and device 1 segments have data that favor
+-- different algorithms, and each segment is compressed into a single batch.
+set timescaledb.enable_bool_compression to on;
+set timescaledb.enable_uuid_compression to on;
+
+create table algos(ts int not null, device int, i int4, n numeric, b bool, u uuid);
+select create_hypertable('algos', 'ts', chunk_time_interval => 10000);
+alter table algos set (timescaledb.compress, timescaledb.compress_segmentby = 'device',
+    timescaledb.compress_orderby = 'ts');
+
+-- For device 0: increasing integers, distinct numerics, a few distinct
+-- plain uuids.
+-- For device 1: integers alternating between two values far apart, numerics
+-- where three quarters of the values are distinct, distinct version 7 uuids.
+insert into algos select x, x % 2,
+    case when x % 2 = 0 then x when x % 4 = 1 then 0 else 1073741824 end,
+    case when x % 2 = 0 then 1e38 + x else 1e38 + (x / 2) % 750 + 1 end,
+    x % 3 = 0,
+    case when x % 2 = 0 then md5((x % 3)::text)::uuid
+        else (lpad(to_hex(1700000000000 + x), 12, '0') || '7abc8def'
+            || lpad(to_hex(x), 12, '0'))::uuid end
+from generate_series(1, 2000) x;
+create table ref as select * from algos;
+
+-- The default algorithm for the type is always used.
+set timescaledb.compression_algorithm_selection to 'default';
+select count(compress_chunk(x)) from show_chunks('algos') x;
+select format('%I.%I', c.schema_name, c.table_name) as "CCHUNK"
+from _timescaledb_catalog.chunk c
+join _timescaledb_catalog.chunk uc on uc.compressed_chunk_id = c.id
+where uc.hypertable_id = 1 \gset
+select device,
+    (_timescaledb_functions.compressed_data_info(i)).algorithm i,
+    (_timescaledb_functions.compressed_data_info(n)).algorithm n,
+    (_timescaledb_functions.compressed_data_info(b)).algorithm b,
+    (_timescaledb_functions.compressed_data_info(u)).algorithm u
+from :CCHUNK order by device;
+-- The compressed data reads back the same, and so does the decompressed chunk.
+select count(*) from ((table ref except all table algos)
+    union all (table algos except all table ref)) diff;
+select device, sum(i), sum(n - 1e38), count(*) filter (where b), count(distinct u)
+from algos group by device order by device;
+select count(decompress_chunk(x)) from show_chunks('algos') x;
+select count(*) from ((table ref except all table algos)
+    union all (table algos except all table ref)) diff;
+
+-- The smallest result is used. The dictionary of the numerics is smaller
+-- than the array, and gorilla packs the alternating integers better than
+-- delta-delta.
+set timescaledb.compression_algorithm_selection to 'size';
+select count(compress_chunk(x)) from show_chunks('algos') x;
+select format('%I.%I', c.schema_name, c.table_name) as "CCHUNK"
+from _timescaledb_catalog.chunk c
+join _timescaledb_catalog.chunk uc on uc.compressed_chunk_id = c.id
+where uc.hypertable_id = 1 \gset
+select device,
+    (_timescaledb_functions.compressed_data_info(i)).algorithm i,
+    (_timescaledb_functions.compressed_data_info(n)).algorithm n,
+    (_timescaledb_functions.compressed_data_info(b)).algorithm b,
+    (_timescaledb_functions.compressed_data_info(u)).algorithm u
+from :CCHUNK order by device;
+-- The compressed data reads back the same, and so does the decompressed chunk.
+select count(*) from ((table ref except all table algos)
+    union all (table algos except all table ref)) diff;
+select device, sum(i), sum(n - 1e38), count(*) filter (where b), count(distinct u)
+from algos group by device order by device;
+select count(decompress_chunk(x)) from show_chunks('algos') x;
+select count(*) from ((table ref except all table algos)
+    union all (table algos except all table ref)) diff;
+
+-- The dictionary of the numerics is not small enough to outweigh its
+-- decompression cost.
+set timescaledb.compression_algorithm_selection to 'speed';
+select count(compress_chunk(x)) from show_chunks('algos') x;
+select format('%I.%I', c.schema_name, c.table_name) as "CCHUNK"
+from _timescaledb_catalog.chunk c
+join _timescaledb_catalog.chunk uc on uc.compressed_chunk_id = c.id
+where uc.hypertable_id = 1 \gset
+select device,
+    (_timescaledb_functions.compressed_data_info(i)).algorithm i,
+    (_timescaledb_functions.compressed_data_info(n)).algorithm n,
+    (_timescaledb_functions.compressed_data_info(b)).algorithm b,
+    (_timescaledb_functions.compressed_data_info(u)).algorithm u
+from :CCHUNK order by device;
+-- The compressed data reads back the same, and so does the decompressed chunk.
+select count(*) from ((table ref except all table algos)
+    union all (table algos except all table ref)) diff;
+select device, sum(i), sum(n - 1e38), count(*) filter (where b), count(distinct u)
+from algos group by device order by device;
+select count(decompress_chunk(x)) from show_chunks('algos') x;
+select count(*) from ((table ref except all table algos)
+    union all (table algos except all table ref)) diff;
+
+reset timescaledb.compression_algorithm_selection;
+reset timescaledb.enable_bool_compression;
+reset timescaledb.enable_uuid_compression;
@@ -0,0 +1,80 @@
+-- This file and its contents are licensed under the Timescale License.
+-- Please see the included NOTICE for copyright information and
+-- LICENSE-TIMESCALE for a copy of the license.
+
+create table sizes(ts int not null, device int, val bigint);
+select create_hypertable('sizes', 'ts', chunk_time_interval => 100000);
+alter table sizes set (timescaledb.compress, timescaledb.compress_segmentby = 'device',
+    timescaledb.compress_orderby = 'ts');
+insert into sizes select x, 0, (x::bigint * 2654435761) % 4294967291
+from generate_series(1, 10000) x;
+
+-- The number of batches and the smallest and largest batch of the compressed
+-- chunks.
+create function batches(out batches bigint, out min_rows int, out max_rows int)
+language plpgsql as $$
+declare
+    ch regclass;
+begin
+    for ch in select format('%I.%I', schema_name, table_name)::regclass
+        from _timescaledb_catalog.chunk where hypertable_id = 2 and not dropped loop
+        execute format('select count(*), min(_ts_meta_count), max(_ts_meta_count) from %s', ch)
+        into batches, min_rows, max_rows;
+    end loop;
+end;
+$$;
+
+select count(compress_chunk(x)) from show_chunks('sizes') x;
+select * from batches();
+select count(decompress_chunk(x)) from show_chunks('sizes') x;
+
+-- The batch size of the hypertable limits the number of rows in a batch and
+-- is copied to the settings of the compressed chunks.
+alter table sizes set (timescaledb.compress_batch_size = 300);
+select relid = 'sizes'::regclass as hypertable, batch_size, batch_target_size
+from _timescaledb_catalog.compression_settings order by 1 desc;
+select count(compress_chunk(x)) from show_chunks('sizes') x;
+select * from batches();
+select relid = 'sizes'::regclass as hypertable, batch_size, batch_target_size
+from _timescaledb_catalog.compression_settings order by 1 desc;
+select fill_factor from _timescaledb_functions.compressed_chunk_batch_stats('sizes');
+
+-- Changing the batch size also changes the settings of the existing
+-- compressed chunks, which the fill factor is relative to.
+alter table sizes set (timescaledb.compress_batch_size = 1000);
+select relid = 'sizes'::regclass as hypertable, batch_size, batch_target_size
+from _timescaledb_catalog.compression_settings order by 1 desc;
+select fill_factor from _timescaledb_functions.compressed_chunk_batch_stats('sizes');
+select count(decompress_chunk(x)) from show_chunks('sizes') x;
+
+-- With a target size, the batches after the first one of a segment have fewer
+-- rows, but the batch size still limits them.
+alter table sizes set (timescaledb.compress_batch_target_size = '1kB');
+select count(compress_chunk(x)) from show_chunks('sizes') x;
+select relid = 'sizes'::regclass as hypertable, batch_size, batch_target_size
+from _timescaledb_catalog.compression_settings order by 1 desc;
+select batches > 10 as more_batches, max_rows = 1000 as first_full from batches();
+-- The fill factor is relative to the target size, so the adaptive batches are
+-- not undersized.
+select fill_factor < 0.5 as undersized
+from _timescaledb_functions.compressed_chunk_batch_stats('sizes');
+-- The compaction doesn't merge the batches that reached the target size.
+select _timescaledb_functions.compact_chunk(x) from show_chunks('sizes') x;
+-- A target size of 0 disables the adaptive batch size.
+alter table sizes set (timescaledb.compress_batch_target_size = '0');
+select relid = 'sizes'::regclass as hypertable, batch_size, batch_target_size
+from _timescaledb_catalog.compression_settings order by 1 desc;
+select fill_factor < 0.5 as undersized
+from _timescaledb_functions.compressed_chunk_batch_stats('sizes');
+select count(decompress_chunk(x)) from show_chunks('sizes') x;
+
+alter table sizes set (timescaledb.compress_batch_size = 100,
+    timescaledb.compress_batch_target_size = '1kB');
+select count(compress_chunk(x)) from show_chunks('sizes') x;
+select * from batches();
+select count(*), sum(val) from sizes;
+
+\set ON_ERROR_STOP 0
+alter table sizes set (timescaledb.compress_batch_size = 0);
+alter table sizes set (timescaledb.compress_batch_target_size = 'large');
+\set ON_ERROR_STOP 1
@@ -0,0 +1,72 @@
+-- This file and its contents are licensed under the Timescale License.
+-- Please see the included NOTICE for copyright information and
+-- LICENSE-TIMESCALE for a copy of the license.
+
+\c :TEST_DBNAME :ROLE_SUPERUSER
+
+create table booltab(ts int not null, device int, b bool);
+select create_hypertable('booltab', 'ts', chunk_time_interval => 1000);
+alter table booltab set (timescaledb.compress, timescaledb.compress_segmentby = 'device',
+    timescaledb.compress_orderby = 'ts');
+
+-- The first chunk is compressed without the bool compression, and the
+-- second one with it.
+set timescaledb.enable_bool_compression to off;
+insert into booltab select x, x % 3, case when x % 5 = 0 then null else x % 2 = 0 end
+from generate_series(1, 999) x;
+select count(compress_chunk(format('%I.%I', chunk_schema, chunk_name)::regclass))
+from timescaledb_information.chunks where hypertable_name = 'booltab' and not is_compressed;
+
+set timescaledb.enable_bool_compression to on;
+insert into booltab select x, x % 3, case when x % 5 = 0 then null else x % 2 = 0 end
+from generate_series(1000, 1998) x;
+select count(compress_chunk(format('%I.%I', chunk_schema, chunk_name)::regclass))
+from timescaledb_information.chunks where hypertable_name = 'booltab' and not is_compressed;
+
+select (_timescaledb_functions.compressed_data_info(b)).algorithm, count(*)
+from _timescaledb_internal.compress_hyper_2_2_chunk group by 1;
+select (_timescaledb_functions.compressed_data_info(b)).algorithm, count(*)
+from _timescaledb_internal.compress_hyper_2_4_chunk group by 1;
+
+-- Both chunks use the vectorized filters on the bool column.
+set timescaledb.debug_require_vector_qual to 'require';
+select count(*) from booltab where b;
+select count(*) from booltab where not b;
+select count(*) from booltab where b is true;
+select count(*) from booltab where b is not true;
+select count(*) from booltab where b is false;
+select count(*) from booltab where b is not false;
+select count(*) from booltab where b is unknown;
+select count(*) from booltab where b is not unknown;
+select count(*) from booltab where b is null;
+select count(*) from booltab where b and ts > 1500;
+
+-- Without the bool compression, the bool columns are not bulk decompressed
+-- and there are no vectorized filters on them.
+set timescaledb.enable_bool_compression to off;
+set timescaledb.debug_require_vector_qual to 'forbid';
+select count(*) from booltab where b;
+select count(*) from booltab where not b;
+select count(*) from booltab where b is true;
+select count(*) from booltab where b is not true;
+select count(*) from booltab where b is false;
+select count(*) from booltab where b is not false;
+select count(*) from booltab where b is unknown;
+select count(*) from booltab where b is not unknown;
+select count(*) from booltab where b is null;
+select count(*) from booltab where b and ts > 1500;
+
+reset timescaledb.debug_require_vector_qual;
+reset timescaledb.enable_bool_compression;
+-- Same results without compression.
+select count(decompress_chunk(x)) from show_chunks('booltab') x;
+select count(*) from booltab where b;
+select count(*) from booltab where not b;
+select count(*) from booltab where b is true;
+select count(*) from booltab where b is not true;
+select count(*) from booltab where b is false;
+select count(*) from booltab where b is not false;
+select count(*) from booltab where b is unknown;
+select count(*) from booltab where b is not unknown;
+select count(*) from booltab where b is null;
+select count(*) from booltab where b and ts > 1500;
@@ -0,0 +1,51 @@
+-- This file and its contents are licensed under the Timescale License.
+-- Please see the included NOTICE for copyright information and
+-- LICENSE-TIMESCALE for a copy of the license.
+
+create table compact(ts int not null, device int, val int);
+select create_hypertable('compact', 'ts', chunk_time_interval => 10000);
+alter table compact set (timescaledb.compress, timescaledb.compress_segmentby = 'device',
+    timescaledb.compress_orderby = 'ts');
+insert into compact select x, x % 2, x from generate_series(1, 1000) x;
+
+-- Compress into small batches.
+alter table compact set (timescaledb.compress_batch_size = 100);
+select count(compress_chunk(x)) from show_chunks('compact') x;
+select chunk_name, total_batches, total_rows, fill_factor
+from _timescaledb_functions.compressed_chunk_batch_stats('compact');
+
+-- The fill factor is relative to the configured batch size.
+alter table compact set (timescaledb.compress_batch_size = 1000);
+select chunk_name, total_batches, total_rows, fill_factor
+from _timescaledb_functions.compressed_chunk_batch_stats('compact');
+
+-- The batches of each segment are merged, the segments are not.
+select _timescaledb_functions.compact_chunk('_timescaledb_internal._hyper_1_1_chunk');
+select chunk_name, total_batches, total_rows, fill_factor
+from _timescaledb_functions.compressed_chunk_batch_stats('compact');
+select device, count(*), sum(val), min(ts), max(ts) from compact group by device order by device;
+
+-- A batch that is above the fill factor is not merged.
+select _timescaledb_functions.compact_chunk('_timescaledb_internal._hyper_1_1_chunk', 0.4);
+select chunk_name, total_batches, total_rows, fill_factor
+from _timescaledb_functions.compressed_chunk_batch_stats('compact');
+
+-- A run of batches is limited by the batch size.
+select count(decompress_chunk(x)) from show_chunks('compact') x;
+alter table compact set (timescaledb.compress_batch_size = 300);
+select count(compress_chunk(x)) from show_chunks('compact') x;
+select chunk_name, total_batches, total_rows, fill_factor
+from _timescaledb_functions.compressed_chunk_batch_stats('compact');
+alter table compact set (timescaledb.compress_batch_size = 400);
+select _timescaledb_functions.compact_chunk('_timescaledb_internal._hyper_1_1_chunk', 1);
+alter table compact set (timescaledb.compress_batch_size = 1000);
+select _timescaledb_functions.compact_chunk('_timescaledb_internal._hyper_1_1_chunk', 1);
+select chunk_name, total_batches, total_rows, fill_factor
+from _timescaledb_functions.compressed_chunk_batch_stats('compact');
+select device, count(*), sum(val), min(ts), max(ts) from compact group by device order by device;
+
+\set ON_ERROR_STOP 0
+select _timescaledb_functions.compact_chunk('_timescaledb_internal._hyper_1_1_chunk', 0);
+insert into compact values (20000, 0, 0);
+select _timescaledb_functions.compact_chunk('_timescaledb_internal._hyper_1_4_chunk');
+\set ON_ERROR_STOP 1
@@ -0,0 +1,87 @@
+-- This file and its contents are licensed under the Timescale License.
+-- Please see the included NOTICE for copyright information and
+-- LICENSE-TIMESCALE for a copy of the license.
+
+create table deltab(ts int not null, device int, val int);
+select create_hypertable('deltab', 'ts', chunk_time_interval => 1000);
+alter table deltab set (timescaledb.compress, timescaledb.compress_segmentby = 'device',
+    timescaledb.compress_orderby = 'ts');
+insert into deltab select x, x % 3, x from generate_series(1, 999) x;
+select count(compress_chunk(x)) from show_chunks('deltab') x;
+create table keep(device int);
+insert into keep values (1);
+create table empty(device int);
+
+-- The number of deleted rows, as reported by the command tag.
+create function delete_count(query text) returns bigint language plpgsql as $$
+declare
+    n bigint;
+begin
+    execute query;
+    get diagnostics n = row_count;
+    return n;
+end;
+$$;
+
+-- The compressed batch statistics of the statement.
+create function delete_stats(query text) returns setof text language plpgsql as $$
+declare
+    line text;
+begin
+    for line in execute 'explain (analyze, costs off, timing off, summary off) ' || query loop
+        if line ~ '(Batches|Tuples) ' then
+            return next trim(line);
+        end if;
+    end loop;
+end;
+$$;
+
+set timescaledb.enable_compressed_direct_row_delete to on;
+
+-- The whole batches and the matching rows are deleted without decompression,
+-- and the deleted rows are counted.
+begin;
+select delete_stats($$delete from deltab where device = 2$$);
+rollback;
+begin;
+select delete_count($$delete from deltab where device = 2$$);
+select count(*) from deltab;
+rollback;
+
+
+begin;
+select delete_stats($$delete from deltab where val < 100$$);
+rollback;
+begin;
+select delete_count($$delete from deltab where val < 100$$);
+select count(*) from deltab;
+rollback;
+
+-- The TID quals are not part of the predicates, so the batches have to be
+-- decompressed.
+begin;
+select delete_stats($$delete from deltab where ctid = '(0,1)'$$);
+rollback;
+begin;
+select delete_count($$delete from deltab where ctid = '(0,1)'$$);
+select count(*) from deltab;
+rollback;
+
+-- An uncorrelated EXISTS is a gating qual above the chunk scan.
+begin;
+select delete_stats($$delete from deltab where val < 100 and exists (select from empty)$$);
+rollback;
+begin;
+select delete_count($$delete from deltab where val < 100 and exists (select from empty)$$);
+select count(*) from deltab;
+rollback;
+
+-- The join quals are not part of the predicates either.
+begin;
+select delete_stats($$delete from deltab d where val < 100 and exists (select from keep k where k.device = d.device)$$);
+rollback;
+begin;
+select delete_count($$delete from deltab d where val < 100 and exists (select from keep k where k.device = d.device)$$);
+select count(*) from deltab;
+rollback;
+
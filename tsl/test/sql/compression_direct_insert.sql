@@ -0,0 +1,113 @@
+-- This file and its contents are licensed under the Timescale License.
+-- Please see the included NOTICE for copyright information and
+-- LICENSE-TIMESCALE for a copy of the license.
+
+create table metrics(ts int not null, device int, val int);
+select create_hypertable('metrics', 'ts', chunk_time_interval => 1000);
+alter table metrics set (timescaledb.compress, timescaledb.compress_segmentby = 'device',
+    timescaledb.compress_orderby = 'ts');
+insert into metrics select x, x % 2, x from generate_series(0, 1999) x;
+select count(compress_chunk(x)) from show_chunks('metrics') x;
+
+-- The rows in the uncompressed chunks, the compressed batches and all rows.
+create function chunk_rows(out uncompressed bigint, out batches bigint, out total bigint)
+language plpgsql as $$
+declare
+    ch regclass;
+    n bigint;
+begin
+    uncompressed := 0;
+    batches := 0;
+    for ch in select show_chunks('metrics') loop
+        execute format('select count(*) from only %s', ch) into n;
+        uncompressed := uncompressed + n;
+    end loop;
+    for ch in select format('%I.%I', schema_name, table_name)::regclass
+        from _timescaledb_catalog.chunk where hypertable_id = 2 and not dropped loop
+        execute format('select count(*) from %s', ch) into n;
+        batches := batches + n;
+    end loop;
+    select count(*) into total from metrics;
+end;
+$$;
+select * from chunk_rows();
+
+set timescaledb.enable_direct_compress_insert to on;
+
+-- The inserted rows are compressed into new batches.
+begin;
+insert into metrics select x, x % 2, x from generate_series(0, 9) x;
+select * from chunk_rows();
+rollback;
+
+begin;
+copy metrics from stdin with (format csv);
+1,0,1
+2,1,2
+3,0,3
+\.
+select * from chunk_rows();
+rollback;
+
+-- The buffer of a chunk is compressed when the chunk is closed, because there
+-- are too many chunks open.
+begin;
+insert into metrics select (x % 2) * 1000 + x, 0, x from generate_series(0, 19) x;
+select * from chunk_rows();
+rollback;
+set timescaledb.max_open_chunks_per_insert to 1;
+begin;
+insert into metrics select (x % 2) * 1000 + x, 0, x from generate_series(0, 19) x;
+select * from chunk_rows();
+rollback;
+reset timescaledb.max_open_chunks_per_insert;
+
+-- The triggers have to see the inserted rows, so the rows are inserted into
+-- the uncompressed chunk when there are insert triggers.
+create function count_rows() returns trigger language plpgsql as $$
+begin
+    raise notice 'rows: %', (select count(*) from metrics);
+    return null;
+end;
+$$;
+create trigger count_rows after insert on metrics
+    for each statement execute function count_rows();
+begin;
+insert into metrics select x, x % 2, x from generate_series(0, 9) x;
+select * from chunk_rows();
+rollback;
+drop trigger count_rows on metrics;
+
+create function count_new_rows() returns trigger language plpgsql as $$
+begin
+    raise notice 'new rows: %, rows: %', (select count(*) from new_rows),
+        (select count(*) from metrics);
+    return null;
+end;
+$$;
+create trigger count_new_rows after insert on metrics referencing new table as new_rows
+    for each statement execute function count_new_rows();
+begin;
+copy metrics from stdin with (format csv);
+1,0,1
+2,1,2
+3,0,3
+\.
+select * from chunk_rows();
+rollback;
+drop trigger count_new_rows on metrics;
+
+create function show_row() returns trigger language plpgsql as $$
+begin
+    raise notice 'inserted %', new;
+    return null;
+end;
+$$;
+create trigger show_row after insert on metrics for each row execute function show_row();
+begin;
+insert into metrics values (5, 0, 5), (6, 1, 6);
+select * from chunk_rows();
+rollback;
+drop trigger show_row on metrics;
+
+reset timescaledb.enable_direct_compress_insert;
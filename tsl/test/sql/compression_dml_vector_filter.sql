@@ -0,0 +1,206 @@
+-- This file and its contents are licensed under the Timescale License.
+-- Please see the included NOTICE for copyright information and
+-- LICENSE-TIMESCALE for a copy of the license.
+
+create table vectab(ts int not null, device int, val int, name text, num numeric);
+select create_hypertable('vectab', 'ts', chunk_time_interval => 10000);
+alter table vectab set (timescaledb.compress, timescaledb.compress_segmentby = 'device',
+    timescaledb.compress_orderby = 'ts');
+insert into vectab select x, x % 4, (x % 4) * 100 + x % 50, 'n' || x % 7, x
+from generate_series(1, 1000) x;
+select count(compress_chunk(x)) from show_chunks('vectab') x;
+
+-- The compressed batch statistics of the statement.
+create function dml_stats(query text) returns setof text language plpgsql as $$
+declare
+    line text;
+begin
+    for line in execute 'explain (analyze, costs off, timing off, summary off) ' || query loop
+        if line ~ '(Batches|Tuples) (filtered|decompressed|deleted|rewritten):' then
+            return next trim(line);
+        end if;
+    end loop;
+end;
+$$;
+
+-- Every batch has one device, and the values of each device are different, so
+-- the vectorized filters skip the batches of the other devices without
+-- decompressing them.
+begin;
+select dml_stats($$delete from vectab where val = 305$$);
+rollback;
+begin;
+delete from vectab where val = 305;
+select count(*) from vectab;
+rollback;
+
+begin;
+select dml_stats($$update vectab set val = -1 where val = 305 and name = 'n5'$$);
+rollback;
+begin;
+update vectab set val = -1 where val = 305 and name = 'n5';
+select count(*) from vectab where val = -1;
+rollback;
+
+-- The stable expressions are evaluated before the vectorized filters.
+begin;
+select dml_stats($$delete from vectab where val = 305 + 0 * extract(year from now())::int$$);
+rollback;
+begin;
+delete from vectab where val = 305 + 0 * extract(year from now())::int;
+select count(*) from vectab;
+rollback;
+
+-- The batches that don't match any vectorized filter are not decompressed.
+begin;
+select dml_stats($$delete from vectab where val > 1000$$);
+rollback;
+begin;
+delete from vectab where val > 1000;
+select count(*) from vectab;
+rollback;
+
+-- The numeric columns don't support bulk decompression, so these predicates
+-- are checked row by row. The vectorized filters on the other columns still
+-- apply.
+begin;
+select dml_stats($$delete from vectab where val = 305 and num = 55$$);
+rollback;
+begin;
+delete from vectab where val = 305 and num = 55;
+select count(*) from vectab;
+rollback;
+
+begin;
+select dml_stats($$delete from vectab where num = 55$$);
+rollback;
+begin;
+delete from vectab where num = 55;
+select count(*) from vectab;
+rollback;
+
+-- The segmentby predicates are checked by the batch scan.
+begin;
+select dml_stats($$delete from vectab where device = 3 and val < 310$$);
+rollback;
+begin;
+delete from vectab where device = 3 and val < 310;
+select count(*) from vectab;
+rollback;
+
+-- Same results without the bulk decompression, when all the predicates are
+-- checked row by row.
+set timescaledb.enable_bulk_decompression to off;
+
+-- Every batch has one device, and the values of each device are different, so
+-- the vectorized filters skip the batches of the other devices without
+-- decompressing them.
+begin;
+select dml_stats($$delete from vectab where val = 305$$);
+rollback;
+begin;
+delete from vectab where val = 305;
+select count(*) from vectab;
+rollback;
+
+begin;
+select dml_stats($$update vectab set val = -1 where val = 305 and name = 'n5'$$);
+rollback;
+begin;
+update vectab set val = -1 where val = 305 and name = 'n5';
+select count(*) from vectab where val = -1;
+rollback;
+
+-- The stable expressions are evaluated before the vectorized filters.
+begin;
+select dml_stats($$delete from vectab where val = 305 + 0 * extract(year from now())::int$$);
+rollback;
+begin;
+delete from vectab where val = 305 + 0 * extract(year from now())::int;
+select count(*) from vectab;
+rollback;
+
+-- The batches that don't match any vectorized filter are not decompressed.
+begin;
+select dml_stats($$delete from vectab where val > 1000$$);
+rollback;
+begin;
+delete from vectab where val > 1000;
+select count(*) from vectab;
+rollback;
+
+-- The numeric columns don't support bulk decompression, so these predicates
+-- are checked row by row. The vectorized filters on the other columns still
+-- apply.
+begin;
+select dml_stats($$delete from vectab where val = 305 and num = 55$$);
+rollback;
+begin;
+delete from vectab where val = 305 and num = 55;
+select count(*) from vectab;
+rollback;
+
+begin;
+select dml_stats($$delete from vectab where num = 55$$);
+rollback;
+begin;
+delete from vectab where num = 55;
+select count(*) from vectab;
+rollback;
+
+-- The segmentby predicates are checked by the batch scan.
+begin;
+select dml_stats($$delete from vectab where device = 3 and val < 310$$);
+rollback;
+begin;
+delete from vectab where device = 3 and val < 310;
+select count(*) from vectab;
+rollback;
+
+reset timescaledb.enable_bulk_decompression;
+
+-- The conflict checks of INSERT use the same vectorized filters on the key
+-- columns. The ts ranges of the batches overlap, so the batch metadata can't
+-- exclude any of them.
+create table conftab(ts int not null primary key, device int, val int);
+select create_hypertable('conftab', 'ts', chunk_time_interval => 10000);
+alter table conftab set (timescaledb.compress, timescaledb.compress_segmentby = 'device',
+    timescaledb.compress_orderby = 'ts');
+insert into conftab select 2 * x, x % 4, x from generate_series(1, 1000) x;
+select count(compress_chunk(x)) from show_chunks('conftab') x;
+
+begin;
+select dml_stats($$insert into conftab values (111, 0, 0) on conflict do nothing$$);
+select count(*) from conftab;
+rollback;
+begin;
+select dml_stats($$insert into conftab values (110, 0, 0) on conflict do nothing$$);
+select count(*) from conftab;
+rollback;
+-- The filters are built once for the chunk, check that every tuple uses its
+-- own key values.
+begin;
+select dml_stats($$insert into conftab values (110, 0, 0), (111, 0, 0), (112, 0, 0),
+    (113, 0, 0) on conflict do nothing$$);
+select count(*) from conftab;
+rollback;
+
+set timescaledb.enable_bulk_decompression to off;
+
+begin;
+select dml_stats($$insert into conftab values (111, 0, 0) on conflict do nothing$$);
+select count(*) from conftab;
+rollback;
+begin;
+select dml_stats($$insert into conftab values (110, 0, 0) on conflict do nothing$$);
+select count(*) from conftab;
+rollback;
+-- The filters are built once for the chunk, check that every tuple uses its
+-- own key values.
+begin;
+select dml_stats($$insert into conftab values (110, 0, 0), (111, 0, 0), (112, 0, 0),
+    (113, 0, 0) on conflict do nothing$$);
+select count(*) from conftab;
+rollback;
+
+reset timescaledb.enable_bulk_decompression;
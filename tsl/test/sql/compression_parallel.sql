@@ -0,0 +1,89 @@
+-- This file and its contents are licensed under the Timescale License.
+-- Please see the included NOTICE for copyright information and
+-- LICENSE-TIMESCALE for a copy of the license.
+
+create table partab(ts int not null, device int, val float8);
+select create_hypertable('partab', 'ts', chunk_time_interval => 100000);
+alter table partab set (timescaledb.compress, timescaledb.compress_segmentby = 'device',
+    timescaledb.compress_orderby = 'ts');
+insert into partab select x, x % 17, x * 0.5 from generate_series(1, 20000) x;
+create table partab_ref as select * from partab;
+
+set max_parallel_maintenance_workers = 2;
+set timescaledb.compression_parallel_workers = 2;
+set min_parallel_table_scan_size = 0;
+
+-- The workers scan the chunk together, and every segment is compressed by a
+-- single participant.
+set timescaledb.debug_compression_path_info = on;
+select count(compress_chunk(x)) from show_chunks('partab') x;
+reset timescaledb.debug_compression_path_info;
+select format('%I.%I', schema_name, table_name) as compressed_chunk
+from _timescaledb_catalog.chunk where hypertable_id = 2 and not dropped \gset
+select count(*) as batches, count(distinct device) as segments,
+    sum(_ts_meta_count) as rows
+from :compressed_chunk;
+select count(*) from (
+    select _ts_meta_max_1,
+        lead(_ts_meta_min_1) over (partition by device order by _ts_meta_min_1) as next_min
+    from :compressed_chunk) b
+where next_min <= _ts_meta_max_1;
+select count(*) from ((table partab except all table partab_ref)
+    union all (table partab_ref except all table partab)) d;
+
+-- The leader compresses the chunk alone if no workers can be launched.
+select count(decompress_chunk(x)) from show_chunks('partab') x;
+set max_parallel_workers = 0;
+set timescaledb.debug_compression_path_info = on;
+select count(compress_chunk(x)) from show_chunks('partab') x;
+reset timescaledb.debug_compression_path_info;
+reset max_parallel_workers;
+select format('%I.%I', schema_name, table_name) as compressed_chunk
+from _timescaledb_catalog.chunk where hypertable_id = 2 and not dropped \gset
+select count(*) as batches, count(distinct device) as segments,
+    sum(_ts_meta_count) as rows
+from :compressed_chunk;
+select count(*) from (
+    select _ts_meta_max_1,
+        lead(_ts_meta_min_1) over (partition by device order by _ts_meta_min_1) as next_min
+    from :compressed_chunk) b
+where next_min <= _ts_meta_max_1;
+select count(*) from ((table partab except all table partab_ref)
+    union all (table partab_ref except all table partab)) d;
+
+-- Segmentwise recompression spools the uncompressed rows into the partitions
+-- with a single scan of the chunk, and every segment is recompressed by a
+-- single participant.
+select show_chunks('partab') as chunk \gset
+insert into partab select x, x % 17, x * 0.5 from generate_series(20001, 22000) x;
+insert into partab_ref select x, x % 17, x * 0.5 from generate_series(20001, 22000) x;
+select count(_timescaledb_functions.recompress_chunk_segmentwise(x))
+from show_chunks('partab') x;
+select count(distinct device) as segments, sum(_ts_meta_count) as rows
+from :compressed_chunk;
+select count(*) from only :chunk;
+select count(*) from (
+    select _ts_meta_max_1,
+        lead(_ts_meta_min_1) over (partition by device order by _ts_meta_min_1) as next_min
+    from :compressed_chunk) b
+where next_min <= _ts_meta_max_1;
+select count(*) from ((table partab except all table partab_ref)
+    union all (table partab_ref except all table partab)) d;
+
+-- The leader recompresses the chunk alone if no workers can be launched.
+insert into partab select x, x % 17, x * 0.5 from generate_series(22001, 24000) x;
+insert into partab_ref select x, x % 17, x * 0.5 from generate_series(22001, 24000) x;
+set max_parallel_workers = 0;
+select count(_timescaledb_functions.recompress_chunk_segmentwise(x))
+from show_chunks('partab') x;
+reset max_parallel_workers;
+select count(distinct device) as segments, sum(_ts_meta_count) as rows
+from :compressed_chunk;
+select count(*) from only :chunk;
+select count(*) from (
+    select _ts_meta_max_1,
+        lead(_ts_meta_min_1) over (partition by device order by _ts_meta_min_1) as next_min
+    from :compressed_chunk) b
+where next_min <= _ts_meta_max_1;
+select count(*) from ((table partab except all table partab_ref)
+    union all (table partab_ref except all table partab)) d;
@@ -0,0 +1,69 @@
+-- This file and its contents are licensed under the Timescale License.
+-- Please see the included NOTICE for copyright information and
+-- LICENSE-TIMESCALE for a copy of the license.
+
+\c :TEST_DBNAME :ROLE_SUPERUSER
+
+create table uuidtab(ts int not null, device int, u uuid);
+select create_hypertable('uuidtab', 'ts', chunk_time_interval => 1000);
+alter table uuidtab set (timescaledb.compress, timescaledb.compress_segmentby = 'device',
+    timescaledb.compress_orderby = 'ts');
+
+-- The first chunk is compressed without the uuid compression, and the
+-- second one with it. The second chunk has both the plain and the version 7
+-- uuid layouts.
+set timescaledb.enable_uuid_compression to off;
+insert into uuidtab select x, x % 3,
+    case when x % 7 = 0 then null else md5((x % 50)::text)::uuid end
+from generate_series(1, 999) x;
+select count(compress_chunk(format('%I.%I', chunk_schema, chunk_name)::regclass))
+from timescaledb_information.chunks where hypertable_name = 'uuidtab' and not is_compressed;
+
+set timescaledb.enable_uuid_compression to on;
+insert into uuidtab select x, x % 3,
+    case when x % 7 = 0 then null
+        when x % 3 = 0 then md5((x % 50)::text)::uuid
+        else (lpad(to_hex(1700000000000 + x), 12, '0') || '7abc8def'
+            || lpad(to_hex(x % 50), 12, '0'))::uuid end
+from generate_series(1000, 1998) x;
+select count(compress_chunk(format('%I.%I', chunk_schema, chunk_name)::regclass))
+from timescaledb_information.chunks where hypertable_name = 'uuidtab' and not is_compressed;
+
+select (_timescaledb_functions.compressed_data_info(u)).algorithm, count(*)
+from _timescaledb_internal.compress_hyper_2_2_chunk group by 1;
+select (_timescaledb_functions.compressed_data_info(u)).algorithm, count(*)
+from _timescaledb_internal.compress_hyper_2_4_chunk group by 1;
+
+-- Both chunks use the vectorized filters on the uuid column.
+set timescaledb.debug_require_vector_qual to 'require';
+select count(*) from uuidtab where u = '8f14e45f-ceea-167a-5a36-dedd4bea2543';
+select count(*) from uuidtab where u <> '8f14e45f-ceea-167a-5a36-dedd4bea2543';
+select count(*) from uuidtab where u = '018bcfe5-6ddd-7abc-8def-000000000001';
+select count(*) from uuidtab where u <> '018bcfe5-6ddd-7abc-8def-000000000001';
+select count(*) from uuidtab where u is null;
+select count(*) from uuidtab where u is not null;
+select count(*) from uuidtab where u = '8f14e45f-ceea-167a-5a36-dedd4bea2543' and ts > 1500;
+
+-- Without the uuid compression, the uuid columns are not bulk decompressed
+-- and there are no vectorized filters on them.
+set timescaledb.enable_uuid_compression to off;
+set timescaledb.debug_require_vector_qual to 'forbid';
+select count(*) from uuidtab where u = '8f14e45f-ceea-167a-5a36-dedd4bea2543';
+select count(*) from uuidtab where u <> '8f14e45f-ceea-167a-5a36-dedd4bea2543';
+select count(*) from uuidtab where u = '018bcfe5-6ddd-7abc-8def-000000000001';
+select count(*) from uuidtab where u <> '018bcfe5-6ddd-7abc-8def-000000000001';
+select count(*) from uuidtab where u is null;
+select count(*) from uuidtab where u is not null;
+select count(*) from uuidtab where u = '8f14e45f-ceea-167a-5a36-dedd4bea2543' and ts > 1500;
+
+reset timescaledb.debug_require_vector_qual;
+reset timescaledb.enable_uuid_compression;
+-- Same results without compression.
+select count(decompress_chunk(x)) from show_chunks('uuidtab') x;
+select count(*) from uuidtab where u = '8f14e45f-ceea-167a-5a36-dedd4bea2543';
+select count(*) from uuidtab where u <> '8f14e45f-ceea-167a-5a36-dedd4bea2543';
+select count(*) from uuidtab where u = '018bcfe5-6ddd-7abc-8def-000000000001';
+select count(*) from uuidtab where u <> '018bcfe5-6ddd-7abc-8def-000000000001';
+select count(*) from uuidtab where u is null;
+select count(*) from uuidtab where u is not null;
+select count(*) from uuidtab where u = '8f14e45f-ceea-167a-5a36-dedd4bea2543' and ts > 1500;
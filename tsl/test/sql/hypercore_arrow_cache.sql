@@ -0,0 +1,106 @@
+-- This file and its contents are licensed under the Timescale License.
+-- Please see the included NOTICE for copyright information and
+-- LICENSE-TIMESCALE for a copy of the license.
+
+-- Test the arrow cache shared by the hypercore scans of a transaction. The
+-- cache has room for two compressed tuples.
+set timescaledb.hypercore_arrow_cache_shared to on;
+set timescaledb.arrow_cache_maxsize = 2;
+set timescaledb.enable_transparent_decompression to false;
+set timescaledb.enable_vectorized_aggregation to off;
+
+create table hc(ts int not null, device int, val int);
+select create_hypertable('hc', 'ts', chunk_time_interval => 10000);
+alter table hc set (timescaledb.compress, timescaledb.compress_segmentby = 'device',
+    timescaledb.compress_orderby = 'ts');
+insert into hc select x, x % 10, x from generate_series(1, 1000) x;
+select show_chunks('hc') as chunk \gset
+alter table :chunk set access method hypercore;
+
+-- The cache statistics of a query.
+create function cache_stats(query text) returns text language plpgsql as $$
+declare
+    line text;
+begin
+    -- Reset the statistics
+    execute 'explain (decompress_cache_stats) select 1';
+    for line in execute 'explain (analyze, costs off, timing off, summary off, '
+        'decompress_cache_stats) ' || query loop
+        if line like 'Array:%' then
+            return regexp_replace(line, ', decompress.*$', '');
+        end if;
+    end loop;
+    return null;
+end;
+$$;
+
+-- Every segment is a compressed tuple, so a scan misses the cache for every
+-- segment and evicts the earlier ones.
+begin;
+select cache_stats('select sum(val) from hc');
+commit;
+
+-- An error in a savepoint leaves the entry of the scan pinned, since its slot
+-- is not cleared. The pins are released with the savepoint, so all the
+-- entries can be evicted afterwards.
+begin;
+savepoint s1;
+\set ON_ERROR_STOP 0
+select val / (device - 3) from hc;
+rollback to savepoint s1;
+savepoint s2;
+select val / (device - 6) from hc;
+rollback to savepoint s2;
+\set ON_ERROR_STOP 1
+select cache_stats('select sum(val) from hc');
+select sum(val) from hc;
+commit;
+
+-- A cursor keeps its entry pinned across a rolled back savepoint, since the
+-- pin belongs to the cursor.
+begin;
+declare c cursor for select ts, val from hc;
+move 150 in c;
+savepoint s1;
+move 100 in c;
+fetch 1 from c;
+\set ON_ERROR_STOP 0
+select 1 / 0;
+\set ON_ERROR_STOP 1
+rollback to savepoint s1;
+fetch 1 from c;
+-- The entry of the cursor is not evicted.
+select cache_stats('select sum(val) from hc');
+close c;
+commit;
+
+-- Compressed tuples that replace truncated ones in the same transaction can
+-- get the same TIDs. The cache must not return the arrays of the truncated
+-- tuples for them.
+create table hc2(ts int not null, device int, val int);
+select create_hypertable('hc2', 'ts', chunk_time_interval => 10000);
+alter table hc2 set (timescaledb.compress, timescaledb.compress_segmentby = 'device',
+    timescaledb.compress_orderby = 'ts');
+insert into hc2 values (1, 1, 1);
+select show_chunks('hc2') as chunk2 \gset
+alter table :chunk2 set access method hypercore;
+begin;
+-- The TRUNCATE creates a new relation file
+truncate :chunk2;
+insert into hc2 select x, 1, x from generate_series(1, 10) x;
+select count(*) from compress_chunk(:'chunk2');
+select sum(val) from hc2;
+-- The file was created in this transaction, so the TRUNCATE keeps it
+truncate :chunk2;
+insert into hc2 select x, 1, x * 100 from generate_series(1, 10) x;
+select count(*) from compress_chunk(:'chunk2');
+select sum(val) from hc2;
+-- In a subtransaction, the TRUNCATE creates a new relation file again
+savepoint s1;
+truncate :chunk2;
+insert into hc2 select x, 1, x * 10000 from generate_series(1, 10) x;
+select count(*) from compress_chunk(:'chunk2');
+select sum(val) from hc2;
+release savepoint s1;
+select sum(val) from hc2;
+commit;
@@ -467,3 +467,26 @@ create unique index time_key on uniquetable (time);
 explain (costs off)
 select * from uniquetable where time = '2024-01-01 01:00';
 select * from uniquetable where time = '2024-01-01 01:00';
+
+-- The arrays decompressed from a compressed tuple have to stay valid while
+-- its rows are indexed, also when several variable-length columns are
+-- decompressed for a multi-column index.
+create table textidx(time timestamptz not null, device int, name text);
+select table_name from create_hypertable('textidx', 'time',
+    chunk_time_interval => interval '1 year', create_default_indexes => false);
+insert into textidx
+select '2024-01-01'::timestamptz + i * interval '1 minute', i % 3,
+    'name ' || (i % 97) || repeat('x', i % 20)
+from generate_series(1, 3000) i;
+alter table textidx set (timescaledb.compress, timescaledb.compress_segmentby = 'device',
+    timescaledb.compress_orderby = 'time');
+select count(compress_chunk(ch, hypercore_use_access_method => true))
+from show_chunks('textidx') ch;
+create index textidx_name_time_idx on textidx (name, time);
+
+set enable_seqscan to off;
+set enable_bitmapscan to off;
+select count(*), count(distinct name), sum(length(name)) from textidx where name >= '';
+select count(*) from textidx where name = 'name 5xxxxx';
+reset enable_seqscan;
+reset enable_bitmapscan;
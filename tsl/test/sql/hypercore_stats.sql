@@ -141,3 +141,35 @@ analyze :hypertable;
 select * from relstats where relid = :'chunk2'::regclass;
 -- Just show that there are attrstats via a count avoid flaky output
 select count(*) from attrstats where relid = :'chunk2'::regclass;
+
+--
+-- Test that ANALYZE samples compressed and non-compressed rows with
+-- the same probability when it only returns every Nth row. Compressed
+-- rows have a non-null value and non-compressed rows a null value, so
+-- the null fraction should be around 0.5.
+--
+create table sampled(created_at timestamptz not null, device int, value float);
+select create_hypertable('sampled', by_range('created_at', '1 year'::interval));
+alter table sampled set (
+	  timescaledb.compress,
+	  timescaledb.compress_orderby = 'created_at',
+	  timescaledb.compress_segmentby = 'device'
+);
+insert into sampled
+select '2022-01-01'::timestamptz + i * interval '1 minute', i % 10, i
+from generate_series(1, 20000) i;
+select compress_chunk(show_chunks('sampled'), hypercore_use_access_method => true) as sampled_chunk \gset
+insert into sampled
+select '2022-02-01'::timestamptz + i * interval '1 minute', i % 10, null
+from generate_series(1, 20000) i;
+
+-- Small statistics target to get a sampling distance larger than one
+set default_statistics_target to 1;
+analyze :sampled_chunk;
+reset default_statistics_target;
+
+select reltuples from pg_class where oid = :'sampled_chunk'::regclass;
+select null_frac between 0.35 and 0.65 as null_frac_ok
+from pg_stats
+where format('%I.%I', schemaname, tablename)::regclass = :'sampled_chunk'::regclass
+  and attname = 'value';
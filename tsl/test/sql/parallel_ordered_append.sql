@@ -0,0 +1,100 @@
+-- This file and its contents are licensed under the Timescale License.
+-- Please see the included NOTICE for copyright information and
+-- LICENSE-TIMESCALE for a copy of the license.
+--
+-- Test Gather Merge on top of a parallel ordered ChunkAppend. Each
+-- participant scans the chunks it gets in order, so the Gather Merge
+-- returns the rows in order.
+--
+-- Show the Gather Merge and ChunkAppend nodes of a plan and what is
+-- below the ChunkAppend
+create function show_plan(query text) returns setof text as $$
+declare
+    line text;
+begin
+    for line in execute 'explain (analyze, verbose, costs off, timing off, summary off) ' || query loop
+        if line ~ '(Gather Merge|Workers Planned|ChunkAppend|Order:|Exclusion|excluded|Merge Append|DecompressChunk|Sorted Merge)' then
+            return next regexp_replace(regexp_replace(line, '^\s*(->\s*)?', ''),
+                                       '\s*\((actual .*|never executed)\)$', '');
+        end if;
+    end loop;
+end
+$$ language plpgsql;
+
+-- Make the parallel plans cheap, so that they are picked for the small
+-- test tables
+set parallel_setup_cost to 0;
+set parallel_tuple_cost to 0;
+set min_parallel_table_scan_size to 0;
+set min_parallel_index_scan_size to 0;
+set max_parallel_workers_per_gather to 2;
+set cpu_tuple_cost to 0.1;
+
+-- Parallel ordered append is off by default
+set timescaledb.enable_parallel_ordered_append to on;
+
+-- Space partitioning, where the children of the ChunkAppend are a
+-- MergeAppend of the chunks of each time slice
+create table space(time timestamptz not null, device int, value float);
+select table_name from create_hypertable('space', 'time', chunk_time_interval => interval '1 day');
+select column_name from add_dimension('space', 'device', number_partitions => 2);
+insert into space
+select t, d, d
+from generate_series('2000-01-01 00:00+00'::timestamptz, '2000-01-03 23:59+00', '1 minute') t,
+     generate_series(1, 4) d;
+analyze space;
+select * from show_plan($$select count(*), count(*) filter (where time < prev) as out_of_order, sum(value)
+from (select time, value, lag(time) over () as prev
+      from (select time, value from space order by time) o) l$$);
+select count(*), count(*) filter (where time < prev) as out_of_order, sum(value)
+from (select time, value, lag(time) over () as prev
+      from (select time, value from space order by time) o) l;
+
+-- Compressed chunks, where the children of the ChunkAppend are
+-- DecompressChunk nodes merging the sorted batches
+create table metrics(time timestamptz not null, device int, value float);
+select table_name from create_hypertable('metrics', 'time', chunk_time_interval => interval '1 day');
+insert into metrics
+select t, d, d
+from generate_series('2000-01-01 00:00+00'::timestamptz, '2000-01-03 23:59+00', '1 minute') t,
+     generate_series(1, 4) d;
+alter table metrics set (timescaledb.compress, timescaledb.compress_segmentby = 'device', timescaledb.compress_orderby = 'time');
+select count(compress_chunk(c)) from show_chunks('metrics') c;
+analyze metrics;
+select * from show_plan($$select count(*), count(*) filter (where time < prev) as out_of_order, sum(value)
+from (select time, value, lag(time) over () as prev
+      from (select time, value from metrics order by time) o) l$$);
+select count(*), count(*) filter (where time < prev) as out_of_order, sum(value)
+from (select time, value, lag(time) over () as prev
+      from (select time, value from metrics order by time) o) l;
+
+-- Runtime exclusion with an InitPlan parameter, which is evaluated before
+-- the workers are started. Each participant excludes the same chunks.
+select * from show_plan($$select count(*), count(*) filter (where time < prev) as out_of_order, sum(value)
+from (select time, value, lag(time) over () as prev
+      from (select time, value from metrics where time >= (select '2000-01-03 00:00+00'::timestamptz) order by time) o) l$$);
+select count(*), count(*) filter (where time < prev) as out_of_order, sum(value)
+from (select time, value, lag(time) over () as prev
+      from (select time, value from metrics where time >= (select '2000-01-03 00:00+00'::timestamptz) order by time) o) l;
+
+-- No parallel ordered ChunkAppend with parallel ChunkAppend turned off
+set timescaledb.enable_parallel_chunk_append to off;
+select count(*) from show_plan($$select time, value from space order by time$$) l
+where l ~ 'Parallel Custom Scan \(ChunkAppend\)';
+reset timescaledb.enable_parallel_chunk_append;
+
+-- No parallel ordered ChunkAppend with parallel ordered append turned off
+set timescaledb.enable_parallel_ordered_append to off;
+select string_agg(l, E'\n') ~ 'Parallel Custom Scan \(ChunkAppend\)[^\n]*\nOrder:' as parallel_ordered
+from show_plan($$select time, value from space order by time$$) l;
+reset timescaledb.enable_parallel_ordered_append;
+
+reset parallel_setup_cost;
+reset parallel_tuple_cost;
+reset min_parallel_table_scan_size;
+reset min_parallel_index_scan_size;
+reset max_parallel_workers_per_gather;
+reset cpu_tuple_cost;
+drop table space;
+drop table metrics;
+drop function show_plan;
@@ -0,0 +1,121 @@
+-- This file and its contents are licensed under the Timescale License.
+-- Please see the included NOTICE for copyright information and
+-- LICENSE-TIMESCALE for a copy of the license.
+
+\c :TEST_DBNAME :ROLE_SUPERUSER
+\ir include/compression_utils.sql
+\c :TEST_DBNAME :ROLE_DEFAULT_PERM_USER
+
+-- The batches overlapping the new rows and the new rows are merged as sorted
+-- runs by segmentwise recompression. The descending order with the nulls first
+-- and the ties on the first orderby column check the comparison of the runs.
+create table mergetab(ts int not null, device int, val int);
+select create_hypertable('mergetab', 'ts', chunk_time_interval => 100000);
+alter table mergetab set (timescaledb.compress, timescaledb.compress_segmentby = 'device',
+    timescaledb.compress_orderby = 'val desc nulls first, ts',
+    timescaledb.compress_batch_size = 100);
+create table mergetab_ref(ts int not null, device int, val int);
+
+create view mergerows as
+select x as ts, x % 3 as device, case when x % 7 = 0 then null else (x / 10) % 20 end as val
+from generate_series(1, 6000) x;
+
+-- The rows of every batch in the order they are stored. The compressed val is
+-- NULL if all the values of the batch are null.
+create view batchrows as
+select c.device, c.ctid as batch, r.n, r.ts, r.val
+from _timescaledb_internal._compressed_hypertable_2 c
+cross join lateral (
+    select n, ts, val
+    from _timescaledb_internal.decompress_forward(c.ts, null::int) with ordinality d(ts, n)
+    left join _timescaledb_internal.decompress_forward(c.val, null::int) with ordinality v(val, n)
+    using (n)) r;
+
+insert into mergetab select * from mergerows where ts % 2 = 1;
+insert into mergetab_ref select * from mergerows where ts % 2 = 1;
+select count(compress_chunk(x)) from show_chunks('mergetab') x;
+select count(*) as rows, count(distinct batch) as batches_with_rows
+from batchrows \gset
+select :rows as rows, :batches_with_rows = count(*) as all_batches,
+    max(_ts_meta_count) <= 100 as max_size
+from _timescaledb_internal._compressed_hypertable_2;
+-- The rows of every batch are ordered by val desc nulls first, ts.
+select count(*) as misordered from (
+    select ts, val, lag(ts) over w as prev_ts, lag(val) over w as prev_val, n
+    from batchrows
+    window w as (partition by batch order by n)) r
+where n > 1 and ((prev_val is not null and val is null) or val > prev_val
+    or (val is not distinct from prev_val and ts < prev_ts));
+select count(*) from only _timescaledb_internal._hyper_1_1_chunk;
+select count(*) from ((table mergetab except all table mergetab_ref)
+    union all (table mergetab_ref except all table mergetab)) d;
+
+-- The new rows fall into all the batches.
+insert into mergetab select * from mergerows where ts % 2 = 0;
+insert into mergetab_ref select * from mergerows where ts % 2 = 0;
+select count(_timescaledb_functions.recompress_chunk_segmentwise(x))
+from show_chunks('mergetab') x;
+select count(*) as rows, count(distinct batch) as batches_with_rows
+from batchrows \gset
+select :rows as rows, :batches_with_rows = count(*) as all_batches,
+    max(_ts_meta_count) <= 100 as max_size
+from _timescaledb_internal._compressed_hypertable_2;
+-- The rows of every batch are ordered by val desc nulls first, ts.
+select count(*) as misordered from (
+    select ts, val, lag(ts) over w as prev_ts, lag(val) over w as prev_val, n
+    from batchrows
+    window w as (partition by batch order by n)) r
+where n > 1 and ((prev_val is not null and val is null) or val > prev_val
+    or (val is not distinct from prev_val and ts < prev_ts));
+select count(*) from only _timescaledb_internal._hyper_1_1_chunk;
+select count(*) from ((table mergetab except all table mergetab_ref)
+    union all (table mergetab_ref except all table mergetab)) d;
+
+-- Nulls and the values before and after all the batches make the new rows
+-- overlap only the first and the last batches of every segment.
+insert into mergetab select 6000 + x, x % 3, case when x % 2 = 0 then null else 100 end
+from generate_series(1, 300) x;
+insert into mergetab_ref select 6000 + x, x % 3, case when x % 2 = 0 then null else 100 end
+from generate_series(1, 300) x;
+insert into mergetab select 6300 + x, x % 3, -1 from generate_series(1, 300) x;
+insert into mergetab_ref select 6300 + x, x % 3, -1 from generate_series(1, 300) x;
+select count(_timescaledb_functions.recompress_chunk_segmentwise(x))
+from show_chunks('mergetab') x;
+select count(*) as rows, count(distinct batch) as batches_with_rows
+from batchrows \gset
+select :rows as rows, :batches_with_rows = count(*) as all_batches,
+    max(_ts_meta_count) <= 100 as max_size
+from _timescaledb_internal._compressed_hypertable_2;
+-- The rows of every batch are ordered by val desc nulls first, ts.
+select count(*) as misordered from (
+    select ts, val, lag(ts) over w as prev_ts, lag(val) over w as prev_val, n
+    from batchrows
+    window w as (partition by batch order by n)) r
+where n > 1 and ((prev_val is not null and val is null) or val > prev_val
+    or (val is not distinct from prev_val and ts < prev_ts));
+select count(*) from only _timescaledb_internal._hyper_1_1_chunk;
+select count(*) from ((table mergetab except all table mergetab_ref)
+    union all (table mergetab_ref except all table mergetab)) d;
+
+-- A segment that only has new rows is recompressed from a single run.
+insert into mergetab select 7000 + x, 5, x % 10 from generate_series(1, 250) x;
+insert into mergetab_ref select 7000 + x, 5, x % 10 from generate_series(1, 250) x;
+select count(_timescaledb_functions.recompress_chunk_segmentwise(x))
+from show_chunks('mergetab') x;
+select count(*) as batches, sum(_ts_meta_count) as rows
+from _timescaledb_internal._compressed_hypertable_2 where device = 5;
+select count(*) as rows, count(distinct batch) as batches_with_rows
+from batchrows \gset
+select :rows as rows, :batches_with_rows = count(*) as all_batches,
+    max(_ts_meta_count) <= 100 as max_size
+from _timescaledb_internal._compressed_hypertable_2;
+-- The rows of every batch are ordered by val desc nulls first, ts.
+select count(*) as misordered from (
+    select ts, val, lag(ts) over w as prev_ts, lag(val) over w as prev_val, n
+    from batchrows
+    window w as (partition by batch order by n)) r
+where n > 1 and ((prev_val is not null and val is null) or val > prev_val
+    or (val is not distinct from prev_val and ts < prev_ts));
+select count(*) from only _timescaledb_internal._hyper_1_1_chunk;
+select count(*) from ((table mergetab except all table mergetab_ref)
+    union all (table mergetab_ref except all table mergetab)) d;
@@ -24,10 +24,12 @@
 #include <export.h>
 
 #include "compression/algorithms/array.h"
+#include "compression/algorithms/bool_compress.h"
 #include "compression/algorithms/deltadelta.h"
 #include "compression/algorithms/dictionary.h"
 #include "compression/algorithms/float_utils.h"
 #include "compression/algorithms/gorilla.h"
+#include "compression/algorithms/uuid_compress.h"
 #include "compression/arrow_c_data_interface.h"
 #include "compression/segment_meta.h"
 
@@ -617,6 +619,315 @@ test_delta4(const int32 *values, int n)
 	TestAssertTrue(i == n);
 }
 
+static void
+test_bool(bool have_nulls, bool have_random)
+{
+	BoolCompressor *compressor = bool_compressor_alloc();
+	Datum compressed;
+
+	bool values[TEST_ELEMENTS];
+	bool nulls[TEST_ELEMENTS];
+	for (int i = 0; i < TEST_ELEMENTS; i++)
+	{
+		if (have_random)
+		{
+			/* Also add some stretches of equal values. */
+			values[i] = (i % 97 < 70) ? (i / 97) % 2 == 0 : test_hash64(i) % 2 == 0;
+		}
+		else
+		{
+			values[i] = i % 3 == 0;
+		}
+
+		nulls[i] = have_nulls && i % 29 == 0;
+
+		if (nulls[i])
+		{
+			bool_compressor_append_null(compressor);
+		}
+		else
+		{
+			bool_compressor_append_value(compressor, values[i]);
+		}
+	}
+
+	compressed = PointerGetDatum(bool_compressor_finish(compressor));
+	TestAssertTrue(DatumGetPointer(compressed) != NULL);
+
+	/* Forward decompression. */
+	DecompressionIterator *iter = bool_decompression_iterator_from_datum_forward(compressed, BOOLOID);
+	ArrowArray *bulk_result = bool_decompress_all(compressed, BOOLOID, CurrentMemoryContext);
+	ArrowArray *generic_result =
+		bool_decompress_all_generic(compressed, BOOLOID, CurrentMemoryContext);
+	TestAssertInt64Eq(bulk_result->length, TEST_ELEMENTS);
+	TestAssertInt64Eq(generic_result->length, TEST_ELEMENTS);
+	TestAssertInt64Eq(bulk_result->null_count, generic_result->null_count);
+	for (int i = 0; i < TEST_ELEMENTS; i++)
+	{
+		DecompressResult r = bool_decompression_iterator_try_next_forward(iter);
+		TestAssertTrue(!r.is_done);
+		if (r.is_null)
+		{
+			TestAssertTrue(nulls[i]);
+			TestAssertTrue(!arrow_row_is_valid(bulk_result->buffers[0], i));
+			TestAssertTrue(!arrow_row_is_valid(generic_result->buffers[0], i));
+		}
+		else
+		{
+			TestAssertTrue(!nulls[i]);
+			TestAssertTrue(arrow_row_is_valid(bulk_result->buffers[0], i));
+			TestAssertTrue(arrow_row_is_valid(generic_result->buffers[0], i));
+			TestAssertTrue(values[i] == DatumGetBool(r.val));
+			TestAssertTrue(values[i] == arrow_row_is_valid(bulk_result->buffers[1], i));
+			TestAssertTrue(values[i] == arrow_row_is_valid(generic_result->buffers[1], i));
+		}
+	}
+	DecompressResult r = bool_decompression_iterator_try_next_forward(iter);
+	TestAssertTrue(r.is_done);
+
+	/* Reverse decompression. */
+	iter = bool_decompression_iterator_from_datum_reverse(compressed, BOOLOID);
+	for (int i = TEST_ELEMENTS - 1; i >= 0; i--)
+	{
+		DecompressResult r = bool_decompression_iterator_try_next_reverse(iter);
+		TestAssertTrue(!r.is_done);
+		if (r.is_null)
+		{
+			TestAssertTrue(nulls[i]);
+		}
+		else
+		{
+			TestAssertTrue(!nulls[i]);
+			TestAssertTrue(values[i] == DatumGetBool(r.val));
+		}
+	}
+	r = bool_decompression_iterator_try_next_reverse(iter);
+	TestAssertTrue(r.is_done);
+}
+
+static void
+test_uuid(bool have_nulls, bool have_v7)
+{
+	UuidCompressor *compressor = uuid_compressor_alloc();
+	Datum compressed;
+
+	pg_uuid_t values[TEST_ELEMENTS];
+	bool nulls[TEST_ELEMENTS];
+	for (int i = 0; i < TEST_ELEMENTS; i++)
+	{
+		uint64 hi = test_hash64(2 * i);
+		uint64 lo = test_hash64(2 * i + 1);
+		memcpy(&values[i].data[0], &hi, sizeof(uint64));
+		memcpy(&values[i].data[8], &lo, sizeof(uint64));
+
+		/* The v4 batch has one v7 value, and the v7 batch has only v7 values. */
+		if (have_v7 || i == 0)
+		{
+			/* Millisecond timestamp with some repeated values. */
+			const uint64 ts = 1700000000000ULL + i / 3;
+			for (int j = 0; j < 6; j++)
+			{
+				values[i].data[j] = (ts >> (8 * (5 - j))) & 0xFF;
+			}
+			values[i].data[6] = (values[i].data[6] & 0x0F) | 0x70;
+		}
+		else
+		{
+			values[i].data[6] = (values[i].data[6] & 0x0F) | 0x40;
+		}
+		values[i].data[8] = (values[i].data[8] & 0x3F) | 0x80;
+
+		nulls[i] = have_nulls && i % 29 == 0;
+
+		if (nulls[i])
+		{
+			uuid_compressor_append_null(compressor);
+		}
+		else
+		{
+			uuid_compressor_append_value(compressor, &values[i]);
+		}
+	}
+
+	compressed = PointerGetDatum(uuid_compressor_finish(compressor));
+	TestAssertTrue(DatumGetPointer(compressed) != NULL);
+
+	/* Forward decompression. */
+	DecompressionIterator *iter = uuid_decompression_iterator_from_datum_forward(compressed, UUIDOID);
+	ArrowArray *bulk_result = uuid_decompress_all(compressed, UUIDOID, CurrentMemoryContext);
+	TestAssertInt64Eq(bulk_result->length, TEST_ELEMENTS);
+	for (int i = 0; i < TEST_ELEMENTS; i++)
+	{
+		DecompressResult r = uuid_decompression_iterator_try_next_forward(iter);
+		TestAssertTrue(!r.is_done);
+		if (r.is_null)
+		{
+			TestAssertTrue(nulls[i]);
+			TestAssertTrue(!arrow_row_is_valid(bulk_result->buffers[0], i));
+		}
+		else
+		{
+			TestAssertTrue(!nulls[i]);
+			TestAssertTrue(arrow_row_is_valid(bulk_result->buffers[0], i));
+			TestAssertTrue(memcmp(&values[i], DatumGetUUIDP(r.val), UUID_LEN) == 0);
+			TestAssertTrue(
+				memcmp(&values[i], &((pg_uuid_t *) bulk_result->buffers[1])[i], UUID_LEN) == 0);
+		}
+	}
+	DecompressResult r = uuid_decompression_iterator_try_next_forward(iter);
+	TestAssertTrue(r.is_done);
+
+	/* Reverse decompression. */
+	iter = uuid_decompression_iterator_from_datum_reverse(compressed, UUIDOID);
+	for (int i = TEST_ELEMENTS - 1; i >= 0; i--)
+	{
+		DecompressResult r = uuid_decompression_iterator_try_next_reverse(iter);
+		TestAssertTrue(!r.is_done);
+		if (r.is_null)
+		{
+			TestAssertTrue(nulls[i]);
+		}
+		else
+		{
+			TestAssertTrue(!nulls[i]);
+			TestAssertTrue(memcmp(&values[i], DatumGetUUIDP(r.val), UUID_LEN) == 0);
+		}
+	}
+	r = uuid_decompression_iterator_try_next_reverse(iter);
+	TestAssertTrue(r.is_done);
+}
+
+/*
+ * The gorilla bulk decompression of the smaller integer types, which is used
+ * when the adaptive compression chooses gorilla instead of delta-delta.
+ */
+static void
+test_gorilla_bulk_int(Oid type, bool have_nulls)
+{
+	Compressor *compressor = gorilla_compressor_for_type(type);
+	int64 values[TEST_ELEMENTS];
+	bool nulls[TEST_ELEMENTS];
+	for (int i = 0; i < TEST_ELEMENTS; i++)
+	{
+		/* The negative values check that the sign survives the bit patterns. */
+		values[i] = (i % 7 == 0 ? -1 : 1) * (i / 10) + (type == INT2OID ? PG_INT16_MIN : 0);
+		if (type == INT4OID && i % 13 == 0)
+			values[i] = PG_INT32_MAX - i;
+
+		nulls[i] = have_nulls && i % 29 == 0;
+		if (nulls[i])
+			compressor->append_null(compressor);
+		else
+			compressor->append_val(compressor,
+								   type == INT2OID ? Int16GetDatum((int16) values[i]) :
+													 Int32GetDatum((int32) values[i]));
+	}
+
+	Datum compressed = PointerGetDatum(compressor->finish(compressor));
+	TestAssertTrue(((const CompressedDataHeader *) DatumGetPointer(compressed))
+					   ->compression_algorithm == COMPRESSION_ALGORITHM_GORILLA);
+
+	DecompressAllFunction decompress_all =
+		tsl_get_decompress_all_function(COMPRESSION_ALGORITHM_GORILLA, type);
+	TestAssertTrue(decompress_all != NULL);
+	ArrowArray *bulk_result = decompress_all(compressed, type, CurrentMemoryContext);
+	TestAssertInt64Eq(bulk_result->length, TEST_ELEMENTS);
+	TestAssertInt64Eq(bulk_result->null_count, have_nulls ? (TEST_ELEMENTS + 28) / 29 : 0);
+
+	/* The bulk and the row-by-row decompression must give the same results. */
+	DecompressionIterator *iter =
+		gorilla_decompression_iterator_from_datum_forward(compressed, type);
+	int i = 0;
+	for (DecompressResult r = iter->try_next(iter); !r.is_done; r = iter->try_next(iter), i++)
+	{
+		TestAssertTrue(i < TEST_ELEMENTS);
+		TestAssertTrue(r.is_null == nulls[i]);
+		TestAssertTrue(arrow_row_is_valid(bulk_result->buffers[0], i) == !nulls[i]);
+		if (nulls[i])
+			continue;
+
+		if (type == INT2OID)
+		{
+			TestAssertInt64Eq(DatumGetInt16(r.val), values[i]);
+			TestAssertInt64Eq(((int16 *) bulk_result->buffers[1])[i], values[i]);
+		}
+		else
+		{
+			TestAssertInt64Eq(DatumGetInt32(r.val), values[i]);
+			TestAssertInt64Eq(((int32 *) bulk_result->buffers[1])[i], values[i]);
+		}
+	}
+	TestAssertInt64Eq(i, TEST_ELEMENTS);
+}
+
+static void
+test_adaptive(bool have_nulls, bool have_random)
+{
+	Compressor *adaptive =
+		adaptive_compressor_for_type(INT8OID, COMPRESSION_ALGORITHM_SELECTION_SIZE);
+	Compressor *deltadelta = delta_delta_compressor_for_type(INT8OID);
+	Compressor *gorilla = gorilla_compressor_for_type(INT8OID);
+	TestAssertTrue(adaptive != NULL);
+
+	int64 values[TEST_ELEMENTS];
+	bool nulls[TEST_ELEMENTS];
+	for (int i = 0; i < TEST_ELEMENTS; i++)
+	{
+		/*
+		 * The regular sequence is best compressed by delta-delta, and the
+		 * random values that repeat for a while, by gorilla.
+		 */
+		values[i] = have_random ? (int64) test_hash64(i / 50) : 10 * i;
+		nulls[i] = have_nulls && i % 29 == 0;
+
+		Compressor *compressors[] = { adaptive, deltadelta, gorilla };
+		for (int j = 0; j < 3; j++)
+		{
+			if (nulls[i])
+				compressors[j]->append_null(compressors[j]);
+			else
+				compressors[j]->append_val(compressors[j], Int64GetDatum(values[i]));
+		}
+	}
+
+	Datum compressed = PointerGetDatum(adaptive->finish(adaptive));
+	Datum deltadelta_compressed = PointerGetDatum(deltadelta->finish(deltadelta));
+	Datum gorilla_compressed = PointerGetDatum(gorilla->finish(gorilla));
+
+	/* The smallest of the candidates must be chosen. */
+	TestAssertInt64Eq(VARSIZE(DatumGetPointer(compressed)),
+					  Min(VARSIZE(DatumGetPointer(deltadelta_compressed)),
+						  VARSIZE(DatumGetPointer(gorilla_compressed))));
+
+	/* The chosen algorithm is recorded in the header and supports bulk decompression. */
+	const CompressedDataHeader *header =
+		(const CompressedDataHeader *) DatumGetPointer(compressed);
+	TestAssertTrue(header->compression_algorithm == COMPRESSION_ALGORITHM_DELTADELTA ||
+				   header->compression_algorithm == COMPRESSION_ALGORITHM_GORILLA);
+	DecompressAllFunction decompress_all =
+		tsl_get_decompress_all_function(header->compression_algorithm, INT8OID);
+	TestAssertTrue(decompress_all != NULL);
+
+	ArrowArray *bulk_result = decompress_all(compressed, INT8OID, CurrentMemoryContext);
+	TestAssertInt64Eq(bulk_result->length, TEST_ELEMENTS);
+	for (int i = 0; i < TEST_ELEMENTS; i++)
+	{
+		if (nulls[i])
+		{
+			TestAssertTrue(!arrow_row_is_valid(bulk_result->buffers[0], i));
+		}
+		else
+		{
+			TestAssertTrue(arrow_row_is_valid(bulk_result->buffers[0], i));
+			TestAssertInt64Eq(((int64 *) bulk_result->buffers[1])[i], values[i]);
+		}
+	}
+
+	/* The compressor is reusable for the next batch. */
+	adaptive->append_null(adaptive);
+	TestAssertTrue(adaptive->finish(adaptive) == NULL);
+}
+
 Datum
 ts_test_compression(PG_FUNCTION_ARGS)
 {
@@ -641,6 +952,23 @@ ts_test_compression(PG_FUNCTION_ARGS)
 	test_delta4(test_delta4_case1, sizeof(test_delta4_case1) / sizeof(*test_delta4_case1));
 	test_delta4(test_delta4_case2, sizeof(test_delta4_case2) / sizeof(*test_delta4_case2));
 
+	test_bool(/* have_nulls = */ false, /* have_random = */ false);
+	test_bool(/* have_nulls = */ false, /* have_random = */ true);
+	test_bool(/* have_nulls = */ true, /* have_random = */ false);
+	test_bool(/* have_nulls = */ true, /* have_random = */ true);
+	test_uuid(/* have_nulls = */ false, /* have_v7 = */ false);
+	test_uuid(/* have_nulls = */ false, /* have_v7 = */ true);
+	test_uuid(/* have_nulls = */ true, /* have_v7 = */ false);
+	test_uuid(/* have_nulls = */ true, /* have_v7 = */ true);
+	test_gorilla_bulk_int(INT2OID, /* have_nulls = */ false);
+	test_gorilla_bulk_int(INT2OID, /* have_nulls = */ true);
+	test_gorilla_bulk_int(INT4OID, /* have_nulls = */ false);
+	test_gorilla_bulk_int(INT4OID, /* have_nulls = */ true);
+	test_adaptive(/* have_nulls = */ false, /* have_random = */ false);
+	test_adaptive(/* have_nulls = */ false, /* have_random = */ true);
+	test_adaptive(/* have_nulls = */ true, /* have_random = */ false);
+	test_adaptive(/* have_nulls = */ true, /* have_random = */ true);
+
 	PG_RETURN_VOID();
 }
 